@@ -18,6 +18,8 @@ enum {
     ARK_LINK_FLAG_INCREMENTAL = 1u << 2,
     ARK_LINK_FLAG_LTO = 1u << 3,
     ARK_LINK_FLAG_STRIP = 1u << 4,
+    ARK_LINK_FLAG_GC_SECTIONS = 1u << 5,
+    ARK_LINK_FLAG_ICF = 1u << 6,
 };
 
 
@@ -104,6 +106,53 @@ typedef struct ArkLinkInput {
     size_t size;            
 } ArkLinkInput;
 
+typedef enum ArkLinkPhase {
+    ARK_LINK_PHASE_LOAD,
+    ARK_LINK_PHASE_ARCHIVE,
+    ARK_LINK_PHASE_RESOLVE,
+    ARK_LINK_PHASE_LAYOUT,
+    ARK_LINK_PHASE_RELOCATE,
+    ARK_LINK_PHASE_WRITE,
+    ARK_LINK_PHASE_COUNT,
+} ArkLinkPhase;
+
+typedef enum ArkLinkStatsFormat {
+    ARK_LINK_STATS_TEXT,
+    ARK_LINK_STATS_JSON,
+    ARK_LINK_STATS_TRACE,
+} ArkLinkStatsFormat;
+
+#define ARK_LINK_STATS_MAX_SPANS 128
+
+typedef struct ArkLinkPhaseStats {
+    uint64_t wall_ns;       
+    uint64_t peak_memory;   
+    uint32_t count;         
+} ArkLinkPhaseStats;
+
+typedef struct ArkLinkStatsSpan {
+    ArkLinkPhase phase;
+    uint32_t depth;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    uint64_t peak_memory;
+} ArkLinkStatsSpan;
+
+typedef struct ArkLinkStats {
+    ArkLinkPhaseStats phases[ARK_LINK_PHASE_COUNT];
+    ArkLinkStatsSpan spans[ARK_LINK_STATS_MAX_SPANS];
+    size_t span_count;
+    uint64_t total_ns;
+    uint64_t peak_memory;
+    size_t unit_count;
+    size_t archive_member_count;
+    size_t section_count;
+    size_t symbol_count;
+    size_t relocation_count;
+    uint64_t input_bytes;
+    uint64_t output_bytes;
+} ArkLinkStats;
+
 typedef struct ArkLinkJob {
     const ArkLinkInput* inputs;
     size_t input_count;
@@ -118,6 +167,7 @@ typedef struct ArkLinkJob {
     size_t library_path_count;
     const char** libraries;
     size_t library_count;
+    ArkLinkStats* stats;
 } ArkLinkJob;
 
 
@@ -131,6 +181,12 @@ ArkLinkResult arklink_link(const ArkLinkJob* job);
 const char* arklink_error_string(ArkLinkResult code);
 
 
+const char* arklink_phase_name(ArkLinkPhase phase);
+
+
+ArkLinkResult arklink_stats_write(const ArkLinkStats* stats, ArkLinkStatsFormat format, const char* path);
+
+
 
 
 
@@ -153,6 +209,7 @@ ArkLinkResult arklink_session_set_image_base(ArkLinkSession* session, uint64_t i
 ArkLinkResult arklink_session_set_stack_size(ArkLinkSession* session, uint64_t stack_size);
 ArkLinkResult arklink_session_set_logger(ArkLinkSession* session, ArkLinkLogger logger, void* user_data);
 ArkLinkResult arklink_session_set_flags(ArkLinkSession* session, uint32_t flags);
+ArkLinkResult arklink_session_enable_stats(ArkLinkSession* session, int enable);
 
 
 ArkLinkResult arklink_session_add_input(ArkLinkSession* session, const char* path);
@@ -179,6 +236,9 @@ ArkLinkResult arklink_session_link(ArkLinkSession* session);
 
 const char* arklink_session_get_error(const ArkLinkSession* session);
 
+
+const ArkLinkStats* arklink_session_get_stats(const ArkLinkSession* session);
+
 #ifdef __cplusplus
 }
 #endif
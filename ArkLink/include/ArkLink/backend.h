@@ -12,6 +12,11 @@ typedef struct ArkBackendInputSection {
     const char* name;
     const ArkSectionBuffer* buffer;
     uint32_t id;
+    size_t reloc_first;
+    size_t reloc_count;
+    size_t reserve;
+    uint64_t address;
+    uint64_t file_offset;
 } ArkBackendInputSection;
 
 typedef struct ArkBackendInputSymbol {
@@ -23,6 +28,8 @@ typedef struct ArkBackendInputSymbol {
     ArkSymbolVisibility visibility;
     int32_t import_id;
     int is_export;          
+    uint64_t address;
+    uint64_t got_address;
 } ArkBackendInputSymbol;
 
 typedef struct ArkBackendInputReloc {
@@ -45,6 +52,20 @@ typedef struct ArkBackendInputExport {
     uint32_t ordinal;
 } ArkBackendInputExport;
 
+typedef enum ArkBackendSlotType {
+    ARK_BACKEND_SLOT_ABS64,
+    ARK_BACKEND_SLOT_REL32,
+    ARK_BACKEND_SLOT_SIZE64,
+} ArkBackendSlotType;
+
+
+typedef struct ArkBackendAddressSlot {
+    uint32_t symbol_index;
+    uint32_t type;
+    uint64_t file_offset;
+    uint64_t address;
+} ArkBackendAddressSlot;
+
 typedef struct ArkBackendInput {
     ArkBackendInputSection* sections;
     size_t section_count;
@@ -56,6 +77,9 @@ typedef struct ArkBackendInput {
     size_t import_count;
     ArkBackendInputExport* exports;
     size_t export_count;
+    ArkBackendAddressSlot* address_slots;
+    size_t address_slot_count;
+    int record_layout;
     uint32_t entry_section;
     uint32_t entry_offset;
     ArkLinkOutputKind output_kind;
@@ -93,6 +93,8 @@ const ArkLinkJob* ark_context_job(const ArkLinkContext* ctx);
 ArkArena* ark_context_arena(ArkLinkContext* ctx);
 
 const char* ark_context_intern(ArkLinkContext* ctx, ArkStringView view);
+const char* ark_context_intern_hashed(ArkLinkContext* ctx, ArkStringView view, size_t hash);
+size_t ark_context_hash(ArkStringView view);
 
 
 const ArkParsedConfig* ark_context_config(const ArkLinkContext* ctx);
@@ -102,11 +104,18 @@ void ark_context_set_config(ArkLinkContext* ctx, ArkParsedConfig* config);
 
 
 
+ArkLinkStats* ark_context_stats(ArkLinkContext* ctx);
+void ark_context_phase_begin(ArkLinkContext* ctx, ArkLinkPhase phase);
+void ark_context_phase_end(ArkLinkContext* ctx, ArkLinkPhase phase);
+
+
+
 
 
 ArkLinkResult ark_section_buffer_init(ArkSectionBuffer* buffer, ArkSectionKind kind, uint32_t flags, uint32_t alignment);
 ArkLinkResult ark_section_buffer_append(ArkSectionBuffer* buffer, const void* data, size_t size);
 ArkLinkResult ark_section_buffer_resize(ArkSectionBuffer* buffer, size_t new_size);
+ArkLinkResult ark_section_buffer_make_writable(ArkSectionBuffer* buffer);
 void ark_section_buffer_release(ArkSectionBuffer* buffer);
 
 
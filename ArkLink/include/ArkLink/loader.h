@@ -7,6 +7,8 @@
 struct ArkArchive;
 typedef struct ArkArchive ArkArchive;
 
+struct ArkMappedFile;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -113,6 +115,7 @@ typedef struct ArkSectionDesc {
     size_t size;
     size_t alignment;
     uint32_t flags;
+    int borrow_data;
 } ArkSectionDesc;
 
 typedef struct ArkLinkUnit {
@@ -127,6 +130,8 @@ typedef struct ArkLinkUnit {
     
     uint8_t* file_data;
     size_t file_size;
+    struct ArkMappedFile* mapping;
+    char* string_pool;
 } ArkLinkUnit;
 
 
@@ -141,6 +146,7 @@ int ark_link_section_add_reloc(ArkLinkSection* section, const ArkRelocationDesc*
 
 
 ArkLinkResult ark_link_load_eo(const char* path, ArkLinkUnit** unit);
+ArkLinkResult ark_link_load_eo_memory(const char* name, const uint8_t* data, size_t size, ArkLinkUnit** unit);
 
 
 int ark_link_unit_add_reloc(ArkLinkUnit* unit, const ArkRelocationDesc* desc);
@@ -0,0 +1,45 @@
+#ifndef ARKLINK_OUTPUT_FILE_H
+#define ARKLINK_OUTPUT_FILE_H
+
+#include "ArkLink/arklink.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct ArkOutputFile {
+    uint8_t* data;
+    size_t size;
+    char* path;
+    char* temp_path;
+    bool mapped;
+#ifdef _WIN32
+    void* file_handle;
+    void* mapping_handle;
+#else
+    int fd;
+#endif
+} ArkOutputFile;
+
+
+
+
+ArkLinkResult ark_output_file_open(const char* path, size_t size, ArkOutputFile* file);
+
+
+
+
+ArkLinkResult ark_output_file_commit(ArkOutputFile* file, bool executable);
+
+
+void ark_output_file_discard(ArkOutputFile* file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
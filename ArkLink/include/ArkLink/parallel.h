@@ -0,0 +1,40 @@
+#ifndef ARKLINK_PARALLEL_H
+#define ARKLINK_PARALLEL_H
+
+#include <stddef.h>
+
+#ifndef _WIN32
+    #include <pthread.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*ArkParallelFn)(void* user_data, size_t index);
+
+typedef struct ArkMutex {
+#ifdef _WIN32
+    void* lock;
+#else
+    pthread_mutex_t lock;
+#endif
+} ArkMutex;
+
+
+size_t ark_parallel_worker_count(void);
+
+
+void ark_parallel_for(size_t count, ArkParallelFn fn, void* user_data);
+
+
+void ark_mutex_init(ArkMutex* mutex);
+void ark_mutex_destroy(ArkMutex* mutex);
+void ark_mutex_lock(ArkMutex* mutex);
+void ark_mutex_unlock(ArkMutex* mutex);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,6 +1,11 @@
 #include "ArkLink/targets/elf.h"
 #include "ArkLink/backend.h"
+#include "ArkLink/context.h"
+#include "ArkLink/output_file.h"
+#include "ArkLink/parallel.h"
 
+#include <stdatomic.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -95,6 +100,12 @@
 #define R_X86_64_RELATIVE 8
 #define R_X86_64_GOTPCREL 9
 
+#define SHN_UNDEF 0
+#define SHN_ABS 0xfff1
+
+#define ARK_ELF_PAGE_SIZE 0x1000
+#define ARK_ELF_IMAGE_BASE 0x400000
+
 
 typedef struct {
     unsigned char e_ident[16];
@@ -167,10 +178,11 @@ typedef struct {
 
 
 typedef struct {
-    char* name;
-    uint8_t* data;
+    const char* name;
+    const uint8_t* data;
     size_t size;
-    size_t capacity;
+    size_t data_size;
+    uint32_t name_offset;
     uint64_t addr;
     uint64_t offset;
     uint32_t type;
@@ -195,11 +207,26 @@ typedef struct {
 
 
 typedef struct {
+    ArkLinkContext* ctx;
     ArkBackendInput* input;
     ArkELFSection* sections;
     size_t section_count;
+    size_t stub_index;
+    size_t got_index;
+    size_t symtab_index;
+    size_t strtab_index;
+    size_t shstrtab_index;
     ArkELFSegment* segments;
     size_t segment_count;
+    uint32_t* got_slots;
+    size_t got_count;
+    Elf64_Sym* symtab;
+    uint32_t* symtab_source;
+    size_t symtab_count;
+    size_t symtab_first_global;
+    char* strtab;
+    size_t strtab_size;
+    uint64_t stub_target;
     char* shstrtab;
     size_t shstrtab_size;
     size_t shstrtab_capacity;
@@ -361,9 +388,101 @@ static int ark_elf_add_dynamic(ArkELFState* state, int64_t tag, uint64_t val) {
     return 0;
 }
 
+static const uint8_t ark_elf_start_stub[] = {
+    0x31, 0xED,
+    0x48, 0x8B, 0x3C, 0x24,
+    0x48, 0x8D, 0x74, 0x24, 0x08,
+    0x48, 0x8D, 0x54, 0xFE, 0x08,
+    0x48, 0x83, 0xE4, 0xF0,
+    0xE8, 0x00, 0x00, 0x00, 0x00,
+    0x89, 0xC7,
+    0xB8, 0xE7, 0x00, 0x00, 0x00,
+    0x0F, 0x05,
+};
+
+#define ARK_ELF_STUB_CALL_OFFSET 21
+
+static int ark_elf_section_class(const ArkELFSection* sec) {
+    if (sec->flags & SHF_EXECINSTR) {
+        return 1;
+    }
+    if (sec->flags & SHF_WRITE) {
+        return 2;
+    }
+    return 0;
+}
+
+static int ark_elf_symbol_defined(const ArkELFState* state, const ArkBackendInputSymbol* sym) {
+    return sym->section_id < state->input->section_count;
+}
+
+static uint64_t ark_elf_symbol_address(const ArkELFState* state, uint32_t symbol_index) {
+    if (symbol_index >= state->input->symbol_count) {
+        return 0;
+    }
+    const ArkBackendInputSymbol* sym = &state->input->symbols[symbol_index];
+    if (!ark_elf_symbol_defined(state, sym)) {
+        return 0;
+    }
+    return state->sections[sym->section_id + 1].addr + sym->value;
+}
+
+static const ArkBackendInputSymbol* ark_elf_find_entry_symbol(const ArkELFState* state) {
+    const char* name = state->input->entry_point_name ? state->input->entry_point_name : "_start";
+    for (size_t i = 0; i < state->input->symbol_count; i++) {
+        const ArkBackendInputSymbol* sym = &state->input->symbols[i];
+        if (sym->name && strcmp(sym->name, name) == 0 && ark_elf_symbol_defined(state, sym)) {
+            return sym;
+        }
+    }
+    return NULL;
+}
+
+static ArkLinkResult ark_elf_check_relocs(ArkELFState* state) {
+    for (size_t i = 0; i < state->input->reloc_count; i++) {
+        const ArkBackendInputReloc* reloc = &state->input->relocs[i];
+        if (reloc->symbol_index >= state->input->symbol_count) {
+            continue;
+        }
+        const ArkBackendInputSymbol* sym = &state->input->symbols[reloc->symbol_index];
+        
+        
+        if (!ark_elf_symbol_defined(state, sym) && sym->import_id >= 0) {
+            ark_context_log(state->ctx, ARK_LOG_ERROR,
+                "Static ELF output cannot bind imported symbol: %s", sym->name ? sym->name : "(null)");
+            return ARK_LINK_ERR_UNSUPPORTED;
+        }
+        
+        if (reloc->type == ARK_RELOC_GOTPC32) {
+            if (!state->got_slots) {
+                state->got_slots = (uint32_t*)malloc(state->input->symbol_count * sizeof(uint32_t));
+                if (!state->got_slots) {
+                    return ARK_LINK_ERR_MEMORY;
+                }
+                memset(state->got_slots, 0xFF, state->input->symbol_count * sizeof(uint32_t));
+            }
+            if (state->got_slots[reloc->symbol_index] == UINT32_MAX) {
+                state->got_slots[reloc->symbol_index] = (uint32_t)state->got_count++;
+            }
+        }
+    }
+    return ARK_LINK_OK;
+}
+
 static ArkLinkResult ark_elf_prepare_sections(ArkELFState* state) {
+    size_t input_count = state->input->section_count;
+    int need_stub = !ark_elf_find_entry_symbol(state) &&
+                    state->input->entry_section > 0 && state->input->entry_section <= input_count;
+    
+    
+    size_t index = input_count + 1;
+    state->stub_index = need_stub ? index++ : 0;
+    state->got_index = state->got_count > 0 ? index++ : 0;
+    state->symtab_index = index++;
+    state->strtab_index = index++;
+    state->shstrtab_index = index++;
+    state->section_count = index;
     
-    state->section_count = state->input->section_count + 4; 
     state->sections = (ArkELFSection*)calloc(state->section_count, sizeof(ArkELFSection));
     if (!state->sections) {
         return ARK_LINK_ERR_INTERNAL;
@@ -372,140 +491,323 @@ static ArkLinkResult ark_elf_prepare_sections(ArkELFState* state) {
     
     state->sections[0].name = "";
     state->sections[0].type = SHT_NULL;
-    state->sections[0].flags = 0;
-    state->sections[0].addr = 0;
-    state->sections[0].offset = 0;
-    state->sections[0].size = 0;
-    state->sections[0].addralign = 0;
-    state->sections[0].entsize = 0;
     
     
-    for (size_t i = 0; i < state->input->section_count; i++) {
+    for (size_t i = 0; i < input_count; i++) {
         ArkBackendInputSection* src = &state->input->sections[i];
         ArkELFSection* dst = &state->sections[i + 1];
         
-        dst->name = strdup(src->name);
+        dst->name = src->name ? src->name : "";
         dst->type = ark_elf_section_type(src->buffer->kind);
         dst->flags = ark_elf_section_flags(src->buffer->kind, src->buffer->flags);
-        dst->size = src->buffer->size;
+        dst->size = src->buffer->size + src->reserve;
+        dst->data_size = src->buffer->size;
         dst->addralign = src->buffer->alignment > 0 ? src->buffer->alignment : 1;
         dst->entsize = 0;
-        
-        if (src->buffer->size > 0 && dst->type != SHT_NOBITS) {
-            dst->data = (uint8_t*)malloc(src->buffer->size);
-            if (!dst->data) {
-                return ARK_LINK_ERR_INTERNAL;
+        dst->data = dst->type != SHT_NOBITS ? src->buffer->data : NULL;
+    }
+    
+    if (state->stub_index) {
+        ArkELFSection* stub = &state->sections[state->stub_index];
+        stub->name = ".text.ark_start";
+        stub->type = SHT_PROGBITS;
+        stub->flags = SHF_ALLOC | SHF_EXECINSTR;
+        stub->size = sizeof(ark_elf_start_stub);
+        stub->data_size = stub->size;
+        stub->addralign = 16;
+        stub->data = ark_elf_start_stub;
+    }
+    
+    if (state->got_index) {
+        ArkELFSection* got = &state->sections[state->got_index];
+        got->name = ".got";
+        got->type = SHT_PROGBITS;
+        got->flags = SHF_ALLOC | SHF_WRITE;
+        got->size = state->got_count * sizeof(uint64_t);
+        got->addralign = 8;
+        got->entsize = sizeof(uint64_t);
+    }
+    
+    ArkELFSection* symtab = &state->sections[state->symtab_index];
+    symtab->name = ".symtab";
+    symtab->type = SHT_SYMTAB;
+    symtab->addralign = 8;
+    symtab->entsize = sizeof(Elf64_Sym);
+    symtab->link = (uint32_t)state->strtab_index;
+    
+    ArkELFSection* strtab = &state->sections[state->strtab_index];
+    strtab->name = ".strtab";
+    strtab->type = SHT_STRTAB;
+    strtab->addralign = 1;
+    
+    ArkELFSection* shstrtab = &state->sections[state->shstrtab_index];
+    shstrtab->name = ".shstrtab";
+    shstrtab->type = SHT_STRTAB;
+    shstrtab->addralign = 1;
+    
+    return ARK_LINK_OK;
+}
+
+static ArkLinkResult ark_elf_build_tables(ArkELFState* state) {
+    
+    size_t strtab_size = 1;
+    for (size_t i = 0; i < state->input->symbol_count; i++) {
+        const char* name = state->input->symbols[i].name;
+        if (name && *name) {
+            strtab_size += strlen(name) + 1;
+        }
+    }
+    
+    state->symtab = (Elf64_Sym*)calloc(state->input->symbol_count + 1, sizeof(Elf64_Sym));
+    state->symtab_source = (uint32_t*)calloc(state->input->symbol_count + 1, sizeof(uint32_t));
+    state->strtab = (char*)malloc(strtab_size);
+    if (!state->symtab || !state->symtab_source || !state->strtab) {
+        return ARK_LINK_ERR_MEMORY;
+    }
+    state->strtab[0] = '\0';
+    state->strtab_size = 1;
+    state->symtab_count = 1;
+    
+    
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            state->symtab_first_global = state->symtab_count;
+        }
+        for (size_t i = 0; i < state->input->symbol_count; i++) {
+            const ArkBackendInputSymbol* sym = &state->input->symbols[i];
+            int is_local = sym->binding == ARK_BIND_LOCAL;
+            if ((pass == 0) != is_local || !sym->name || !*sym->name) {
+                continue;
             }
-            memcpy(dst->data, src->buffer->data, src->buffer->size);
+            
+            state->symtab_source[state->symtab_count] = (uint32_t)i;
+            Elf64_Sym* dst = &state->symtab[state->symtab_count++];
+            size_t len = strlen(sym->name) + 1;
+            dst->st_name = (uint32_t)state->strtab_size;
+            memcpy(state->strtab + state->strtab_size, sym->name, len);
+            state->strtab_size += len;
+            
+            int bind = is_local ? STB_LOCAL : (sym->binding == ARK_BIND_WEAK ? STB_WEAK : STB_GLOBAL);
+            int type = STT_NOTYPE;
+            if (ark_elf_symbol_defined(state, sym)) {
+                dst->st_shndx = (uint16_t)(sym->section_id + 1);
+                type = (state->sections[sym->section_id + 1].flags & SHF_EXECINSTR) ? STT_FUNC : STT_OBJECT;
+            } else {
+                dst->st_shndx = SHN_UNDEF;
+            }
+            dst->st_info = (unsigned char)((bind << 4) | type);
+            dst->st_value = sym->value;
+            dst->st_size = sym->size;
+        }
+    }
+    
+    ArkELFSection* symtab = &state->sections[state->symtab_index];
+    symtab->data = (const uint8_t*)state->symtab;
+    symtab->size = state->symtab_count * sizeof(Elf64_Sym);
+    symtab->info = (uint32_t)state->symtab_first_global;
+    
+    ArkELFSection* strtab = &state->sections[state->strtab_index];
+    strtab->data = (const uint8_t*)state->strtab;
+    strtab->size = state->strtab_size;
+    
+    
+    ark_elf_add_shstr(state, "");
+    for (size_t i = 1; i < state->section_count; i++) {
+        ArkELFSection* sec = &state->sections[i];
+        sec->name_offset = (uint32_t)ark_elf_add_shstr(state, sec->name);
+        if (!state->shstrtab) {
+            return ARK_LINK_ERR_MEMORY;
         }
     }
+    ArkELFSection* shstrtab = &state->sections[state->shstrtab_index];
+    shstrtab->data = (const uint8_t*)state->shstrtab;
+    shstrtab->size = state->shstrtab_size;
     
     return ARK_LINK_OK;
 }
 
 static void ark_elf_free_sections(ArkELFState* state) {
-    for (size_t i = 0; i < state->section_count; i++) {
-        free(state->sections[i].name);
-        free(state->sections[i].data);
-    }
     free(state->sections);
     state->sections = NULL;
 }
 
 static void ark_elf_compute_layout(ArkELFState* state) {
-    const uint64_t page_size = 4096;
-    state->image_base = 0x400000;
-    
-    
-    size_t ehdr_size = sizeof(Elf64_Ehdr);
-    size_t phdr_size = 0;
+    state->image_base = ARK_ELF_IMAGE_BASE;
+    size_t alloc_end = state->symtab_index;
     
     
-    state->segment_count = 0;
-    for (size_t i = 0; i < state->input->section_count; i++) {
-        ArkELFSection* sec = &state->sections[i + 1];
-        if (sec->flags & SHF_ALLOC) {
-            state->segment_count++;
-        }
+    int class_used[3] = {1, 0, 0};
+    for (size_t i = 1; i < alloc_end; i++) {
+        class_used[ark_elf_section_class(&state->sections[i])] = 1;
     }
-    
-    if (state->segment_count > 0) {
-        phdr_size = (state->segment_count + 2) * sizeof(Elf64_Phdr); 
+    state->segment_count = 0;
+    for (int cls = 0; cls < 3; cls++) {
+        state->segment_count += class_used[cls] ? 1 : 0;
     }
     
-    state->phdr_offset = ark_elf_align(ehdr_size, 8);
-    state->phdr_size = phdr_size;
-    
+    state->phdr_offset = sizeof(Elf64_Ehdr);
+    state->phdr_size = (state->segment_count + 1) * sizeof(Elf64_Phdr);
     
-    uint64_t current_offset = ark_elf_align(state->phdr_offset + phdr_size, 8);
     
-    for (size_t i = 0; i < state->input->section_count; i++) {
-        ArkELFSection* sec = &state->sections[i + 1];
+    uint64_t offset = state->phdr_offset + state->phdr_size;
+    size_t seg = 0;
+    for (int cls = 0; cls < 3; cls++) {
+        if (!class_used[cls]) {
+            continue;
+        }
+        if (cls != 0) {
+            offset = ark_elf_align(offset, ARK_ELF_PAGE_SIZE);
+        }
+        uint64_t start = cls == 0 ? 0 : offset;
+        
+        for (size_t i = 1; i < alloc_end; i++) {
+            ArkELFSection* sec = &state->sections[i];
+            if (ark_elf_section_class(sec) != cls || sec->type == SHT_NOBITS) {
+                continue;
+            }
+            offset = ark_elf_align(offset, sec->addralign);
+            sec->offset = offset;
+            sec->addr = state->image_base + offset;
+            offset += sec->size;
+        }
         
-        if (sec->type == SHT_NOBITS) {
-            sec->offset = 0;
-        } else {
-            current_offset = ark_elf_align(current_offset, sec->addralign);
-            sec->offset = current_offset;
-            current_offset += sec->size;
+        uint64_t mem = offset;
+        for (size_t i = 1; i < alloc_end; i++) {
+            ArkELFSection* sec = &state->sections[i];
+            if (ark_elf_section_class(sec) != cls || sec->type != SHT_NOBITS) {
+                continue;
+            }
+            mem = ark_elf_align(mem, sec->addralign);
+            sec->offset = offset;
+            sec->addr = state->image_base + mem;
+            mem += sec->size;
+        }
+        
+        ArkELFSegment* segment = &state->segments[seg++];
+        segment->type = PT_LOAD;
+        segment->flags = PF_R | (cls == 1 ? PF_X : 0) | (cls == 2 ? PF_W : 0);
+        segment->offset = start;
+        segment->vaddr = state->image_base + start;
+        segment->paddr = segment->vaddr;
+        segment->filesz = offset - start;
+        segment->memsz = mem - start;
+        segment->align = ARK_ELF_PAGE_SIZE;
+        
+        if (mem > offset) {
+            offset = mem;
         }
     }
     
     
-    size_t shstrtab_idx = state->section_count - 3;
-    ArkELFSection* shstrtab = &state->sections[shstrtab_idx];
-    shstrtab->name = ".shstrtab";
-    shstrtab->type = SHT_STRTAB;
-    shstrtab->flags = 0;
-    shstrtab->addralign = 1;
-    shstrtab->entsize = 0;
+    for (size_t i = alloc_end; i < state->section_count; i++) {
+        ArkELFSection* sec = &state->sections[i];
+        offset = ark_elf_align(offset, sec->addralign);
+        sec->offset = offset;
+        sec->addr = 0;
+        offset += sec->size;
+    }
     
     
-    ark_elf_add_shstr(state, ""); 
-    for (size_t i = 0; i < state->input->section_count; i++) {
-        ArkELFSection* sec = &state->sections[i + 1];
-        ark_elf_add_shstr(state, sec->name);
+    for (size_t i = 1; i < state->symtab_count; i++) {
+        Elf64_Sym* sym = &state->symtab[i];
+        if (sym->st_shndx != SHN_UNDEF) {
+            sym->st_value += state->sections[sym->st_shndx].addr;
+        }
     }
-    ark_elf_add_shstr(state, ".shstrtab");
-    ark_elf_add_shstr(state, ".symtab");
-    ark_elf_add_shstr(state, ".strtab");
     
-    shstrtab->size = state->shstrtab_size;
-    current_offset = ark_elf_align(current_offset, shstrtab->addralign);
-    shstrtab->offset = current_offset;
-    current_offset += shstrtab->size;
     
+    state->entry_addr = 0;
+    state->stub_target = 0;
+    const ArkBackendInputSymbol* entry = ark_elf_find_entry_symbol(state);
+    if (entry) {
+        state->entry_addr = state->sections[entry->section_id + 1].addr + entry->value;
+    } else if (state->stub_index) {
+        state->stub_target = state->sections[state->input->entry_section].addr + state->input->entry_offset;
+        state->entry_addr = state->sections[state->stub_index].addr;
+    }
     
-    uint64_t current_addr = state->image_base + page_size;
+    offset = ark_elf_align(offset, 8);
+    state->shdr_offset = offset;
+    offset += state->section_count * sizeof(Elf64_Shdr);
     
-    for (size_t i = 0; i < state->input->section_count; i++) {
-        ArkELFSection* sec = &state->sections[i + 1];
-        
-        if (sec->flags & SHF_ALLOC) {
-            current_addr = ark_elf_align(current_addr, sec->addralign);
-            sec->addr = current_addr;
-            current_addr += sec->size;
-        } else {
-            sec->addr = 0;
-        }
+    state->total_file_size = offset;
+}
+
+static void ark_elf_add_slot(ArkBackendInput* input, uint32_t symbol_index, uint32_t type,
+                             uint64_t file_offset, uint64_t address) {
+    ArkBackendAddressSlot* slot = &input->address_slots[input->address_slot_count++];
+    slot->symbol_index = symbol_index;
+    slot->type = type;
+    slot->file_offset = file_offset;
+    slot->address = address;
+}
+
+static ArkLinkResult ark_elf_report_layout(ArkELFState* state) {
+    ArkBackendInput* input = state->input;
+    for (size_t i = 0; i < input->section_count; i++) {
+        const ArkELFSection* sec = &state->sections[i + 1];
+        input->sections[i].address = sec->addr;
+        input->sections[i].file_offset = sec->type == SHT_NOBITS ? UINT64_MAX : sec->offset;
     }
     
-    
-    state->entry_addr = 0;
-    if (state->input->entry_section < state->input->section_count) {
-        ArkELFSection* sec = &state->sections[state->input->entry_section + 1];
-        state->entry_addr = sec->addr + state->input->entry_offset;
+    for (size_t i = 0; i < input->symbol_count; i++) {
+        ArkBackendInputSymbol* sym = &input->symbols[i];
+        sym->address = ark_elf_symbol_address(state, (uint32_t)i);
+        sym->got_address = 0;
+        if (state->got_slots && state->got_slots[i] != UINT32_MAX) {
+            sym->got_address = state->sections[state->got_index].addr +
+                               (uint64_t)state->got_slots[i] * sizeof(uint64_t);
+        }
     }
     
+    size_t capacity = state->got_count + state->symtab_count * 2 + 1;
+    input->address_slots = (ArkBackendAddressSlot*)calloc(capacity, sizeof(ArkBackendAddressSlot));
+    if (!input->address_slots) {
+        return ARK_LINK_ERR_MEMORY;
+    }
+    input->address_slot_count = 0;
+    
+    if (state->got_index) {
+        uint64_t got_offset = state->sections[state->got_index].offset;
+        for (size_t i = 0; i < input->symbol_count; i++) {
+            if (state->got_slots[i] != UINT32_MAX) {
+                ark_elf_add_slot(input, (uint32_t)i, ARK_BACKEND_SLOT_ABS64,
+                                 got_offset + (uint64_t)state->got_slots[i] * sizeof(uint64_t), 0);
+            }
+        }
+    }
     
-    current_offset = ark_elf_align(current_offset, 8);
-    state->shdr_offset = current_offset;
-    current_offset += state->section_count * sizeof(Elf64_Shdr);
+    uint64_t symtab_offset = state->sections[state->symtab_index].offset;
+    for (size_t i = 1; i < state->symtab_count; i++) {
+        uint32_t source = state->symtab_source[i];
+        if (!ark_elf_symbol_defined(state, &input->symbols[source])) {
+            continue;
+        }
+        uint64_t entry_offset = symtab_offset + i * sizeof(Elf64_Sym);
+        ark_elf_add_slot(input, source, ARK_BACKEND_SLOT_ABS64, entry_offset + offsetof(Elf64_Sym, st_value), 0);
+        ark_elf_add_slot(input, source, ARK_BACKEND_SLOT_SIZE64, entry_offset + offsetof(Elf64_Sym, st_size), 0);
+    }
     
-    state->total_file_size = current_offset;
+    const ArkBackendInputSymbol* entry = ark_elf_find_entry_symbol(state);
+    if (entry) {
+        ark_elf_add_slot(input, (uint32_t)(entry - input->symbols), ARK_BACKEND_SLOT_ABS64,
+                         offsetof(Elf64_Ehdr, e_entry), 0);
+    } else if (state->stub_index) {
+        const ArkELFSection* stub = &state->sections[state->stub_index];
+        for (size_t i = 0; i < input->symbol_count; i++) {
+            const ArkBackendInputSymbol* sym = &input->symbols[i];
+            if (sym->section_id + 1 == input->entry_section && sym->value == input->entry_offset) {
+                ark_elf_add_slot(input, (uint32_t)i, ARK_BACKEND_SLOT_REL32,
+                                 stub->offset + ARK_ELF_STUB_CALL_OFFSET,
+                                 stub->addr + ARK_ELF_STUB_CALL_OFFSET + 4);
+                break;
+            }
+        }
+    }
+    return ARK_LINK_OK;
 }
 
-static ArkLinkResult ark_elf_write_header(ArkELFState* state, FILE* fp) {
+static void ark_elf_write_header(ArkELFState* state, uint8_t* image) {
     Elf64_Ehdr ehdr = {0};
     
     
@@ -527,23 +829,16 @@ static ArkLinkResult ark_elf_write_header(ArkELFState* state, FILE* fp) {
     ehdr.e_flags = 0;
     ehdr.e_ehsize = sizeof(Elf64_Ehdr);
     ehdr.e_phentsize = sizeof(Elf64_Phdr);
-    ehdr.e_phnum = (uint16_t)(state->segment_count + 2);
+    ehdr.e_phnum = (uint16_t)(state->segment_count + 1);
     ehdr.e_shentsize = sizeof(Elf64_Shdr);
     ehdr.e_shnum = (uint16_t)state->section_count;
-    ehdr.e_shstrndx = (uint16_t)(state->section_count - 3); 
-    
-    if (fwrite(&ehdr, sizeof(ehdr), 1, fp) != 1) {
-        return ARK_LINK_ERR_IO;
-    }
+    ehdr.e_shstrndx = (uint16_t)state->shstrtab_index;
     
-    return ARK_LINK_OK;
+    memcpy(image, &ehdr, sizeof(ehdr));
 }
 
-static ArkLinkResult ark_elf_write_program_headers(ArkELFState* state, FILE* fp) {
-    
-    if (fseek(fp, (long)state->phdr_offset, SEEK_SET) != 0) {
-        return ARK_LINK_ERR_IO;
-    }
+static void ark_elf_write_program_headers(ArkELFState* state, uint8_t* image) {
+    uint8_t* cursor = image + state->phdr_offset;
     
     
     Elf64_Phdr phdr_phdr = {0};
@@ -555,105 +850,127 @@ static ArkLinkResult ark_elf_write_program_headers(ArkELFState* state, FILE* fp)
     phdr_phdr.p_filesz = state->phdr_size;
     phdr_phdr.p_memsz = state->phdr_size;
     phdr_phdr.p_align = 8;
+    memcpy(cursor, &phdr_phdr, sizeof(phdr_phdr));
+    cursor += sizeof(phdr_phdr);
     
-    if (fwrite(&phdr_phdr, sizeof(phdr_phdr), 1, fp) != 1) {
-        return ARK_LINK_ERR_IO;
-    }
-    
-    
-    for (size_t i = 0; i < state->input->section_count; i++) {
-        ArkELFSection* sec = &state->sections[i + 1];
-        
-        if (!(sec->flags & SHF_ALLOC)) {
-            continue;
-        }
-        
+    for (size_t i = 0; i < state->segment_count; i++) {
+        const ArkELFSegment* segment = &state->segments[i];
         Elf64_Phdr phdr = {0};
-        phdr.p_type = PT_LOAD;
-        phdr.p_flags = PF_R;
-        if (sec->flags & SHF_WRITE) {
-            phdr.p_flags |= PF_W;
-        }
-        if (sec->flags & SHF_EXECINSTR) {
-            phdr.p_flags |= PF_X;
-        }
-        phdr.p_offset = sec->offset;
-        phdr.p_vaddr = sec->addr;
-        phdr.p_paddr = sec->addr;
-        phdr.p_filesz = sec->type == SHT_NOBITS ? 0 : sec->size;
-        phdr.p_memsz = sec->size;
-        phdr.p_align = sec->addralign;
-        
-        if (fwrite(&phdr, sizeof(phdr), 1, fp) != 1) {
-            return ARK_LINK_ERR_IO;
-        }
+        phdr.p_type = segment->type;
+        phdr.p_flags = segment->flags;
+        phdr.p_offset = segment->offset;
+        phdr.p_vaddr = segment->vaddr;
+        phdr.p_paddr = segment->paddr;
+        phdr.p_filesz = segment->filesz;
+        phdr.p_memsz = segment->memsz;
+        phdr.p_align = segment->align;
+        memcpy(cursor, &phdr, sizeof(phdr));
+        cursor += sizeof(phdr);
     }
-    
-    return ARK_LINK_OK;
 }
 
-static ArkLinkResult ark_elf_write_section_data(ArkELFState* state, FILE* fp) {
-    for (size_t i = 0; i < state->input->section_count; i++) {
-        ArkELFSection* sec = &state->sections[i + 1];
-        
-        if (sec->type == SHT_NOBITS || sec->size == 0) {
-            continue;
-        }
-        
-        if (fseek(fp, (long)sec->offset, SEEK_SET) != 0) {
-            return ARK_LINK_ERR_IO;
-        }
+static int ark_elf_apply_relocs(const ArkELFState* state, size_t input_index, uint8_t* data) {
+    const ArkBackendInputSection* input_sec = &state->input->sections[input_index];
+    const ArkELFSection* sec = &state->sections[input_index + 1];
+    const ArkBackendInputReloc* relocs = state->input->relocs + input_sec->reloc_first;
+    int overflow = 0;
+    
+    for (size_t i = 0; i < input_sec->reloc_count; i++) {
+        const ArkBackendInputReloc* reloc = &relocs[i];
+        uint64_t place = sec->addr + reloc->offset;
+        uint64_t target = ark_elf_symbol_address(state, reloc->symbol_index) + (uint64_t)(int64_t)reloc->addend;
         
-        if (sec->data && sec->size > 0) {
-            if (fwrite(sec->data, 1, sec->size, fp) != sec->size) {
-                return ARK_LINK_ERR_IO;
+        switch (reloc->type) {
+        case ARK_RELOC_ABS64:
+            if ((uint64_t)reloc->offset + 8 <= sec->size) {
+                memcpy(data + reloc->offset, &target, sizeof(target));
+            }
+            break;
+            
+        case ARK_RELOC_GOTPC32:
+        case ARK_RELOC_PC32:
+            if (reloc->type == ARK_RELOC_GOTPC32 && reloc->symbol_index < state->input->symbol_count) {
+                target = state->sections[state->got_index].addr +
+                         (uint64_t)state->got_slots[reloc->symbol_index] * sizeof(uint64_t) +
+                         (uint64_t)(int64_t)reloc->addend;
+            }
+            if ((uint64_t)reloc->offset + 4 <= sec->size) {
+                int64_t displacement = (int64_t)(target - place);
+                if (displacement < INT32_MIN || displacement > INT32_MAX) {
+                    overflow = 1;
+                }
+                int32_t value = (int32_t)displacement;
+                memcpy(data + reloc->offset, &value, sizeof(value));
             }
+            break;
+            
+        case ARK_RELOC_SECREL32:
+            if ((uint64_t)reloc->offset + 4 <= sec->size && reloc->symbol_index < state->input->symbol_count) {
+                const ArkBackendInputSymbol* sym = &state->input->symbols[reloc->symbol_index];
+                uint32_t value = (uint32_t)(sym->value + reloc->addend);
+                memcpy(data + reloc->offset, &value, sizeof(value));
+            }
+            break;
         }
     }
-    
-    
-    ArkELFSection* shstrtab = &state->sections[state->section_count - 3];
-    if (fseek(fp, (long)shstrtab->offset, SEEK_SET) != 0) {
-        return ARK_LINK_ERR_IO;
-    }
-    if (fwrite(state->shstrtab, 1, state->shstrtab_size, fp) != state->shstrtab_size) {
-        return ARK_LINK_ERR_IO;
+    return overflow;
+}
+
+
+typedef struct {
+    ArkELFState* state;
+    uint8_t* image;
+    atomic_int overflow;
+} ArkELFSectionFill;
+
+
+static void ark_elf_fill_section(void* user_data, size_t index) {
+    ArkELFSectionFill* fill = (ArkELFSectionFill*)user_data;
+    const ArkELFSection* sec = &fill->state->sections[index + 1];
+    if (sec->type == SHT_NOBITS || sec->data_size == 0 || !sec->data) {
+        return;
     }
     
-    return ARK_LINK_OK;
+    uint8_t* dst = fill->image + sec->offset;
+    memcpy(dst, sec->data, sec->data_size);
+    if (ark_elf_apply_relocs(fill->state, index, dst)) {
+        atomic_store(&fill->overflow, 1);
+    }
 }
 
-static ArkLinkResult ark_elf_write_section_headers(ArkELFState* state, FILE* fp) {
-    if (fseek(fp, (long)state->shdr_offset, SEEK_SET) != 0) {
-        return ARK_LINK_ERR_IO;
+static void ark_elf_write_synthetic(ArkELFState* state, uint8_t* image) {
+    for (size_t i = state->input->section_count + 1; i < state->section_count; i++) {
+        const ArkELFSection* sec = &state->sections[i];
+        if (sec->data && sec->size > 0) {
+            memcpy(image + sec->offset, sec->data, sec->size);
+        }
     }
     
-    
-    size_t name_offset = 0;
-    size_t* name_offsets = (size_t*)calloc(state->section_count, sizeof(size_t));
-    if (!name_offsets) {
-        return ARK_LINK_ERR_INTERNAL;
+    if (state->stub_index) {
+        const ArkELFSection* stub = &state->sections[state->stub_index];
+        uint64_t next_ip = stub->addr + ARK_ELF_STUB_CALL_OFFSET + 4;
+        int32_t displacement = (int32_t)(state->stub_target - next_ip);
+        memcpy(image + stub->offset + ARK_ELF_STUB_CALL_OFFSET, &displacement, sizeof(displacement));
     }
     
-    name_offsets[0] = 0; 
-    name_offset = 1; 
-    
-    for (size_t i = 0; i < state->input->section_count; i++) {
-        name_offsets[i + 1] = name_offset;
-        name_offset += strlen(state->sections[i + 1].name) + 1;
+    if (state->got_index) {
+        uint8_t* got = image + state->sections[state->got_index].offset;
+        for (size_t i = 0; i < state->input->symbol_count; i++) {
+            if (state->got_slots[i] != UINT32_MAX) {
+                uint64_t addr = ark_elf_symbol_address(state, (uint32_t)i);
+                memcpy(got + (size_t)state->got_slots[i] * sizeof(uint64_t), &addr, sizeof(addr));
+            }
+        }
     }
-    
-    name_offsets[state->section_count - 3] = name_offset;
-    name_offset += strlen(".shstrtab") + 1;
-    name_offsets[state->section_count - 2] = name_offset;
-    name_offset += strlen(".symtab") + 1;
-    name_offsets[state->section_count - 1] = name_offset;
-    
+}
+
+static void ark_elf_write_section_headers(ArkELFState* state, uint8_t* image) {
+    uint8_t* cursor = image + state->shdr_offset;
     for (size_t i = 0; i < state->section_count; i++) {
         ArkELFSection* sec = &state->sections[i];
         Elf64_Shdr shdr = {0};
         
-        shdr.sh_name = (uint32_t)name_offsets[i];
+        shdr.sh_name = sec->name_offset;
         shdr.sh_type = sec->type;
         shdr.sh_flags = sec->flags;
         shdr.sh_addr = sec->addr;
@@ -664,18 +981,32 @@ static ArkLinkResult ark_elf_write_section_headers(ArkELFState* state, FILE* fp)
         shdr.sh_addralign = sec->addralign;
         shdr.sh_entsize = sec->entsize;
         
-        if (fwrite(&shdr, sizeof(shdr), 1, fp) != 1) {
-            free(name_offsets);
-            return ARK_LINK_ERR_IO;
-        }
+        memcpy(cursor, &shdr, sizeof(shdr));
+        cursor += sizeof(shdr);
+    }
+}
+
+static void ark_elf_destroy_state(ArkBackendState* state_ptr) {
+    ArkELFState* state = (ArkELFState*)state_ptr;
+    if (!state) {
+        return;
     }
     
-    free(name_offsets);
-    return ARK_LINK_OK;
+    ark_elf_free_sections(state);
+    free(state->segments);
+    free(state->got_slots);
+    free(state->symtab);
+    free(state->symtab_source);
+    free(state->strtab);
+    free(state->shstrtab);
+    free(state->dynstrtab);
+    free(state->dynsyms);
+    free(state->dynrelas);
+    free(state->dynamics);
+    free(state);
 }
 
 static ArkLinkResult ark_elf_prepare(ArkLinkContext* ctx, ArkBackendInput* input, ArkBackendState** out_state) {
-    (void)ctx;
     if (!input || !out_state) {
         return ARK_LINK_ERR_INVALID_ARGUMENT;
     }
@@ -685,18 +1016,41 @@ static ArkLinkResult ark_elf_prepare(ArkLinkContext* ctx, ArkBackendInput* input
         return ARK_LINK_ERR_INTERNAL;
     }
     
+    state->ctx = ctx;
     state->input = input;
     
     
-    ArkLinkResult res = ark_elf_prepare_sections(state);
+    ArkLinkResult res = ark_elf_check_relocs(state);
+    if (res == ARK_LINK_OK) {
+        res = ark_elf_prepare_sections(state);
+    }
+    if (res == ARK_LINK_OK) {
+        res = ark_elf_build_tables(state);
+    }
+    if (res == ARK_LINK_OK) {
+        state->segments = (ArkELFSegment*)calloc(3, sizeof(ArkELFSegment));
+        if (!state->segments) {
+            res = ARK_LINK_ERR_MEMORY;
+        }
+    }
     if (res != ARK_LINK_OK) {
-        ark_elf_free_sections(state);
-        free(state);
+        ark_elf_destroy_state((ArkBackendState*)state);
         return res;
     }
     
     
     ark_elf_compute_layout(state);
+    if (state->entry_addr == 0) {
+        ark_context_log(ctx, ARK_LOG_WARN, "No entry point found for ELF output");
+    }
+    
+    if (input->record_layout) {
+        res = ark_elf_report_layout(state);
+        if (res != ARK_LINK_OK) {
+            ark_elf_destroy_state((ArkBackendState*)state);
+            return res;
+        }
+    }
     
     *out_state = (ArkBackendState*)state;
     return ARK_LINK_OK;
@@ -708,53 +1062,40 @@ static ArkLinkResult ark_elf_write_output(ArkBackendState* state_ptr, const char
         return ARK_LINK_ERR_INVALID_ARGUMENT;
     }
     
-    FILE* fp = fopen(output_path, "wb");
-    if (!fp) {
-        return ARK_LINK_ERR_IO;
+    ArkOutputFile output;
+    ArkLinkResult res = ark_output_file_open(output_path, state->total_file_size, &output);
+    if (res != ARK_LINK_OK) {
+        return res;
     }
+    uint8_t* image = output.data;
     
-    ArkLinkResult res = ARK_LINK_OK;
-    
-    
-    res = ark_elf_write_header(state, fp);
-    if (res != ARK_LINK_OK) goto cleanup;
-    
-    
-    res = ark_elf_write_program_headers(state, fp);
-    if (res != ARK_LINK_OK) goto cleanup;
+    ark_elf_write_header(state, image);
+    ark_elf_write_program_headers(state, image);
     
     
-    res = ark_elf_write_section_data(state, fp);
-    if (res != ARK_LINK_OK) goto cleanup;
-    
-    
-    res = ark_elf_write_section_headers(state, fp);
-    if (res != ARK_LINK_OK) goto cleanup;
-    
-    
-    if (fseek(fp, 0, SEEK_END) != 0) {
-        res = ARK_LINK_ERR_IO;
-        goto cleanup;
+    ArkELFSectionFill fill = {
+        .state = state,
+        .image = image,
+    };
+    atomic_init(&fill.overflow, 0);
+    ark_context_phase_begin(state->ctx, ARK_LINK_PHASE_RELOCATE);
+    ark_parallel_for(state->input->section_count, ark_elf_fill_section, &fill);
+    ark_context_phase_end(state->ctx, ARK_LINK_PHASE_RELOCATE);
+    
+    ark_elf_write_synthetic(state, image);
+    ark_elf_write_section_headers(state, image);
+    
+    if (atomic_load(&fill.overflow)) {
+        ark_context_log(state->ctx, ARK_LOG_ERROR, "Relocation target out of range for 32-bit displacement");
+        ark_output_file_discard(&output);
+        return ARK_LINK_ERR_BACKEND;
     }
     
-cleanup:
-    fclose(fp);
-    return res;
-}
-
-static void ark_elf_destroy_state(ArkBackendState* state_ptr) {
-    ArkELFState* state = (ArkELFState*)state_ptr;
-    if (!state) {
-        return;
+    ArkLinkStats* stats = ark_context_stats(state->ctx);
+    if (stats) {
+        stats->output_bytes = state->total_file_size;
     }
-    
-    ark_elf_free_sections(state);
-    free(state->shstrtab);
-    free(state->dynstrtab);
-    free(state->dynsyms);
-    free(state->dynrelas);
-    free(state->dynamics);
-    free(state);
+    return ark_output_file_commit(&output, true);
 }
 
 const ArkBackendOps* ark_elf_backend_ops(void) {
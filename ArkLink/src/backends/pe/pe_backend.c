@@ -1,7 +1,10 @@
 #include "ArkLink/targets/pe.h"
 #include "ArkLink/backend.h"
 #include "ArkLink/context.h"
+#include "ArkLink/output_file.h"
+#include "ArkLink/parallel.h"
 
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -159,8 +162,9 @@ _Static_assert(sizeof(ArkPEBaseRelocBlock) == 8, "ArkPEBaseRelocBlock must be 8
 
 typedef struct {
     char name[8];
-    uint8_t* data;
+    const uint8_t* data;
     size_t size;
+    size_t data_size;
     size_t raw_size;
     uint32_t virtual_address;
     uint32_t raw_offset;
@@ -182,10 +186,12 @@ typedef struct {
 typedef struct {
     size_t module_index;
     size_t symbol_index;
+    uint32_t iat_offset;
 } ArkPEImportMapping;
 
 
 typedef struct {
+    ArkLinkContext* ctx;
     ArkBackendInput* input;
     ArkPESection* sections;
     size_t section_count;
@@ -213,6 +219,13 @@ typedef struct {
     int is_dll;
 } ArkPEState;
 
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t pos;
+} ArkPEImage;
+
 static uint32_t ark_pe_align(uint32_t value, uint32_t alignment) {
     uint32_t mask = alignment - 1;
     return (value + mask) & ~mask;
@@ -307,6 +320,16 @@ static int ark_pe_collect_imports(ArkPEState* state) {
         mod->symbol_count++;
     }
     
+    
+    for (size_t i = 0; i < state->input->import_count; i++) {
+        ArkPEImportMapping* map = &state->import_map[i];
+        uint32_t iat_offset = 0;
+        for (size_t m = 0; m < map->module_index; m++) {
+            iat_offset += (uint32_t)((state->imports[m].symbol_count + 1) * sizeof(uint64_t));
+        }
+        map->iat_offset = iat_offset + (uint32_t)(map->symbol_index * sizeof(uint64_t));
+    }
+    
     return 0;
 }
 
@@ -364,18 +387,12 @@ static ArkLinkResult ark_pe_prepare_sections(ArkPEState* state) {
         if (name_len > 8) name_len = 8;
         memcpy(dst->name, src->name, name_len);
         
-        dst->size = src->buffer->size;
-        dst->raw_size = (uint32_t)ark_pe_align((uint32_t)src->buffer->size, 512);
+        dst->size = src->buffer->size + src->reserve;
+        dst->data_size = src->buffer->size;
+        dst->raw_size = (uint32_t)ark_pe_align((uint32_t)dst->size, 512);
         dst->characteristics = ark_pe_section_characteristics(src->buffer->kind, src->buffer->flags);
         dst->alignment = src->buffer->alignment > 0 ? src->buffer->alignment : 4096;
-        
-        if (src->buffer->size > 0) {
-            dst->data = (uint8_t*)malloc(src->buffer->size);
-            if (!dst->data) {
-                return ARK_LINK_ERR_INTERNAL;
-            }
-            memcpy(dst->data, src->buffer->data, src->buffer->size);
-        }
+        dst->data = src->buffer->size > 0 ? src->buffer->data : NULL;
     }
     
     
@@ -400,9 +417,6 @@ static ArkLinkResult ark_pe_prepare_sections(ArkPEState* state) {
 }
 
 static void ark_pe_free_sections(ArkPEState* state) {
-    for (size_t i = 0; i < state->section_count; i++) {
-        free(state->sections[i].data);
-    }
     free(state->sections);
     state->sections = NULL;
 }
@@ -417,6 +431,9 @@ static uint32_t ark_pe_calc_reloc_size(ArkPEState* state) {
     
     for (size_t i = 0; i < state->input->reloc_count; i++) {
         ArkBackendInputReloc* reloc = &state->input->relocs[i];
+        if (reloc->type != 0) {
+            continue;
+        }
         uint32_t rva = 0;
         if (reloc->section_id < state->input->section_count) {
             rva = state->sections[reloc->section_id].virtual_address + reloc->offset;
@@ -562,21 +579,39 @@ static void ark_pe_compute_layout(ArkPEState* state) {
     }
 }
 
-static ArkLinkResult ark_pe_write_dos_header(FILE* fp) {
+static size_t ark_pe_emit(const void* src, size_t size, size_t count, ArkPEImage* image) {
+    size_t len = size * count;
+    if (image->pos + len > image->size) {
+        return 0;
+    }
+    memcpy(image->data + image->pos, src, len);
+    image->pos += len;
+    return count;
+}
+
+static int ark_pe_seek(ArkPEImage* image, size_t offset) {
+    if (offset > image->size) {
+        return -1;
+    }
+    image->pos = offset;
+    return 0;
+}
+
+static ArkLinkResult ark_pe_write_dos_header(ArkPEImage* image) {
     ArkPEDOSHeader dos = {0};
     dos.e_magic = PE_MAGIC_DOS;
     dos.e_lfanew = sizeof(ArkPEDOSHeader);
     
-    if (fwrite(&dos, sizeof(dos), 1, fp) != 1) {
+    if (ark_pe_emit(&dos, sizeof(dos), 1, image) != 1) {
         return ARK_LINK_ERR_IO;
     }
     return ARK_LINK_OK;
 }
 
-static ArkLinkResult ark_pe_write_nt_headers(ArkPEState* state, FILE* fp) {
+static ArkLinkResult ark_pe_write_nt_headers(ArkPEState* state, ArkPEImage* image) {
     
     uint32_t pe_sig = PE_MAGIC_NT;
-    if (fwrite(&pe_sig, sizeof(pe_sig), 1, fp) != 1) {
+    if (ark_pe_emit(&pe_sig, sizeof(pe_sig), 1, image) != 1) {
         return ARK_LINK_ERR_IO;
     }
     
@@ -597,7 +632,7 @@ static ArkLinkResult ark_pe_write_nt_headers(ArkPEState* state, FILE* fp) {
         file_hdr.Characteristics |= 0x2000; 
     }
     
-    if (fwrite(&file_hdr, sizeof(file_hdr), 1, fp) != 1) {
+    if (ark_pe_emit(&file_hdr, sizeof(file_hdr), 1, image) != 1) {
         return ARK_LINK_ERR_IO;
     }
     
@@ -664,17 +699,17 @@ static ArkLinkResult ark_pe_write_nt_headers(ArkPEState* state, FILE* fp) {
     }
     fprintf(stderr, "\n");
     
-    long pos_before = ftell(fp);
-    fprintf(stderr, "[DEBUG] File position before fwrite: %ld\n", pos_before);
+    long pos_before = (long)image->pos;
+    fprintf(stderr, "[DEBUG] Image position before emit: %ld\n", pos_before);
 #endif
     
-    size_t written = fwrite(&opt_hdr, sizeof(opt_hdr), 1, fp);
+    size_t written = ark_pe_emit(&opt_hdr, sizeof(opt_hdr), 1, image);
     
 #ifdef ARKLINK_DEBUG
-    fprintf(stderr, "[DEBUG] fwrite returned: %zu\n", written);
+    fprintf(stderr, "[DEBUG] emit returned: %zu\n", written);
     
-    long pos_after = ftell(fp);
-    fprintf(stderr, "[DEBUG] File position after fwrite: %ld\n", pos_after);
+    long pos_after = (long)image->pos;
+    fprintf(stderr, "[DEBUG] Image position after emit: %ld\n", pos_after);
 #endif
     
     if (written != 1) {
@@ -684,7 +719,7 @@ static ArkLinkResult ark_pe_write_nt_headers(ArkPEState* state, FILE* fp) {
     return ARK_LINK_OK;
 }
 
-static ArkLinkResult ark_pe_write_section_headers(ArkPEState* state, FILE* fp) {
+static ArkLinkResult ark_pe_write_section_headers(ArkPEState* state, ArkPEImage* image) {
     for (size_t i = 0; i < state->section_count; i++) {
         ArkPESection* sec = &state->sections[i];
         ArkPESectionHeader hdr = {0};
@@ -701,7 +736,7 @@ static ArkLinkResult ark_pe_write_section_headers(ArkPEState* state, FILE* fp) {
         hdr.NumberOfLinenumbers = 0;
         hdr.Characteristics = sec->characteristics;
         
-        if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1) {
+        if (ark_pe_emit(&hdr, sizeof(hdr), 1, image) != 1) {
             return ARK_LINK_ERR_IO;
         }
     }
@@ -709,18 +744,18 @@ static ArkLinkResult ark_pe_write_section_headers(ArkPEState* state, FILE* fp) {
 }
 
 
-static void ark_pe_apply_relocs(ArkPEState* state, uint8_t* data, size_t size, uint32_t section_rva) {
+static void ark_pe_apply_relocs(ArkPEState* state, size_t section_index, uint8_t* data) {
+    const ArkBackendInputSection* input_sec = &state->input->sections[section_index];
+    const ArkPESection* sec = &state->sections[section_index];
+    size_t size = sec->size;
+    uint32_t section_rva = sec->virtual_address;
 #ifdef ARKLINK_DEBUG
-    fprintf(stderr, "[DEBUG] ark_pe_apply_relocs: reloc_count=%zu, section_rva=0x%X, iat_rva=0x%X\n",
-            state->input->reloc_count, section_rva, state->iat_rva);
+    fprintf(stderr, "[DEBUG] ark_pe_apply_relocs: section=%zu, reloc_count=%zu, section_rva=0x%X, iat_rva=0x%X\n",
+            section_index, input_sec->reloc_count, section_rva, state->iat_rva);
 #endif
-    for (size_t i = 0; i < state->input->reloc_count; i++) {
-        ArkBackendInputReloc* reloc = &state->input->relocs[i];
-        
-        
-        if (reloc->section_id >= state->input->section_count) {
-            continue;
-        }
+    const ArkBackendInputReloc* relocs = state->input->relocs + input_sec->reloc_first;
+    for (size_t i = 0; i < input_sec->reloc_count; i++) {
+        const ArkBackendInputReloc* reloc = &relocs[i];
         
         
         if (reloc->offset >= size) {
@@ -740,21 +775,7 @@ static void ark_pe_apply_relocs(ArkPEState* state, uint8_t* data, size_t size, u
             if (sym->section_id == 0xFFFFFFFF) {
                 
                 if (sym->import_id >= 0 && (size_t)sym->import_id < state->input->import_count) {
-                    
-                    ArkPEImportMapping* map = &state->import_map[sym->import_id];
-                    
-                    
-                    uint32_t iat_entry_offset = 0;
-                    for (size_t m = 0; m < map->module_index; m++) {
-                        ArkPEImportModule* mod = &state->imports[m];
-                        
-                        iat_entry_offset += (uint32_t)((mod->symbol_count + 1) * sizeof(uint64_t));
-                    }
-                    
-                    
-                    iat_entry_offset += (uint32_t)(map->symbol_index * sizeof(uint64_t));
-                    
-                    target_addr = state->image_base + state->iat_rva + iat_entry_offset;
+                    target_addr = state->image_base + state->iat_rva + state->import_map[sym->import_id].iat_offset;
                 }
             } else if (sym->section_id < state->section_count) {
                 
@@ -768,13 +789,6 @@ static void ark_pe_apply_relocs(ArkPEState* state, uint8_t* data, size_t size, u
                 i, reloc->section_id, reloc->offset, reloc->type, reloc->symbol_index, (unsigned long long)target_addr);
 #endif
         
-        
-
-
-
-
-
-
         switch (reloc->type) {
             case 0: 
                 if (reloc->offset + 8 <= size) {
@@ -786,13 +800,13 @@ static void ark_pe_apply_relocs(ArkPEState* state, uint8_t* data, size_t size, u
             case 1: 
                 if (reloc->offset + 4 <= size) {
                     
-                    uint32_t next_rip = section_rva + reloc->offset + 4;
+                    uint32_t place = section_rva + reloc->offset;
                     
                     uint64_t effective_target = target_addr + reloc->addend;
-                    int32_t displacement = (int32_t)(effective_target - (state->image_base + next_rip));
+                    int32_t displacement = (int32_t)(effective_target - (state->image_base + place));
 #ifdef ARKLINK_DEBUG
-                    fprintf(stderr, "[DEBUG] target_addr=0x%llX, addend=%d, effective_target=0x%llX, next_rip=0x%X, displacement=0x%X\n",
-                            (unsigned long long)target_addr, reloc->addend, (unsigned long long)effective_target, next_rip, (uint32_t)displacement);
+                    fprintf(stderr, "[DEBUG] target_addr=0x%llX, addend=%d, effective_target=0x%llX, place=0x%X, displacement=0x%X\n",
+                            (unsigned long long)target_addr, reloc->addend, (unsigned long long)effective_target, place, (uint32_t)displacement);
 #endif
                     memcpy(data + reloc->offset, &displacement, sizeof(displacement));
                 }
@@ -801,73 +815,51 @@ static void ark_pe_apply_relocs(ArkPEState* state, uint8_t* data, size_t size, u
     }
 }
 
-static ArkLinkResult ark_pe_write_section_data(ArkPEState* state, FILE* fp) {
+
+typedef struct {
+    ArkPEState* state;
+    uint8_t* image;
+} ArkPESectionFill;
+
+
+static void ark_pe_fill_section(void* user_data, size_t index) {
+    ArkPESectionFill* fill = (ArkPESectionFill*)user_data;
+    ArkPESection* sec = &fill->state->sections[index];
+    if (sec->data_size == 0 || sec->data == NULL) {
+        return;
+    }
+    
+    uint8_t* dst = fill->image + sec->raw_offset;
+    memcpy(dst, sec->data, sec->data_size);
+    ark_pe_apply_relocs(fill->state, index, dst);
+}
+
+static ArkLinkResult ark_pe_write_section_data(ArkPEState* state, ArkPEImage* image) {
     for (size_t i = 0; i < state->section_count; i++) {
         ArkPESection* sec = &state->sections[i];
-        
-        
-        if (fseek(fp, sec->raw_offset, SEEK_SET) != 0) {
-            return ARK_LINK_ERR_IO;
-        }
-        
-        
-        if (sec->size > 0 && sec->data != NULL) {
-            
-            uint8_t* data_copy = (uint8_t*)malloc(sec->size);
-            if (!data_copy) {
-                return ARK_LINK_ERR_INTERNAL;
-            }
-            memcpy(data_copy, sec->data, sec->size);
-            
-#ifdef ARKLINK_DEBUG
-            
-            fprintf(stderr, "[DEBUG] Original data (size=%zu):", sec->size);
-            for (size_t j = 0; j < sec->size && j < 32; j++) {
-                fprintf(stderr, " %02X", sec->data[j]);
-            }
-            fprintf(stderr, "\n");
-#endif
-            
-            
-            ark_pe_apply_relocs(state, data_copy, sec->size, sec->virtual_address);
-            
-#ifdef ARKLINK_DEBUG
-            
-            fprintf(stderr, "[DEBUG] Modified data:");
-            for (size_t j = 0; j < sec->size && j < 32; j++) {
-                fprintf(stderr, " %02X", data_copy[j]);
-            }
-            fprintf(stderr, "\n");
-#endif
-            
-            if (fwrite(data_copy, 1, sec->size, fp) != sec->size) {
-                free(data_copy);
-                return ARK_LINK_ERR_IO;
-            }
-            free(data_copy);
-        }
-        
-        
-        size_t written = (sec->data != NULL) ? sec->size : 0;
-        size_t padding = sec->raw_size - written;
-        while (padding > 0) {
-            uint8_t zero = 0;
-            if (fwrite(&zero, 1, 1, fp) != 1) {
-                return ARK_LINK_ERR_IO;
-            }
-            padding--;
+        if ((size_t)sec->raw_offset + sec->raw_size > image->size) {
+            return ARK_LINK_ERR_INTERNAL;
         }
     }
+    
+    
+    ArkPESectionFill fill = {
+        .state = state,
+        .image = image->data,
+    };
+    ark_context_phase_begin(state->ctx, ARK_LINK_PHASE_RELOCATE);
+    ark_parallel_for(state->input->section_count, ark_pe_fill_section, &fill);
+    ark_context_phase_end(state->ctx, ARK_LINK_PHASE_RELOCATE);
     return ARK_LINK_OK;
 }
 
-static ArkLinkResult ark_pe_write_import_table(ArkPEState* state, FILE* fp) {
+static ArkLinkResult ark_pe_write_import_table(ArkPEState* state, ArkPEImage* image) {
     if (state->import_count == 0) {
         return ARK_LINK_OK;
     }
     
     
-    if (fseek(fp, state->idt_file_offset, SEEK_SET) != 0) {
+    if (ark_pe_seek(image, state->idt_file_offset) != 0) {
         return ARK_LINK_ERR_IO;
     }
     
@@ -912,7 +904,7 @@ static ArkLinkResult ark_pe_write_import_table(ArkPEState* state, FILE* fp) {
         dir.NameRVA = current_module_name_rva;
         dir.ImportAddressTableRVA = current_iat_rva;
         
-        if (fwrite(&dir, sizeof(dir), 1, fp) != 1) {
+        if (ark_pe_emit(&dir, sizeof(dir), 1, image) != 1) {
             return ARK_LINK_ERR_IO;
         }
         
@@ -923,7 +915,7 @@ static ArkLinkResult ark_pe_write_import_table(ArkPEState* state, FILE* fp) {
     
     
     ArkPEImportDirectory null_dir = {0};
-    if (fwrite(&null_dir, sizeof(null_dir), 1, fp) != 1) {
+    if (ark_pe_emit(&null_dir, sizeof(null_dir), 1, image) != 1) {
         return ARK_LINK_ERR_IO;
     }
     
@@ -935,7 +927,7 @@ static ArkLinkResult ark_pe_write_import_table(ArkPEState* state, FILE* fp) {
         for (size_t j = 0; j < mod->symbol_count; j++) {
             
             uint64_t entry = current_hint_name_rva;
-            if (fwrite(&entry, sizeof(entry), 1, fp) != 1) {
+            if (ark_pe_emit(&entry, sizeof(entry), 1, image) != 1) {
                 return ARK_LINK_ERR_IO;
             }
             current_hint_name_rva += 2 + (uint32_t)strlen(mod->symbols[j]) + 1;
@@ -944,7 +936,7 @@ static ArkLinkResult ark_pe_write_import_table(ArkPEState* state, FILE* fp) {
         
         
         uint64_t null_entry = 0;
-        if (fwrite(&null_entry, sizeof(null_entry), 1, fp) != 1) {
+        if (ark_pe_emit(&null_entry, sizeof(null_entry), 1, image) != 1) {
             return ARK_LINK_ERR_IO;
         }
     }
@@ -957,7 +949,7 @@ static ArkLinkResult ark_pe_write_import_table(ArkPEState* state, FILE* fp) {
         for (size_t j = 0; j < mod->symbol_count; j++) {
             
             uint64_t entry = current_hint_name_rva;
-            if (fwrite(&entry, sizeof(entry), 1, fp) != 1) {
+            if (ark_pe_emit(&entry, sizeof(entry), 1, image) != 1) {
                 return ARK_LINK_ERR_IO;
             }
             current_hint_name_rva += 2 + (uint32_t)strlen(mod->symbols[j]) + 1;
@@ -965,7 +957,7 @@ static ArkLinkResult ark_pe_write_import_table(ArkPEState* state, FILE* fp) {
         }
         
         uint64_t null_entry = 0;
-        if (fwrite(&null_entry, sizeof(null_entry), 1, fp) != 1) {
+        if (ark_pe_emit(&null_entry, sizeof(null_entry), 1, image) != 1) {
             return ARK_LINK_ERR_IO;
         }
     }
@@ -976,17 +968,17 @@ static ArkLinkResult ark_pe_write_import_table(ArkPEState* state, FILE* fp) {
         
         for (size_t j = 0; j < mod->symbol_count; j++) {
             uint16_t hint = 0;
-            if (fwrite(&hint, sizeof(hint), 1, fp) != 1) {
+            if (ark_pe_emit(&hint, sizeof(hint), 1, image) != 1) {
                 return ARK_LINK_ERR_IO;
             }
-            if (fwrite(mod->symbols[j], 1, strlen(mod->symbols[j]) + 1, fp) != 
+            if (ark_pe_emit(mod->symbols[j], 1, strlen(mod->symbols[j]) + 1, image) != 
                 strlen(mod->symbols[j]) + 1) {
                 return ARK_LINK_ERR_IO;
             }
             
             if ((2 + strlen(mod->symbols[j]) + 1) % 2 != 0) {
                 uint8_t pad = 0;
-                if (fwrite(&pad, 1, 1, fp) != 1) {
+                if (ark_pe_emit(&pad, 1, 1, image) != 1) {
                     return ARK_LINK_ERR_IO;
                 }
             }
@@ -996,7 +988,7 @@ static ArkLinkResult ark_pe_write_import_table(ArkPEState* state, FILE* fp) {
     
     for (size_t i = 0; i < state->import_count; i++) {
         ArkPEImportModule* mod = &state->imports[i];
-        if (fwrite(mod->module_name, 1, strlen(mod->module_name) + 1, fp) != 
+        if (ark_pe_emit(mod->module_name, 1, strlen(mod->module_name) + 1, image) != 
             strlen(mod->module_name) + 1) {
             return ARK_LINK_ERR_IO;
         }
@@ -1005,14 +997,14 @@ static ArkLinkResult ark_pe_write_import_table(ArkPEState* state, FILE* fp) {
     return ARK_LINK_OK;
 }
 
-static ArkLinkResult ark_pe_write_relocs(ArkPEState* state, FILE* fp) {
+static ArkLinkResult ark_pe_write_relocs(ArkPEState* state, ArkPEImage* image) {
     if (state->input->reloc_count == 0) {
         return ARK_LINK_OK;
     }
     
     
     ArkPESection* reloc_sec = &state->sections[state->reloc_section_index];
-    if (fseek(fp, reloc_sec->raw_offset, SEEK_SET) != 0) {
+    if (ark_pe_seek(image, reloc_sec->raw_offset) != 0) {
         return ARK_LINK_ERR_IO;
     }
     
@@ -1029,6 +1021,9 @@ static ArkLinkResult ark_pe_write_relocs(ArkPEState* state, FILE* fp) {
         
         if (i < state->input->reloc_count) {
             ArkBackendInputReloc* reloc = &state->input->relocs[i];
+            if (reloc->type != 0) {
+                continue;
+            }
             
             if (reloc->section_id < state->section_count) {
                 page = state->sections[reloc->section_id].virtual_address + 
@@ -1061,11 +1056,11 @@ static ArkLinkResult ark_pe_write_relocs(ArkPEState* state, FILE* fp) {
                 block.PageRVA = current_page;
                 block.BlockSize = (uint32_t)(sizeof(ArkPEBaseRelocBlock) + entry_count * sizeof(uint16_t));
                 
-                if (fwrite(&block, sizeof(block), 1, fp) != 1) {
+                if (ark_pe_emit(&block, sizeof(block), 1, image) != 1) {
                     free(entries);
                     return ARK_LINK_ERR_IO;
                 }
-                if (fwrite(entries, sizeof(uint16_t), entry_count, fp) != entry_count) {
+                if (ark_pe_emit(entries, sizeof(uint16_t), entry_count, image) != entry_count) {
                     free(entries);
                     return ARK_LINK_ERR_IO;
                 }
@@ -1074,7 +1069,7 @@ static ArkLinkResult ark_pe_write_relocs(ArkPEState* state, FILE* fp) {
                 size_t padding = (4 - (entry_count * sizeof(uint16_t)) % 4) % 4;
                 for (size_t p = 0; p < padding; p++) {
                     uint8_t zero = 0;
-                    if (fwrite(&zero, 1, 1, fp) != 1) {
+                    if (ark_pe_emit(&zero, 1, 1, image) != 1) {
                         free(entries);
                         return ARK_LINK_ERR_IO;
                     }
@@ -1103,8 +1098,46 @@ static ArkLinkResult ark_pe_write_relocs(ArkPEState* state, FILE* fp) {
     return ARK_LINK_OK;
 }
 
+static ArkLinkResult ark_pe_report_layout(ArkPEState* state) {
+    ArkBackendInput* input = state->input;
+    for (size_t i = 0; i < input->section_count; i++) {
+        input->sections[i].address = state->image_base + state->sections[i].virtual_address;
+        input->sections[i].file_offset = state->sections[i].raw_offset;
+    }
+    
+    for (size_t i = 0; i < input->symbol_count; i++) {
+        ArkBackendInputSymbol* sym = &input->symbols[i];
+        sym->address = 0;
+        sym->got_address = 0;
+        if (sym->section_id < input->section_count) {
+            sym->address = state->image_base + state->sections[sym->section_id].virtual_address + sym->value;
+        } else if (sym->import_id >= 0 && (size_t)sym->import_id < input->import_count) {
+            sym->address = state->image_base + state->iat_rva + state->import_map[sym->import_id].iat_offset;
+        }
+    }
+    
+    input->address_slots = (ArkBackendAddressSlot*)calloc(1, sizeof(ArkBackendAddressSlot));
+    if (!input->address_slots) {
+        return ARK_LINK_ERR_MEMORY;
+    }
+    input->address_slot_count = 0;
+    
+    for (size_t i = 0; i < input->symbol_count && state->entry_point_rva != 0; i++) {
+        const ArkBackendInputSymbol* sym = &input->symbols[i];
+        if (sym->section_id + 1 == input->entry_section && sym->value == input->entry_offset) {
+            ArkBackendAddressSlot* slot = &input->address_slots[input->address_slot_count++];
+            slot->symbol_index = (uint32_t)i;
+            slot->type = ARK_BACKEND_SLOT_REL32;
+            slot->file_offset = sizeof(ArkPEDOSHeader) + 4 + sizeof(ArkPEFileHeader) +
+                                offsetof(ArkPEOptionalHeader64, AddressOfEntryPoint);
+            slot->address = state->image_base;
+            break;
+        }
+    }
+    return ARK_LINK_OK;
+}
+
 static ArkLinkResult ark_pe_prepare(ArkLinkContext* ctx, ArkBackendInput* input, ArkBackendState** out_state) {
-    (void)ctx;
     if (!input || !out_state) {
         return ARK_LINK_ERR_INVALID_ARGUMENT;
     }
@@ -1114,6 +1147,7 @@ static ArkLinkResult ark_pe_prepare(ArkLinkContext* ctx, ArkBackendInput* input,
         return ARK_LINK_ERR_INTERNAL;
     }
     
+    state->ctx = ctx;
     state->input = input;
 
     
@@ -1155,6 +1189,16 @@ static ArkLinkResult ark_pe_prepare(ArkLinkContext* ctx, ArkBackendInput* input,
     
     ark_pe_compute_layout(state);
     
+    if (input->record_layout) {
+        res = ark_pe_report_layout(state);
+        if (res != ARK_LINK_OK) {
+            ark_pe_free_imports(state);
+            ark_pe_free_sections(state);
+            free(state);
+            return res;
+        }
+    }
+    
     *out_state = (ArkBackendState*)state;
     return ARK_LINK_OK;
 }
@@ -1165,54 +1209,58 @@ static ArkLinkResult ark_pe_write_output(ArkBackendState* state_ptr, const char*
         return ARK_LINK_ERR_INVALID_ARGUMENT;
     }
     
-    FILE* fp = fopen(output_path, "wb");
-    if (!fp) {
-        return ARK_LINK_ERR_IO;
+    
+    size_t file_size = state->headers_size;
+    for (size_t i = 0; i < state->section_count; i++) {
+        ArkPESection* sec = &state->sections[i];
+        if ((size_t)sec->raw_offset + sec->raw_size > file_size) {
+            file_size = (size_t)sec->raw_offset + sec->raw_size;
+        }
     }
     
-    ArkLinkResult res = ARK_LINK_OK;
+    ArkOutputFile output;
+    ArkLinkResult res = ark_output_file_open(output_path, file_size, &output);
+    if (res != ARK_LINK_OK) {
+        return res;
+    }
+    ArkPEImage image = {
+        .data = output.data,
+        .size = file_size,
+        .pos = 0,
+    };
     
     
-    res = ark_pe_write_dos_header(fp);
+    res = ark_pe_write_dos_header(&image);
     if (res != ARK_LINK_OK) goto cleanup;
     
     
-    res = ark_pe_write_nt_headers(state, fp);
+    res = ark_pe_write_nt_headers(state, &image);
     if (res != ARK_LINK_OK) goto cleanup;
     
     
-    res = ark_pe_write_section_headers(state, fp);
+    res = ark_pe_write_section_headers(state, &image);
     if (res != ARK_LINK_OK) goto cleanup;
     
     
-    long current_pos = ftell(fp);
-    if (current_pos < 0) {
-        res = ARK_LINK_ERR_IO;
-        goto cleanup;
-    }
-    while ((size_t)current_pos < state->headers_size) {
-        uint8_t zero = 0;
-        if (fwrite(&zero, 1, 1, fp) != 1) {
-            res = ARK_LINK_ERR_IO;
-            goto cleanup;
-        }
-        current_pos++;
-    }
-    
-    
-    res = ark_pe_write_section_data(state, fp);
+    res = ark_pe_write_section_data(state, &image);
     if (res != ARK_LINK_OK) goto cleanup;
     
     
-    res = ark_pe_write_import_table(state, fp);
+    res = ark_pe_write_import_table(state, &image);
     if (res != ARK_LINK_OK) goto cleanup;
     
     
-    res = ark_pe_write_relocs(state, fp);
+    res = ark_pe_write_relocs(state, &image);
     if (res != ARK_LINK_OK) goto cleanup;
     
+    ArkLinkStats* stats = ark_context_stats(state->ctx);
+    if (stats) {
+        stats->output_bytes = file_size;
+    }
+    return ark_output_file_commit(&output, false);
+    
 cleanup:
-    fclose(fp);
+    ark_output_file_discard(&output);
     return res;
 }
 
@@ -26,6 +26,12 @@ static void print_usage(const char* prog) {
     fprintf(stderr, "  --import-config path     Import configuration JSON file\n");
     fprintf(stderr, "  --config-json json       Inline JSON configuration\n");
     fprintf(stderr, "  --config-file path       Configuration file path\n");
+    fprintf(stderr, "  --gc-sections            Remove sections unreachable from the entry point and exports\n");
+    fprintf(stderr, "  --icf                    Fold identical code sections\n");
+    fprintf(stderr, "  --incremental            Patch changed inputs into the previous output when possible\n");
+    fprintf(stderr, "  --stats                  Print per-phase time, peak memory and link counts\n");
+    fprintf(stderr, "  --stats-json path        Write link statistics as JSON\n");
+    fprintf(stderr, "  --stats-trace path       Write link phases as a Chrome trace-event file\n");
     fprintf(stderr, "  --verbose                Enable verbose output\n");
     fprintf(stderr, "  --quiet                  Suppress output\n");
     fprintf(stderr, "  -h, --help               Show this help message\n");
@@ -83,6 +89,9 @@ int main(int argc, char** argv) {
     ArkLinkLogger logger = ark_cli_logger;
     uint32_t flags = 0;
     int show_help = 0;
+    int show_stats = 0;
+    const char* stats_json = NULL;
+    const char* stats_trace = NULL;
 
     int i = 1;
     while (i < argc) {
@@ -120,6 +129,24 @@ int main(int argc, char** argv) {
         } else if (strcmp(argv[i], "--config-file") == 0 && i + 1 < argc) {
             config_file = argv[++i];
             i++;
+        } else if (strcmp(argv[i], "--gc-sections") == 0) {
+            flags |= ARK_LINK_FLAG_GC_SECTIONS;
+            i++;
+        } else if (strcmp(argv[i], "--icf") == 0) {
+            flags |= ARK_LINK_FLAG_ICF;
+            i++;
+        } else if (strcmp(argv[i], "--incremental") == 0) {
+            flags |= ARK_LINK_FLAG_INCREMENTAL;
+            i++;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            show_stats = 1;
+            i++;
+        } else if (strcmp(argv[i], "--stats-json") == 0 && i + 1 < argc) {
+            stats_json = argv[++i];
+            i++;
+        } else if (strcmp(argv[i], "--stats-trace") == 0 && i + 1 < argc) {
+            stats_trace = argv[++i];
+            i++;
         } else if (strcmp(argv[i], "--verbose") == 0) {
             flags |= ARK_LINK_FLAG_VERBOSE;
             flags &= ~ARK_LINK_FLAG_QUIET;
@@ -284,6 +311,10 @@ int main(int argc, char** argv) {
         }
     }
     
+    ArkLinkStats stats;
+    memset(&stats, 0, sizeof(stats));
+    int want_stats = show_stats || stats_json || stats_trace;
+    
     ArkLinkJob job = {
         .inputs = job_inputs,
         .input_count = input_count,
@@ -298,6 +329,7 @@ int main(int argc, char** argv) {
         .logger = logger,
         .logger_user_data = parsed_config, 
         .flags = flags,
+        .stats = want_stats ? &stats : NULL,
     };
     
 #ifdef ARKLINK_DEBUG
@@ -319,6 +351,17 @@ int main(int argc, char** argv) {
     }
     
     
+    if (show_stats) {
+        arklink_stats_write(&stats, ARK_LINK_STATS_TEXT, NULL);
+    }
+    if (stats_json && arklink_stats_write(&stats, ARK_LINK_STATS_JSON, stats_json) != ARK_LINK_OK) {
+        fprintf(stderr, "Error: Failed to write statistics to %s\n", stats_json);
+    }
+    if (stats_trace && arklink_stats_write(&stats, ARK_LINK_STATS_TRACE, stats_trace) != ARK_LINK_OK) {
+        fprintf(stderr, "Error: Failed to write trace to %s\n", stats_trace);
+    }
+    
+    
     if (runtime.imports) {
         
         for (size_t i = config_import_count; i < total_import_count; i++) {
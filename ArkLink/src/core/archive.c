@@ -38,20 +38,143 @@ static int parse_decimal(const char* str, size_t len) {
     return result;
 }
 
-static ArkArchiveResult parse_ar_archive(ArkArchive* archive, FILE* fp) {
-    
-    if (fseek(fp, AR_ARCHIVE_MAGIC_LEN, SEEK_SET) != 0) {
-        return ARK_ARCHIVE_ERR_IO;
+static uint32_t ark_archive_hash(const char* name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint64_t read_be(const uint8_t* p, size_t width) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < width; i++) {
+        value = (value << 8) | p[i];
     }
+    return value;
+}
+
+static ArkArchiveResult ark_archive_grow_slots(ArkArchive* archive) {
+    size_t slot_count = archive->symbol_slot_count ? archive->symbol_slot_count * 2 : 64;
+    uint32_t* slots = calloc(slot_count, sizeof(uint32_t));
+    if (!slots) {
+        return ARK_ARCHIVE_ERR_MEMORY;
+    }
+
+    size_t mask = slot_count - 1;
+    for (size_t i = 0; i < archive->symbol_count; i++) {
+        size_t slot = archive->symbols[i].hash & mask;
+        while (slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = (uint32_t)(i + 1);
+    }
+
+    free(archive->symbol_slots);
+    archive->symbol_slots = slots;
+    archive->symbol_slot_count = slot_count;
+    return ARK_ARCHIVE_OK;
+}
+
+static bool ark_archive_member_at(const ArkArchive* archive, size_t header_offset, size_t* out_member) {
+    size_t lo = 0;
+    size_t hi = archive->object_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        size_t candidate = archive->objects[mid].header_offset;
+        if (candidate == header_offset) {
+            *out_member = mid;
+            return true;
+        }
+        if (candidate < header_offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return false;
+}
+
+
+static ArkArchiveResult parse_symbol_index(ArkArchive* archive, size_t offset, size_t size, size_t width) {
+    if (size < width) {
+        return ARK_ARCHIVE_OK;
+    }
+
+    const uint8_t* data = archive->file.data + offset;
+    uint64_t count = read_be(data, width);
+    if (count > (size - width) / width) {
+        return ARK_ARCHIVE_ERR_FORMAT;
+    }
+
+    const uint8_t* offsets = data + width;
+    const char* name = (const char*)(offsets + count * width);
+    const char* names_end = (const char*)data + size;
+
+    for (uint64_t i = 0; i < count && name < names_end; i++) {
+        const char* terminator = memchr(name, '\0', (size_t)(names_end - name));
+        if (!terminator) {
+            break;
+        }
+        size_t member;
+        if (terminator > name && ark_archive_member_at(archive, (size_t)read_be(offsets + i * width, width), &member)) {
+            ArkArchiveResult result = ark_archive_add_symbol(archive, name, member);
+            if (result != ARK_ARCHIVE_OK) {
+                return result;
+            }
+        }
+        name = terminator + 1;
+    }
+
+    archive->has_symbol_index = true;
+    return ARK_ARCHIVE_OK;
+}
+
+static char* member_name(const ArArchiveHeader* hdr, const char* long_names, size_t long_names_size) {
+    const char* src = hdr->name;
+    size_t name_len = 16;
+
+    if (hdr->name[0] == '/' && hdr->name[1] >= '0' && hdr->name[1] <= '9' && long_names) {
+        size_t name_offset = (size_t)parse_decimal(hdr->name + 1, 15);
+        if (name_offset < long_names_size) {
+            src = long_names + name_offset;
+            name_len = 0;
+            while (name_offset + name_len < long_names_size &&
+                   src[name_len] != '\n' && src[name_len] != '\0') {
+                name_len++;
+            }
+        }
+    } else {
+        while (name_len > 0 && hdr->name[name_len - 1] == ' ') {
+            name_len--;
+        }
+    }
+
+    if (name_len > 0 && src[name_len - 1] == '/') {
+        name_len--;
+    }
+
+    char* name = malloc(name_len + 1);
+    if (name) {
+        memcpy(name, src, name_len);
+        name[name_len] = '\0';
+    }
+    return name;
+}
+
+static ArkArchiveResult parse_ar_archive(ArkArchive* archive) {
+    const uint8_t* base = archive->file.data;
+    size_t file_size = archive->file.size;
 
     
-    ArArchiveHeader first_hdr;
-    if (fread(&first_hdr, sizeof(first_hdr), 1, fp) != 1) {
+    if (file_size < AR_ARCHIVE_MAGIC_LEN + sizeof(ArArchiveHeader)) {
         return ARK_ARCHIVE_ERR_FORMAT;
     }
 
     
-    if (strncmp(first_hdr.name, COFF_IMPORT_SIG, COFF_IMPORT_SIG_LEN) == 0) {
+    const ArArchiveHeader* first_hdr = (const ArArchiveHeader*)(base + AR_ARCHIVE_MAGIC_LEN);
+    if (strncmp(first_hdr->name, COFF_IMPORT_SIG, COFF_IMPORT_SIG_LEN) == 0) {
         archive->type = ARK_ARCHIVE_COFF_IMPORT;
     } else {
         
@@ -59,38 +182,45 @@ static ArkArchiveResult parse_ar_archive(ArkArchive* archive, FILE* fp) {
     }
 
     
-    long current_offset = AR_ARCHIVE_MAGIC_LEN;
+    size_t current_offset = AR_ARCHIVE_MAGIC_LEN;
+    size_t symtab_offset = 0;
+    size_t symtab_size = 0;
+    size_t symtab_width = 0;
+    const char* long_names = NULL;
+    size_t long_names_size = 0;
     
-    while (1) {
-        
-        ArArchiveHeader hdr;
-        if (fseek(fp, current_offset, SEEK_SET) != 0) {
-            break;
-        }
-        
-        if (fread(&hdr, sizeof(hdr), 1, fp) != 1) {
-            break;
-        }
+    while (current_offset + sizeof(ArArchiveHeader) <= file_size) {
+        const ArArchiveHeader* hdr = (const ArArchiveHeader*)(base + current_offset);
 
         
-        if (hdr.end[0] != '`' || hdr.end[1] != '\n') {
+        if (hdr->end[0] != '`' || hdr->end[1] != '\n') {
             
             break;
         }
 
         
-        int size = parse_decimal(hdr.size, 10);
-        if (size <= 0) {
+        int size = parse_decimal(hdr->size, 10);
+        size_t data_offset = current_offset + sizeof(ArArchiveHeader);
+        if (size <= 0 || data_offset + (size_t)size > file_size) {
             break;
         }
 
-        
-        
-        bool is_special = (hdr.name[0] == '/' || 
-                          (hdr.name[0] == '/' && hdr.name[1] == '/') ||
-                          strncmp(hdr.name, "__.SYMDEF", 9) == 0);
-
-        if (!is_special) {
+        if (hdr->name[0] == '/' && hdr->name[1] == ' ') {
+            if (symtab_width == 0) {
+                symtab_offset = data_offset;
+                symtab_size = (size_t)size;
+                symtab_width = 4;
+            }
+        } else if (strncmp(hdr->name, "/SYM64/", 7) == 0) {
+            if (symtab_width == 0) {
+                symtab_offset = data_offset;
+                symtab_size = (size_t)size;
+                symtab_width = 8;
+            }
+        } else if (hdr->name[0] == '/' && hdr->name[1] == '/') {
+            long_names = (const char*)(base + data_offset);
+            long_names_size = (size_t)size;
+        } else if (strncmp(hdr->name, "__.SYMDEF", 9) != 0) {
             
             if (archive->object_count >= archive->object_capacity) {
                 archive->object_capacity = archive->object_capacity ? 
@@ -103,50 +233,29 @@ static ArkArchiveResult parse_ar_archive(ArkArchive* archive, FILE* fp) {
                 archive->objects = new_objects;
             }
 
-            ArkArchiveObject* obj = &archive->objects[archive->object_count++];
-            
-            
-            size_t name_len = 16;
-            while (name_len > 0 && hdr.name[name_len - 1] == ' ') {
-                name_len--;
-            }
-            if (name_len > 0 && hdr.name[name_len - 1] == '/') {
-                name_len--;
-            }
-            
-            obj->name = malloc(name_len + 1);
+            ArkArchiveObject* obj = &archive->objects[archive->object_count];
+            memset(obj, 0, sizeof(*obj));
+            obj->name = member_name(hdr, long_names, long_names_size);
             if (!obj->name) {
                 return ARK_ARCHIVE_ERR_MEMORY;
             }
-            memcpy(obj->name, hdr.name, name_len);
-            obj->name[name_len] = '\0';
-
-            
-            obj->size = size;
-            obj->data = malloc(size);
-            if (!obj->data) {
-                free(obj->name);
-                return ARK_ARCHIVE_ERR_MEMORY;
-            }
-
-            long data_offset = current_offset + sizeof(ArArchiveHeader);
-            if (fseek(fp, data_offset, SEEK_SET) != 0 ||
-                fread(obj->data, 1, size, fp) != size) {
-                free(obj->name);
-                free(obj->data);
-                return ARK_ARCHIVE_ERR_IO;
-            }
-
+            obj->size = (size_t)size;
             obj->offset = data_offset;
+            obj->header_offset = current_offset;
+            archive->object_count++;
         }
 
         
-        current_offset += sizeof(ArArchiveHeader) + size;
+        current_offset = data_offset + (size_t)size;
         if (size % 2 != 0) {
             current_offset++; 
         }
     }
 
+    if (symtab_width != 0) {
+        return parse_symbol_index(archive, symtab_offset, symtab_size, symtab_width);
+    }
+
     return ARK_ARCHIVE_OK;
 }
 
@@ -158,42 +267,33 @@ ArkArchiveResult ark_archive_open(const char* filename, ArkArchive** archive) {
     *archive = NULL;
 
     
-    FILE* fp = fopen(filename, "rb");
-    if (!fp) {
-        return ARK_ARCHIVE_ERR_IO;
-    }
-
-    
-    char magic[AR_ARCHIVE_MAGIC_LEN];
-    if (fread(magic, 1, AR_ARCHIVE_MAGIC_LEN, fp) != AR_ARCHIVE_MAGIC_LEN) {
-        fclose(fp);
-        return ARK_ARCHIVE_ERR_FORMAT;
-    }
-
-    
-    if (memcmp(magic, AR_ARCHIVE_MAGIC, AR_ARCHIVE_MAGIC_LEN) != 0 &&
-        memcmp(magic, THIN_ARCHIVE_MAGIC, THIN_ARCHIVE_MAGIC_LEN) != 0) {
-        fclose(fp);
-        return ARK_ARCHIVE_ERR_FORMAT;
-    }
-
-    
     ArkArchive* ar = calloc(1, sizeof(ArkArchive));
     if (!ar) {
-        fclose(fp);
         return ARK_ARCHIVE_ERR_MEMORY;
     }
 
     ar->filename = strdup(filename);
     if (!ar->filename) {
         free(ar);
-        fclose(fp);
         return ARK_ARCHIVE_ERR_MEMORY;
     }
 
     
-    ArkArchiveResult result = parse_ar_archive(ar, fp);
-    fclose(fp);
+    if (ark_mapped_file_open(filename, &ar->file) != ARK_LINK_OK) {
+        ark_archive_close(ar);
+        return ARK_ARCHIVE_ERR_IO;
+    }
+
+    
+    if (ar->file.size < AR_ARCHIVE_MAGIC_LEN ||
+        (memcmp(ar->file.data, AR_ARCHIVE_MAGIC, AR_ARCHIVE_MAGIC_LEN) != 0 &&
+         memcmp(ar->file.data, THIN_ARCHIVE_MAGIC, THIN_ARCHIVE_MAGIC_LEN) != 0)) {
+        ark_archive_close(ar);
+        return ARK_ARCHIVE_ERR_FORMAT;
+    }
+
+    
+    ArkArchiveResult result = parse_ar_archive(ar);
 
     if (result != ARK_ARCHIVE_OK) {
         ark_archive_close(ar);
@@ -212,11 +312,15 @@ void ark_archive_close(ArkArchive* archive) {
     if (archive->objects) {
         for (size_t i = 0; i < archive->object_count; i++) {
             free(archive->objects[i].name);
-            free(archive->objects[i].data);
         }
         free(archive->objects);
     }
 
+    ark_mapped_file_close(&archive->file);
+
+    free(archive->symbols);
+    free(archive->symbol_slots);
+    free(archive->string_pool);
     free(archive->filename);
     free(archive);
 }
@@ -254,3 +358,112 @@ bool ark_archive_is_archive(const char* filename) {
     return (memcmp(magic, AR_ARCHIVE_MAGIC, AR_ARCHIVE_MAGIC_LEN) == 0 ||
             memcmp(magic, THIN_ARCHIVE_MAGIC, THIN_ARCHIVE_MAGIC_LEN) == 0);
 }
+
+ArkArchiveResult ark_archive_read_member(ArkArchive* archive, size_t index) {
+    if (!archive || index >= archive->object_count) {
+        return ARK_ARCHIVE_ERR_FORMAT;
+    }
+
+    ArkArchiveObject* obj = &archive->objects[index];
+    if (obj->data) {
+        return ARK_ARCHIVE_OK;
+    }
+
+    if (obj->offset + obj->size > archive->file.size) {
+        return ARK_ARCHIVE_ERR_FORMAT;
+    }
+
+    obj->data = archive->file.data + obj->offset;
+    return ARK_ARCHIVE_OK;
+}
+
+void ark_archive_release_member(ArkArchive* archive, size_t index) {
+    if (!archive || index >= archive->object_count) {
+        return;
+    }
+    archive->objects[index].data = NULL;
+}
+
+ArkArchiveResult ark_archive_add_symbol(ArkArchive* archive, const char* name, size_t member) {
+    if (!archive || !name || member >= archive->object_count) {
+        return ARK_ARCHIVE_ERR_FORMAT;
+    }
+
+    if (ark_archive_find_symbol(archive, name, NULL)) {
+        return ARK_ARCHIVE_OK;
+    }
+
+    if ((archive->symbol_count + 1) * 2 > archive->symbol_slot_count) {
+        ArkArchiveResult result = ark_archive_grow_slots(archive);
+        if (result != ARK_ARCHIVE_OK) {
+            return result;
+        }
+    }
+
+    if (archive->symbol_count >= archive->symbol_capacity) {
+        size_t capacity = archive->symbol_capacity ? archive->symbol_capacity * 2 : 64;
+        ArkArchiveSymbol* symbols = realloc(archive->symbols, capacity * sizeof(ArkArchiveSymbol));
+        if (!symbols) {
+            return ARK_ARCHIVE_ERR_MEMORY;
+        }
+        archive->symbols = symbols;
+        archive->symbol_capacity = capacity;
+    }
+
+    size_t len = strlen(name) + 1;
+    if (archive->string_pool_size + len > archive->string_pool_capacity) {
+        size_t capacity = archive->string_pool_capacity ? archive->string_pool_capacity * 2 : 4096;
+        while (capacity < archive->string_pool_size + len) {
+            capacity *= 2;
+        }
+        char* pool = realloc(archive->string_pool, capacity);
+        if (!pool) {
+            return ARK_ARCHIVE_ERR_MEMORY;
+        }
+        archive->string_pool = pool;
+        archive->string_pool_capacity = capacity;
+    }
+
+    ArkArchiveSymbol* sym = &archive->symbols[archive->symbol_count];
+    sym->name_offset = archive->string_pool_size;
+    sym->member = member;
+    sym->hash = ark_archive_hash(name);
+    memcpy(archive->string_pool + archive->string_pool_size, name, len);
+    archive->string_pool_size += len;
+
+    size_t mask = archive->symbol_slot_count - 1;
+    size_t slot = sym->hash & mask;
+    while (archive->symbol_slots[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    archive->symbol_slots[slot] = (uint32_t)(++archive->symbol_count);
+    return ARK_ARCHIVE_OK;
+}
+
+bool ark_archive_find_symbol(const ArkArchive* archive, const char* name, size_t* out_member) {
+    if (!archive || !name || archive->symbol_slot_count == 0) {
+        return false;
+    }
+
+    uint32_t hash = ark_archive_hash(name);
+    size_t mask = archive->symbol_slot_count - 1;
+    size_t slot = hash & mask;
+    while (archive->symbol_slots[slot] != 0) {
+        const ArkArchiveSymbol* sym = &archive->symbols[archive->symbol_slots[slot] - 1];
+        if (sym->hash == hash && strcmp(archive->string_pool + sym->name_offset, name) == 0) {
+            if (out_member) {
+                *out_member = sym->member;
+            }
+            return true;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return false;
+}
+
+const char* ark_archive_symbol_name(const ArkArchive* archive, size_t index) {
+    if (!archive || index >= archive->symbol_count) {
+        return NULL;
+    }
+    return archive->string_pool + archive->symbols[index].name_offset;
+}
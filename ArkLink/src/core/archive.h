@@ -2,6 +2,7 @@
 #define ARK_ARCHIVE_H
 
 #include "ArkLink/arklink.h"
+#include "mapped_file.h"
 #include <stddef.h>
 #include <stdio.h>
 #include <stdbool.h>
@@ -21,18 +22,38 @@ typedef enum {
 
 typedef struct {
     char* name;           
-    uint8_t* data;        
+    const uint8_t* data;  
     size_t size;          
     size_t offset;        
+    size_t header_offset; 
+    bool extracted;       
 } ArkArchiveObject;
 
 
+typedef struct {
+    size_t name_offset;   
+    size_t member;        
+    uint32_t hash;        
+} ArkArchiveSymbol;
+
+
 typedef struct ArkArchive {
     ArkArchiveType type;
     ArkArchiveObject* objects;
     size_t object_count;
     size_t object_capacity;
     char* filename;
+    ArkMappedFile file;
+
+    ArkArchiveSymbol* symbols;
+    size_t symbol_count;
+    size_t symbol_capacity;
+    uint32_t* symbol_slots;
+    size_t symbol_slot_count;
+    char* string_pool;
+    size_t string_pool_size;
+    size_t string_pool_capacity;
+    bool has_symbol_index;
 } ArkArchive;
 
 
@@ -64,6 +85,31 @@ ArkArchiveType ark_archive_detect_type(const char* filename);
 
 bool ark_archive_is_archive(const char* filename);
 
+
+
+
+ArkArchiveResult ark_archive_read_member(ArkArchive* archive, size_t index);
+
+
+
+
+void ark_archive_release_member(ArkArchive* archive, size_t index);
+
+
+
+
+ArkArchiveResult ark_archive_add_symbol(ArkArchive* archive, const char* name, size_t member);
+
+
+
+
+bool ark_archive_find_symbol(const ArkArchive* archive, const char* name, size_t* out_member);
+
+
+
+
+const char* ark_archive_symbol_name(const ArkArchive* archive, size_t index);
+
 #ifdef __cplusplus
 }
 #endif
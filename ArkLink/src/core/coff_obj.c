@@ -72,11 +72,7 @@ int ark_coff_parse(const uint8_t* data, size_t size, ArkCOFFObject* obj) {
     memset(obj, 0, sizeof(ArkCOFFObject));
     
     
-    obj->raw_data = malloc(size);
-    if (!obj->raw_data) {
-        return -1;
-    }
-    memcpy(obj->raw_data, data, size);
+    obj->raw_data = data;
     obj->raw_size = size;
     
     
@@ -93,13 +89,17 @@ int ark_coff_parse(const uint8_t* data, size_t size, ArkCOFFObject* obj) {
         }
         
         size_t section_offset = sizeof(ArkCOFFFileHeader) + obj->header.SizeOfOptionalHeader;
+        if (section_offset + (size_t)obj->header.NumberOfSections * sizeof(ArkCOFFSectionHeader) > size) {
+            ark_coff_free(obj);
+            return -1;
+        }
         for (uint16_t i = 0; i < obj->header.NumberOfSections; i++) {
             memcpy(&obj->sections[i], obj->raw_data + section_offset, sizeof(ArkCOFFSectionHeader));
             section_offset += sizeof(ArkCOFFSectionHeader);
             
             
             if (obj->sections[i].PointerToRawData > 0 && obj->sections[i].SizeOfRawData > 0) {
-                if (obj->sections[i].PointerToRawData + obj->sections[i].SizeOfRawData <= size) {
+                if ((size_t)obj->sections[i].PointerToRawData + obj->sections[i].SizeOfRawData <= size) {
                     obj->section_data[i] = obj->raw_data + obj->sections[i].PointerToRawData;
                 }
             }
@@ -115,6 +115,10 @@ int ark_coff_parse(const uint8_t* data, size_t size, ArkCOFFObject* obj) {
         }
         
         size_t sym_offset = obj->header.PointerToSymbolTable;
+        if (sym_offset + (size_t)obj->header.NumberOfSymbols * sizeof(ArkCOFFSymbol) > size) {
+            ark_coff_free(obj);
+            return -1;
+        }
         for (uint32_t i = 0; i < obj->header.NumberOfSymbols; i++) {
             memcpy(&obj->symbols[i], obj->raw_data + sym_offset, sizeof(ArkCOFFSymbol));
             sym_offset += sizeof(ArkCOFFSymbol);
@@ -127,7 +131,7 @@ int ark_coff_parse(const uint8_t* data, size_t size, ArkCOFFObject* obj) {
             uint32_t string_table_size;
             memcpy(&string_table_size, obj->raw_data + string_table_offset, sizeof(uint32_t));
             if (string_table_size > 4 && string_table_offset + string_table_size <= size) {
-                obj->string_table = obj->raw_data + string_table_offset;
+                obj->string_table = (const char*)obj->raw_data + string_table_offset;
                 obj->string_table_size = string_table_size;
             }
         }
@@ -136,13 +140,36 @@ int ark_coff_parse(const uint8_t* data, size_t size, ArkCOFFObject* obj) {
     return 0;
 }
 
+char* ark_coff_copy_symbol_names(const ArkCOFFObject* obj) {
+    size_t pool_size = 1;
+    for (uint32_t i = 0; i < obj->header.NumberOfSymbols; i++) {
+        pool_size += strlen(ark_coff_get_symbol_name(obj, &obj->symbols[i])) + 1;
+        i += obj->symbols[i].NumberOfAuxSymbols;
+    }
+    
+    char* pool = (char*)malloc(pool_size);
+    if (!pool) {
+        return NULL;
+    }
+    
+    char* cursor = pool;
+    for (uint32_t i = 0; i < obj->header.NumberOfSymbols; i++) {
+        const char* name = ark_coff_get_symbol_name(obj, &obj->symbols[i]);
+        size_t len = strlen(name) + 1;
+        memcpy(cursor, name, len);
+        cursor += len;
+        i += obj->symbols[i].NumberOfAuxSymbols;
+    }
+    *cursor = '\0';
+    return pool;
+}
+
 void ark_coff_free(ArkCOFFObject* obj) {
     if (!obj) return;
     
     free(obj->sections);
     free(obj->section_data);
     free(obj->symbols);
-    free(obj->raw_data);
     
     memset(obj, 0, sizeof(ArkCOFFObject));
 }
@@ -242,7 +269,8 @@ ArkLinkResult ark_coff_load_unit(ArkLinkContext* ctx, const uint8_t* data, size_
             .data = sec_data,
             .size = sec_size,
             .alignment = alignment,
-            .flags = coff_section_flags(sec->Characteristics)
+            .flags = coff_section_flags(sec->Characteristics),
+            .borrow_data = 1
         };
         
         ArkLinkSection* section = ark_link_unit_add_section(unit, &sdesc);
@@ -253,7 +281,8 @@ ArkLinkResult ark_coff_load_unit(ArkLinkContext* ctx, const uint8_t* data, size_
         }
         
         
-        if (sec->NumberOfRelocations > 0 && sec->PointerToRelocations > 0) {
+        if (sec->NumberOfRelocations > 0 && sec->PointerToRelocations > 0 &&
+            (size_t)sec->PointerToRelocations + (size_t)sec->NumberOfRelocations * sizeof(ArkCOFFRelocation) <= coff.raw_size) {
             size_t reloc_offset = sec->PointerToRelocations;
             for (uint16_t r = 0; r < sec->NumberOfRelocations; r++) {
                 ArkCOFFRelocation coff_reloc;
@@ -264,7 +293,7 @@ ArkLinkResult ark_coff_load_unit(ArkLinkContext* ctx, const uint8_t* data, size_
                     .offset = coff_reloc.VirtualAddress,
                     .sym_idx = coff_reloc.SymbolTableIndex,
                     .type = coff_reloc_type(coff_reloc.Type),
-                    .addend = 0
+                    .addend = (coff_reloc.Type == IMAGE_REL_AMD64_REL32) ? -4 : 0
                 };
                 
                 if (!ark_link_section_add_reloc(section, &rdesc)) {
@@ -277,11 +306,17 @@ ArkLinkResult ark_coff_load_unit(ArkLinkContext* ctx, const uint8_t* data, size_
     }
 
     
+    unit->string_pool = ark_coff_copy_symbol_names(&coff);
+    if (!unit->string_pool) {
+        ark_link_unit_destroy(unit);
+        ark_coff_free(&coff);
+        return ARK_LINK_ERR_MEMORY;
+    }
+    
+    const char* name = unit->string_pool;
     for (uint32_t i = 0; i < coff.header.NumberOfSymbols; i++) {
         ArkCOFFSymbol* coff_sym = &coff.symbols[i];
         
-        const char* name = ark_coff_get_symbol_name(&coff, coff_sym);
-        
         
         uint8_t binding;
         if (coff_sym->StorageClass == IMAGE_SYM_CLASS_EXTERNAL) {
@@ -295,7 +330,7 @@ ArkLinkResult ark_coff_load_unit(ArkLinkContext* ctx, const uint8_t* data, size_
         if (coff_sym->SectionNumber == IMAGE_SYM_UNDEFINED) {
             section_index = 0; 
         } else if (coff_sym->SectionNumber > 0 && coff_sym->SectionNumber <= coff.header.NumberOfSections) {
-            section_index = coff_sym->SectionNumber - 1; 
+            section_index = (uint16_t)coff_sym->SectionNumber; 
         } else {
             section_index = 0; 
         }
@@ -316,6 +351,7 @@ ArkLinkResult ark_coff_load_unit(ArkLinkContext* ctx, const uint8_t* data, size_
             return ARK_LINK_ERR_INTERNAL;
         }
         
+        name += strlen(name) + 1;
         i += coff_sym->NumberOfAuxSymbols;
     }
 
@@ -328,7 +364,55 @@ ArkLinkResult ark_coff_load_unit(ArkLinkContext* ctx, const uint8_t* data, size_
         }
     }
 
+    ArkLinkResult remap = ark_coff_remap_reloc_symbols(&coff, unit);
+    if (remap != ARK_LINK_OK) {
+        ark_link_unit_destroy(unit);
+        ark_coff_free(&coff);
+        return remap;
+    }
+
     *out_unit = unit;
     ark_coff_free(&coff);
     return ARK_LINK_OK;
 }
+
+ArkLinkResult ark_coff_remap_reloc_symbols(const ArkCOFFObject* obj, ArkLinkUnit* unit) {
+    if (!obj || !unit) {
+        return ARK_LINK_ERR_INVALID_ARGUMENT;
+    }
+    if (obj->header.NumberOfSymbols == 0) {
+        return ARK_LINK_OK;
+    }
+
+    
+    uint32_t* map = (uint32_t*)malloc(obj->header.NumberOfSymbols * sizeof(uint32_t));
+    if (!map) {
+        return ARK_LINK_ERR_MEMORY;
+    }
+    uint32_t unit_index = 0;
+    for (uint32_t i = 0; i < obj->header.NumberOfSymbols; i++) {
+        map[i] = unit_index;
+        uint32_t aux = obj->symbols[i].NumberOfAuxSymbols;
+        for (uint32_t a = 1; a <= aux && i + a < obj->header.NumberOfSymbols; a++) {
+            map[i + a] = UINT32_MAX;
+        }
+        i += aux;
+        unit_index++;
+    }
+
+    ArkLinkResult result = ARK_LINK_OK;
+    for (size_t s = 0; s < unit->section_count && result == ARK_LINK_OK; s++) {
+        ArkLinkSection* section = &unit->sections[s];
+        for (size_t r = 0; r < section->reloc_count; r++) {
+            uint32_t sym_idx = section->relocs[r].sym_idx;
+            if (sym_idx >= obj->header.NumberOfSymbols || map[sym_idx] == UINT32_MAX) {
+                result = ARK_LINK_ERR_FORMAT;
+                break;
+            }
+            section->relocs[r].sym_idx = map[sym_idx];
+        }
+    }
+
+    free(map);
+    return result;
+}
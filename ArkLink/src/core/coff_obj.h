@@ -30,6 +30,7 @@ extern "C" {
 #define IMAGE_REL_AMD64_REL32  4
 
 
+#pragma pack(push, 1)
 typedef struct {
     uint16_t Machine;
     uint16_t NumberOfSections;
@@ -76,16 +77,17 @@ typedef struct {
     uint32_t SymbolTableIndex;
     uint16_t Type;
 } ArkCOFFRelocation;
+#pragma pack(pop)
 
 
 typedef struct {
     ArkCOFFFileHeader header;
     ArkCOFFSectionHeader* sections;
-    uint8_t** section_data;
+    const uint8_t** section_data;
     ArkCOFFSymbol* symbols;
-    char* string_table;
+    const char* string_table;
     uint32_t string_table_size;
-    uint8_t* raw_data;
+    const uint8_t* raw_data;
     size_t raw_size;
 } ArkCOFFObject;
 
@@ -137,6 +139,11 @@ int ark_coff_extract_relocations(const ArkCOFFObject* obj, ArkCOFFRelocationInfo
 bool ark_coff_is_valid(const uint8_t* data, size_t size);
 
 
+
+
+char* ark_coff_copy_symbol_names(const ArkCOFFObject* obj);
+
+
 struct ArkLinkContext;
 typedef struct ArkLinkContext ArkLinkContext;
 struct ArkLinkUnit;
@@ -148,6 +155,11 @@ typedef struct ArkLinkUnit ArkLinkUnit;
 ArkLinkResult ark_coff_load_unit(ArkLinkContext* ctx, const uint8_t* data, size_t size,
                                   const char* path, ArkLinkUnit** out_unit);
 
+
+
+
+ArkLinkResult ark_coff_remap_reloc_symbols(const ArkCOFFObject* obj, ArkLinkUnit* unit);
+
 #ifdef __cplusplus
 }
 #endif
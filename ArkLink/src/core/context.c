@@ -1,4 +1,6 @@
 #include "ArkLink/context.h"
+#include "ArkLink/parallel.h"
+#include "stats.h"
 
 #include <stdarg.h>
 #include <stdio.h>
@@ -20,19 +22,31 @@ struct ArkArena {
 
 struct ArkStringNode {
     struct ArkStringNode* next;
+    size_t hash;
     size_t length;
     char data[1];
 };
 
+#define ARK_INTERN_SHARD_BITS 4
+#define ARK_INTERN_SHARD_COUNT (1u << ARK_INTERN_SHARD_BITS)
+
+struct ArkStringShard {
+    ArkMutex mutex;
+    ArkArena* arena;
+    struct ArkStringNode** buckets;
+    size_t bucket_count;
+    size_t count;
+};
+
 struct ArkLinkContext {
     ArkArena* arena;
     ArkLinkJob job;
     ArkContextConfig config;
     ArkLinkLogger logger;
     void* logger_user_data;
-    struct ArkStringNode** buckets;
-    size_t bucket_count;
+    struct ArkStringShard strings[ARK_INTERN_SHARD_COUNT];
     ArkParsedConfig* parsed_config;
+    ArkStatsRecorder recorder;
 };
 
 static struct ArkArenaChunk* arena_chunk_create(size_t chunk_size) {
@@ -108,25 +122,54 @@ static size_t hash_bytes(const char* data, size_t length) {
     return hash;
 }
 
-static const char* ark_context_intern_impl(ArkLinkContext* ctx, const char* data, size_t length) {
-    size_t idx = hash_bytes(data, length) % ctx->bucket_count;
-    struct ArkStringNode* node = ctx->buckets[idx];
+static void ark_string_shard_grow(struct ArkStringShard* shard) {
+    size_t bucket_count = shard->bucket_count * 2;
+    struct ArkStringNode** buckets = (struct ArkStringNode**)calloc(bucket_count, sizeof(struct ArkStringNode*));
+    if (!buckets) {
+        return;
+    }
+    for (size_t i = 0; i < shard->bucket_count; ++i) {
+        struct ArkStringNode* node = shard->buckets[i];
+        while (node) {
+            struct ArkStringNode* next = node->next;
+            size_t idx = node->hash % bucket_count;
+            node->next = buckets[idx];
+            buckets[idx] = node;
+            node = next;
+        }
+    }
+    free(shard->buckets);
+    shard->buckets = buckets;
+    shard->bucket_count = bucket_count;
+}
+
+static const char* ark_context_intern_impl(ArkLinkContext* ctx, const char* data, size_t length, size_t hash) {
+    struct ArkStringShard* shard = &ctx->strings[hash >> (sizeof(size_t) * 8 - ARK_INTERN_SHARD_BITS)];
+
+    ark_mutex_lock(&shard->mutex);
+    size_t idx = hash % shard->bucket_count;
+    struct ArkStringNode* node = shard->buckets[idx];
     while (node) {
-        if (node->length == length && memcmp(node->data, data, length) == 0) {
+        if (node->hash == hash && node->length == length && memcmp(node->data, data, length) == 0) {
+            ark_mutex_unlock(&shard->mutex);
             return node->data;
         }
         node = node->next;
     }
-    node = (struct ArkStringNode*)ark_arena_alloc(ctx->arena, sizeof(struct ArkStringNode) + length, alignof(struct ArkStringNode));
-    if (!node) {
-        return NULL;
+    node = (struct ArkStringNode*)ark_arena_alloc(shard->arena, sizeof(struct ArkStringNode) + length, alignof(struct ArkStringNode));
+    if (node) {
+        node->hash = hash;
+        node->length = length;
+        memcpy(node->data, data, length);
+        node->data[length] = '\0';
+        node->next = shard->buckets[idx];
+        shard->buckets[idx] = node;
+        if (++shard->count > shard->bucket_count * 2) {
+            ark_string_shard_grow(shard);
+        }
     }
-    node->length = length;
-    memcpy(node->data, data, length);
-    node->data[length] = '\0';
-    node->next = ctx->buckets[idx];
-    ctx->buckets[idx] = node;
-    return node->data;
+    ark_mutex_unlock(&shard->mutex);
+    return node ? node->data : NULL;
 }
 
 ArkLinkContext* ark_context_create(const ArkLinkJob* job, const ArkContextConfig* cfg) {
@@ -161,11 +204,21 @@ ArkLinkContext* ark_context_create(const ArkLinkJob* job, const ArkContextConfig
     if (job) {
         ctx->job = *job;
     }
-    ctx->bucket_count = applied.string_table_buckets;
-    ctx->buckets = (struct ArkStringNode**)calloc(ctx->bucket_count, sizeof(struct ArkStringNode*));
-    if (!ctx->buckets) {
-        ark_context_destroy(ctx);
-        return NULL;
+    ark_stats_recorder_init(&ctx->recorder, job ? job->stats : NULL);
+    size_t bucket_count = applied.string_table_buckets / ARK_INTERN_SHARD_COUNT;
+    if (bucket_count < 16) {
+        bucket_count = 16;
+    }
+    for (size_t i = 0; i < ARK_INTERN_SHARD_COUNT; ++i) {
+        struct ArkStringShard* shard = &ctx->strings[i];
+        ark_mutex_init(&shard->mutex);
+        shard->arena = ark_arena_create(applied.arena_chunk_size);
+        shard->bucket_count = bucket_count;
+        shard->buckets = (struct ArkStringNode**)calloc(bucket_count, sizeof(struct ArkStringNode*));
+        if (!shard->arena || !shard->buckets) {
+            ark_context_destroy(ctx);
+            return NULL;
+        }
     }
     return ctx;
 }
@@ -186,9 +239,17 @@ void ark_context_destroy(ArkLinkContext* ctx) {
     if (!ctx) {
         return;
     }
+    ark_stats_recorder_finish(&ctx->recorder);
     ark_parsed_config_free(ctx->parsed_config);
     ark_arena_destroy(ctx->arena);
-    free(ctx->buckets);
+    for (size_t i = 0; i < ARK_INTERN_SHARD_COUNT; ++i) {
+        struct ArkStringShard* shard = &ctx->strings[i];
+        if (shard->arena || shard->buckets) {
+            ark_arena_destroy(shard->arena);
+            free(shard->buckets);
+            ark_mutex_destroy(&shard->mutex);
+        }
+    }
     free(ctx);
 }
 
@@ -204,7 +265,18 @@ const char* ark_context_intern(ArkLinkContext* ctx, ArkStringView view) {
     if (!ctx || !view.data) {
         return NULL;
     }
-    return ark_context_intern_impl(ctx, view.data, view.length);
+    return ark_context_intern_impl(ctx, view.data, view.length, hash_bytes(view.data, view.length));
+}
+
+const char* ark_context_intern_hashed(ArkLinkContext* ctx, ArkStringView view, size_t hash) {
+    if (!ctx || !view.data) {
+        return NULL;
+    }
+    return ark_context_intern_impl(ctx, view.data, view.length, hash);
+}
+
+size_t ark_context_hash(ArkStringView view) {
+    return view.data ? hash_bytes(view.data, view.length) : 0;
 }
 
 const ArkParsedConfig* ark_context_config(const ArkLinkContext* ctx) {
@@ -221,6 +293,22 @@ void ark_context_set_config(ArkLinkContext* ctx, ArkParsedConfig* config) {
     ctx->parsed_config = config;
 }
 
+ArkLinkStats* ark_context_stats(ArkLinkContext* ctx) {
+    return ctx ? ctx->recorder.stats : NULL;
+}
+
+void ark_context_phase_begin(ArkLinkContext* ctx, ArkLinkPhase phase) {
+    if (ctx) {
+        ark_stats_recorder_begin(&ctx->recorder, phase);
+    }
+}
+
+void ark_context_phase_end(ArkLinkContext* ctx, ArkLinkPhase phase) {
+    if (ctx) {
+        ark_stats_recorder_end(&ctx->recorder, phase);
+    }
+}
+
 ArkLinkResult ark_section_buffer_init(ArkSectionBuffer* buffer, ArkSectionKind kind, uint32_t flags, uint32_t alignment) {
     if (!buffer) {
         return ARK_LINK_ERR_INVALID_ARGUMENT;
@@ -235,7 +323,16 @@ ArkLinkResult ark_section_buffer_init(ArkSectionBuffer* buffer, ArkSectionKind k
 }
 
 static uint8_t* ark_section_buffer_grow(ArkSectionBuffer* buffer, size_t new_capacity) {
-    uint8_t* new_data = (uint8_t*)realloc(buffer->data, new_capacity);
+    uint8_t* new_data;
+    if (buffer->capacity == 0 && buffer->data) {
+        new_data = (uint8_t*)malloc(new_capacity);
+        if (!new_data) {
+            return NULL;
+        }
+        memcpy(new_data, buffer->data, buffer->size < new_capacity ? buffer->size : new_capacity);
+    } else {
+        new_data = (uint8_t*)realloc(buffer->data, new_capacity);
+    }
     if (!new_data) {
         return NULL;
     }
@@ -265,6 +362,18 @@ ArkLinkResult ark_section_buffer_append(ArkSectionBuffer* buffer, const void* da
     return ARK_LINK_OK;
 }
 
+ArkLinkResult ark_section_buffer_make_writable(ArkSectionBuffer* buffer) {
+    if (!buffer) {
+        return ARK_LINK_ERR_INVALID_ARGUMENT;
+    }
+    if (buffer->capacity == 0 && buffer->data && buffer->size > 0) {
+        if (!ark_section_buffer_grow(buffer, buffer->size)) {
+            return ARK_LINK_ERR_MEMORY;
+        }
+    }
+    return ARK_LINK_OK;
+}
+
 ArkLinkResult ark_section_buffer_resize(ArkSectionBuffer* buffer, size_t new_size) {
     if (!buffer) {
         return ARK_LINK_ERR_INVALID_ARGUMENT;
@@ -285,7 +394,9 @@ void ark_section_buffer_release(ArkSectionBuffer* buffer) {
     if (!buffer) {
         return;
     }
-    free(buffer->data);
+    if (buffer->capacity > 0) {
+        free(buffer->data);
+    }
     buffer->data = NULL;
     buffer->size = 0;
     buffer->capacity = 0;
@@ -0,0 +1,1162 @@
+#include "incremental.h"
+#include "mapped_file.h"
+#include "ArkLink/output_file.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define ARK_LINK_MAP_MAGIC 0x3150414D4B4C4B41ULL
+#define ARK_LINK_MAP_VERSION 1
+#define ARK_LINK_MAP_NONE 0xFFFFFFFFu
+#define ARK_LINK_MAP_UNIT_LIBRARY 0x1u
+#define ARK_INCREMENTAL_HASH_SEED 0xCBF29CE484222325ULL
+
+
+typedef struct ArkMapHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t target;
+    uint64_t config_hash;
+    uint64_t output_size;
+    uint32_t unit_count;
+    uint32_t section_count;
+    uint32_t symbol_count;
+    uint32_t slot_count;
+    uint32_t reloc_count;
+    uint32_t string_size;
+} ArkMapHeader;
+
+typedef struct ArkMapUnit {
+    uint64_t hash;
+    uint64_t size;
+    uint32_t path;
+    uint32_t flags;
+    uint32_t first_section;
+    uint32_t section_count;
+} ArkMapUnit;
+
+typedef struct ArkMapSection {
+    uint64_t address;
+    uint64_t file_offset;
+    uint64_t size;
+    uint64_t capacity;
+    uint32_t name;
+    uint32_t unit;
+    uint32_t kind;
+    uint32_t alignment;
+} ArkMapSection;
+
+typedef struct ArkMapSymbol {
+    uint64_t address;
+    uint64_t got_address;
+    uint32_t name;
+    uint32_t section;
+    uint32_t size;
+    uint32_t binding;
+} ArkMapSymbol;
+
+typedef struct ArkMapSlot {
+    uint64_t file_offset;
+    uint64_t address;
+    uint32_t symbol;
+    uint32_t type;
+} ArkMapSlot;
+
+typedef struct ArkMapReloc {
+    uint32_t section;
+    uint32_t offset;
+    uint32_t type;
+    uint32_t symbol;
+    int32_t addend;
+} ArkMapReloc;
+
+
+typedef struct ArkLinkMap {
+    ArkMapHeader header;
+    ArkMapUnit* units;
+    ArkMapSection* sections;
+    ArkMapSymbol* symbols;
+    ArkMapSlot* slots;
+    ArkMapReloc* relocs;
+    char* strings;
+    size_t string_capacity;
+    bool string_failed;
+} ArkLinkMap;
+
+
+typedef struct ArkRelink {
+    ArkLinkContext* ctx;
+    const ArkLinkJob* job;
+    ArkLinkMap map;
+    size_t primary_count;
+    uint32_t* lookup;
+    size_t lookup_mask;
+    uint64_t* old_addresses;
+    uint32_t* old_sizes;
+    uint32_t* old_sections;
+    uint8_t* defined;
+    size_t* reloc_first;
+    ArkLinkUnit** loaded;
+    ArkMapReloc* relocs;
+    size_t reloc_count;
+    size_t reloc_capacity;
+    size_t* new_reloc_first;
+    size_t* new_reloc_count;
+    size_t changed_count;
+    char reason[256];
+} ArkRelink;
+
+
+static uint64_t ark_incremental_hash(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static uint64_t ark_incremental_hash_u64(uint64_t hash, uint64_t value) {
+    return ark_incremental_hash(hash, &value, sizeof(value));
+}
+
+static uint64_t ark_incremental_hash_string(uint64_t hash, const char* str) {
+    if (!str) {
+        str = "";
+    }
+    return ark_incremental_hash(hash, str, strlen(str) + 1);
+}
+
+static char* ark_incremental_map_path(const char* output) {
+    size_t len = strlen(output);
+    char* path = (char*)malloc(len + sizeof(".arkmap"));
+    if (!path) {
+        return NULL;
+    }
+    memcpy(path, output, len);
+    memcpy(path + len, ".arkmap", sizeof(".arkmap"));
+    return path;
+}
+
+static ArkLinkResult ark_incremental_file_size(const char* path, uint64_t* out_size) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        return ARK_LINK_ERR_IO;
+    }
+    long size = fseek(fp, 0, SEEK_END) == 0 ? ftell(fp) : -1;
+    fclose(fp);
+    if (size < 0) {
+        return ARK_LINK_ERR_IO;
+    }
+    *out_size = (uint64_t)size;
+    return ARK_LINK_OK;
+}
+
+static ArkLinkResult ark_incremental_hash_input(const ArkLinkInput* in, uint64_t* out_hash, uint64_t* out_size) {
+    if (in->data && in->size > 0) {
+        *out_hash = ark_incremental_hash(ARK_INCREMENTAL_HASH_SEED, in->data, in->size);
+        *out_size = in->size;
+        return ARK_LINK_OK;
+    }
+    if (!in->path) {
+        return ARK_LINK_ERR_INVALID_ARGUMENT;
+    }
+
+    ArkMappedFile file;
+    ArkLinkResult res = ark_mapped_file_open(in->path, &file);
+    if (res != ARK_LINK_OK) {
+        return res;
+    }
+    *out_hash = ark_incremental_hash(ARK_INCREMENTAL_HASH_SEED, file.data, file.size);
+    *out_size = file.size;
+    ark_mapped_file_close(&file);
+    return ARK_LINK_OK;
+}
+
+
+static uint64_t ark_incremental_config_hash(const ArkLinkContext* ctx) {
+    const ArkLinkJob* job = ark_context_job(ctx);
+    const ArkParsedConfig* config = ark_context_config(ctx);
+    uint64_t hash = ARK_INCREMENTAL_HASH_SEED;
+
+    hash = ark_incremental_hash_u64(hash, (uint64_t)job->target);
+    hash = ark_incremental_hash_u64(hash, (uint64_t)job->output_kind);
+    hash = ark_incremental_hash_u64(hash, job->flags & ~(uint32_t)(ARK_LINK_FLAG_VERBOSE | ARK_LINK_FLAG_QUIET));
+    if (config) {
+        hash = ark_incremental_hash_string(hash, config->entry_point);
+        hash = ark_incremental_hash_u64(hash, (uint64_t)config->subsystem);
+        hash = ark_incremental_hash_u64(hash, config->image_base);
+        hash = ark_incremental_hash_u64(hash, config->stack_size);
+        for (size_t i = 0; i < config->import_count; i++) {
+            hash = ark_incremental_hash_string(hash, config->imports[i].module);
+            hash = ark_incremental_hash_string(hash, config->imports[i].symbol);
+            hash = ark_incremental_hash_u64(hash, config->imports[i].slot);
+        }
+        for (size_t i = 0; i < config->export_symbol_count; i++) {
+            hash = ark_incremental_hash_string(hash, config->export_symbols[i]);
+        }
+    }
+
+    for (size_t i = 0; i < job->library_count; i++) {
+        char lib_path[512];
+        hash = ark_incremental_hash_string(hash, job->libraries[i]);
+        if (ark_loader_find_library(job->libraries[i], job->library_paths, job->library_path_count,
+                                    lib_path, sizeof(lib_path)) == ARK_LINK_OK) {
+            ArkLinkInput lib = {
+                .path = lib_path,
+            };
+            uint64_t lib_hash = 0;
+            uint64_t lib_size = 0;
+            if (ark_incremental_hash_input(&lib, &lib_hash, &lib_size) == ARK_LINK_OK) {
+                hash = ark_incremental_hash_u64(hash, lib_hash);
+            }
+        }
+    }
+    return hash;
+}
+
+
+static void ark_link_map_free(ArkLinkMap* map) {
+    free(map->units);
+    free(map->sections);
+    free(map->symbols);
+    free(map->slots);
+    free(map->relocs);
+    free(map->strings);
+    memset(map, 0, sizeof(*map));
+}
+
+static size_t ark_link_map_size(const ArkMapHeader* header) {
+    return sizeof(ArkMapHeader) +
+           (size_t)header->unit_count * sizeof(ArkMapUnit) +
+           (size_t)header->section_count * sizeof(ArkMapSection) +
+           (size_t)header->symbol_count * sizeof(ArkMapSymbol) +
+           (size_t)header->slot_count * sizeof(ArkMapSlot) +
+           (size_t)header->reloc_count * sizeof(ArkMapReloc) +
+           header->string_size;
+}
+
+static uint32_t ark_link_map_add_string(ArkLinkMap* map, const char* str) {
+    if (!str) {
+        str = "";
+    }
+    size_t len = strlen(str) + 1;
+    size_t offset = map->header.string_size;
+    if (offset + len > map->string_capacity) {
+        size_t capacity = map->string_capacity ? map->string_capacity * 2 : 4096;
+        while (capacity < offset + len) {
+            capacity *= 2;
+        }
+        char* strings = (char*)realloc(map->strings, capacity);
+        if (!strings) {
+            map->string_failed = true;
+            return 0;
+        }
+        map->strings = strings;
+        map->string_capacity = capacity;
+    }
+    memcpy(map->strings + offset, str, len);
+    map->header.string_size = (uint32_t)(offset + len);
+    return (uint32_t)offset;
+}
+
+static const char* ark_link_map_string(const ArkLinkMap* map, uint32_t offset) {
+    if (offset >= map->header.string_size) {
+        return "";
+    }
+    return map->strings + offset;
+}
+
+static uint8_t* ark_link_map_emit(uint8_t* cursor, const void* data, size_t size) {
+    if (size > 0) {
+        memcpy(cursor, data, size);
+    }
+    return cursor + size;
+}
+
+static ArkLinkResult ark_link_map_write(const ArkLinkMap* map, const char* path) {
+    const ArkMapHeader* header = &map->header;
+    ArkOutputFile file;
+    ArkLinkResult res = ark_output_file_open(path, ark_link_map_size(header), &file);
+    if (res != ARK_LINK_OK) {
+        return res;
+    }
+
+    uint8_t* cursor = file.data;
+    cursor = ark_link_map_emit(cursor, header, sizeof(*header));
+    cursor = ark_link_map_emit(cursor, map->units, header->unit_count * sizeof(ArkMapUnit));
+    cursor = ark_link_map_emit(cursor, map->sections, header->section_count * sizeof(ArkMapSection));
+    cursor = ark_link_map_emit(cursor, map->symbols, header->symbol_count * sizeof(ArkMapSymbol));
+    cursor = ark_link_map_emit(cursor, map->slots, header->slot_count * sizeof(ArkMapSlot));
+    cursor = ark_link_map_emit(cursor, map->relocs, header->reloc_count * sizeof(ArkMapReloc));
+    ark_link_map_emit(cursor, map->strings, header->string_size);
+    return ark_output_file_commit(&file, false);
+}
+
+static void* ark_link_map_take(const uint8_t** cursor, size_t size) {
+    void* copy = malloc(size > 0 ? size : 1);
+    if (copy && size > 0) {
+        memcpy(copy, *cursor, size);
+    }
+    *cursor += size;
+    return copy;
+}
+
+static bool ark_link_map_valid(const ArkLinkMap* map) {
+    const ArkMapHeader* header = &map->header;
+    if (header->string_size == 0 || map->strings[header->string_size - 1] != '\0') {
+        return false;
+    }
+    for (size_t i = 0; i < header->unit_count; i++) {
+        const ArkMapUnit* unit = &map->units[i];
+        if ((uint64_t)unit->first_section + unit->section_count > header->section_count) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < header->section_count; i++) {
+        if (map->sections[i].unit >= header->unit_count) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < header->symbol_count; i++) {
+        uint32_t section = map->symbols[i].section;
+        if (section != ARK_LINK_MAP_NONE && section >= header->section_count) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < header->slot_count; i++) {
+        if (map->slots[i].symbol >= header->symbol_count) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < header->reloc_count; i++) {
+        const ArkMapReloc* reloc = &map->relocs[i];
+        if (reloc->section >= header->section_count || reloc->symbol >= header->symbol_count ||
+            (i > 0 && reloc->section < map->relocs[i - 1].section)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static ArkLinkResult ark_link_map_read(const char* path, ArkLinkMap* map) {
+    memset(map, 0, sizeof(*map));
+
+    ArkMappedFile file;
+    ArkLinkResult res = ark_mapped_file_open(path, &file);
+    if (res != ARK_LINK_OK) {
+        return res;
+    }
+    if (file.size < sizeof(ArkMapHeader)) {
+        ark_mapped_file_close(&file);
+        return ARK_LINK_ERR_FORMAT;
+    }
+    memcpy(&map->header, file.data, sizeof(map->header));
+    const ArkMapHeader* header = &map->header;
+    if (header->magic != ARK_LINK_MAP_MAGIC || header->version != ARK_LINK_MAP_VERSION ||
+        ark_link_map_size(header) != file.size) {
+        ark_mapped_file_close(&file);
+        return ARK_LINK_ERR_FORMAT;
+    }
+
+    const uint8_t* cursor = file.data + sizeof(ArkMapHeader);
+    map->units = (ArkMapUnit*)ark_link_map_take(&cursor, header->unit_count * sizeof(ArkMapUnit));
+    map->sections = (ArkMapSection*)ark_link_map_take(&cursor, header->section_count * sizeof(ArkMapSection));
+    map->symbols = (ArkMapSymbol*)ark_link_map_take(&cursor, header->symbol_count * sizeof(ArkMapSymbol));
+    map->slots = (ArkMapSlot*)ark_link_map_take(&cursor, header->slot_count * sizeof(ArkMapSlot));
+    map->relocs = (ArkMapReloc*)ark_link_map_take(&cursor, header->reloc_count * sizeof(ArkMapReloc));
+    map->strings = (char*)ark_link_map_take(&cursor, header->string_size);
+    map->string_capacity = header->string_size;
+    ark_mapped_file_close(&file);
+
+    if (!map->units || !map->sections || !map->symbols || !map->slots || !map->relocs || !map->strings) {
+        ark_link_map_free(map);
+        return ARK_LINK_ERR_MEMORY;
+    }
+    if (!ark_link_map_valid(map)) {
+        ark_link_map_free(map);
+        return ARK_LINK_ERR_FORMAT;
+    }
+    return ARK_LINK_OK;
+}
+
+
+void ark_incremental_reserve(ArkBackendInput* input) {
+    if (!input) {
+        return;
+    }
+    for (size_t i = 0; i < input->section_count; i++) {
+        size_t size = input->sections[i].buffer ? input->sections[i].buffer->size : 0;
+        input->sections[i].reserve = (size / 4 + 64 + 15) & ~(size_t)15;
+    }
+    input->record_layout = 1;
+}
+
+void ark_incremental_discard(const char* output_path) {
+    if (!output_path) {
+        return;
+    }
+    char* path = ark_incremental_map_path(output_path);
+    if (path) {
+        remove(path);
+        free(path);
+    }
+}
+
+ArkLinkResult ark_incremental_save(ArkLinkContext* ctx, ArkLinkUnit* const* units, size_t unit_count,
+                                   const ArkBackendInput* input) {
+    const ArkLinkJob* job = ark_context_job(ctx);
+    if (!job || !job->output || !input || !input->record_layout || unit_count != job->input_count) {
+        return ARK_LINK_ERR_INVALID_ARGUMENT;
+    }
+
+    size_t primary_sections = 0;
+    for (size_t u = 0; u < unit_count; u++) {
+        primary_sections += units[u]->section_count;
+    }
+    if (primary_sections > input->section_count) {
+        return ARK_LINK_ERR_INTERNAL;
+    }
+    int has_library = input->section_count > primary_sections;
+
+    size_t reloc_count = 0;
+    for (size_t i = 0; i < input->reloc_count; i++) {
+        const ArkBackendInputReloc* reloc = &input->relocs[i];
+        if (reloc->section_id < input->section_count && reloc->symbol_index < input->symbol_count) {
+            reloc_count++;
+        }
+    }
+
+    ArkLinkMap map;
+    memset(&map, 0, sizeof(map));
+    ArkMapHeader* header = &map.header;
+    header->magic = ARK_LINK_MAP_MAGIC;
+    header->version = ARK_LINK_MAP_VERSION;
+    header->target = (uint32_t)job->target;
+    header->config_hash = ark_incremental_config_hash(ctx);
+    header->unit_count = (uint32_t)(unit_count + (has_library ? 1 : 0));
+    header->section_count = (uint32_t)input->section_count;
+    header->symbol_count = (uint32_t)input->symbol_count;
+    header->slot_count = (uint32_t)input->address_slot_count;
+    header->reloc_count = (uint32_t)reloc_count;
+
+    ArkLinkResult res = ark_incremental_file_size(job->output, &header->output_size);
+    if (res != ARK_LINK_OK) {
+        return res;
+    }
+
+    map.units = (ArkMapUnit*)calloc(header->unit_count + 1, sizeof(ArkMapUnit));
+    map.sections = (ArkMapSection*)calloc(header->section_count + 1, sizeof(ArkMapSection));
+    map.symbols = (ArkMapSymbol*)calloc(header->symbol_count + 1, sizeof(ArkMapSymbol));
+    map.slots = (ArkMapSlot*)calloc(header->slot_count + 1, sizeof(ArkMapSlot));
+    map.relocs = (ArkMapReloc*)calloc(header->reloc_count + 1, sizeof(ArkMapReloc));
+    if (!map.units || !map.sections || !map.symbols || !map.slots || !map.relocs) {
+        ark_link_map_free(&map);
+        return ARK_LINK_ERR_MEMORY;
+    }
+
+    size_t first = 0;
+    for (size_t u = 0; u < unit_count; u++) {
+        const ArkLinkInput* in = &job->inputs[u];
+        ArkMapUnit* rec = &map.units[u];
+        res = ark_incremental_hash_input(in, &rec->hash, &rec->size);
+        if (res != ARK_LINK_OK) {
+            ark_link_map_free(&map);
+            return res;
+        }
+        rec->path = ark_link_map_add_string(&map, in->path ? in->path : "<memory>");
+        rec->first_section = (uint32_t)first;
+        rec->section_count = (uint32_t)units[u]->section_count;
+        for (size_t s = 0; s < units[u]->section_count; s++) {
+            map.sections[first + s].unit = (uint32_t)u;
+        }
+        first += units[u]->section_count;
+    }
+    if (has_library) {
+        ArkMapUnit* rec = &map.units[unit_count];
+        rec->path = ark_link_map_add_string(&map, "");
+        rec->flags = ARK_LINK_MAP_UNIT_LIBRARY;
+        rec->first_section = (uint32_t)first;
+        rec->section_count = (uint32_t)(input->section_count - first);
+        for (size_t i = first; i < input->section_count; i++) {
+            map.sections[i].unit = (uint32_t)unit_count;
+        }
+    }
+
+    for (size_t i = 0; i < input->section_count; i++) {
+        const ArkBackendInputSection* src = &input->sections[i];
+        ArkMapSection* dst = &map.sections[i];
+        dst->address = src->address;
+        dst->file_offset = src->file_offset;
+        dst->size = src->buffer->size;
+        dst->capacity = src->buffer->size + src->reserve;
+        dst->name = ark_link_map_add_string(&map, src->name);
+        dst->kind = (uint32_t)src->buffer->kind;
+        dst->alignment = src->buffer->alignment > 0 ? src->buffer->alignment : 1;
+    }
+
+    for (size_t i = 0; i < input->symbol_count; i++) {
+        const ArkBackendInputSymbol* src = &input->symbols[i];
+        ArkMapSymbol* dst = &map.symbols[i];
+        dst->address = src->address;
+        dst->got_address = src->got_address;
+        dst->name = ark_link_map_add_string(&map, src->name);
+        dst->section = src->section_id < input->section_count ? src->section_id : ARK_LINK_MAP_NONE;
+        dst->size = src->size;
+        dst->binding = (uint32_t)src->binding;
+    }
+
+    for (size_t i = 0; i < input->address_slot_count; i++) {
+        const ArkBackendAddressSlot* src = &input->address_slots[i];
+        ArkMapSlot* dst = &map.slots[i];
+        dst->file_offset = src->file_offset;
+        dst->address = src->address;
+        dst->symbol = src->symbol_index;
+        dst->type = src->type;
+    }
+
+    size_t cursor = 0;
+    for (size_t i = 0; i < input->reloc_count; i++) {
+        const ArkBackendInputReloc* src = &input->relocs[i];
+        if (src->section_id >= input->section_count || src->symbol_index >= input->symbol_count) {
+            continue;
+        }
+        ArkMapReloc* dst = &map.relocs[cursor++];
+        dst->section = src->section_id;
+        dst->offset = src->offset;
+        dst->type = src->type;
+        dst->symbol = src->symbol_index;
+        dst->addend = src->addend;
+    }
+
+    if (map.string_failed) {
+        ark_link_map_free(&map);
+        return ARK_LINK_ERR_MEMORY;
+    }
+
+    char* path = ark_incremental_map_path(job->output);
+    res = path ? ark_link_map_write(&map, path) : ARK_LINK_ERR_MEMORY;
+    free(path);
+    ark_link_map_free(&map);
+    return res;
+}
+
+
+static bool ark_relink_fail(ArkRelink* relink, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(relink->reason, sizeof(relink->reason), fmt, args);
+    va_end(args);
+    return false;
+}
+
+static void ark_relink_free(ArkRelink* relink) {
+    if (relink->loaded) {
+        for (size_t i = 0; i < relink->map.header.unit_count; i++) {
+            if (relink->loaded[i]) {
+                ark_loader_unit_destroy(relink->ctx, relink->loaded[i]);
+            }
+        }
+    }
+    free(relink->loaded);
+    free(relink->lookup);
+    free(relink->old_addresses);
+    free(relink->old_sizes);
+    free(relink->old_sections);
+    free(relink->defined);
+    free(relink->reloc_first);
+    free(relink->relocs);
+    free(relink->new_reloc_first);
+    free(relink->new_reloc_count);
+    ark_link_map_free(&relink->map);
+}
+
+static uint32_t ark_relink_find(const ArkRelink* relink, const char* name) {
+    ArkStringView view = {name, strlen(name)};
+    size_t slot = ark_context_hash(view) & relink->lookup_mask;
+    while (relink->lookup[slot] != ARK_LINK_MAP_NONE) {
+        uint32_t index = relink->lookup[slot];
+        if (strcmp(ark_link_map_string(&relink->map, relink->map.symbols[index].name), name) == 0) {
+            return index;
+        }
+        slot = (slot + 1) & relink->lookup_mask;
+    }
+    return ARK_LINK_MAP_NONE;
+}
+
+static bool ark_relink_index(ArkRelink* relink) {
+    const ArkLinkMap* map = &relink->map;
+    size_t symbol_count = map->header.symbol_count;
+    size_t section_count = map->header.section_count;
+
+    size_t bucket_count = 16;
+    while (bucket_count < symbol_count * 2) {
+        bucket_count <<= 1;
+    }
+    relink->lookup = (uint32_t*)malloc(bucket_count * sizeof(uint32_t));
+    relink->lookup_mask = bucket_count - 1;
+    relink->old_addresses = (uint64_t*)malloc((symbol_count + 1) * sizeof(uint64_t));
+    relink->old_sizes = (uint32_t*)malloc((symbol_count + 1) * sizeof(uint32_t));
+    relink->old_sections = (uint32_t*)malloc((symbol_count + 1) * sizeof(uint32_t));
+    relink->defined = (uint8_t*)calloc(symbol_count + 1, 1);
+    relink->reloc_first = (size_t*)calloc(section_count + 1, sizeof(size_t));
+    relink->new_reloc_first = (size_t*)calloc(section_count + 1, sizeof(size_t));
+    relink->new_reloc_count = (size_t*)calloc(section_count + 1, sizeof(size_t));
+    relink->loaded = (ArkLinkUnit**)calloc(map->header.unit_count + 1, sizeof(ArkLinkUnit*));
+    if (!relink->lookup || !relink->old_addresses || !relink->old_sizes || !relink->old_sections ||
+        !relink->defined || !relink->reloc_first || !relink->new_reloc_first ||
+        !relink->new_reloc_count || !relink->loaded) {
+        return ark_relink_fail(relink, "out of memory");
+    }
+    memset(relink->lookup, 0xFF, bucket_count * sizeof(uint32_t));
+
+    for (size_t i = 0; i < symbol_count; i++) {
+        const ArkMapSymbol* sym = &map->symbols[i];
+        const char* name = ark_link_map_string(map, sym->name);
+        ArkStringView view = {name, strlen(name)};
+        size_t slot = ark_context_hash(view) & relink->lookup_mask;
+        while (relink->lookup[slot] != ARK_LINK_MAP_NONE) {
+            slot = (slot + 1) & relink->lookup_mask;
+        }
+        relink->lookup[slot] = (uint32_t)i;
+        relink->old_addresses[i] = sym->address;
+        relink->old_sizes[i] = sym->size;
+        relink->old_sections[i] = sym->section;
+    }
+
+    for (size_t i = 0; i < map->header.reloc_count; i++) {
+        relink->reloc_first[map->relocs[i].section + 1]++;
+    }
+    for (size_t i = 0; i < section_count; i++) {
+        relink->reloc_first[i + 1] += relink->reloc_first[i];
+    }
+    return true;
+}
+
+
+static int ark_relink_reloc_compare(const void* a, const void* b) {
+    const ArkMapReloc* lhs = (const ArkMapReloc*)a;
+    const ArkMapReloc* rhs = (const ArkMapReloc*)b;
+    if (lhs->offset != rhs->offset) {
+        return lhs->offset < rhs->offset ? -1 : 1;
+    }
+    return 0;
+}
+
+static bool ark_relink_unit(ArkRelink* relink, uint32_t unit_index) {
+    ArkLinkMap* map = &relink->map;
+    const ArkMapUnit* rec = &map->units[unit_index];
+    const ArkLinkUnit* unit = relink->loaded[unit_index];
+    const char* path = ark_link_map_string(map, rec->path);
+
+    if (unit->section_count != rec->section_count) {
+        return ark_relink_fail(relink, "%s has a different number of sections", path);
+    }
+    for (size_t s = 0; s < unit->section_count; s++) {
+        const ArkLinkSection* src = &unit->sections[s];
+        ArkMapSection* dst = &map->sections[rec->first_section + s];
+        const char* name = ark_link_map_string(map, dst->name);
+        if (strcmp(src->name, name) != 0 || (uint32_t)src->buffer->kind != dst->kind) {
+            return ark_relink_fail(relink, "section %s of %s changed name or kind", name, path);
+        }
+        if (src->buffer->size > dst->capacity) {
+            return ark_relink_fail(relink, "section %s of %s outgrew its reserved space (%zu > %llu bytes)",
+                                   name, path, src->buffer->size, (unsigned long long)dst->capacity);
+        }
+        if (src->buffer->alignment > 1 && dst->address % src->buffer->alignment != 0) {
+            return ark_relink_fail(relink, "section %s of %s needs a stricter alignment", name, path);
+        }
+        dst->size = src->buffer->size;
+    }
+
+    for (size_t i = 0; i < unit->symbol_count; i++) {
+        const ArkSymbolDesc* desc = &unit->symbols[i];
+        const char* name = desc->name ? desc->name : "";
+        uint32_t index = ark_relink_find(relink, name);
+        if (index == ARK_LINK_MAP_NONE) {
+            return ark_relink_fail(relink, "symbol %s in %s is new", name, path);
+        }
+        if (desc->section_index == 0 || desc->section_index > unit->section_count) {
+            continue;
+        }
+
+        ArkMapSymbol* sym = &map->symbols[index];
+        if (sym->section == ARK_LINK_MAP_NONE || map->sections[sym->section].unit != unit_index) {
+            return ark_relink_fail(relink, "symbol %s moved into %s", name, path);
+        }
+        if (relink->defined[index]) {
+            return ark_relink_fail(relink, "symbol %s is defined more than once in %s", name, path);
+        }
+        if (sym->binding != desc->binding) {
+            return ark_relink_fail(relink, "binding of symbol %s changed", name);
+        }
+        relink->defined[index] = 1;
+        sym->section = rec->first_section + desc->section_index - 1;
+        sym->address = map->sections[sym->section].address + desc->value;
+        sym->size = desc->size;
+    }
+
+    for (size_t s = 0; s < unit->section_count; s++) {
+        const ArkLinkSection* section = &unit->sections[s];
+        size_t section_index = rec->first_section + s;
+        relink->new_reloc_first[section_index] = relink->reloc_count;
+        relink->new_reloc_count[section_index] = section->reloc_count;
+
+        for (size_t r = 0; r < section->reloc_count; r++) {
+            const ArkRelocationDesc* desc = &section->relocs[r];
+            if (desc->sym_idx >= unit->symbol_count) {
+                return ark_relink_fail(relink, "relocation in %s references a missing symbol", path);
+            }
+            const char* name = unit->symbols[desc->sym_idx].name;
+            if (relink->reloc_count == relink->reloc_capacity) {
+                size_t capacity = relink->reloc_capacity ? relink->reloc_capacity * 2 : 256;
+                ArkMapReloc* relocs = (ArkMapReloc*)realloc(relink->relocs, capacity * sizeof(ArkMapReloc));
+                if (!relocs) {
+                    return ark_relink_fail(relink, "out of memory");
+                }
+                relink->relocs = relocs;
+                relink->reloc_capacity = capacity;
+            }
+            ArkMapReloc* dst = &relink->relocs[relink->reloc_count++];
+            dst->section = (uint32_t)section_index;
+            dst->offset = (uint32_t)desc->offset;
+            dst->type = desc->type;
+            dst->symbol = ark_relink_find(relink, name ? name : "");
+            dst->addend = desc->addend;
+        }
+
+        if (section->reloc_count > 1) {
+            qsort(relink->relocs + relink->new_reloc_first[section_index], section->reloc_count,
+                  sizeof(ArkMapReloc), ark_relink_reloc_compare);
+        }
+    }
+    return true;
+}
+
+
+static bool ark_relink_check_sites(ArkRelink* relink) {
+    const ArkLinkMap* map = &relink->map;
+    for (size_t i = 0; i < map->header.symbol_count; i++) {
+        uint32_t section = relink->old_sections[i];
+        if (section != ARK_LINK_MAP_NONE && relink->loaded[map->sections[section].unit] && !relink->defined[i]) {
+            return ark_relink_fail(relink, "symbol %s was removed from %s",
+                                   ark_link_map_string(map, map->symbols[i].name),
+                                   ark_link_map_string(map, map->units[map->sections[section].unit].path));
+        }
+    }
+
+    if (map->header.target != ARK_LINK_TARGET_PE) {
+        return true;
+    }
+    for (size_t i = 0; i < map->header.section_count; i++) {
+        if (!relink->loaded[map->sections[i].unit]) {
+            continue;
+        }
+        const ArkMapReloc* old_relocs = map->relocs + relink->reloc_first[i];
+        const ArkMapReloc* new_relocs = relink->relocs + relink->new_reloc_first[i];
+        size_t old_count = relink->reloc_first[i + 1] - relink->reloc_first[i];
+        size_t new_count = relink->new_reloc_count[i];
+        size_t a = 0;
+        size_t b = 0;
+        for (;;) {
+            while (a < old_count && old_relocs[a].type != ARK_RELOC_ABS64) {
+                a++;
+            }
+            while (b < new_count && new_relocs[b].type != ARK_RELOC_ABS64) {
+                b++;
+            }
+            if (a == old_count || b == new_count) {
+                break;
+            }
+            if (old_relocs[a].offset != new_relocs[b].offset) {
+                break;
+            }
+            a++;
+            b++;
+        }
+        if (a != old_count || b != new_count) {
+            return ark_relink_fail(relink, "base relocations of section %s changed",
+                                   ark_link_map_string(map, map->sections[i].name));
+        }
+    }
+    return true;
+}
+
+
+static bool ark_relink_plan(ArkRelink* relink, const char* map_path) {
+    const ArkLinkJob* job = relink->job;
+    ArkLinkMap* map = &relink->map;
+
+    ArkLinkResult res = ark_link_map_read(map_path, map);
+    if (res == ARK_LINK_ERR_IO) {
+        return ark_relink_fail(relink, "no link map found for %s", job->output);
+    }
+    if (res != ARK_LINK_OK) {
+        return ark_relink_fail(relink, "link map %s is unusable", map_path);
+    }
+    if (map->header.target != (uint32_t)job->target ||
+        map->header.config_hash != ark_incremental_config_hash(relink->ctx)) {
+        return ark_relink_fail(relink, "link options or libraries changed");
+    }
+
+    uint64_t output_size = 0;
+    if (ark_incremental_file_size(job->output, &output_size) != ARK_LINK_OK ||
+        output_size != map->header.output_size) {
+        return ark_relink_fail(relink, "%s changed since the last link", job->output);
+    }
+
+    size_t primary_count = map->header.unit_count;
+    if (primary_count > 0 && (map->units[primary_count - 1].flags & ARK_LINK_MAP_UNIT_LIBRARY)) {
+        primary_count--;
+    }
+    if (primary_count != job->input_count) {
+        return ark_relink_fail(relink, "the input list changed");
+    }
+    relink->primary_count = primary_count;
+
+    if (!ark_relink_index(relink)) {
+        return false;
+    }
+
+    for (size_t u = 0; u < primary_count; u++) {
+        const ArkLinkInput* in = &job->inputs[u];
+        ArkMapUnit* rec = &map->units[u];
+        const char* path = in->path ? in->path : "<memory>";
+        if (strcmp(path, ark_link_map_string(map, rec->path)) != 0) {
+            return ark_relink_fail(relink, "the input list changed");
+        }
+
+        uint64_t hash = 0;
+        uint64_t size = 0;
+        if (ark_incremental_hash_input(in, &hash, &size) != ARK_LINK_OK) {
+            return ark_relink_fail(relink, "cannot read %s", path);
+        }
+        if (hash == rec->hash && size == rec->size) {
+            continue;
+        }
+        rec->hash = hash;
+        rec->size = size;
+
+        ArkLoaderDiagnostics diag = {0};
+        if (in->data && in->size > 0) {
+            res = ark_loader_load_unit_memory(relink->ctx, path, in->data, in->size, NULL, &relink->loaded[u], &diag);
+        } else {
+            res = ark_loader_load_unit(relink->ctx, path, NULL, &relink->loaded[u], &diag);
+        }
+        if (res != ARK_LINK_OK) {
+            relink->loaded[u] = NULL;
+            return ark_relink_fail(relink, "%s could not be loaded", path);
+        }
+        relink->changed_count++;
+        if (!ark_relink_unit(relink, (uint32_t)u)) {
+            return false;
+        }
+    }
+
+    return relink->changed_count == 0 || ark_relink_check_sites(relink);
+}
+
+
+static void ark_relink_store(uint8_t* dst, uint64_t value, size_t width) {
+    if (width == sizeof(uint64_t)) {
+        memcpy(dst, &value, sizeof(value));
+    } else {
+        uint32_t narrow = (uint32_t)value;
+        memcpy(dst, &narrow, sizeof(narrow));
+    }
+}
+
+static ArkLinkResult ark_relink_write(FILE* out, uint64_t offset, const void* data, size_t size) {
+    if (!out || size == 0) {
+        return ARK_LINK_OK;
+    }
+    if (fseek(out, (long)offset, SEEK_SET) != 0 || fwrite(data, 1, size, out) != size) {
+        return ARK_LINK_ERR_IO;
+    }
+    return ARK_LINK_OK;
+}
+
+static bool ark_relink_symbol_moved(const ArkRelink* relink, uint32_t index) {
+    return relink->map.symbols[index].address != relink->old_addresses[index];
+}
+
+
+static bool ark_relink_reloc_value(ArkRelink* relink, const ArkMapReloc* reloc, uint64_t* out_value, size_t* out_width) {
+    const ArkLinkMap* map = &relink->map;
+    const ArkMapSection* section = &map->sections[reloc->section];
+    const ArkMapSymbol* sym = &map->symbols[reloc->symbol];
+    int is_elf = map->header.target == ARK_LINK_TARGET_ELF;
+    uint64_t place = section->address + reloc->offset;
+    uint64_t target = sym->address + (uint64_t)(int64_t)reloc->addend;
+    uint64_t value = 0;
+    size_t width = 0;
+
+    switch (reloc->type) {
+    case ARK_RELOC_ABS64:
+        value = target;
+        width = sizeof(uint64_t);
+        break;
+
+    case ARK_RELOC_GOTPC32:
+    case ARK_RELOC_PC32:
+        if (reloc->type == ARK_RELOC_GOTPC32) {
+            if (!is_elf) {
+                break;
+            }
+            if (sym->got_address == 0) {
+                return ark_relink_fail(relink, "%s has no GOT entry", ark_link_map_string(map, sym->name));
+            }
+            target = sym->got_address + (uint64_t)(int64_t)reloc->addend;
+        }
+        {
+            int64_t displacement = (int64_t)(target - place);
+            if (displacement < INT32_MIN || displacement > INT32_MAX) {
+                return ark_relink_fail(relink, "relocation against %s is out of range",
+                                       ark_link_map_string(map, sym->name));
+            }
+            value = (uint32_t)(int32_t)displacement;
+            width = sizeof(uint32_t);
+        }
+        break;
+
+    case ARK_RELOC_SECREL32:
+        if (is_elf) {
+            uint64_t base = sym->section != ARK_LINK_MAP_NONE ? map->sections[sym->section].address : sym->address;
+            value = (uint32_t)(sym->address - base + (uint64_t)(int64_t)reloc->addend);
+            width = sizeof(uint32_t);
+        }
+        break;
+    }
+
+    if ((uint64_t)reloc->offset + width > section->capacity) {
+        width = 0;
+    }
+    *out_value = value;
+    *out_width = width;
+    return true;
+}
+
+
+static ArkLinkResult ark_relink_apply(ArkRelink* relink, FILE* out, size_t* out_sites) {
+    const ArkLinkMap* map = &relink->map;
+    uint8_t* buffer = NULL;
+    size_t buffer_size = 0;
+    size_t sites = 0;
+    ArkLinkResult res = ARK_LINK_OK;
+    uint8_t bytes[sizeof(uint64_t)];
+
+    for (size_t i = 0; i < map->header.section_count && res == ARK_LINK_OK; i++) {
+        const ArkMapSection* section = &map->sections[i];
+        if (section->file_offset == UINT64_MAX) {
+            continue;
+        }
+
+        const ArkLinkUnit* unit = relink->loaded[section->unit];
+        if (unit) {
+            const ArkSectionBuffer* src = unit->sections[i - map->units[section->unit].first_section].buffer;
+            if (out) {
+                if (section->capacity > buffer_size) {
+                    uint8_t* grown = (uint8_t*)realloc(buffer, (size_t)section->capacity);
+                    if (!grown) {
+                        res = ARK_LINK_ERR_MEMORY;
+                        break;
+                    }
+                    buffer = grown;
+                    buffer_size = (size_t)section->capacity;
+                }
+                memset(buffer, 0, (size_t)section->capacity);
+                if (src->data && src->size > 0) {
+                    memcpy(buffer, src->data, src->size);
+                }
+            }
+
+            const ArkMapReloc* relocs = relink->relocs + relink->new_reloc_first[i];
+            for (size_t r = 0; r < relink->new_reloc_count[i]; r++) {
+                uint64_t value = 0;
+                size_t width = 0;
+                if (!ark_relink_reloc_value(relink, &relocs[r], &value, &width)) {
+                    res = ARK_LINK_ERR_UNSUPPORTED;
+                    break;
+                }
+                if (out && width > 0) {
+                    ark_relink_store(buffer + relocs[r].offset, value, width);
+                }
+            }
+            sites += relink->new_reloc_count[i];
+            if (res == ARK_LINK_OK) {
+                res = ark_relink_write(out, section->file_offset, buffer, (size_t)section->capacity);
+            }
+            continue;
+        }
+
+        for (size_t r = relink->reloc_first[i]; r < relink->reloc_first[i + 1]; r++) {
+            const ArkMapReloc* reloc = &map->relocs[r];
+            if (reloc->type == ARK_RELOC_GOTPC32 || !ark_relink_symbol_moved(relink, reloc->symbol)) {
+                continue;
+            }
+            uint64_t value = 0;
+            size_t width = 0;
+            if (!ark_relink_reloc_value(relink, reloc, &value, &width)) {
+                res = ARK_LINK_ERR_UNSUPPORTED;
+                break;
+            }
+            ark_relink_store(bytes, value, width);
+            res = ark_relink_write(out, section->file_offset + reloc->offset, bytes, width);
+            if (res != ARK_LINK_OK) {
+                break;
+            }
+            sites++;
+        }
+    }
+
+    for (size_t i = 0; i < map->header.slot_count && res == ARK_LINK_OK; i++) {
+        const ArkMapSlot* slot = &map->slots[i];
+        const ArkMapSymbol* sym = &map->symbols[slot->symbol];
+        uint64_t value = 0;
+        size_t width = 0;
+        switch (slot->type) {
+        case ARK_BACKEND_SLOT_ABS64:
+            if (ark_relink_symbol_moved(relink, slot->symbol)) {
+                value = sym->address;
+                width = sizeof(uint64_t);
+            }
+            break;
+        case ARK_BACKEND_SLOT_REL32:
+            if (ark_relink_symbol_moved(relink, slot->symbol)) {
+                value = (uint32_t)(int32_t)(sym->address - slot->address);
+                width = sizeof(uint32_t);
+            }
+            break;
+        case ARK_BACKEND_SLOT_SIZE64:
+            if (sym->size != relink->old_sizes[slot->symbol]) {
+                value = sym->size;
+                width = sizeof(uint64_t);
+            }
+            break;
+        }
+        if (width == 0) {
+            continue;
+        }
+        ark_relink_store(bytes, value, width);
+        res = ark_relink_write(out, slot->file_offset, bytes, width);
+        sites++;
+    }
+
+    free(buffer);
+    *out_sites = sites;
+    return res;
+}
+
+
+static bool ark_relink_merge_relocs(ArkRelink* relink) {
+    ArkLinkMap* map = &relink->map;
+    size_t total = 0;
+    for (size_t i = 0; i < map->header.section_count; i++) {
+        total += relink->loaded[map->sections[i].unit] ? relink->new_reloc_count[i]
+                                                         : relink->reloc_first[i + 1] - relink->reloc_first[i];
+    }
+
+    ArkMapReloc* merged = (ArkMapReloc*)malloc((total + 1) * sizeof(ArkMapReloc));
+    if (!merged) {
+        return false;
+    }
+    size_t cursor = 0;
+    for (size_t i = 0; i < map->header.section_count; i++) {
+        const ArkMapReloc* src = map->relocs + relink->reloc_first[i];
+        size_t count = relink->reloc_first[i + 1] - relink->reloc_first[i];
+        if (relink->loaded[map->sections[i].unit]) {
+            src = relink->relocs + relink->new_reloc_first[i];
+            count = relink->new_reloc_count[i];
+        }
+        if (count > 0) {
+            memcpy(merged + cursor, src, count * sizeof(ArkMapReloc));
+        }
+        cursor += count;
+    }
+
+    free(map->relocs);
+    map->relocs = merged;
+    map->header.reloc_count = (uint32_t)total;
+    return true;
+}
+
+
+ArkLinkResult ark_incremental_relink(ArkLinkContext* ctx, bool* out_patched) {
+    const ArkLinkJob* job = ark_context_job(ctx);
+    if (!job || !job->output || !out_patched) {
+        return ARK_LINK_ERR_INVALID_ARGUMENT;
+    }
+    *out_patched = false;
+
+    char* map_path = ark_incremental_map_path(job->output);
+    if (!map_path) {
+        return ARK_LINK_ERR_MEMORY;
+    }
+
+    ArkRelink relink;
+    memset(&relink, 0, sizeof(relink));
+    relink.ctx = ctx;
+    relink.job = job;
+
+    size_t sites = 0;
+    ark_context_phase_begin(ctx, ARK_LINK_PHASE_LOAD);
+    bool ready = ark_relink_plan(&relink, map_path);
+    ark_context_phase_end(ctx, ARK_LINK_PHASE_LOAD);
+    if (ready && relink.changed_count == 0) {
+        ark_context_log(ctx, ARK_LOG_INFO, "Incremental link: %s is up to date", job->output);
+        *out_patched = true;
+        ark_relink_free(&relink);
+        free(map_path);
+        return ARK_LINK_OK;
+    }
+    ark_context_phase_begin(ctx, ARK_LINK_PHASE_RELOCATE);
+    if (ready && ark_relink_apply(&relink, NULL, &sites) != ARK_LINK_OK) {
+        ready = false;
+    }
+    ark_context_phase_end(ctx, ARK_LINK_PHASE_RELOCATE);
+
+    FILE* out = ready ? fopen(job->output, "r+b") : NULL;
+    if (ready && !out) {
+        ready = ark_relink_fail(&relink, "%s cannot be opened for patching", job->output);
+    }
+    if (!ready) {
+        ark_context_log(ctx, ARK_LOG_INFO, "Incremental link: %s; performing a full link", relink.reason);
+        ark_relink_free(&relink);
+        free(map_path);
+        return ARK_LINK_OK;
+    }
+
+    ark_context_phase_begin(ctx, ARK_LINK_PHASE_WRITE);
+    remove(map_path);
+    ArkLinkResult res = ark_relink_apply(&relink, out, &sites);
+    if (fclose(out) != 0 && res == ARK_LINK_OK) {
+        res = ARK_LINK_ERR_IO;
+    }
+    if (res != ARK_LINK_OK) {
+        ark_context_log(ctx, ARK_LOG_ERROR, "Incremental link: failed to patch %s", job->output);
+        ark_relink_free(&relink);
+        free(map_path);
+        return res;
+    }
+
+    ark_context_log(ctx, ARK_LOG_INFO, "Incremental link: patched %zu of %zu units (%zu relocation sites)",
+                    relink.changed_count, relink.primary_count, sites);
+    ArkLinkStats* stats = ark_context_stats(ctx);
+    if (stats) {
+        stats->unit_count = relink.primary_count;
+        stats->relocation_count = sites;
+    }
+    if (!ark_relink_merge_relocs(&relink) || ark_link_map_write(&relink.map, map_path) != ARK_LINK_OK) {
+        ark_context_log(ctx, ARK_LOG_WARN, "Incremental link: could not update %s; the next link will be a full link", map_path);
+    }
+
+    ark_context_phase_end(ctx, ARK_LINK_PHASE_WRITE);
+
+    *out_patched = true;
+    ark_relink_free(&relink);
+    free(map_path);
+    return ARK_LINK_OK;
+}
@@ -0,0 +1,36 @@
+#ifndef ARK_INCREMENTAL_H
+#define ARK_INCREMENTAL_H
+
+#include "ArkLink/arklink.h"
+#include "ArkLink/context.h"
+#include "ArkLink/loader.h"
+#include "ArkLink/backend.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+
+
+ArkLinkResult ark_incremental_relink(ArkLinkContext* ctx, bool* out_patched);
+
+
+void ark_incremental_reserve(ArkBackendInput* input);
+
+
+
+ArkLinkResult ark_incremental_save(ArkLinkContext* ctx, ArkLinkUnit* const* units, size_t unit_count,
+                                   const ArkBackendInput* input);
+
+
+void ark_incremental_discard(const char* output_path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
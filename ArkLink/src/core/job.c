@@ -3,6 +3,7 @@
 #include "ArkLink/loader.h"
 #include "ArkLink/resolver.h"
 #include "ArkLink/backend.h"
+#include "incremental.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -21,12 +22,16 @@ static ArkLinkResult arklink_run_backends(ArkLinkContext* ctx, ArkResolverPlan*
         return ARK_LINK_ERR_BACKEND;
     }
     ArkBackendState* state = NULL;
+    ark_context_phase_begin(ctx, ARK_LINK_PHASE_LAYOUT);
     ArkLinkResult res = ops->prepare(ctx, plan->backend_input, &state);
+    ark_context_phase_end(ctx, ARK_LINK_PHASE_LAYOUT);
     if (res != ARK_LINK_OK) {
         return res;
     }
     const char* output = ark_context_job(ctx)->output;
+    ark_context_phase_begin(ctx, ARK_LINK_PHASE_WRITE);
     res = ops->write_output(state, output);
+    ark_context_phase_end(ctx, ARK_LINK_PHASE_WRITE);
     ops->destroy_state(state);
     return res;
 }
@@ -131,12 +136,27 @@ ArkLinkResult arklink_link(const ArkLinkJob* job) {
     ark_context_set_config(ctx, config);
 
     ArkLinkResult res = ARK_LINK_OK;
+    bool incremental = (job->flags & ARK_LINK_FLAG_INCREMENTAL) && job->output;
+    if (incremental && (job->flags & (ARK_LINK_FLAG_GC_SECTIONS | ARK_LINK_FLAG_ICF))) {
+        ark_context_log(ctx, ARK_LOG_INFO, "Incremental link: disabled by --gc-sections or --icf");
+        incremental = false;
+    }
+    if (incremental) {
+        bool patched = false;
+        res = ark_incremental_relink(ctx, &patched);
+        if (res != ARK_LINK_OK || patched) {
+            ark_context_destroy(ctx);
+            return res;
+        }
+    }
+
     ArkLinkUnit** units = (ArkLinkUnit**)calloc(job->input_count, sizeof(ArkLinkUnit*));
     if (!units) {
         ark_context_destroy(ctx);
         return ARK_LINK_ERR_INTERNAL;
     }
 
+    ark_context_phase_begin(ctx, ARK_LINK_PHASE_LOAD);
     for (size_t i = 0; i < job->input_count; ++i) {
         const ArkLinkInput* in = &job->inputs[i];
         ArkLoaderDiagnostics diag = {0};
@@ -168,16 +188,32 @@ ArkLinkResult arklink_link(const ArkLinkJob* job) {
             goto cleanup;
         }
     }
+    ark_context_phase_end(ctx, ARK_LINK_PHASE_LOAD);
 
     
 
     ArkResolverPlan plan = {0};
+    ark_context_phase_begin(ctx, ARK_LINK_PHASE_RESOLVE);
     res = ark_resolver_resolve(ctx, units, job->input_count, &plan);
+    ark_context_phase_end(ctx, ARK_LINK_PHASE_RESOLVE);
     if (res != ARK_LINK_OK) {
         goto cleanup_plan;
     }
 
+    if (incremental) {
+        ark_incremental_reserve(plan.backend_input);
+    }
+
     res = arklink_run_backends(ctx, &plan);
+    if (res == ARK_LINK_OK && incremental) {
+        ark_context_phase_begin(ctx, ARK_LINK_PHASE_WRITE);
+        if (ark_incremental_save(ctx, units, job->input_count, plan.backend_input) != ARK_LINK_OK) {
+            ark_context_log(ctx, ARK_LOG_WARN, "Incremental link: could not write the link map for %s", job->output);
+        }
+        ark_context_phase_end(ctx, ARK_LINK_PHASE_WRITE);
+    } else if (res == ARK_LINK_OK) {
+        ark_incremental_discard(job->output);
+    }
 
 cleanup_plan:
     ark_resolver_plan_destroy(ctx, &plan);
@@ -233,6 +269,9 @@ struct ArkLinkSession {
     const char** export_symbols;
     size_t export_capacity;
     
+    ArkLinkStats stats;
+    int stats_enabled;
+    
     ArkLinkResult last_error;
 };
 
@@ -323,6 +362,13 @@ ArkLinkResult arklink_session_set_flags(ArkLinkSession* session, uint32_t flags)
     return ARK_LINK_OK;
 }
 
+ArkLinkResult arklink_session_enable_stats(ArkLinkSession* session, int enable) {
+    if (!session) return ARK_LINK_ERR_INVALID_ARGUMENT;
+    session->stats_enabled = enable != 0;
+    session->job.stats = session->stats_enabled ? &session->stats : NULL;
+    return ARK_LINK_OK;
+}
+
 ArkLinkResult arklink_session_add_input(ArkLinkSession* session, const char* path) {
     if (!session) return ARK_LINK_ERR_INVALID_ARGUMENT;
     
@@ -392,6 +438,11 @@ const char* arklink_session_get_error(const ArkLinkSession* session) {
     return arklink_error_string(session->last_error);
 }
 
+const ArkLinkStats* arklink_session_get_stats(const ArkLinkSession* session) {
+    if (!session || !session->stats_enabled) return NULL;
+    return &session->stats;
+}
+
 
 ArkLinkResult arklink_session_add_input_memory(ArkLinkSession* session, const char* name, const void* data, size_t size) {
     if (!session || !name || !data || size == 0) return ARK_LINK_ERR_INVALID_ARGUMENT;
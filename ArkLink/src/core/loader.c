@@ -1,5 +1,6 @@
 #include "ArkLink/loader.h"
 #include "coff_obj.h"
+#include "mapped_file.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -31,7 +32,7 @@ void ark_link_unit_destroy(ArkLinkUnit* unit) {
         for (size_t i = 0; i < unit->section_count; i++) {
             free(unit->sections[i].relocs);
             if (unit->sections[i].buffer) {
-                free(unit->sections[i].buffer->data);
+                ark_section_buffer_release(unit->sections[i].buffer);
                 free(unit->sections[i].buffer);
             }
         }
@@ -43,12 +44,22 @@ void ark_link_unit_destroy(ArkLinkUnit* unit) {
         free(unit->symbols);
     }
 
+    free(unit->relocations.relocs);
+
     
     if (unit->file_data) {
         free(unit->file_data);
     }
 
     
+    if (unit->mapping) {
+        ark_mapped_file_close(unit->mapping);
+        free(unit->mapping);
+    }
+
+    free(unit->string_pool);
+
+    
     if (unit->path) {
         free((void*)unit->path);
     }
@@ -82,7 +93,10 @@ ArkLinkSection* ark_link_unit_add_section(ArkLinkUnit* unit, const ArkSectionDes
     if (sec->buffer) {
         memset(sec->buffer, 0, sizeof(ArkSectionBuffer));
 
-        if (desc->data && desc->size > 0) {
+        if (desc->data && desc->size > 0 && desc->borrow_data) {
+            sec->buffer->data = (uint8_t*)desc->data;
+            sec->buffer->size = desc->size;
+        } else if (desc->data && desc->size > 0) {
             sec->buffer->data = (uint8_t*)malloc(desc->size);
             if (sec->buffer->data) {
                 memcpy(sec->buffer->data, desc->data, desc->size);
@@ -158,6 +172,20 @@ int ark_link_unit_add_reloc(ArkLinkUnit* unit, const ArkRelocationDesc* desc) {
 
 
 
+static ArkLinkResult ark_loader_parse_unit(ArkLinkContext* ctx, const char* name,
+                                           const uint8_t* data, size_t size,
+                                           ArkLinkUnit** out_unit) {
+    if (size >= 4 && data[0] == 0x4F && data[1] == 0x45 && data[2] == 0x23 && data[3] == 0x45) {
+        return ark_link_load_eo_memory(name, data, size, out_unit);
+    }
+    
+    if (ark_coff_is_valid(data, size)) {
+        return ark_coff_load_unit(ctx, data, size, name, out_unit);
+    }
+    
+    return ARK_LINK_ERR_FORMAT;
+}
+
 ArkLinkResult ark_loader_load_unit(ArkLinkContext* ctx, const char* path, 
                                     const ArkLoaderOptions* opts, 
                                     ArkLinkUnit** out_unit, 
@@ -170,39 +198,26 @@ ArkLinkResult ark_loader_load_unit(ArkLinkContext* ctx, const char* path,
     }
     
     
-    ArkLinkResult result = ark_link_load_eo(path, out_unit);
-    if (result == ARK_LINK_OK) {
-        return ARK_LINK_OK;
+    ArkMappedFile* file = (ArkMappedFile*)malloc(sizeof(ArkMappedFile));
+    if (!file) {
+        return ARK_LINK_ERR_MEMORY;
     }
-    
-    
-    
-    FILE* fp = fopen(path, "rb");
-    if (fp) {
-        fseek(fp, 0, SEEK_END);
-        long size = ftell(fp);
-        fseek(fp, 0, SEEK_SET);
-        
-        if (size > 0) {
-            uint8_t* data = (uint8_t*)malloc((size_t)size);
-            if (data) {
-                if (fread(data, 1, (size_t)size, fp) == (size_t)size) {
-                    result = ark_coff_load_unit(ctx, data, (size_t)size, path, out_unit);
-                    if (result == ARK_LINK_OK) {
-                        free(data);
-                        fclose(fp);
-                        return ARK_LINK_OK;
-                    }
-                }
-                free(data);
-            }
-        }
-        fclose(fp);
+    ArkLinkResult result = ark_mapped_file_open(path, file);
+    if (result != ARK_LINK_OK) {
+        free(file);
+        return result;
     }
     
     
+    result = ark_loader_parse_unit(ctx, path, file->data, file->size, out_unit);
+    if (result != ARK_LINK_OK) {
+        ark_mapped_file_close(file);
+        free(file);
+        return result;
+    }
     
-    return ARK_LINK_ERR_FORMAT;
+    (*out_unit)->mapping = file;
+    return ARK_LINK_OK;
 }
 
 ArkLinkResult ark_loader_load_unit_memory(ArkLinkContext* ctx, const char* name, 
@@ -210,7 +225,6 @@ ArkLinkResult ark_loader_load_unit_memory(ArkLinkContext* ctx, const char* name,
                                            const ArkLoaderOptions* opts, 
                                            ArkLinkUnit** out_unit, 
                                            ArkLoaderDiagnostics* diag) {
-    (void)ctx;
     (void)opts;
     (void)diag;
     
@@ -219,40 +233,21 @@ ArkLinkResult ark_loader_load_unit_memory(ArkLinkContext* ctx, const char* name,
     }
     
     
-    if (size >= 4) {
-        const uint8_t* bytes = (const uint8_t*)data;
-        
-        if (bytes[0] == 0x4F && bytes[1] == 0x45 && bytes[2] == 0x23 && bytes[3] == 0x45) {
-            
-            char temp_path[256];
-            snprintf(temp_path, sizeof(temp_path), "temp_%s.eo", name);
-            
-            FILE* fp = fopen(temp_path, "wb");
-            if (!fp) {
-                return ARK_LINK_ERR_IO;
-            }
-            
-            if (fwrite(data, 1, size, fp) != size) {
-                fclose(fp);
-                remove(temp_path);
-                return ARK_LINK_ERR_IO;
-            }
-            fclose(fp);
-            
-            ArkLinkResult result = ark_link_load_eo(temp_path, out_unit);
-            remove(temp_path);
-            
-            if (result == ARK_LINK_OK && *out_unit) {
-                
-                free((void*)(*out_unit)->path);
-                (*out_unit)->path = strdup(name);
-            }
-            
-            return result;
-        }
+    uint8_t* copy = (uint8_t*)malloc(size);
+    if (!copy) {
+        return ARK_LINK_ERR_MEMORY;
     }
+    memcpy(copy, data, size);
     
-    return ARK_LINK_ERR_FORMAT;
+    ArkLinkResult result = ark_loader_parse_unit(ctx, name, copy, size, out_unit);
+    if (result != ARK_LINK_OK) {
+        free(copy);
+        return result;
+    }
+    
+    (*out_unit)->file_data = copy;
+    (*out_unit)->file_size = size;
+    return ARK_LINK_OK;
 }
 
 void ark_loader_unit_destroy(ArkLinkContext* ctx, ArkLinkUnit* unit) {
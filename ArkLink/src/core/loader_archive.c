@@ -79,7 +79,9 @@ static ArkLinkResult coff_to_unit(ArkLinkContext* ctx, const ArkCOFFObject* coff
         
         
         if (coff->sections[i].NumberOfRelocations > 0 && 
-            coff->sections[i].PointerToRelocations > 0) {
+            coff->sections[i].PointerToRelocations > 0 &&
+            (size_t)coff->sections[i].PointerToRelocations +
+                (size_t)coff->sections[i].NumberOfRelocations * sizeof(ArkCOFFRelocation) <= coff->raw_size) {
             
             size_t reloc_offset = coff->sections[i].PointerToRelocations;
             for (uint16_t r = 0; r < coff->sections[i].NumberOfRelocations; r++) {
@@ -91,7 +93,7 @@ static ArkLinkResult coff_to_unit(ArkLinkContext* ctx, const ArkCOFFObject* coff
                     .offset = coff_reloc.VirtualAddress,
                     .sym_idx = coff_reloc.SymbolTableIndex,
                     .type = (uint16_t)coff_reloc_type(coff_reloc.Type),
-                    .addend = 0
+                    .addend = (coff_reloc.Type == IMAGE_REL_AMD64_REL32) ? -4 : 0
                 };
                 
                 if (!ark_link_section_add_reloc(section, &rdesc)) {
@@ -103,12 +105,17 @@ static ArkLinkResult coff_to_unit(ArkLinkContext* ctx, const ArkCOFFObject* coff
     }
     
     
+    unit->string_pool = ark_coff_copy_symbol_names(coff);
+    if (!unit->string_pool) {
+        ark_link_unit_destroy(unit);
+        return ARK_LINK_ERR_MEMORY;
+    }
+    
+    const char* sym_name = unit->string_pool;
     for (uint32_t i = 0; i < coff->header.NumberOfSymbols; i++) {
         const ArkCOFFSymbol* coff_sym = &coff->symbols[i];
         
         
-        const char* sym_name = ark_coff_get_symbol_name(coff, coff_sym);
-        
         
         uint8_t binding;
         if (coff_sym->StorageClass == 2) { 
@@ -122,7 +129,7 @@ static ArkLinkResult coff_to_unit(ArkLinkContext* ctx, const ArkCOFFObject* coff
         
         uint16_t sec_idx = 0;
         if (coff_sym->SectionNumber > 0) {
-            sec_idx = coff_sym->SectionNumber - 1; 
+            sec_idx = (uint16_t)coff_sym->SectionNumber; 
         }
         
         ArkSymbolDesc sdesc = {
@@ -140,6 +147,7 @@ static ArkLinkResult coff_to_unit(ArkLinkContext* ctx, const ArkCOFFObject* coff
             return ARK_LINK_ERR_INTERNAL;
         }
         
+        sym_name += strlen(sym_name) + 1;
         i += coff_sym->NumberOfAuxSymbols;
     }
     
@@ -152,6 +160,12 @@ static ArkLinkResult coff_to_unit(ArkLinkContext* ctx, const ArkCOFFObject* coff
         }
     }
     
+    ArkLinkResult remap = ark_coff_remap_reloc_symbols(coff, unit);
+    if (remap != ARK_LINK_OK) {
+        ark_link_unit_destroy(unit);
+        return remap;
+    }
+    
     *out_unit = unit;
     return ARK_LINK_OK;
 }
@@ -200,6 +214,46 @@ const char* ark_archive_member_name(ArkArchive* archive, size_t index) {
     return archive->objects[index].name;
 }
 
+static ArkLinkResult ark_archive_parse_member(ArkArchive* archive, size_t index, ArkCOFFObject* coff) {
+    if (ark_archive_read_member(archive, index) != ARK_ARCHIVE_OK) {
+        return ARK_LINK_ERR_IO;
+    }
+    
+    const ArkArchiveObject* obj = &archive->objects[index];
+    int result = -1;
+    if (ark_coff_is_valid(obj->data, obj->size)) {
+        result = ark_coff_parse(obj->data, obj->size, coff);
+    }
+    ark_archive_release_member(archive, index);
+    
+    return result == 0 ? ARK_LINK_OK : ARK_LINK_ERR_FORMAT;
+}
+
+
+static ArkLinkResult ark_archive_index_members(ArkArchive* archive) {
+    for (size_t i = 0; i < archive->object_count; i++) {
+        ArkCOFFObject coff;
+        if (ark_archive_parse_member(archive, i, &coff) != ARK_LINK_OK) {
+            continue;
+        }
+        
+        for (uint32_t s = 0; s < coff.header.NumberOfSymbols; s++) {
+            const ArkCOFFSymbol* coff_sym = &coff.symbols[s];
+            if (coff_sym->StorageClass == 2 && coff_sym->SectionNumber > 0) {
+                if (ark_archive_add_symbol(archive, ark_coff_get_symbol_name(&coff, coff_sym), i) != ARK_ARCHIVE_OK) {
+                    ark_coff_free(&coff);
+                    return ARK_LINK_ERR_MEMORY;
+                }
+            }
+            s += coff_sym->NumberOfAuxSymbols;
+        }
+        ark_coff_free(&coff);
+    }
+    
+    archive->has_symbol_index = true;
+    return ARK_LINK_OK;
+}
+
 ArkLinkResult ark_archive_extract_unit(ArkLinkContext* ctx, ArkArchive* archive, 
                                         size_t index, ArkLinkUnit** out_unit) {
     if (!archive || !out_unit) {
@@ -211,19 +265,16 @@ ArkLinkResult ark_archive_extract_unit(ArkLinkContext* ctx, ArkArchive* archive,
     }
     
     
-    const uint8_t* obj_data = archive->objects[index].data;
-    size_t obj_size = archive->objects[index].size;
-    const char* obj_name = archive->objects[index].name;
-    
-    
     ArkCOFFObject coff;
-    int result = ark_coff_parse(obj_data, obj_size, &coff);
-    if (result != 0) {
-        return ARK_LINK_ERR_FORMAT;
+    ArkLinkResult result = ark_archive_parse_member(archive, index, &coff);
+    if (result != ARK_LINK_OK) {
+        return result;
     }
     
     
-    return coff_to_unit(ctx, &coff, obj_name, out_unit);
+    result = coff_to_unit(ctx, &coff, archive->objects[index].name, out_unit);
+    ark_coff_free(&coff);
+    return result;
 }
 
 ArkLinkResult ark_archive_extract_needed(ArkLinkContext* ctx, ArkArchive* archive,
@@ -238,41 +289,49 @@ ArkLinkResult ark_archive_extract_needed(ArkLinkContext* ctx, ArkArchive* archiv
     *out_units = NULL;
     *out_unit_count = 0;
     
+    if (!archive->has_symbol_index) {
+        ArkLinkResult result = ark_archive_index_members(archive);
+        if (result != ARK_LINK_OK) {
+            return result;
+        }
+    }
+    
     ArkLinkUnit** units = NULL;
     size_t unit_count = 0;
+    size_t unit_capacity = 0;
     
     
-    for (size_t i = 0; i < archive->object_count; i++) {
-        ArkLinkUnit* unit = NULL;
-        ArkLinkResult result = ark_archive_extract_unit(ctx, archive, i, &unit);
-        if (result != ARK_LINK_OK) {
+    for (size_t u = 0; u < undef_count; u++) {
+        size_t member;
+        if (!ark_archive_find_symbol(archive, undefined_symbols[u], &member) ||
+            archive->objects[member].extracted) {
             continue;
         }
         
+        archive->objects[member].extracted = true;
         
-        bool needed = false;
-        for (size_t s = 0; s < unit->symbol_count && !needed; s++) {
-            if (unit->symbols[s].binding == ARK_BIND_GLOBAL) {
-                for (size_t u = 0; u < undef_count; u++) {
-                    if (strcmp(unit->symbols[s].name, undefined_symbols[u]) == 0) {
-                        needed = true;
-                        break;
-                    }
-                }
-            }
+        ArkLinkUnit* unit = NULL;
+        if (ark_archive_extract_unit(ctx, archive, member, &unit) != ARK_LINK_OK) {
+            ark_context_log(ctx, ARK_LOG_WARN, "Cannot extract %s from %s for symbol %s",
+                archive->objects[member].name, archive->filename, undefined_symbols[u]);
+            continue;
         }
         
-        if (needed) {
-            ArkLinkUnit** new_units = realloc(units, (unit_count + 1) * sizeof(ArkLinkUnit*));
-            if (new_units) {
-                units = new_units;
-                units[unit_count++] = unit;
-            } else {
+        if (unit_count >= unit_capacity) {
+            size_t new_capacity = unit_capacity ? unit_capacity * 2 : 8;
+            ArkLinkUnit** new_units = realloc(units, new_capacity * sizeof(ArkLinkUnit*));
+            if (!new_units) {
                 ark_link_unit_destroy(unit);
+                for (size_t i = 0; i < unit_count; i++) {
+                    ark_link_unit_destroy(units[i]);
+                }
+                free(units);
+                return ARK_LINK_ERR_MEMORY;
             }
-        } else {
-            ark_link_unit_destroy(unit);
+            units = new_units;
+            unit_capacity = new_capacity;
         }
+        units[unit_count++] = unit;
     }
     
     *out_units = units;
@@ -291,9 +350,27 @@ ArkLinkResult ark_archive_list_symbols(ArkArchive* archive,
     *out_symbols = NULL;
     *out_count = 0;
     
-    (void)archive;
+    if (!archive->has_symbol_index) {
+        ArkLinkResult result = ark_archive_index_members(archive);
+        if (result != ARK_LINK_OK) {
+            return result;
+        }
+    }
+    
+    if (archive->symbol_count == 0) {
+        return ARK_LINK_OK;
+    }
     
+    const char** symbols = (const char**)malloc(archive->symbol_count * sizeof(char*));
+    if (!symbols) {
+        return ARK_LINK_ERR_MEMORY;
+    }
+    for (size_t i = 0; i < archive->symbol_count; i++) {
+        symbols[i] = ark_archive_symbol_name(archive, i);
+    }
     
+    *out_symbols = symbols;
+    *out_count = archive->symbol_count;
     return ARK_LINK_OK;
 }
 
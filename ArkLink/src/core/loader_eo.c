@@ -1,5 +1,6 @@
 #include "ArkLink/loader.h"
 #include "ArkLink/context.h"
+#include "mapped_file.h"
 
 #include <errno.h>
 #include <stdio.h>
@@ -118,41 +119,6 @@ typedef struct EOReader {
     size_t offset;
 } EOReader;
 
-static ArkLinkResult eo_read_file(const char* path, uint8_t** out_data, size_t* out_size) {
-    FILE* f = fopen(path, "rb");
-    if (!f) {
-        return ARK_LINK_ERR_IO;
-    }
-    if (fseek(f, 0, SEEK_END) != 0) {
-        fclose(f);
-        return ARK_LINK_ERR_IO;
-    }
-    long size = ftell(f);
-    if (size < 0) {
-        fclose(f);
-        return ARK_LINK_ERR_IO;
-    }
-    if (fseek(f, 0, SEEK_SET) != 0) {
-        fclose(f);
-        return ARK_LINK_ERR_IO;
-    }
-    uint8_t* data = (uint8_t*)malloc((size_t)size);
-    if (!data) {
-        fclose(f);
-        return ARK_LINK_ERR_MEMORY;
-    }
-    size_t read_size = fread(data, 1, (size_t)size, f);
-    if (read_size != (size_t)size) {
-        free(data);
-        fclose(f);
-        return ARK_LINK_ERR_IO;
-    }
-    fclose(f);
-    *out_data = data;
-    *out_size = (size_t)size;
-    return ARK_LINK_OK;
-}
-
 static int eo_reader_read(EOReader* reader, void* out, size_t size) {
     if (reader->offset + size > reader->size) {
         return 0;
@@ -227,28 +193,45 @@ static int eo_type_to_arklink(uint8_t type) {
 }
 
 ArkLinkResult ark_link_load_eo(const char* path, ArkLinkUnit** unit) {
-    uint8_t* data = NULL;
-    size_t size = 0;
+    ArkMappedFile* file = (ArkMappedFile*)malloc(sizeof(ArkMappedFile));
+    if (!file) {
+        return ARK_LINK_ERR_MEMORY;
+    }
+    ArkLinkResult result = ark_mapped_file_open(path, file);
+    if (result != ARK_LINK_OK) {
+        free(file);
+        return result;
+    }
     
-    ArkLinkResult result = eo_read_file(path, &data, &size);
+    result = ark_link_load_eo_memory(path, file->data, file->size, unit);
     if (result != ARK_LINK_OK) {
+        ark_mapped_file_close(file);
+        free(file);
         return result;
     }
     
+    (*unit)->mapping = file;
+    return ARK_LINK_OK;
+}
+
+ArkLinkResult ark_link_load_eo_memory(const char* name, const uint8_t* data, size_t size, ArkLinkUnit** unit) {
+    if (!name || !data || !unit) {
+        return ARK_LINK_ERR_INVALID_ARGUMENT;
+    }
+    
     EOReader reader = { data, size, 0 };
+    ArkLinkResult result;
     
     
     EOHeader header;
     result = eo_parse_header(&reader, &header);
     if (result != ARK_LINK_OK) {
-        free(data);
         return result;
     }
     
     
-    *unit = ark_link_unit_create(path);
+    *unit = ark_link_unit_create(name);
     if (!*unit) {
-        free(data);
         return ARK_LINK_ERR_MEMORY;
     }
     
@@ -258,7 +241,6 @@ ArkLinkResult ark_link_load_eo(const char* path, ArkLinkUnit** unit) {
     result = eo_parse_sections(&reader, sections, sec_count);
     if (result != ARK_LINK_OK) {
         ark_link_unit_destroy(*unit);
-        free(data);
         return result;
     }
 
@@ -288,7 +270,6 @@ ArkLinkResult ark_link_load_eo(const char* path, ArkLinkUnit** unit) {
             ArkLinkSection* section = ark_link_unit_add_section(*unit, &sdesc);
             if (!section) {
                 ark_link_unit_destroy(*unit);
-                free(data);
                 return ARK_LINK_ERR_MEMORY;
             }
             sec_idx_map[i] = (int)(*unit)->section_count - 1;
@@ -300,7 +281,6 @@ ArkLinkResult ark_link_load_eo(const char* path, ArkLinkUnit** unit) {
         if (esec->file_size > 0) {
             if (esec->file_offset + esec->file_size > size) {
                 ark_link_unit_destroy(*unit);
-                free(data);
                 return ARK_LINK_ERR_FORMAT;
             }
             sec_data = data + esec->file_offset;
@@ -312,7 +292,8 @@ ArkLinkResult ark_link_load_eo(const char* path, ArkLinkUnit** unit) {
             .data = sec_data,
             .size = (size_t)esec->file_size,
             .alignment = 1u << esec->align_log2,
-            .flags = 0
+            .flags = 0,
+            .borrow_data = 1
         };
 
         if (esec->flags & EO_SECF_EXEC) {
@@ -328,7 +309,6 @@ ArkLinkResult ark_link_load_eo(const char* path, ArkLinkUnit** unit) {
         ArkLinkSection* section = ark_link_unit_add_section(*unit, &sdesc);
         if (!section) {
             ark_link_unit_destroy(*unit);
-            free(data);
             return ARK_LINK_ERR_MEMORY;
         }
 
@@ -339,7 +319,6 @@ ArkLinkResult ark_link_load_eo(const char* path, ArkLinkUnit** unit) {
         if (esec->reloc_count > 0 && esec->reloc_offset > 0) {
             if (esec->reloc_offset + esec->reloc_count * sizeof(EOReloc) > size) {
                 ark_link_unit_destroy(*unit);
-                free(data);
                 return ARK_LINK_ERR_FORMAT;
             }
 
@@ -368,14 +347,6 @@ ArkLinkResult ark_link_load_eo(const char* path, ArkLinkUnit** unit) {
 
                 if (!ark_link_section_add_reloc(section, &rdesc)) {
                     ark_link_unit_destroy(*unit);
-                    free(data);
-                    return ARK_LINK_ERR_MEMORY;
-                }
-                
-                
-                if (!ark_link_unit_add_reloc(*unit, &rdesc)) {
-                    ark_link_unit_destroy(*unit);
-                    free(data);
                     return ARK_LINK_ERR_MEMORY;
                 }
             }
@@ -419,7 +390,6 @@ ArkLinkResult ark_link_load_eo(const char* path, ArkLinkUnit** unit) {
             fprintf(stderr, "[ERROR] Symbol table extends beyond file: offset=%zu, count=%u, file_size=%zu\n",
                     sym_offset, header.sym_count, size);
             ark_link_unit_destroy(*unit);
-            free(data);
             return ARK_LINK_ERR_FORMAT;
         }
         
@@ -429,6 +399,23 @@ ArkLinkResult ark_link_load_eo(const char* path, ArkLinkUnit** unit) {
         
         const EOSymbol* symbols = (const EOSymbol*)(data + sym_offset);
         
+        
+        size_t unterminated = 0;
+        for (uint32_t i = 0; i < header.sym_count; i++) {
+            if (!memchr(symbols[i].name, '\0', sizeof(symbols[i].name))) {
+                unterminated++;
+            }
+        }
+        char* name_cursor = NULL;
+        if (unterminated > 0) {
+            (*unit)->string_pool = (char*)malloc(unterminated * (sizeof(symbols[0].name) + 1));
+            if (!(*unit)->string_pool) {
+                ark_link_unit_destroy(*unit);
+                return ARK_LINK_ERR_MEMORY;
+            }
+            name_cursor = (*unit)->string_pool;
+        }
+        
         for (uint32_t i = 0; i < header.sym_count; i++) {
             const EOSymbol* esym = &symbols[i];
 
@@ -437,17 +424,14 @@ ArkLinkResult ark_link_load_eo(const char* path, ArkLinkUnit** unit) {
                     i, esym->name, esym->sec_idx, (unsigned long long)esym->value);
 #endif
 
-            
-            char* name_copy = strdup(esym->name);
-            if (!name_copy) {
-                ark_link_unit_destroy(*unit);
-                free(data);
-                return ARK_LINK_ERR_MEMORY;
+            const char* sym_name = esym->name;
+            if (!memchr(esym->name, '\0', sizeof(esym->name))) {
+                memcpy(name_cursor, esym->name, sizeof(esym->name));
+                name_cursor[sizeof(esym->name)] = '\0';
+                sym_name = name_cursor;
+                name_cursor += sizeof(esym->name) + 1;
             }
 
-            
-
-
             uint16_t arklink_sec_idx = 0;
             if (esym->sec_idx > 0 && esym->sec_idx <= sec_count) {
                 int mapped = sec_idx_map[esym->sec_idx - 1];
@@ -457,7 +441,7 @@ ArkLinkResult ark_link_load_eo(const char* path, ArkLinkUnit** unit) {
             }
 
             ArkSymbolDesc sdesc = {
-                .name = name_copy,
+                .name = sym_name,
                 .value = esym->value,
                 .size = 0,  
                 .section_index = arklink_sec_idx,
@@ -467,9 +451,7 @@ ArkLinkResult ark_link_load_eo(const char* path, ArkLinkUnit** unit) {
             };
 
             if (!ark_link_unit_add_symbol(*unit, &sdesc)) {
-                free(name_copy);
                 ark_link_unit_destroy(*unit);
-                free(data);
                 return ARK_LINK_ERR_MEMORY;
             }
         }
@@ -480,9 +462,5 @@ ArkLinkResult ark_link_load_eo(const char* path, ArkLinkUnit** unit) {
         (*unit)->entry_point = header.entry_point;
     }
     
-    
-    (*unit)->file_data = data;
-    (*unit)->file_size = size;
-    
     return ARK_LINK_OK;
 }
@@ -0,0 +1,113 @@
+#include "mapped_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+static ArkLinkResult ark_mapped_file_read(const char* path, ArkMappedFile* file) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        return ARK_LINK_ERR_IO;
+    }
+    if (fseek(fp, 0, SEEK_END) != 0) {
+        fclose(fp);
+        return ARK_LINK_ERR_IO;
+    }
+    long size = ftell(fp);
+    if (size <= 0 || fseek(fp, 0, SEEK_SET) != 0) {
+        fclose(fp);
+        return ARK_LINK_ERR_IO;
+    }
+    uint8_t* data = (uint8_t*)malloc((size_t)size);
+    if (!data) {
+        fclose(fp);
+        return ARK_LINK_ERR_MEMORY;
+    }
+    if (fread(data, 1, (size_t)size, fp) != (size_t)size) {
+        free(data);
+        fclose(fp);
+        return ARK_LINK_ERR_IO;
+    }
+    fclose(fp);
+
+    file->data = data;
+    file->size = (size_t)size;
+    file->mapped = false;
+    return ARK_LINK_OK;
+}
+
+ArkLinkResult ark_mapped_file_open(const char* path, ArkMappedFile* file) {
+    if (!path || !file) {
+        return ARK_LINK_ERR_INVALID_ARGUMENT;
+    }
+    memset(file, 0, sizeof(*file));
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return ARK_LINK_ERR_IO;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(handle, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(handle);
+        return ARK_LINK_ERR_IO;
+    }
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(handle);
+    if (mapping) {
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view) {
+            file->data = (const uint8_t*)view;
+            file->size = (size_t)file_size.QuadPart;
+            file->mapped = true;
+            return ARK_LINK_OK;
+        }
+    }
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return ARK_LINK_ERR_IO;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return ARK_LINK_ERR_IO;
+    }
+    void* view = S_ISREG(st.st_mode) ? mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (view != MAP_FAILED) {
+        file->data = (const uint8_t*)view;
+        file->size = (size_t)st.st_size;
+        file->mapped = true;
+        return ARK_LINK_OK;
+    }
+#endif
+
+    return ark_mapped_file_read(path, file);
+}
+
+void ark_mapped_file_close(ArkMappedFile* file) {
+    if (!file || !file->data) {
+        return;
+    }
+    if (file->mapped) {
+#ifdef _WIN32
+        UnmapViewOfFile((LPCVOID)file->data);
+#else
+        munmap((void*)file->data, file->size);
+#endif
+    } else {
+        free((void*)file->data);
+    }
+    memset(file, 0, sizeof(*file));
+}
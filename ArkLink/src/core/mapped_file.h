@@ -0,0 +1,34 @@
+#ifndef ARK_MAPPED_FILE_H
+#define ARK_MAPPED_FILE_H
+
+#include "ArkLink/arklink.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct ArkMappedFile {
+    const uint8_t* data;
+    size_t size;
+    bool mapped;
+} ArkMappedFile;
+
+
+
+
+ArkLinkResult ark_mapped_file_open(const char* path, ArkMappedFile* file);
+
+
+
+
+void ark_mapped_file_close(ArkMappedFile* file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif 
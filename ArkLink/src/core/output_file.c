@@ -0,0 +1,247 @@
+#define _POSIX_C_SOURCE 200809L
+#include "ArkLink/output_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <process.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+static char* ark_output_temp_path(const char* path) {
+    size_t len = strlen(path) + 32;
+    char* temp = (char*)malloc(len);
+    if (!temp) {
+        return NULL;
+    }
+#ifdef _WIN32
+    snprintf(temp, len, "%s.%d.tmp", path, _getpid());
+#else
+    snprintf(temp, len, "%s.%ld.tmp", path, (long)getpid());
+#endif
+    return temp;
+}
+
+
+static void ark_output_file_reset(ArkOutputFile* file) {
+    free(file->path);
+    free(file->temp_path);
+    memset(file, 0, sizeof(*file));
+#ifndef _WIN32
+    file->fd = -1;
+#endif
+}
+
+#ifdef _WIN32
+
+ArkLinkResult ark_output_file_open(const char* path, size_t size, ArkOutputFile* file) {
+    if (!path || !file) {
+        return ARK_LINK_ERR_INVALID_ARGUMENT;
+    }
+    memset(file, 0, sizeof(*file));
+    file->size = size;
+    file->path = _strdup(path);
+    file->temp_path = ark_output_temp_path(path);
+    if (!file->path || !file->temp_path) {
+        ark_output_file_reset(file);
+        return ARK_LINK_ERR_MEMORY;
+    }
+
+    HANDLE handle = CreateFileA(file->temp_path, GENERIC_READ | GENERIC_WRITE, 0, NULL,
+                                CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        ark_output_file_reset(file);
+        return ARK_LINK_ERR_IO;
+    }
+    file->file_handle = handle;
+
+    if (size > 0) {
+        HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READWRITE,
+                                            (DWORD)((uint64_t)size >> 32), (DWORD)size, NULL);
+        if (mapping) {
+            void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+            if (view) {
+                file->mapping_handle = mapping;
+                file->data = (uint8_t*)view;
+                file->mapped = true;
+                return ARK_LINK_OK;
+            }
+            CloseHandle(mapping);
+        }
+    }
+
+
+    file->data = (uint8_t*)calloc(1, size > 0 ? size : 1);
+    if (!file->data) {
+        ark_output_file_discard(file);
+        return ARK_LINK_ERR_MEMORY;
+    }
+    return ARK_LINK_OK;
+}
+
+ArkLinkResult ark_output_file_commit(ArkOutputFile* file, bool executable) {
+    (void)executable;
+    if (!file || !file->file_handle) {
+        return ARK_LINK_ERR_INVALID_ARGUMENT;
+    }
+
+    ArkLinkResult result = ARK_LINK_OK;
+    if (file->mapped) {
+        if (!FlushViewOfFile(file->data, file->size)) {
+            result = ARK_LINK_ERR_IO;
+        }
+        UnmapViewOfFile(file->data);
+        CloseHandle((HANDLE)file->mapping_handle);
+    } else {
+        size_t written = 0;
+        while (written < file->size && result == ARK_LINK_OK) {
+            DWORD chunk = 0;
+            DWORD request = (DWORD)((file->size - written) > 0x40000000 ? 0x40000000 : (file->size - written));
+            if (!WriteFile((HANDLE)file->file_handle, file->data + written, request, &chunk, NULL) || chunk == 0) {
+                result = ARK_LINK_ERR_IO;
+            }
+            written += chunk;
+        }
+        free(file->data);
+    }
+    file->data = NULL;
+    file->mapping_handle = NULL;
+    CloseHandle((HANDLE)file->file_handle);
+    file->file_handle = NULL;
+
+    if (result == ARK_LINK_OK &&
+        !MoveFileExA(file->temp_path, file->path, MOVEFILE_REPLACE_EXISTING)) {
+        result = ARK_LINK_ERR_IO;
+    }
+    if (result != ARK_LINK_OK) {
+        DeleteFileA(file->temp_path);
+    }
+    ark_output_file_reset(file);
+    return result;
+}
+
+void ark_output_file_discard(ArkOutputFile* file) {
+    if (!file) {
+        return;
+    }
+    if (file->mapped) {
+        UnmapViewOfFile(file->data);
+        CloseHandle((HANDLE)file->mapping_handle);
+    } else {
+        free(file->data);
+    }
+    if (file->file_handle) {
+        CloseHandle((HANDLE)file->file_handle);
+        DeleteFileA(file->temp_path);
+    }
+    ark_output_file_reset(file);
+}
+
+#else
+
+ArkLinkResult ark_output_file_open(const char* path, size_t size, ArkOutputFile* file) {
+    if (!path || !file) {
+        return ARK_LINK_ERR_INVALID_ARGUMENT;
+    }
+    memset(file, 0, sizeof(*file));
+    file->fd = -1;
+    file->size = size;
+    file->path = strdup(path);
+    file->temp_path = ark_output_temp_path(path);
+    if (!file->path || !file->temp_path) {
+        ark_output_file_reset(file);
+        return ARK_LINK_ERR_MEMORY;
+    }
+
+    file->fd = open(file->temp_path, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (file->fd < 0) {
+        ark_output_file_reset(file);
+        return ARK_LINK_ERR_IO;
+    }
+
+    if (size > 0 && ftruncate(file->fd, (off_t)size) == 0) {
+        void* view = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, 0);
+        if (view != MAP_FAILED) {
+            file->data = (uint8_t*)view;
+            file->mapped = true;
+            return ARK_LINK_OK;
+        }
+    }
+
+
+    file->data = (uint8_t*)calloc(1, size > 0 ? size : 1);
+    if (!file->data) {
+        ark_output_file_discard(file);
+        return ARK_LINK_ERR_MEMORY;
+    }
+    return ARK_LINK_OK;
+}
+
+ArkLinkResult ark_output_file_commit(ArkOutputFile* file, bool executable) {
+    if (!file || file->fd < 0) {
+        return ARK_LINK_ERR_INVALID_ARGUMENT;
+    }
+
+    ArkLinkResult result = ARK_LINK_OK;
+    if (file->mapped) {
+        if (munmap(file->data, file->size) != 0) {
+            result = ARK_LINK_ERR_IO;
+        }
+    } else {
+        size_t written = 0;
+        while (written < file->size) {
+            ssize_t chunk = write(file->fd, file->data + written, file->size - written);
+            if (chunk <= 0) {
+                result = ARK_LINK_ERR_IO;
+                break;
+            }
+            written += (size_t)chunk;
+        }
+        free(file->data);
+    }
+    file->data = NULL;
+
+    if (result == ARK_LINK_OK && executable) {
+        mode_t mask = umask(0);
+        umask(mask);
+        fchmod(file->fd, 0777 & ~mask);
+    }
+    if (close(file->fd) != 0) {
+        result = ARK_LINK_ERR_IO;
+    }
+    file->fd = -1;
+
+    if (result == ARK_LINK_OK && rename(file->temp_path, file->path) != 0) {
+        result = ARK_LINK_ERR_IO;
+    }
+    if (result != ARK_LINK_OK) {
+        unlink(file->temp_path);
+    }
+    ark_output_file_reset(file);
+    return result;
+}
+
+void ark_output_file_discard(ArkOutputFile* file) {
+    if (!file) {
+        return;
+    }
+    if (file->mapped) {
+        munmap(file->data, file->size);
+    } else {
+        free(file->data);
+    }
+    if (file->fd >= 0) {
+        close(file->fd);
+        unlink(file->temp_path);
+    }
+    ark_output_file_reset(file);
+}
+
+#endif
@@ -0,0 +1,168 @@
+#include "ArkLink/parallel.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+#define ARK_PARALLEL_MAX_WORKERS 64
+
+
+typedef struct ArkParallelJob {
+    ArkParallelFn fn;
+    void* user_data;
+    size_t count;
+    atomic_size_t next;
+} ArkParallelJob;
+
+
+static void ark_parallel_drain(ArkParallelJob* job) {
+    for (;;) {
+        size_t index = atomic_fetch_add_explicit(&job->next, 1, memory_order_relaxed);
+        if (index >= job->count) {
+            break;
+        }
+        job->fn(job->user_data, index);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI ark_parallel_thread(LPVOID arg) {
+    ark_parallel_drain((ArkParallelJob*)arg);
+    return 0;
+}
+#else
+static void* ark_parallel_thread(void* arg) {
+    ark_parallel_drain((ArkParallelJob*)arg);
+    return NULL;
+}
+#endif
+
+
+size_t ark_parallel_worker_count(void) {
+    static size_t cached = 0;
+    if (cached) {
+        return cached;
+    }
+
+    size_t count = 1;
+    const char* env = getenv("ARKLINK_THREADS");
+    if (env && *env) {
+        long value = strtol(env, NULL, 10);
+        if (value > 0) {
+            count = (size_t)value;
+        }
+    } else {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        count = info.dwNumberOfProcessors;
+#else
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        if (online > 0) {
+            count = (size_t)online;
+        }
+#endif
+    }
+
+    if (count > ARK_PARALLEL_MAX_WORKERS) {
+        count = ARK_PARALLEL_MAX_WORKERS;
+    }
+    cached = count;
+    return cached;
+}
+
+
+void ark_parallel_for(size_t count, ArkParallelFn fn, void* user_data) {
+    if (!fn || count == 0) {
+        return;
+    }
+
+    ArkParallelJob job = {
+        .fn = fn,
+        .user_data = user_data,
+        .count = count,
+    };
+    atomic_init(&job.next, 0);
+
+    size_t workers = ark_parallel_worker_count();
+    if (workers > count) {
+        workers = count;
+    }
+
+#ifdef _WIN32
+    HANDLE threads[ARK_PARALLEL_MAX_WORKERS];
+#else
+    pthread_t threads[ARK_PARALLEL_MAX_WORKERS];
+#endif
+    size_t started = 0;
+    for (size_t i = 1; i < workers; i++) {
+#ifdef _WIN32
+        threads[started] = CreateThread(NULL, 0, ark_parallel_thread, &job, 0, NULL);
+        if (!threads[started]) {
+            break;
+        }
+#else
+        if (pthread_create(&threads[started], NULL, ark_parallel_thread, &job) != 0) {
+            break;
+        }
+#endif
+        started++;
+    }
+
+
+    ark_parallel_drain(&job);
+
+    for (size_t i = 0; i < started; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+}
+
+
+#ifdef _WIN32
+
+void ark_mutex_init(ArkMutex* mutex) {
+    InitializeSRWLock((PSRWLOCK)&mutex->lock);
+}
+
+void ark_mutex_destroy(ArkMutex* mutex) {
+    (void)mutex;
+}
+
+void ark_mutex_lock(ArkMutex* mutex) {
+    AcquireSRWLockExclusive((PSRWLOCK)&mutex->lock);
+}
+
+void ark_mutex_unlock(ArkMutex* mutex) {
+    ReleaseSRWLockExclusive((PSRWLOCK)&mutex->lock);
+}
+
+#else
+
+void ark_mutex_init(ArkMutex* mutex) {
+    pthread_mutex_init(&mutex->lock, NULL);
+}
+
+void ark_mutex_destroy(ArkMutex* mutex) {
+    pthread_mutex_destroy(&mutex->lock);
+}
+
+void ark_mutex_lock(ArkMutex* mutex) {
+    pthread_mutex_lock(&mutex->lock);
+}
+
+void ark_mutex_unlock(ArkMutex* mutex) {
+    pthread_mutex_unlock(&mutex->lock);
+}
+
+#endif
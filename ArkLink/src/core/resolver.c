@@ -1,22 +1,48 @@
 #include "ArkLink/resolver.h"
 #include "ArkLink/backend.h"
+#include "ArkLink/parallel.h"
+#include "mapped_file.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 
+#define ARK_SYMTAB_SHARD_BITS 6
+#define ARK_SYMTAB_SHARD_COUNT (1u << ARK_SYMTAB_SHARD_BITS)
+
+
 typedef struct ArkSymbolEntry {
     struct ArkSymbolEntry* next;
     const char* name;
+    size_t hash;
     ArkResolverSymbol* symbol;
     size_t symbol_index;
+    size_t first_ordinal;
 } ArkSymbolEntry;
 
 
-typedef struct {
+typedef struct ArkSymbolShard {
+    ArkArena* arena;
     ArkSymbolEntry** buckets;
-    size_t bucket_count;
+    size_t bucket_mask;
+    const size_t* ordinals;
+    size_t ordinal_count;
+    ArkLinkResult result;
+    size_t error_ordinal;
+} ArkSymbolShard;
+
+
+typedef struct {
+    ArkSymbolShard shards[ARK_SYMTAB_SHARD_COUNT];
+    size_t* symbol_base;
+    size_t* section_base;
+    uint32_t* unit_of;
+    size_t* hashes;
+    const char** names;
+    ArkSymbolEntry** resolved;
+    size_t* shard_ordinals;
+    size_t total;
 } ArkSymbolTable;
 
 typedef struct ArkResolverState {
@@ -26,52 +52,69 @@ typedef struct ArkResolverState {
     size_t unit_capacity;
     ArkResolverPlan* plan;
     ArkSymbolTable symtab;
+    uint8_t* section_live;
+    size_t section_total;
+    uint32_t* section_map;
+    uint32_t* symbol_map;
 } ArkResolverState;
 
 
-static size_t ark_hash_string(const char* str) {
-    size_t hash = 1469598103934665603ull;
-    while (*str) {
-        hash ^= (unsigned char)*str++;
-        hash *= 1099511628211ull;
-    }
-    return hash;
+static ArkSymbolShard* ark_symtab_shard(ArkSymbolTable* table, size_t hash) {
+    return &table->shards[hash >> (sizeof(size_t) * 8 - ARK_SYMTAB_SHARD_BITS)];
 }
 
 
-static ArkLinkResult ark_symtab_init(ArkSymbolTable* table, size_t bucket_count) {
-    table->buckets = (ArkSymbolEntry**)calloc(bucket_count, sizeof(ArkSymbolEntry*));
-    if (!table->buckets) {
+static ArkLinkResult ark_symtab_init(ArkSymbolTable* table, ArkLinkUnit* const* units, size_t unit_count, size_t total) {
+    memset(table, 0, sizeof(*table));
+    table->total = total;
+    table->symbol_base = (size_t*)calloc(unit_count + 1, sizeof(size_t));
+    table->section_base = (size_t*)calloc(unit_count + 1, sizeof(size_t));
+    table->unit_of = (uint32_t*)malloc(total * sizeof(uint32_t));
+    table->hashes = (size_t*)malloc(total * sizeof(size_t));
+    table->names = (const char**)malloc(total * sizeof(const char*));
+    table->resolved = (ArkSymbolEntry**)calloc(total, sizeof(ArkSymbolEntry*));
+    table->shard_ordinals = (size_t*)malloc(total * sizeof(size_t));
+    if (!table->symbol_base || !table->section_base || !table->unit_of || !table->hashes ||
+        !table->names || !table->resolved || !table->shard_ordinals) {
         return ARK_LINK_ERR_MEMORY;
     }
-    table->bucket_count = bucket_count;
+    for (size_t u = 0; u < unit_count; ++u) {
+        table->symbol_base[u + 1] = table->symbol_base[u] + units[u]->symbol_count;
+        table->section_base[u + 1] = table->section_base[u] + units[u]->section_count;
+    }
     return ARK_LINK_OK;
 }
 
 
 static void ark_symtab_free(ArkSymbolTable* table) {
-    if (!table || !table->buckets) {
+    if (!table) {
         return;
     }
-    for (size_t i = 0; i < table->bucket_count; i++) {
-        ArkSymbolEntry* entry = table->buckets[i];
-        while (entry) {
-            ArkSymbolEntry* next = entry->next;
-            free(entry);
-            entry = next;
+    for (size_t i = 0; i < ARK_SYMTAB_SHARD_COUNT; i++) {
+        if (table->shards[i].arena) {
+            ark_arena_destroy(table->shards[i].arena);
         }
+        free(table->shards[i].buckets);
     }
-    free(table->buckets);
-    table->buckets = NULL;
-    table->bucket_count = 0;
+    free(table->symbol_base);
+    free(table->section_base);
+    free(table->unit_of);
+    free(table->hashes);
+    free(table->names);
+    free(table->resolved);
+    free(table->shard_ordinals);
+    memset(table, 0, sizeof(*table));
 }
 
 
-static ArkSymbolEntry* ark_symtab_lookup(ArkSymbolTable* table, const char* name) {
-    size_t idx = ark_hash_string(name) % table->bucket_count;
-    ArkSymbolEntry* entry = table->buckets[idx];
+static ArkSymbolEntry* ark_symtab_find(ArkSymbolTable* table, const char* name, size_t hash) {
+    ArkSymbolShard* shard = ark_symtab_shard(table, hash);
+    if (!shard->buckets) {
+        return NULL;
+    }
+    ArkSymbolEntry* entry = shard->buckets[hash & shard->bucket_mask];
     while (entry) {
-        if (strcmp(entry->name, name) == 0) {
+        if (entry->hash == hash && (entry->name == name || strcmp(entry->name, name) == 0)) {
             return entry;
         }
         entry = entry->next;
@@ -80,31 +123,115 @@ static ArkSymbolEntry* ark_symtab_lookup(ArkSymbolTable* table, const char* name
 }
 
 
-static ArkLinkResult ark_symtab_insert(ArkSymbolTable* table, const char* name, 
-                              ArkResolverSymbol* symbol, size_t symbol_index) {
-    size_t idx = ark_hash_string(name) % table->bucket_count;
-    
-    
-    ArkSymbolEntry* existing = table->buckets[idx];
-    while (existing) {
-        if (strcmp(existing->name, name) == 0) {
-            return ARK_LINK_ERR_FORMAT;  
-        }
-        existing = existing->next;
-    }
-    
-    ArkSymbolEntry* entry = (ArkSymbolEntry*)malloc(sizeof(ArkSymbolEntry));
+static ArkSymbolEntry* ark_symtab_lookup(ArkSymbolTable* table, const char* name) {
+    return ark_symtab_find(table, name, ark_context_hash((ArkStringView){name, strlen(name)}));
+}
+
+
+static ArkSymbolEntry* ark_symtab_insert(ArkSymbolShard* shard, const char* name, size_t hash,
+                                         ArkResolverSymbol* symbol, size_t ordinal) {
+    ArkSymbolEntry* entry = (ArkSymbolEntry*)ark_arena_alloc(shard->arena, sizeof(ArkSymbolEntry), 0);
     if (!entry) {
-        return ARK_LINK_ERR_MEMORY;
+        return NULL;
     }
-    
     entry->name = name;
+    entry->hash = hash;
     entry->symbol = symbol;
-    entry->symbol_index = symbol_index;
-    entry->next = table->buckets[idx];
-    table->buckets[idx] = entry;
-    
-    return ARK_LINK_OK;
+    entry->symbol_index = ordinal;
+    entry->first_ordinal = ordinal;
+    entry->next = shard->buckets[hash & shard->bucket_mask];
+    shard->buckets[hash & shard->bucket_mask] = entry;
+    return entry;
+}
+
+
+static uint32_t ark_resolver_global_section(size_t section_base, const ArkLinkUnit* unit, uint32_t local_index) {
+    if (local_index == 0 || local_index > unit->section_count) {
+        return 0;
+    }
+    return (uint32_t)(section_base + local_index);
+}
+
+
+static void ark_resolver_hash_unit(void* user_data, size_t index) {
+    ArkResolverState* state = (ArkResolverState*)user_data;
+    ArkSymbolTable* table = &state->symtab;
+    ArkLinkUnit* unit = state->units[index];
+    size_t base = table->symbol_base[index];
+
+    for (size_t s = 0; s < unit->symbol_count; ++s) {
+        const char* name = unit->symbols[s].name ? unit->symbols[s].name : "";
+        ArkStringView view = {name, strlen(name)};
+        size_t hash = ark_context_hash(view);
+        table->unit_of[base + s] = (uint32_t)index;
+        table->hashes[base + s] = hash;
+        table->names[base + s] = ark_context_intern_hashed(state->ctx, view, hash);
+    }
+}
+
+
+static void ark_resolver_merge_shard(void* user_data, size_t index) {
+    ArkResolverState* state = (ArkResolverState*)user_data;
+    ArkSymbolTable* table = &state->symtab;
+    ArkSymbolShard* shard = &table->shards[index];
+
+    for (size_t i = 0; i < shard->ordinal_count; ++i) {
+        size_t ordinal = shard->ordinals[i];
+        size_t u = table->unit_of[ordinal];
+        ArkLinkUnit* unit = state->units[u];
+        ArkSymbolDesc* src = &unit->symbols[ordinal - table->symbol_base[u]];
+        size_t section_base = table->section_base[u];
+        int src_defined = src->section_index > 0 && src->section_index <= unit->section_count;
+        
+        
+        ArkSymbolEntry* existing = ark_symtab_find(table, table->names[ordinal], table->hashes[ordinal]);
+        
+        if (existing) {
+            
+            ArkResolverSymbol* existing_sym = existing->symbol;
+            int existing_defined = existing_sym->section != NULL;
+            
+            if (src_defined && existing_defined &&
+                src->binding == ARK_BIND_GLOBAL && 
+                existing_sym->binding == ARK_BIND_GLOBAL) {
+                shard->result = ARK_LINK_ERR_FORMAT;
+                shard->error_ordinal = ordinal;
+                return;
+            }
+            
+            if (src_defined &&
+                (!existing_defined || src->binding == ARK_BIND_GLOBAL ||
+                 (src->binding == ARK_BIND_LOCAL && existing_sym->binding == ARK_BIND_WEAK))) {
+                
+                existing_sym->binding = src->binding;
+                existing_sym->visibility = src->visibility;
+                existing_sym->section_index = ark_resolver_global_section(section_base, unit, src->section_index);
+                existing_sym->value = src->value;
+                existing_sym->size = src->size;
+                existing_sym->section = unit->sections[src->section_index - 1].buffer;
+            }
+            table->resolved[ordinal] = existing;
+            
+        } else {
+            
+            ArkResolverSymbol* dst = &state->plan->symbols[ordinal];
+            dst->name = table->names[ordinal];
+            dst->binding = src->binding;
+            dst->visibility = src->visibility;
+            dst->section_index = ark_resolver_global_section(section_base, unit, src->section_index);
+            dst->value = src->value;
+            dst->size = src->size;
+            dst->import_id = -1;  
+            dst->section = src_defined ? unit->sections[src->section_index - 1].buffer : NULL;
+            
+            table->resolved[ordinal] = ark_symtab_insert(shard, dst->name, table->hashes[ordinal], dst, ordinal);
+            if (!table->resolved[ordinal]) {
+                shard->result = ARK_LINK_ERR_MEMORY;
+                shard->error_ordinal = ordinal;
+                return;
+            }
+        }
+    }
 }
 
 
@@ -122,83 +249,89 @@ static ArkLinkResult ark_resolver_collect_symbols(ArkResolverState* state) {
     }
     
     
-    size_t bucket_count = total * 2;
-    if (bucket_count < 16) bucket_count = 16;
-    ArkLinkResult result = ark_symtab_init(&state->symtab, bucket_count);
+    ArkSymbolTable* table = &state->symtab;
+    ArkLinkResult result = ark_symtab_init(table, state->units, state->unit_count, total);
     if (result != ARK_LINK_OK) {
+        ark_symtab_free(table);
         return result;
     }
     
     
     state->plan->symbols = (ArkResolverSymbol*)calloc(total, sizeof(ArkResolverSymbol));
     if (!state->plan->symbols) {
-        ark_symtab_free(&state->symtab);
+        ark_symtab_free(table);
         return ARK_LINK_ERR_INTERNAL;
     }
     
     
+    ark_parallel_for(state->unit_count, ark_resolver_hash_unit, state);
+
+    size_t shard_fill[ARK_SYMTAB_SHARD_COUNT + 1] = {0};
+    for (size_t i = 0; i < total; ++i) {
+        if (!table->names[i]) {
+            ark_symtab_free(table);
+            return ARK_LINK_ERR_MEMORY;
+        }
+        shard_fill[(table->hashes[i] >> (sizeof(size_t) * 8 - ARK_SYMTAB_SHARD_BITS)) + 1]++;
+    }
+    for (size_t i = 0; i < ARK_SYMTAB_SHARD_COUNT; ++i) {
+        ArkSymbolShard* shard = &table->shards[i];
+        size_t count = shard_fill[i + 1];
+        shard_fill[i + 1] += shard_fill[i];
+        shard->ordinals = table->shard_ordinals + shard_fill[i];
+        shard->ordinal_count = 0;
+        if (count == 0) {
+            continue;
+        }
+
+        size_t bucket_count = 16;
+        while (bucket_count < count * 2) {
+            bucket_count <<= 1;
+        }
+        shard->bucket_mask = bucket_count - 1;
+        shard->buckets = (ArkSymbolEntry**)calloc(bucket_count, sizeof(ArkSymbolEntry*));
+        shard->arena = ark_arena_create(count * sizeof(ArkSymbolEntry));
+        if (!shard->buckets || !shard->arena) {
+            ark_symtab_free(table);
+            return ARK_LINK_ERR_MEMORY;
+        }
+    }
+    for (size_t i = 0; i < total; ++i) {
+        ArkSymbolShard* shard = ark_symtab_shard(table, table->hashes[i]);
+        table->shard_ordinals[(shard->ordinals - table->shard_ordinals) + shard->ordinal_count++] = i;
+    }
+    
+    
+    ark_parallel_for(ARK_SYMTAB_SHARD_COUNT, ark_resolver_merge_shard, state);
+
+    size_t error_ordinal = total;
+    for (size_t i = 0; i < ARK_SYMTAB_SHARD_COUNT; ++i) {
+        if (table->shards[i].result != ARK_LINK_OK && table->shards[i].error_ordinal < error_ordinal) {
+            error_ordinal = table->shards[i].error_ordinal;
+            result = table->shards[i].result;
+        }
+    }
+    if (result != ARK_LINK_OK) {
+        if (result == ARK_LINK_ERR_FORMAT) {
+            ark_context_log(state->ctx, ARK_LOG_ERROR, 
+                "Multiple definitions of symbol: %s", table->names[error_ordinal]);
+        }
+        return result;
+    }
+    
+    
     size_t cursor = 0;
-    for (size_t u = 0; u < state->unit_count; ++u) {
-        ArkLinkUnit* unit = state->units[u];
-        for (size_t s = 0; s < unit->symbol_count; ++s) {
-            ArkSymbolDesc* src = &unit->symbols[s];
-            
-            
-            ArkSymbolEntry* existing = ark_symtab_lookup(&state->symtab, src->name);
-            
-            if (existing) {
-                
-                ArkResolverSymbol* existing_sym = existing->symbol;
-                
-                if (src->binding == ARK_BIND_GLOBAL && 
-                    existing_sym->binding == ARK_BIND_GLOBAL) {
-                    
-                    ark_context_log(state->ctx, ARK_LOG_ERROR, 
-                        "Multiple definitions of symbol: %s", src->name);
-                    return ARK_LINK_ERR_FORMAT;
-                }
-                
-                if (src->binding == ARK_BIND_GLOBAL ||
-                    (src->binding == ARK_BIND_LOCAL && existing_sym->binding == ARK_BIND_WEAK)) {
-                    
-                    existing_sym->binding = src->binding;
-                    existing_sym->visibility = src->visibility;
-                    existing_sym->section_index = src->section_index;
-                    existing_sym->value = src->value;
-                    existing_sym->size = src->size;
-                    
-                    if (src->section_index > 0 && src->section_index <= unit->section_count) {
-                        existing_sym->section = unit->sections[src->section_index - 1].buffer;
-                    } else {
-                        existing_sym->section = NULL;
-                    }
-                }
-                
-            } else {
-                
-                ArkResolverSymbol* dst = &state->plan->symbols[cursor];
-                dst->name = src->name;
-                dst->binding = src->binding;
-                dst->visibility = src->visibility;
-                dst->section_index = src->section_index;
-                dst->value = src->value;
-                dst->size = src->size;
-                dst->import_id = -1;  
-                
-                if (src->section_index > 0 && src->section_index <= unit->section_count) {
-                    dst->section = unit->sections[src->section_index - 1].buffer;
-                } else {
-                    dst->section = NULL;
-                }
-                
-                result = ark_symtab_insert(&state->symtab, src->name, dst, cursor);
-                if (result != ARK_LINK_OK) {
-                    ark_symtab_free(&state->symtab);
-                    return result;
-                }
-                cursor++;
-            }
+    for (size_t i = 0; i < total; ++i) {
+        ArkSymbolEntry* entry = table->resolved[i];
+        if (entry->first_ordinal != i) {
+            continue;
+        }
+        if (cursor != i) {
+            state->plan->symbols[cursor] = state->plan->symbols[i];
         }
+        entry->symbol = &state->plan->symbols[cursor];
+        entry->symbol_index = cursor;
+        cursor++;
     }
     
     state->plan->symbol_count = cursor;
@@ -212,7 +345,26 @@ static ArkLinkResult ark_resolver_check_undefined(ArkResolverState* state) {
     const ArkLinkJob* job = ark_context_job(state->ctx);
 
     
-    int progress = 1;
+    ArkArchive** archives = NULL;
+    size_t archive_count = 0;
+    if (job && job->library_count > 0) {
+        archives = (ArkArchive**)calloc(job->library_count, sizeof(ArkArchive*));
+        if (!archives) {
+            return ARK_LINK_ERR_MEMORY;
+        }
+        ark_context_phase_begin(state->ctx, ARK_LINK_PHASE_ARCHIVE);
+        for (size_t i = 0; i < job->library_count; i++) {
+            char lib_path[512];
+            if (ark_loader_find_library(job->libraries[i], job->library_paths, job->library_path_count, lib_path, sizeof(lib_path)) == ARK_LINK_OK &&
+                ark_loader_load_archive(state->ctx, lib_path, &archives[archive_count], NULL) == ARK_LINK_OK) {
+                archive_count++;
+            }
+        }
+        ark_context_phase_end(state->ctx, ARK_LINK_PHASE_ARCHIVE);
+    }
+
+    ArkLinkResult status = ARK_LINK_OK;
+    int progress = archive_count > 0;
     while (progress) {
         progress = 0;
         size_t undef_count = 0;
@@ -238,52 +390,63 @@ static ArkLinkResult ark_resolver_check_undefined(ArkResolverState* state) {
                 const char** new_undef_names = (const char**)realloc(undef_names, (undef_count + 1) * sizeof(char*));
                 if (!new_undef_names) {
                     free(undef_names);
-                    return ARK_LINK_ERR_MEMORY;
+                    status = ARK_LINK_ERR_MEMORY;
+                    break;
                 }
                 undef_names = new_undef_names;
                 undef_names[undef_count++] = sym->name;
             }
         }
 
-        if (undef_count == 0) break;
+        if (status != ARK_LINK_OK || undef_count == 0) break;
 
         
         
-        for (size_t i = 0; i < job->library_count; i++) {
-            char lib_path[512];
-            if (ark_loader_find_library(job->libraries[i], job->library_paths, job->library_path_count, lib_path, sizeof(lib_path)) == ARK_LINK_OK) {
-                ArkArchive* archive = NULL;
-                if (ark_loader_load_archive(state->ctx, lib_path, &archive, NULL) == ARK_LINK_OK) {
-                    ArkLinkUnit** extracted_units = NULL;
-                    size_t extracted_count = 0;
-                    if (ark_archive_extract_needed(state->ctx, archive, undef_names, undef_count, &extracted_units, &extracted_count) == ARK_LINK_OK && extracted_count > 0) {
-                        
-                        ArkLinkUnit** new_units = (ArkLinkUnit**)realloc(state->units, (state->unit_count + extracted_count) * sizeof(ArkLinkUnit*));
-                        if (!new_units) {
-                            free(extracted_units);
-                            free(undef_names);
-                            return ARK_LINK_ERR_MEMORY;
-                        }
-                        state->units = new_units;
-                        for (size_t j = 0; j < extracted_count; j++) {
-                            state->units[state->unit_count++] = extracted_units[j];
-                        }
-                        free(extracted_units);
-                        progress = 1;
-                        
-                        
-                        ark_symtab_free(&state->symtab);
-                        free(state->plan->symbols);
-                        state->plan->symbols = NULL;
-                        state->plan->symbol_count = 0;
-                        ark_resolver_collect_symbols(state);
-                    }
-                    ark_archive_destroy(state->ctx, archive);
+        for (size_t i = 0; i < archive_count && !progress; i++) {
+            ArkLinkUnit** extracted_units = NULL;
+            size_t extracted_count = 0;
+            ark_context_phase_begin(state->ctx, ARK_LINK_PHASE_ARCHIVE);
+            ArkLinkResult extracted = ark_archive_extract_needed(state->ctx, archives[i], undef_names, undef_count, &extracted_units, &extracted_count);
+            ark_context_phase_end(state->ctx, ARK_LINK_PHASE_ARCHIVE);
+            if (extracted != ARK_LINK_OK || extracted_count == 0) {
+                continue;
+            }
+
+            ArkLinkUnit** new_units = (ArkLinkUnit**)realloc(state->units, (state->unit_count + extracted_count) * sizeof(ArkLinkUnit*));
+            if (!new_units) {
+                for (size_t j = 0; j < extracted_count; j++) {
+                    ark_link_unit_destroy(extracted_units[j]);
                 }
+                free(extracted_units);
+                status = ARK_LINK_ERR_MEMORY;
+                break;
+            }
+            state->units = new_units;
+            for (size_t j = 0; j < extracted_count; j++) {
+                state->units[state->unit_count++] = extracted_units[j];
             }
-            if (progress) break;
+            free(extracted_units);
+            progress = 1;
         }
         free(undef_names);
+
+        if (status == ARK_LINK_OK && progress) {
+            
+            ark_symtab_free(&state->symtab);
+            free(state->plan->symbols);
+            state->plan->symbols = NULL;
+            state->plan->symbol_count = 0;
+            status = ark_resolver_collect_symbols(state);
+        }
+        if (status != ARK_LINK_OK) break;
+    }
+
+    for (size_t i = 0; i < archive_count; i++) {
+        ark_archive_destroy(state->ctx, archives[i]);
+    }
+    free(archives);
+    if (status != ARK_LINK_OK) {
+        return status;
     }
 
     for (size_t i = 0; i < state->plan->symbol_count; i++) {
@@ -454,36 +617,45 @@ static ArkLinkResult ark_resolver_collect_exports(ArkResolverState* state) {
 }
 
 
-static ArkLinkResult ark_resolver_collect_relocs(ArkResolverState* state) {
-    size_t total = 0;
-    for (size_t i = 0; i < state->unit_count; ++i) {
-        total += state->units[i]->relocations.count;
+static int ark_resolver_reloc_compare(const void* a, const void* b) {
+    const ArkResolverReloc* lhs = (const ArkResolverReloc*)a;
+    const ArkResolverReloc* rhs = (const ArkResolverReloc*)b;
+    if (lhs->section_index != rhs->section_index) {
+        return lhs->section_index < rhs->section_index ? -1 : 1;
     }
-    
-    if (total == 0) {
-        state->plan->relocs = NULL;
-        state->plan->reloc_count = 0;
-        return ARK_LINK_OK;
-    }
-    
-    state->plan->relocs = (ArkResolverReloc*)calloc(total, sizeof(ArkResolverReloc));
-    if (!state->plan->relocs) {
-        return ARK_LINK_ERR_INTERNAL;
+    if (lhs->offset != rhs->offset) {
+        return lhs->offset < rhs->offset ? -1 : 1;
     }
-    
-    size_t cursor = 0;
-    size_t symbol_offset = 0;
+    return 0;
+}
 
-    for (size_t u = 0; u < state->unit_count; ++u) {
-        ArkLinkUnit* unit = state->units[u];
 
-        for (size_t r = 0; r < unit->relocations.count; ++r) {
-            ArkRelocationDesc* src = &unit->relocations.relocs[r];
-            ArkResolverReloc* dst = &state->plan->relocs[cursor++];
+typedef struct ArkRelocBinding {
+    ArkResolverState* state;
+    size_t* reloc_base;
+    ArkLinkResult* results;
+} ArkRelocBinding;
 
-            
 
-            dst->section_index = src->section_index;
+static void ark_resolver_bind_unit_relocs(void* user_data, size_t index) {
+    ArkRelocBinding* binding = (ArkRelocBinding*)user_data;
+    ArkResolverState* state = binding->state;
+    ArkSymbolTable* table = &state->symtab;
+    ArkLinkUnit* unit = state->units[index];
+    size_t cursor = binding->reloc_base[index];
+    size_t section_base = table->section_base[index];
+    size_t symbol_base = table->symbol_base[index];
+
+    for (size_t s = 0; s < unit->section_count; ++s) {
+        ArkLinkSection* section = &unit->sections[s];
+        ArkResolverReloc* first = &state->plan->relocs[cursor];
+
+        for (size_t r = 0; r < section->reloc_count; ++r) {
+            ArkRelocationDesc* src = &section->relocs[r];
+            ArkResolverReloc* dst = &state->plan->relocs[cursor++];
+
+            dst->section = section->buffer;
+            dst->section_index = (uint32_t)(section_base + s + 1);
             dst->offset = (uint32_t)src->offset;
             dst->type = src->type;
             dst->addend = src->addend;
@@ -493,40 +665,70 @@ static ArkLinkResult ark_resolver_collect_relocs(ArkResolverState* state) {
 #endif
 
             
-            if (src->section_index > 0 && src->section_index <= unit->section_count) {
-                dst->section = unit->sections[src->section_index - 1].buffer;
-            } else {
-                dst->section = NULL;
+            if (src->sym_idx >= unit->symbol_count) {
+                binding->results[index] = ARK_LINK_ERR_FORMAT;
+                return;
             }
 
             
-            size_t symbol_index = symbol_offset + src->sym_idx;
-            if (symbol_index >= state->plan->symbol_count) {
-                return ARK_LINK_ERR_FORMAT;
-            }
+            dst->symbol = table->resolved[symbol_base + src->sym_idx]->symbol;
+        }
 
-            
-            if (src->sym_idx < unit->symbol_count) {
-                ArkSymbolDesc* target_desc = &unit->symbols[src->sym_idx];
-                ArkSymbolEntry* entry = ark_symtab_lookup(&state->symtab, target_desc->name);
+        if (section->reloc_count > 1) {
+            qsort(first, section->reloc_count, sizeof(ArkResolverReloc), ark_resolver_reloc_compare);
+        }
+    }
+}
 
-                if (entry) {
-                    dst->symbol = entry->symbol;
-                } else {
-                    
-                    dst->symbol = &state->plan->symbols[symbol_index];
-                }
-            } else {
-                
-                dst->symbol = &state->plan->symbols[symbol_index];
-            }
+
+static ArkLinkResult ark_resolver_collect_relocs(ArkResolverState* state) {
+    ArkRelocBinding binding = {
+        .state = state,
+        .reloc_base = (size_t*)calloc(state->unit_count + 1, sizeof(size_t)),
+        .results = (ArkLinkResult*)calloc(state->unit_count + 1, sizeof(ArkLinkResult)),
+    };
+    if (!binding.reloc_base || !binding.results) {
+        free(binding.reloc_base);
+        free(binding.results);
+        return ARK_LINK_ERR_MEMORY;
+    }
+
+    for (size_t i = 0; i < state->unit_count; ++i) {
+        ArkLinkUnit* unit = state->units[i];
+        binding.reloc_base[i + 1] = binding.reloc_base[i];
+        for (size_t s = 0; s < unit->section_count; ++s) {
+            binding.reloc_base[i + 1] += unit->sections[s].reloc_count;
         }
+    }
+    size_t total = binding.reloc_base[state->unit_count];
+    
+    if (total == 0) {
+        free(binding.reloc_base);
+        free(binding.results);
+        state->plan->relocs = NULL;
+        state->plan->reloc_count = 0;
+        return ARK_LINK_OK;
+    }
+    
+    state->plan->relocs = (ArkResolverReloc*)calloc(total, sizeof(ArkResolverReloc));
+    if (!state->plan->relocs) {
+        free(binding.reloc_base);
+        free(binding.results);
+        return ARK_LINK_ERR_INTERNAL;
+    }
+    
+    
+    ark_parallel_for(state->unit_count, ark_resolver_bind_unit_relocs, &binding);
 
-        symbol_offset += unit->symbol_count;
+    ArkLinkResult result = ARK_LINK_OK;
+    for (size_t i = 0; i < state->unit_count && result == ARK_LINK_OK; ++i) {
+        result = binding.results[i];
     }
+    free(binding.reloc_base);
+    free(binding.results);
     
-    state->plan->reloc_count = cursor;
-    return ARK_LINK_OK;
+    state->plan->reloc_count = total;
+    return result;
 }
 
 
@@ -577,6 +779,459 @@ static void ark_resolver_find_entry(ArkResolverState* state) {
 }
 
 
+static int ark_resolver_section_retained(const char* name) {
+    static const char* retained[] = {
+        ".init", ".fini", ".ctors", ".dtors", ".preinit_array",
+        ".pdata", ".xdata", ".tls", ".CRT", ".idata", ".edata", ".rsrc",
+    };
+    for (size_t i = 0; i < sizeof(retained) / sizeof(retained[0]); i++) {
+        size_t len = strlen(retained[i]);
+        if (strncmp(name, retained[i], len) == 0 &&
+            (name[len] == '\0' || name[len] == '$' || name[len] == '.' || name[len] == '_')) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+static size_t* ark_resolver_reloc_buckets(const ArkResolverState* state) {
+    size_t* bucket = (size_t*)calloc(state->section_total + 2, sizeof(size_t));
+    if (!bucket) {
+        return NULL;
+    }
+    for (size_t i = 0; i < state->plan->reloc_count; ++i) {
+        uint32_t section_index = state->plan->relocs[i].section_index;
+        if (section_index <= state->section_total) {
+            bucket[section_index + 1]++;
+        }
+    }
+    for (size_t i = 1; i < state->section_total + 2; ++i) {
+        bucket[i] += bucket[i - 1];
+    }
+    return bucket;
+}
+
+
+static void ark_resolver_gc_mark(ArkResolverState* state, uint32_t* stack, size_t* depth, uint32_t section_index) {
+    if (section_index == 0 || section_index > state->section_total || state->section_live[section_index]) {
+        return;
+    }
+    state->section_live[section_index] = 1;
+    stack[(*depth)++] = section_index;
+}
+
+
+static ArkLinkResult ark_resolver_gc_sections(ArkResolverState* state) {
+    size_t section_total = 0;
+    for (size_t u = 0; u < state->unit_count; ++u) {
+        section_total += state->units[u]->section_count;
+    }
+    if (section_total == 0) {
+        return ARK_LINK_OK;
+    }
+
+    state->section_total = section_total;
+    state->section_live = (uint8_t*)calloc(section_total + 1, sizeof(uint8_t));
+    uint32_t* stack = (uint32_t*)malloc(section_total * sizeof(uint32_t));
+    size_t* bucket = ark_resolver_reloc_buckets(state);
+    if (!state->section_live || !stack || !bucket) {
+        free(stack);
+        free(bucket);
+        return ARK_LINK_ERR_MEMORY;
+    }
+
+    size_t depth = 0;
+    ark_resolver_gc_mark(state, stack, &depth, state->plan->entry_section);
+
+    const ArkParsedConfig* config = ark_context_config(state->ctx);
+    if (config && config->entry_point) {
+        ArkSymbolEntry* entry = ark_symtab_lookup(&state->symtab, config->entry_point);
+        if (entry) {
+            ark_resolver_gc_mark(state, stack, &depth, entry->symbol->section_index);
+        }
+    }
+
+    for (size_t i = 0; i < state->plan->export_count; ++i) {
+        uint32_t symbol_index = state->plan->exports[i].symbol_index;
+        if (symbol_index < state->plan->symbol_count) {
+            ark_resolver_gc_mark(state, stack, &depth, state->plan->symbols[symbol_index].section_index);
+        }
+    }
+
+    size_t section_base = 0;
+    for (size_t u = 0; u < state->unit_count; ++u) {
+        ArkLinkUnit* unit = state->units[u];
+        for (size_t s = 0; s < unit->section_count; ++s) {
+            if (ark_resolver_section_retained(unit->sections[s].name)) {
+                ark_resolver_gc_mark(state, stack, &depth, (uint32_t)(section_base + s + 1));
+            }
+        }
+        section_base += unit->section_count;
+    }
+
+    if (depth == 0) {
+        ark_context_log(state->ctx, ARK_LOG_WARN,
+            "--gc-sections: no entry point or exported symbols, keeping all sections");
+        free(stack);
+        free(bucket);
+        free(state->section_live);
+        state->section_live = NULL;
+        return ARK_LINK_OK;
+    }
+
+    while (depth > 0) {
+        uint32_t section_index = stack[--depth];
+        for (size_t r = bucket[section_index]; r < bucket[section_index + 1]; ++r) {
+            const ArkResolverSymbol* target = state->plan->relocs[r].symbol;
+            if (target) {
+                ark_resolver_gc_mark(state, stack, &depth, target->section_index);
+            }
+        }
+    }
+    free(stack);
+    free(bucket);
+
+    const ArkLinkJob* job = ark_context_job(state->ctx);
+    int verbose = job && (job->flags & ARK_LINK_FLAG_VERBOSE);
+    size_t removed_count = 0;
+    uint64_t removed_bytes = 0;
+    section_base = 0;
+    for (size_t u = 0; u < state->unit_count; ++u) {
+        ArkLinkUnit* unit = state->units[u];
+        for (size_t s = 0; s < unit->section_count; ++s) {
+            if (state->section_live[section_base + s + 1]) {
+                continue;
+            }
+            size_t size = unit->sections[s].buffer ? unit->sections[s].buffer->size : 0;
+            removed_count++;
+            removed_bytes += size;
+            if (verbose) {
+                ark_context_log(state->ctx, ARK_LOG_DEBUG, "--gc-sections: removing %s in %s (%zu bytes)",
+                    unit->sections[s].name,
+                    unit->path ? unit->path : "(memory)", size);
+            }
+        }
+        section_base += unit->section_count;
+    }
+
+    ark_context_log(state->ctx, ARK_LOG_INFO, "--gc-sections: removed %zu of %zu sections (%llu bytes)",
+        removed_count, section_total, (unsigned long long)removed_bytes);
+    return ARK_LINK_OK;
+}
+
+
+typedef struct ArkIcfItem {
+    uint32_t section_index;
+    uint32_t class_id;
+    uint64_t hash;
+} ArkIcfItem;
+
+
+typedef struct ArkIcfState {
+    ArkResolverState* resolver;
+    ArkLinkSection** sections;
+    ArkLinkUnit** owners;
+    size_t* bucket;
+    uint32_t* class_of;
+    ArkIcfItem* items;
+    size_t item_count;
+} ArkIcfState;
+
+
+static uint64_t ark_hash_bytes(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+
+static int ark_resolver_icf_candidate(const ArkResolverState* state, const ArkLinkSection* section, uint32_t section_index) {
+    const ArkSectionBuffer* buffer = section->buffer;
+    if (!buffer || buffer->size == 0 || !buffer->data) {
+        return 0;
+    }
+    if (state->section_live && !state->section_live[section_index]) {
+        return 0;
+    }
+    if (buffer->kind != ARK_SECTION_CODE && !(buffer->flags & ARK_SECTION_FLAG_EXECUTABLE)) {
+        return 0;
+    }
+    if (buffer->flags & ARK_SECTION_FLAG_WRITABLE) {
+        return 0;
+    }
+    return !ark_resolver_section_retained(section->name);
+}
+
+
+static uint64_t ark_resolver_icf_target(const ArkIcfState* icf, const ArkResolverSymbol* symbol) {
+    const ArkResolverState* state = icf->resolver;
+    if (!symbol) {
+        return 0;
+    }
+    if (symbol->section_index == 0 || symbol->section_index > state->section_total) {
+        return (1ull << 63) | (uint64_t)(symbol - state->plan->symbols);
+    }
+    return ((uint64_t)icf->class_of[symbol->section_index] << 32) | symbol->value;
+}
+
+
+static uint64_t ark_resolver_icf_hash(const ArkIcfState* icf, uint32_t section_index, int with_targets) {
+    const ArkResolverPlan* plan = icf->resolver->plan;
+    const ArkSectionBuffer* buffer = icf->sections[section_index]->buffer;
+    uint64_t hash = 1469598103934665603ull;
+
+    if (with_targets) {
+        hash = ark_hash_bytes(hash, &icf->class_of[section_index], sizeof(uint32_t));
+    } else {
+        hash = ark_hash_bytes(hash, &buffer->kind, sizeof(buffer->kind));
+        hash = ark_hash_bytes(hash, &buffer->flags, sizeof(buffer->flags));
+        hash = ark_hash_bytes(hash, &buffer->alignment, sizeof(buffer->alignment));
+        hash = ark_hash_bytes(hash, &buffer->size, sizeof(buffer->size));
+        hash = ark_hash_bytes(hash, buffer->data, buffer->size);
+    }
+
+    for (size_t r = icf->bucket[section_index]; r < icf->bucket[section_index + 1]; ++r) {
+        const ArkResolverReloc* reloc = &plan->relocs[r];
+        if (with_targets) {
+            uint64_t target = ark_resolver_icf_target(icf, reloc->symbol);
+            hash = ark_hash_bytes(hash, &target, sizeof(target));
+        } else {
+            hash = ark_hash_bytes(hash, &reloc->offset, sizeof(reloc->offset));
+            hash = ark_hash_bytes(hash, &reloc->type, sizeof(reloc->type));
+            hash = ark_hash_bytes(hash, &reloc->addend, sizeof(reloc->addend));
+        }
+    }
+    return hash;
+}
+
+
+static int ark_resolver_icf_equal(const ArkIcfState* icf, uint32_t lhs, uint32_t rhs, int with_targets) {
+    const ArkResolverPlan* plan = icf->resolver->plan;
+    size_t lhs_count = icf->bucket[lhs + 1] - icf->bucket[lhs];
+    size_t rhs_count = icf->bucket[rhs + 1] - icf->bucket[rhs];
+    if (lhs_count != rhs_count) {
+        return 0;
+    }
+
+    if (!with_targets) {
+        const ArkSectionBuffer* a = icf->sections[lhs]->buffer;
+        const ArkSectionBuffer* b = icf->sections[rhs]->buffer;
+        if (a->kind != b->kind || a->flags != b->flags || a->alignment != b->alignment ||
+            a->size != b->size || memcmp(a->data, b->data, a->size) != 0) {
+            return 0;
+        }
+    }
+
+    for (size_t i = 0; i < lhs_count; ++i) {
+        const ArkResolverReloc* a = &plan->relocs[icf->bucket[lhs] + i];
+        const ArkResolverReloc* b = &plan->relocs[icf->bucket[rhs] + i];
+        if (with_targets) {
+            if (ark_resolver_icf_target(icf, a->symbol) != ark_resolver_icf_target(icf, b->symbol)) {
+                return 0;
+            }
+        } else if (a->offset != b->offset || a->type != b->type || a->addend != b->addend) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+static int ark_resolver_icf_compare(const void* a, const void* b) {
+    const ArkIcfItem* lhs = (const ArkIcfItem*)a;
+    const ArkIcfItem* rhs = (const ArkIcfItem*)b;
+    if (lhs->class_id != rhs->class_id) {
+        return lhs->class_id < rhs->class_id ? -1 : 1;
+    }
+    if (lhs->hash != rhs->hash) {
+        return lhs->hash < rhs->hash ? -1 : 1;
+    }
+    if (lhs->section_index != rhs->section_index) {
+        return lhs->section_index < rhs->section_index ? -1 : 1;
+    }
+    return 0;
+}
+
+
+static size_t ark_resolver_icf_partition(ArkIcfState* icf, int with_targets, uint32_t* next_class, uint32_t* leaders) {
+    for (size_t i = 0; i < icf->item_count; ++i) {
+        icf->items[i].hash = ark_resolver_icf_hash(icf, icf->items[i].section_index, with_targets);
+    }
+    qsort(icf->items, icf->item_count, sizeof(ArkIcfItem), ark_resolver_icf_compare);
+
+    size_t class_count = 0;
+    size_t run_start = 0;
+    while (run_start < icf->item_count) {
+        size_t run_end = run_start + 1;
+        while (run_end < icf->item_count &&
+               icf->items[run_end].class_id == icf->items[run_start].class_id &&
+               icf->items[run_end].hash == icf->items[run_start].hash) {
+            run_end++;
+        }
+
+        size_t leader_count = 0;
+        for (size_t i = run_start; i < run_end; ++i) {
+            uint32_t section_index = icf->items[i].section_index;
+            size_t l = 0;
+            while (l < leader_count &&
+                   !ark_resolver_icf_equal(icf, leaders[l], section_index, with_targets)) {
+                l++;
+            }
+            if (l == leader_count) {
+                leaders[leader_count++] = section_index;
+                next_class[section_index] = (uint32_t)(++class_count);
+            } else {
+                next_class[section_index] = next_class[leaders[l]];
+            }
+        }
+        run_start = run_end;
+    }
+
+    for (size_t i = 0; i < icf->item_count; ++i) {
+        icf->items[i].class_id = next_class[icf->items[i].section_index];
+    }
+    return class_count;
+}
+
+
+static ArkLinkResult ark_resolver_fold_sections(ArkResolverState* state) {
+    size_t section_total = 0;
+    for (size_t u = 0; u < state->unit_count; ++u) {
+        section_total += state->units[u]->section_count;
+    }
+    if (section_total == 0) {
+        return ARK_LINK_OK;
+    }
+    state->section_total = section_total;
+
+    if (!state->section_live) {
+        state->section_live = (uint8_t*)malloc(section_total + 1);
+        if (!state->section_live) {
+            return ARK_LINK_ERR_MEMORY;
+        }
+        memset(state->section_live, 1, section_total + 1);
+        state->section_live[0] = 0;
+    }
+
+    ArkIcfState icf = {
+        .resolver = state,
+        .sections = (ArkLinkSection**)calloc(section_total + 1, sizeof(ArkLinkSection*)),
+        .owners = (ArkLinkUnit**)calloc(section_total + 1, sizeof(ArkLinkUnit*)),
+        .bucket = ark_resolver_reloc_buckets(state),
+        .class_of = (uint32_t*)calloc(section_total + 1, sizeof(uint32_t)),
+        .items = (ArkIcfItem*)calloc(section_total, sizeof(ArkIcfItem)),
+        .item_count = 0,
+    };
+    uint32_t* next_class = (uint32_t*)calloc(section_total + 1, sizeof(uint32_t));
+    uint32_t* leaders = (uint32_t*)calloc(section_total, sizeof(uint32_t));
+    ArkLinkResult result = ARK_LINK_OK;
+    if (!icf.sections || !icf.owners || !icf.bucket || !icf.class_of || !icf.items || !next_class || !leaders) {
+        result = ARK_LINK_ERR_MEMORY;
+        goto cleanup;
+    }
+
+    size_t global = 1;
+    for (size_t u = 0; u < state->unit_count; ++u) {
+        ArkLinkUnit* unit = state->units[u];
+        for (size_t s = 0; s < unit->section_count; ++s, ++global) {
+            icf.sections[global] = &unit->sections[s];
+            icf.owners[global] = unit;
+            icf.class_of[global] = (uint32_t)(section_total + global);
+            if (ark_resolver_icf_candidate(state, &unit->sections[s], (uint32_t)global)) {
+                icf.items[icf.item_count].section_index = (uint32_t)global;
+                icf.items[icf.item_count].class_id = 0;
+                icf.item_count++;
+            }
+        }
+    }
+    if (icf.item_count < 2) {
+        goto cleanup;
+    }
+
+
+    size_t class_count = ark_resolver_icf_partition(&icf, 0, next_class, leaders);
+    size_t iterations = 1;
+    for (;;) {
+        for (size_t i = 0; i < icf.item_count; ++i) {
+            icf.class_of[icf.items[i].section_index] = icf.items[i].class_id;
+        }
+        size_t refined = ark_resolver_icf_partition(&icf, 1, next_class, leaders);
+        iterations++;
+        if (refined == class_count) {
+            break;
+        }
+        class_count = refined;
+    }
+
+
+    uint32_t* survivor = leaders;
+    memset(survivor, 0, section_total * sizeof(uint32_t));
+    for (size_t i = 0; i < icf.item_count; ++i) {
+        uint32_t section_index = icf.items[i].section_index;
+        uint32_t class_id = icf.items[i].class_id;
+        if (survivor[class_id - 1] == 0 || section_index < survivor[class_id - 1]) {
+            survivor[class_id - 1] = section_index;
+        }
+    }
+
+    const ArkLinkJob* job = ark_context_job(state->ctx);
+    int verbose = job && (job->flags & ARK_LINK_FLAG_VERBOSE);
+    memset(next_class, 0, (section_total + 1) * sizeof(uint32_t));
+    size_t folded_count = 0;
+    uint64_t folded_bytes = 0;
+    for (size_t i = 0; i < icf.item_count; ++i) {
+        uint32_t section_index = icf.items[i].section_index;
+        uint32_t keep = survivor[icf.items[i].class_id - 1];
+        if (keep == section_index) {
+            continue;
+        }
+        next_class[section_index] = keep;
+        state->section_live[section_index] = 0;
+        folded_count++;
+        folded_bytes += icf.sections[section_index]->buffer->size;
+        if (verbose) {
+            ark_context_log(state->ctx, ARK_LOG_DEBUG, "--icf: folding %s in %s into %s in %s",
+                icf.sections[section_index]->name, icf.owners[section_index]->path ? icf.owners[section_index]->path : "(memory)",
+                icf.sections[keep]->name, icf.owners[keep]->path ? icf.owners[keep]->path : "(memory)");
+        }
+    }
+
+
+    for (size_t i = 0; i < state->plan->symbol_count; ++i) {
+        ArkResolverSymbol* symbol = &state->plan->symbols[i];
+        if (symbol->section_index == 0 || symbol->section_index > section_total) {
+            continue;
+        }
+        uint32_t keep = next_class[symbol->section_index];
+        if (keep != 0) {
+            symbol->section_index = keep;
+            symbol->section = icf.sections[keep]->buffer;
+        }
+    }
+    if (state->plan->entry_section != 0 && state->plan->entry_section <= section_total &&
+        next_class[state->plan->entry_section] != 0) {
+        state->plan->entry_section = next_class[state->plan->entry_section];
+    }
+
+    ark_context_log(state->ctx, ARK_LOG_INFO, "--icf: folded %zu sections (%llu bytes) in %zu iterations",
+        folded_count, (unsigned long long)folded_bytes, iterations);
+
+cleanup:
+    free(icf.sections);
+    free(icf.owners);
+    free(icf.bucket);
+    free(icf.class_of);
+    free(icf.items);
+    free(next_class);
+    free(leaders);
+    return result;
+}
+
+
 static ArkLinkResult ark_resolver_build_backend_input(ArkResolverState* state) {
     ArkBackendInput* input = (ArkBackendInput*)calloc(1, sizeof(ArkBackendInput));
     if (!input) {
@@ -589,48 +1244,77 @@ static ArkLinkResult ark_resolver_build_backend_input(ArkResolverState* state) {
     for (size_t i = 0; i < state->unit_count; ++i) {
         section_total += state->units[i]->section_count;
     }
+
+    state->section_map = (uint32_t*)malloc((section_total + 1) * sizeof(uint32_t));
+    if (!state->section_map) {
+        return ARK_LINK_ERR_MEMORY;
+    }
+    state->section_map[0] = 0xFFFFFFFF;
+    size_t live_sections = 0;
+    for (size_t i = 1; i <= section_total; ++i) {
+        if (state->section_live && !state->section_live[i]) {
+            state->section_map[i] = 0xFFFFFFFF;
+        } else {
+            state->section_map[i] = (uint32_t)live_sections++;
+        }
+    }
     
-    if (section_total > 0) {
-        input->sections = (ArkBackendInputSection*)calloc(section_total, sizeof(ArkBackendInputSection));
+    if (live_sections > 0) {
+        input->sections = (ArkBackendInputSection*)calloc(live_sections, sizeof(ArkBackendInputSection));
         if (!input->sections) {
             return ARK_LINK_ERR_INTERNAL;
         }
-        input->section_count = section_total;
+        input->section_count = live_sections;
         
-        size_t cursor = 0;
+        size_t global = 1;
         for (size_t u = 0; u < state->unit_count; ++u) {
             ArkLinkUnit* unit = state->units[u];
-            for (size_t s = 0; s < unit->section_count; ++s) {
+            for (size_t s = 0; s < unit->section_count; ++s, ++global) {
+                uint32_t id = state->section_map[global];
+                if (id == 0xFFFFFFFF) {
+                    continue;
+                }
                 ArkLinkSection* src = &unit->sections[s];
-                ArkBackendInputSection* dst = &input->sections[cursor];
+                ArkBackendInputSection* dst = &input->sections[id];
                 dst->name = src->name;
                 dst->buffer = src->buffer;
-                dst->id = (uint32_t)cursor;
-                ++cursor;
+                dst->id = id;
+                dst->reloc_first = 0;
+                dst->reloc_count = 0;
             }
         }
     }
     
     
     if (state->plan->symbol_count > 0) {
+        state->symbol_map = (uint32_t*)malloc(state->plan->symbol_count * sizeof(uint32_t));
         input->symbols = (ArkBackendInputSymbol*)calloc(state->plan->symbol_count, sizeof(ArkBackendInputSymbol));
-        if (!input->symbols) {
+        if (!state->symbol_map || !input->symbols) {
             return ARK_LINK_ERR_INTERNAL;
         }
-        input->symbol_count = state->plan->symbol_count;
         
+        size_t cursor = 0;
         for (size_t i = 0; i < state->plan->symbol_count; ++i) {
             ArkResolverSymbol* src = &state->plan->symbols[i];
-            ArkBackendInputSymbol* dst = &input->symbols[i];
+            uint32_t section_id = 0xFFFFFFFF;
+            if (src->section_index != 0) {
+                section_id = (src->section_index <= section_total) ? state->section_map[src->section_index] : src->section_index - 1;
+                if (section_id == 0xFFFFFFFF) {
+                    state->symbol_map[i] = 0xFFFFFFFF;
+                    continue;
+                }
+            }
+            state->symbol_map[i] = (uint32_t)cursor;
+            ArkBackendInputSymbol* dst = &input->symbols[cursor++];
             dst->name = src->name;
-            
-            dst->section_id = (src->section_index == 0) ? 0xFFFFFFFF : (src->section_index - 1);
+            dst->section_id = section_id;
             dst->value = src->value;
             dst->size = src->size;
             dst->binding = src->binding;
             dst->visibility = src->visibility;
             dst->import_id = src->import_id;
         }
+        input->symbol_count = cursor;
     }
     
     
@@ -639,23 +1323,47 @@ static ArkLinkResult ark_resolver_build_backend_input(ArkResolverState* state) {
         if (!input->relocs) {
             return ARK_LINK_ERR_INTERNAL;
         }
-        input->reloc_count = state->plan->reloc_count;
         
+        size_t cursor = 0;
         for (size_t i = 0; i < state->plan->reloc_count; ++i) {
             ArkResolverReloc* src = &state->plan->relocs[i];
-            ArkBackendInputReloc* dst = &input->relocs[i];
-            dst->section_id = src->section_index;
+            uint32_t section_id = 0xFFFFFFFF;
+            if (src->section_index != 0) {
+                section_id = (src->section_index <= section_total) ? state->section_map[src->section_index] : src->section_index - 1;
+                if (section_id == 0xFFFFFFFF) {
+                    continue;
+                }
+            }
+            
+            
+            uint32_t symbol_index = 0;
+            if (src->symbol && state->plan->symbols) {
+                symbol_index = state->symbol_map[src->symbol - state->plan->symbols];
+                if (symbol_index == 0xFFFFFFFF) {
+                    ark_context_log(state->ctx, ARK_LOG_ERROR,
+                        "Relocation in live section references removed symbol %s", src->symbol->name);
+                    return ARK_LINK_ERR_INTERNAL;
+                }
+            }
+
+            ArkBackendInputReloc* dst = &input->relocs[cursor];
+            dst->section_id = section_id;
             dst->offset = src->offset;
             dst->type = src->type;
             dst->addend = src->addend;
+            dst->symbol_index = symbol_index;
+
             
-            
-            if (src->symbol && state->plan->symbols) {
-                dst->symbol_index = (uint32_t)(src->symbol - state->plan->symbols);
-            } else {
-                dst->symbol_index = 0;
+            if (dst->section_id < input->section_count) {
+                ArkBackendInputSection* section = &input->sections[dst->section_id];
+                if (section->reloc_count == 0) {
+                    section->reloc_first = cursor;
+                }
+                section->reloc_count++;
             }
+            cursor++;
         }
+        input->reloc_count = cursor;
     }
     
     
@@ -687,13 +1395,17 @@ static ArkLinkResult ark_resolver_build_backend_input(ArkResolverState* state) {
             ArkExportBinding* src = &state->plan->exports[i];
             ArkBackendInputExport* dst = &input->exports[i];
             dst->name = src->name;
-            dst->symbol_index = src->symbol_index;
+            dst->symbol_index = (src->symbol_index < state->plan->symbol_count) ? state->symbol_map[src->symbol_index] : src->symbol_index;
             dst->ordinal = src->ordinal;
         }
     }
     
     
-    input->entry_section = state->plan->entry_section;
+    input->entry_section = 0;
+    if (state->plan->entry_section != 0 && state->plan->entry_section <= section_total &&
+        state->section_map[state->plan->entry_section] != 0xFFFFFFFF) {
+        input->entry_section = state->section_map[state->plan->entry_section] + 1;
+    }
     input->entry_offset = state->plan->entry_offset;
     
     return ARK_LINK_OK;
@@ -711,7 +1423,10 @@ ArkLinkResult ark_resolver_resolve(ArkLinkContext* ctx, ArkLinkUnit* const* unit
         .unit_count = unit_count,
         .unit_capacity = unit_count,
         .plan = out_plan,
-        .symtab = {NULL, 0},
+        .section_live = NULL,
+        .section_total = 0,
+        .section_map = NULL,
+        .symbol_map = NULL,
     };
     memcpy(state.units, units, unit_count * sizeof(ArkLinkUnit*));
     
@@ -752,11 +1467,49 @@ ArkLinkResult ark_resolver_resolve(ArkLinkContext* ctx, ArkLinkUnit* const* unit
     
     
     ark_resolver_find_entry(&state);
+
+
+    const ArkLinkJob* job = ark_context_job(ctx);
+    if (job && (job->flags & ARK_LINK_FLAG_GC_SECTIONS)) {
+        res = ark_resolver_gc_sections(&state);
+        if (res != ARK_LINK_OK) {
+            ark_symtab_free(&state.symtab);
+            free(state.section_live);
+            free(state.units);
+            return res;
+        }
+    }
+    if (job && (job->flags & ARK_LINK_FLAG_ICF)) {
+        res = ark_resolver_fold_sections(&state);
+        if (res != ARK_LINK_OK) {
+            ark_symtab_free(&state.symtab);
+            free(state.section_live);
+            free(state.units);
+            return res;
+        }
+    }
     
     
     res = ark_resolver_build_backend_input(&state);
+
+    ArkLinkStats* stats = ark_context_stats(ctx);
+    if (stats && res == ARK_LINK_OK) {
+        stats->unit_count = state.unit_count;
+        stats->archive_member_count = state.unit_count - unit_count;
+        stats->input_bytes = 0;
+        for (size_t i = 0; i < state.unit_count; i++) {
+            const ArkLinkUnit* unit = state.units[i];
+            stats->input_bytes += unit->mapping ? unit->mapping->size : unit->file_size;
+        }
+        stats->section_count = out_plan->backend_input ? out_plan->backend_input->section_count : 0;
+        stats->symbol_count = out_plan->symbol_count;
+        stats->relocation_count = out_plan->reloc_count;
+    }
     
     ark_symtab_free(&state.symtab);
+    free(state.section_live);
+    free(state.section_map);
+    free(state.symbol_map);
     free(state.units);
     return res;
 }
@@ -771,10 +1524,13 @@ void ark_resolver_plan_destroy(ArkLinkContext* ctx, ArkResolverPlan* plan) {
         free(plan->backend_input->symbols);
         free(plan->backend_input->relocs);
         free(plan->backend_input->imports);
+        free(plan->backend_input->exports);
+        free(plan->backend_input->address_slots);
         free(plan->backend_input);
     }
     free(plan->symbols);
     free(plan->relocs);
     free(plan->imports);
+    free(plan->exports);
     memset(plan, 0, sizeof(*plan));
 }
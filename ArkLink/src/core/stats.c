@@ -0,0 +1,258 @@
+#define _POSIX_C_SOURCE 200809L
+#include "stats.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+    #include <time.h>
+#endif
+
+
+uint64_t ark_stats_clock_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+#endif
+}
+
+uint64_t ark_stats_peak_memory(void) {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return (uint64_t)counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return (uint64_t)usage.ru_maxrss;
+#else
+    return (uint64_t)usage.ru_maxrss * 1024u;
+#endif
+#endif
+}
+
+
+void ark_stats_recorder_init(ArkStatsRecorder* recorder, ArkLinkStats* stats) {
+    memset(recorder, 0, sizeof(*recorder));
+    recorder->stats = stats;
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    recorder->origin = ark_stats_clock_ns();
+    recorder->mark = recorder->origin;
+}
+
+
+
+static void ark_stats_recorder_charge(ArkStatsRecorder* recorder, uint64_t now) {
+    if (recorder->depth > 0) {
+        ArkLinkPhase top = recorder->phases[recorder->depth - 1];
+        recorder->stats->phases[top].wall_ns += now - recorder->mark;
+    }
+    recorder->mark = now;
+}
+
+void ark_stats_recorder_begin(ArkStatsRecorder* recorder, ArkLinkPhase phase) {
+    ArkLinkStats* stats = recorder->stats;
+    if (!stats || phase >= ARK_LINK_PHASE_COUNT || recorder->depth == ARK_STATS_MAX_DEPTH) {
+        return;
+    }
+    uint64_t now = ark_stats_clock_ns();
+    ark_stats_recorder_charge(recorder, now);
+
+    size_t span = SIZE_MAX;
+    if (stats->span_count < ARK_LINK_STATS_MAX_SPANS) {
+        span = stats->span_count++;
+        stats->spans[span].phase = phase;
+        stats->spans[span].depth = (uint32_t)recorder->depth;
+        stats->spans[span].start_ns = now - recorder->origin;
+    }
+    stats->phases[phase].count++;
+    recorder->phases[recorder->depth] = phase;
+    recorder->starts[recorder->depth] = now;
+    recorder->spans[recorder->depth] = span;
+    recorder->depth++;
+}
+
+static void ark_stats_recorder_pop(ArkStatsRecorder* recorder, uint64_t now, uint64_t peak) {
+    ArkLinkStats* stats = recorder->stats;
+    ark_stats_recorder_charge(recorder, now);
+    recorder->depth--;
+    ArkLinkPhase phase = recorder->phases[recorder->depth];
+    if (peak > stats->phases[phase].peak_memory) {
+        stats->phases[phase].peak_memory = peak;
+    }
+    size_t span = recorder->spans[recorder->depth];
+    if (span != SIZE_MAX) {
+        stats->spans[span].duration_ns = now - recorder->starts[recorder->depth];
+        stats->spans[span].peak_memory = peak;
+    }
+}
+
+
+
+void ark_stats_recorder_end(ArkStatsRecorder* recorder, ArkLinkPhase phase) {
+    if (!recorder->stats) {
+        return;
+    }
+    size_t found = recorder->depth;
+    while (found > 0 && recorder->phases[found - 1] != phase) {
+        found--;
+    }
+    if (found == 0) {
+        return;
+    }
+    uint64_t now = ark_stats_clock_ns();
+    uint64_t peak = ark_stats_peak_memory();
+    while (recorder->depth >= found) {
+        ark_stats_recorder_pop(recorder, now, peak);
+    }
+}
+
+void ark_stats_recorder_finish(ArkStatsRecorder* recorder) {
+    ArkLinkStats* stats = recorder->stats;
+    if (!stats) {
+        return;
+    }
+    uint64_t now = ark_stats_clock_ns();
+    uint64_t peak = ark_stats_peak_memory();
+    while (recorder->depth > 0) {
+        ark_stats_recorder_pop(recorder, now, peak);
+    }
+    stats->total_ns = now - recorder->origin;
+    stats->peak_memory = peak;
+    recorder->stats = NULL;
+}
+
+
+const char* arklink_phase_name(ArkLinkPhase phase) {
+    switch (phase) {
+    case ARK_LINK_PHASE_LOAD:
+        return "load";
+    case ARK_LINK_PHASE_ARCHIVE:
+        return "archive";
+    case ARK_LINK_PHASE_RESOLVE:
+        return "resolve";
+    case ARK_LINK_PHASE_LAYOUT:
+        return "layout";
+    case ARK_LINK_PHASE_RELOCATE:
+        return "relocate";
+    case ARK_LINK_PHASE_WRITE:
+        return "write";
+    default:
+        return "unknown";
+    }
+}
+
+static double ark_stats_ms(uint64_t ns) {
+    return (double)ns / 1e6;
+}
+
+static void ark_stats_write_text(const ArkLinkStats* stats, FILE* out) {
+    fprintf(out, "%-10s %12s %8s %12s\n", "phase", "wall ms", "calls", "peak KiB");
+    for (int i = 0; i < ARK_LINK_PHASE_COUNT; i++) {
+        const ArkLinkPhaseStats* phase = &stats->phases[i];
+        fprintf(out, "%-10s %12.3f %8u %12llu\n", arklink_phase_name((ArkLinkPhase)i),
+                ark_stats_ms(phase->wall_ns), phase->count, (unsigned long long)(phase->peak_memory / 1024));
+    }
+    fprintf(out, "%-10s %12.3f %8s %12llu\n", "total", ark_stats_ms(stats->total_ns), "",
+            (unsigned long long)(stats->peak_memory / 1024));
+    fprintf(out, "units: %zu (%zu from archives), sections: %zu, symbols: %zu, relocations: %zu\n",
+            stats->unit_count, stats->archive_member_count, stats->section_count,
+            stats->symbol_count, stats->relocation_count);
+    fprintf(out, "input bytes: %llu, output bytes: %llu\n",
+            (unsigned long long)stats->input_bytes, (unsigned long long)stats->output_bytes);
+}
+
+static void ark_stats_write_json(const ArkLinkStats* stats, FILE* out) {
+    fprintf(out, "{\n");
+    fprintf(out, "  \"total_ms\": %.3f,\n", ark_stats_ms(stats->total_ns));
+    fprintf(out, "  \"peak_memory\": %llu,\n", (unsigned long long)stats->peak_memory);
+    fprintf(out, "  \"units\": %zu,\n", stats->unit_count);
+    fprintf(out, "  \"archive_members\": %zu,\n", stats->archive_member_count);
+    fprintf(out, "  \"sections\": %zu,\n", stats->section_count);
+    fprintf(out, "  \"symbols\": %zu,\n", stats->symbol_count);
+    fprintf(out, "  \"relocations\": %zu,\n", stats->relocation_count);
+    fprintf(out, "  \"input_bytes\": %llu,\n", (unsigned long long)stats->input_bytes);
+    fprintf(out, "  \"output_bytes\": %llu,\n", (unsigned long long)stats->output_bytes);
+    fprintf(out, "  \"phases\": [\n");
+    for (int i = 0; i < ARK_LINK_PHASE_COUNT; i++) {
+        const ArkLinkPhaseStats* phase = &stats->phases[i];
+        fprintf(out, "    {\"name\": \"%s\", \"wall_ms\": %.3f, \"calls\": %u, \"peak_memory\": %llu}%s\n",
+                arklink_phase_name((ArkLinkPhase)i), ark_stats_ms(phase->wall_ns), phase->count,
+                (unsigned long long)phase->peak_memory, i + 1 < ARK_LINK_PHASE_COUNT ? "," : "");
+    }
+    fprintf(out, "  ]\n");
+    fprintf(out, "}\n");
+}
+
+
+
+static void ark_stats_write_trace(const ArkLinkStats* stats, FILE* out) {
+    fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    fprintf(out, "  {\"name\": \"link\", \"cat\": \"arklink\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+                 "\"ts\": 0, \"dur\": %.3f, \"args\": {\"units\": %zu, \"archive_members\": %zu, "
+                 "\"sections\": %zu, \"symbols\": %zu, \"relocations\": %zu, "
+                 "\"input_bytes\": %llu, \"output_bytes\": %llu, \"peak_memory\": %llu}}",
+            (double)stats->total_ns / 1e3, stats->unit_count, stats->archive_member_count,
+            stats->section_count, stats->symbol_count, stats->relocation_count,
+            (unsigned long long)stats->input_bytes, (unsigned long long)stats->output_bytes,
+            (unsigned long long)stats->peak_memory);
+    for (size_t i = 0; i < stats->span_count; i++) {
+        const ArkLinkStatsSpan* span = &stats->spans[i];
+        double start = (double)span->start_ns / 1e3;
+        double end = (double)(span->start_ns + span->duration_ns) / 1e3;
+        fprintf(out, ",\n  {\"name\": \"%s\", \"cat\": \"arklink\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+                     "\"ts\": %.3f, \"dur\": %.3f}",
+                arklink_phase_name(span->phase), start, end - start);
+        fprintf(out, ",\n  {\"name\": \"peak_memory\", \"cat\": \"arklink\", \"ph\": \"C\", \"pid\": 1, "
+                     "\"ts\": %.3f, \"args\": {\"bytes\": %llu}}",
+                end, (unsigned long long)span->peak_memory);
+    }
+    fprintf(out, "\n]}\n");
+}
+
+ArkLinkResult arklink_stats_write(const ArkLinkStats* stats, ArkLinkStatsFormat format, const char* path) {
+    if (!stats) {
+        return ARK_LINK_ERR_INVALID_ARGUMENT;
+    }
+    FILE* out = path ? fopen(path, "w") : stderr;
+    if (!out) {
+        return ARK_LINK_ERR_IO;
+    }
+    switch (format) {
+    case ARK_LINK_STATS_JSON:
+        ark_stats_write_json(stats, out);
+        break;
+    case ARK_LINK_STATS_TRACE:
+        ark_stats_write_trace(stats, out);
+        break;
+    case ARK_LINK_STATS_TEXT:
+    default:
+        ark_stats_write_text(stats, out);
+        break;
+    }
+    if (!path) {
+        fflush(out);
+        return ARK_LINK_OK;
+    }
+    return fclose(out) == 0 ? ARK_LINK_OK : ARK_LINK_ERR_IO;
+}
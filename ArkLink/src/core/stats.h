@@ -0,0 +1,44 @@
+#ifndef ARK_STATS_H
+#define ARK_STATS_H
+
+#include "ArkLink/arklink.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ARK_STATS_MAX_DEPTH 8
+
+
+typedef struct ArkStatsRecorder {
+    ArkLinkStats* stats;
+    uint64_t origin;
+    uint64_t mark;
+    ArkLinkPhase phases[ARK_STATS_MAX_DEPTH];
+    uint64_t starts[ARK_STATS_MAX_DEPTH];
+    size_t spans[ARK_STATS_MAX_DEPTH];
+    size_t depth;
+} ArkStatsRecorder;
+
+
+uint64_t ark_stats_clock_ns(void);
+
+
+uint64_t ark_stats_peak_memory(void);
+
+
+
+void ark_stats_recorder_init(ArkStatsRecorder* recorder, ArkLinkStats* stats);
+void ark_stats_recorder_begin(ArkStatsRecorder* recorder, ArkLinkPhase phase);
+void ark_stats_recorder_end(ArkStatsRecorder* recorder, ArkLinkPhase phase);
+
+
+void ark_stats_recorder_finish(ArkStatsRecorder* recorder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -42,7 +42,13 @@ typedef enum {
     
     OP_INT_TO_STRING, 
     
-    OP_HALT
+    OP_HALT,
+    
+    OP_ADD_LOCAL_CONST,
+    OP_INC_LOCAL,
+    OP_LESS_JUMP_IF_FALSE,
+    
+    OP_CONSTANT_LONG
 } EsOpCode;
 
 typedef enum {
@@ -1,4 +1,5 @@
 #include "bytecode_generator.h"
+#include "ebc_format.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -44,8 +45,20 @@ void es_bytecode_generator_write_byte(EsChunk* chunk, uint8_t byte, int line) {
 }
 
 void es_bytecode_generator_write_short(EsChunk* chunk, uint16_t value) {
-    es_bytecode_generator_write_byte(chunk, (uint8_t)(value & 0xFF), 0);
     es_bytecode_generator_write_byte(chunk, (uint8_t)((value >> 8) & 0xFF), 0);
+    es_bytecode_generator_write_byte(chunk, (uint8_t)(value & 0xFF), 0);
+}
+
+void es_bytecode_generator_write_constant(EsChunk* chunk, int constant, int line) {
+    if (constant < 256) {
+        es_bytecode_generator_write_byte(chunk, OP_CONSTANT, line);
+        es_bytecode_generator_write_byte(chunk, (uint8_t)constant, line);
+        return;
+    }
+    es_bytecode_generator_write_byte(chunk, OP_CONSTANT_LONG, line);
+    es_bytecode_generator_write_byte(chunk, (uint8_t)((constant >> 16) & 0xFF), line);
+    es_bytecode_generator_write_byte(chunk, (uint8_t)((constant >> 8) & 0xFF), line);
+    es_bytecode_generator_write_byte(chunk, (uint8_t)(constant & 0xFF), line);
 }
 
 int es_bytecode_generator_add_constant(EsChunk* chunk, EsValue value) {
@@ -73,41 +86,83 @@ void es_bytecode_generator_free_chunk(EsChunk* chunk) {
     es_bytecode_generator_init_chunk(chunk);
 }
 
+static uint32_t align_up(uint32_t value, uint32_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static uint32_t count_line_runs(EsChunk* chunk) {
+    uint32_t runs = 0;
+    for (int i = 0; i < chunk->count; i++) {
+        if (i == 0 || chunk->lines[i] != chunk->lines[i - 1]) {
+            runs++;
+        }
+    }
+    return runs;
+}
+
 bool es_bytecode_generator_serialize_to_file(EsChunk* chunk, const char* filename) {
-    FILE* file = fopen(filename, "wb");
-    if (!file) {
+    uint32_t line_run_count = count_line_runs(chunk);
+    uint32_t strings_size = 0;
+    for (int i = 0; i < chunk->constants.count; i++) {
+        if (chunk->constants.values[i].type == VAL_STRING_LITERAL) {
+            strings_size += (uint32_t)strlen(chunk->constants.values[i].as.string_literal) + 1;
+        }
+    }
+
+    EsEbcHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = ES_EBC_MAGIC;
+    header.version = ES_EBC_VERSION_MAPPED;
+    header.page_size = ES_EBC_PAGE_SIZE;
+    header.code_offset = ES_EBC_PAGE_SIZE;
+    header.code_size = (uint32_t)chunk->count;
+    header.lines_offset = align_up(header.code_offset + header.code_size, ES_EBC_SECTION_ALIGN);
+    header.line_run_count = line_run_count;
+    header.constants_offset = align_up(header.lines_offset + line_run_count * sizeof(EsEbcLineRun), ES_EBC_SECTION_ALIGN);
+    header.constant_count = (uint32_t)chunk->constants.count;
+    header.strings_offset = header.constants_offset + header.constant_count * sizeof(EsEbcConstant);
+    header.strings_size = strings_size;
+    header.file_size = align_up(header.strings_offset + strings_size, ES_EBC_SECTION_ALIGN);
+
+    uint8_t* image = calloc(1, header.file_size);
+    if (!image) {
         return false;
     }
-    
-    uint32_t magic = 0x45534243;
-    uint16_t version = 1;
-    fwrite(&magic, sizeof(uint32_t), 1, file);
-    fwrite(&version, sizeof(uint16_t), 1, file);
-    
-    uint32_t code_count = chunk->count;
-    fwrite(&code_count, sizeof(uint32_t), 1, file);
-    if (code_count > 0) {
-        fwrite(chunk->code, sizeof(uint8_t), code_count, file);
-        fwrite(chunk->lines, sizeof(int), code_count, file);
+    memcpy(image, &header, sizeof(header));
+    if (chunk->count > 0) {
+        memcpy(image + header.code_offset, chunk->code, chunk->count);
     }
-    
-    uint32_t constant_count = chunk->constants.count;
-    fwrite(&constant_count, sizeof(uint32_t), 1, file);
-    for (int i = 0; i < constant_count; i++) {
+
+    EsEbcLineRun* runs = (EsEbcLineRun*)(image + header.lines_offset);
+    int run = -1;
+    for (int i = 0; i < chunk->count; i++) {
+        if (i == 0 || chunk->lines[i] != chunk->lines[i - 1]) {
+            run++;
+            runs[run].line = (uint32_t)chunk->lines[i];
+            runs[run].count = 0;
+        }
+        runs[run].count++;
+    }
+
+    EsEbcConstant* constants = (EsEbcConstant*)(image + header.constants_offset);
+    char* strings = (char*)(image + header.strings_offset);
+    uint32_t string_cursor = 0;
+    for (int i = 0; i < chunk->constants.count; i++) {
         EsValue value = chunk->constants.values[i];
-        fwrite(&value.type, sizeof(EsValueType), 1, file);
-        
+        constants[i].type = (uint32_t)value.type;
         switch (value.type) {
             case VAL_BOOL:
-                fwrite(&value.as.boolean, sizeof(bool), 1, file);
+                constants[i].as.boolean = value.as.boolean ? 1 : 0;
                 break;
             case VAL_NUMBER:
-                fwrite(&value.as.number, sizeof(double), 1, file);
+                constants[i].as.number = value.as.number;
                 break;
             case VAL_STRING_LITERAL: {
-                uint16_t length = strlen(value.as.string_literal);
-                fwrite(&length, sizeof(uint16_t), 1, file);
-                fwrite(value.as.string_literal, sizeof(char), length, file);
+                uint32_t length = (uint32_t)strlen(value.as.string_literal);
+                constants[i].length = length;
+                constants[i].as.string_offset = string_cursor;
+                memcpy(strings + string_cursor, value.as.string_literal, length + 1);
+                string_cursor += length + 1;
                 break;
             }
             case VAL_NULL:
@@ -115,7 +170,14 @@ bool es_bytecode_generator_serialize_to_file(EsChunk* chunk, const char* filenam
                 break;
         }
     }
-    
-    fclose(file);
-    return true;
-}
\ No newline at end of file
+
+    FILE* file = fopen(filename, "wb");
+    if (!file) {
+        free(image);
+        return false;
+    }
+    bool ok = fwrite(image, 1, header.file_size, file) == header.file_size;
+    ok = fclose(file) == 0 && ok;
+    free(image);
+    return ok;
+}
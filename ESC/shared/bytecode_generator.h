@@ -8,6 +8,7 @@ void es_bytecode_generator_destroy(EsBytecodeGenerator* generator);
 void es_bytecode_generator_init_chunk(EsChunk* chunk);
 void es_bytecode_generator_write_byte(EsChunk* chunk, uint8_t byte, int line);
 void es_bytecode_generator_write_short(EsChunk* chunk, uint16_t value);
+void es_bytecode_generator_write_constant(EsChunk* chunk, int constant, int line);
 int es_bytecode_generator_add_constant(EsChunk* chunk, EsValue value);
 int es_bytecode_generator_add_string_constant(EsChunk* chunk, const char* string);
 void es_bytecode_generator_free_chunk(EsChunk* chunk);
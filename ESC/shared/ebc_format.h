@@ -0,0 +1,47 @@
+#ifndef ES_EBC_FORMAT_H
+#define ES_EBC_FORMAT_H
+
+#include <stdint.h>
+
+#define ES_EBC_MAGIC 0x45534243
+#define ES_EBC_VERSION_STREAM 1
+#define ES_EBC_VERSION_MAPPED 2
+#define ES_EBC_PAGE_SIZE 4096
+#define ES_EBC_SECTION_ALIGN 8
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+    uint32_t page_size;
+    uint32_t file_size;
+    uint32_t code_offset;
+    uint32_t code_size;
+    uint32_t lines_offset;
+    uint32_t line_run_count;
+    uint32_t constants_offset;
+    uint32_t constant_count;
+    uint32_t strings_offset;
+    uint32_t strings_size;
+    uint32_t reserved[4];
+} EsEbcHeader;
+
+typedef struct {
+    uint32_t line;
+    uint32_t count;
+} EsEbcLineRun;
+
+typedef struct {
+    uint32_t type;
+    uint32_t length;
+    union {
+        double number;
+        uint64_t boolean;
+        uint64_t string_offset;
+    } as;
+} EsEbcConstant;
+
+typedef char es_ebc_header_size_check[sizeof(EsEbcHeader) == 64 ? 1 : -1];
+typedef char es_ebc_constant_size_check[sizeof(EsEbcConstant) == 16 ? 1 : -1];
+
+#endif
@@ -34,7 +34,10 @@ typedef struct {
     PendingJump* pending_jumps;
     int pending_jump_count;
     int pending_jump_capacity;
-    int next_temp_index;
+    int* temp_slots;
+    int* temp_uses;
+    int temp_capacity;
+    int slot_count;
 } CodegenContext;
 
 static void init_context(CodegenContext* ctx, EsIRModule* module) {
@@ -49,13 +52,18 @@ static void init_context(CodegenContext* ctx, EsIRModule* module) {
     ctx->pending_jumps = NULL;
     ctx->pending_jump_count = 0;
     ctx->pending_jump_capacity = 0;
-    ctx->next_temp_index = 1000; 
+    ctx->temp_slots = NULL;
+    ctx->temp_uses = NULL;
+    ctx->temp_capacity = 0;
+    ctx->slot_count = 0;
 }
 
 static void free_context(CodegenContext* ctx) {
     ES_FREE(ctx->locals);
     ES_FREE(ctx->labels);
     ES_FREE(ctx->pending_jumps);
+    ES_FREE(ctx->temp_slots);
+    ES_FREE(ctx->temp_uses);
 }
 
 static int get_local_index(CodegenContext* ctx, const char* name) {
@@ -64,68 +72,185 @@ static int get_local_index(CodegenContext* ctx, const char* name) {
             return ctx->locals[i].index;
         }
     }
-    
-    
+
+
     if (ctx->local_count >= ctx->local_capacity) {
         int old_capacity = ctx->local_capacity;
         ctx->local_capacity = old_capacity < 8 ? 8 : old_capacity * 2;
-        ctx->locals = realloc(ctx->locals, ctx->local_capacity * sizeof(LocalMapping));
+        ctx->locals = ES_REALLOC(ctx->locals, ctx->local_capacity * sizeof(LocalMapping));
     }
-    
-    int index = ctx->local_count;
+
+    int index = ctx->slot_count++;
     ctx->locals[ctx->local_count].name = name;
     ctx->locals[ctx->local_count].index = index;
     ctx->local_count++;
-    
+
     return index;
 }
 
+static void ensure_temp_capacity(CodegenContext* ctx, int temp_id) {
+    if (temp_id < ctx->temp_capacity) {
+        return;
+    }
+    int old_capacity = ctx->temp_capacity;
+    int new_capacity = old_capacity < 16 ? 16 : old_capacity;
+    while (new_capacity <= temp_id) {
+        new_capacity *= 2;
+    }
+    ctx->temp_slots = ES_REALLOC(ctx->temp_slots, new_capacity * sizeof(int));
+    ctx->temp_uses = ES_REALLOC(ctx->temp_uses, new_capacity * sizeof(int));
+    for (int i = old_capacity; i < new_capacity; i++) {
+        ctx->temp_slots[i] = -1;
+        ctx->temp_uses[i] = 0;
+    }
+    ctx->temp_capacity = new_capacity;
+}
+
 static int get_temp_index(CodegenContext* ctx, int temp_id) {
-    printf("get_temp_index: temp_id=%d, local_count=%d\n", temp_id, ctx->local_count);
-    
-    return ctx->local_count + temp_id;
+    ensure_temp_capacity(ctx, temp_id);
+    if (ctx->temp_slots[temp_id] < 0) {
+        ctx->temp_slots[temp_id] = ctx->slot_count++;
+    }
+    return ctx->temp_slots[temp_id];
+}
+
+static int get_value_slot(CodegenContext* ctx, EsIRValue val) {
+    switch (val.type) {
+        case ES_IR_VALUE_VAR:
+            return get_local_index(ctx, val.data.name);
+        case ES_IR_VALUE_TEMP:
+            return get_temp_index(ctx, val.data.index);
+        case ES_IR_VALUE_ARG:
+            return val.data.index;
+        default:
+            return -1;
+    }
+}
+
+static void count_temp_uses(CodegenContext* ctx, EsIRFunction* func) {
+    for (EsIRBasicBlock* block = func->entry_block; block; block = block->next) {
+        for (EsIRInst* inst = block->first_inst; inst; inst = inst->next) {
+            for (int i = 0; i < inst->operand_count; i++) {
+                if (inst->operands[i].type == ES_IR_VALUE_TEMP) {
+                    int temp_id = inst->operands[i].data.index;
+                    ensure_temp_capacity(ctx, temp_id);
+                    ctx->temp_uses[temp_id]++;
+                }
+            }
+        }
+    }
+}
+
+static bool is_single_use_temp(CodegenContext* ctx, EsIRValue val) {
+    return val.type == ES_IR_VALUE_TEMP &&
+           val.data.index < ctx->temp_capacity &&
+           ctx->temp_uses[val.data.index] == 1;
+}
+
+static bool is_slot_value(EsIRValue val) {
+    return val.type == ES_IR_VALUE_VAR || val.type == ES_IR_VALUE_TEMP || val.type == ES_IR_VALUE_ARG;
+}
+
+static bool is_imm(EsIRValue val) {
+    return val.type == ES_IR_VALUE_IMM;
+}
+
+static int find_label(CodegenContext* ctx, const char* name) {
+    for (int i = 0; i < ctx->label_count; i++) {
+        if (strcmp(ctx->labels[i].name, name) == 0) {
+            return ctx->labels[i].address;
+        }
+    }
+    return -1;
+}
+
+static void define_label(CodegenContext* ctx, const char* name, int address) {
+    if (!name) {
+        return;
+    }
+    if (ctx->label_count >= ctx->label_capacity) {
+        int old_capacity = ctx->label_capacity;
+        ctx->label_capacity = old_capacity < 8 ? 8 : old_capacity * 2;
+        ctx->labels = ES_REALLOC(ctx->labels, ctx->label_capacity * sizeof(LabelMapping));
+    }
+    ctx->labels[ctx->label_count].name = name;
+    ctx->labels[ctx->label_count].address = address;
+    ctx->label_count++;
+}
+
+static void add_pending_jump(CodegenContext* ctx, const char* label, int address) {
+    if (ctx->pending_jump_count >= ctx->pending_jump_capacity) {
+        int old_capacity = ctx->pending_jump_capacity;
+        ctx->pending_jump_capacity = old_capacity < 8 ? 8 : old_capacity * 2;
+        ctx->pending_jumps = ES_REALLOC(ctx->pending_jumps, ctx->pending_jump_capacity * sizeof(PendingJump));
+    }
+    ctx->pending_jumps[ctx->pending_jump_count].label_name = label;
+    ctx->pending_jumps[ctx->pending_jump_count].jump_inst_address = address;
+    ctx->pending_jump_count++;
+}
+
+static void emit_jump_to(CodegenContext* ctx, EsChunk* chunk, const char* label) {
+    int target = find_label(ctx, label);
+    if (target >= 0) {
+        es_bytecode_generator_write_byte(chunk, OP_LOOP, 0);
+        es_bytecode_generator_write_short(chunk, (uint16_t)(chunk->count + 2 - target));
+        return;
+    }
+    add_pending_jump(ctx, label, chunk->count);
+    es_bytecode_generator_write_byte(chunk, OP_JUMP, 0);
+    es_bytecode_generator_write_short(chunk, 0xFFFF);
+}
+
+static void emit_cond_jump_to(CodegenContext* ctx, EsChunk* chunk, uint8_t op, const char* label) {
+    if (find_label(ctx, label) >= 0) {
+        es_bytecode_generator_write_byte(chunk, op, 0);
+        es_bytecode_generator_write_short(chunk, 3);
+        es_bytecode_generator_write_byte(chunk, OP_JUMP, 0);
+        es_bytecode_generator_write_short(chunk, 3);
+        emit_jump_to(ctx, chunk, label);
+        return;
+    }
+    add_pending_jump(ctx, label, chunk->count);
+    es_bytecode_generator_write_byte(chunk, op, 0);
+    es_bytecode_generator_write_short(chunk, 0xFFFF);
+}
+
+static void patch_pending_jumps(CodegenContext* ctx, EsChunk* chunk) {
+    for (int i = 0; i < ctx->pending_jump_count; i++) {
+        PendingJump* jump = &ctx->pending_jumps[i];
+        int target = find_label(ctx, jump->label_name);
+        if (target < 0) {
+            ES_ERROR("VM codegen: undefined label '%s'", jump->label_name);
+            continue;
+        }
+        int offset = target - (jump->jump_inst_address + 3);
+        chunk->code[jump->jump_inst_address + 1] = (uint8_t)((offset >> 8) & 0xFF);
+        chunk->code[jump->jump_inst_address + 2] = (uint8_t)(offset & 0xFF);
+    }
 }
 
 static void emit_value_push(CodegenContext* ctx, EsChunk* chunk, EsIRValue val) {
-    printf("emit_value_push: val.type=%d\n", val.type);
     switch (val.type) {
         case ES_IR_VALUE_IMM: {
-            printf("emit_value_push: ES_IR_VALUE_IMM, imm=%f\n", val.data.imm);
             int constant = es_bytecode_generator_add_constant(chunk, NUMBER_VAL(val.data.imm));
-            es_bytecode_generator_write_byte(chunk, OP_CONSTANT, 0);
-            es_bytecode_generator_write_byte(chunk, (uint8_t)constant, 0);
-            break;
-        }
-        case ES_IR_VALUE_VAR: {
-            printf("emit_value_push: ES_IR_VALUE_VAR, name=%s\n", val.data.name);
-            int index = get_local_index(ctx, val.data.name);
-            es_bytecode_generator_write_byte(chunk, OP_GET_LOCAL, 0);
-            es_bytecode_generator_write_byte(chunk, (uint8_t)index, 0);
+            es_bytecode_generator_write_constant(chunk, constant, 0);
             break;
         }
-        case ES_IR_VALUE_TEMP: {
-            printf("emit_value_push: ES_IR_VALUE_TEMP, index=%d\n", val.data.index);
-            
-            int index = get_temp_index(ctx, val.data.index);
+        case ES_IR_VALUE_VAR:
+        case ES_IR_VALUE_TEMP:
+        case ES_IR_VALUE_ARG: {
+            int index = get_value_slot(ctx, val);
             es_bytecode_generator_write_byte(chunk, OP_GET_LOCAL, 0);
             es_bytecode_generator_write_byte(chunk, (uint8_t)index, 0);
             break;
         }
         case ES_IR_VALUE_STRING_CONST: {
-            printf("emit_value_push: ES_IR_VALUE_STRING_CONST, string_const_id=%d\n", val.data.string_const_id);
             if (!ctx->module->string_constants || val.data.string_const_id < 0 || val.data.string_const_id >= ctx->module->string_const_count) {
                 break;
             }
             const char* str = ctx->module->string_constants[val.data.string_const_id];
             int constant = es_bytecode_generator_add_string_constant(chunk, str);
-            es_bytecode_generator_write_byte(chunk, OP_CONSTANT, 0);
-            es_bytecode_generator_write_byte(chunk, (uint8_t)constant, 0);
-            break;
-        }
-        case ES_IR_VALUE_ARG: {
-            
-            es_bytecode_generator_write_byte(chunk, OP_GET_LOCAL, 0);
-            es_bytecode_generator_write_byte(chunk, (uint8_t)val.data.index, 0);
+            es_bytecode_generator_write_constant(chunk, constant, 0);
             break;
         }
         default:
@@ -134,64 +259,84 @@ static void emit_value_push(CodegenContext* ctx, EsChunk* chunk, EsIRValue val)
     }
 }
 
-static void emit_binary_op(CodegenContext* ctx, EsChunk* chunk, EsIRInst* inst, EsOpCode op) {
-    printf("emit_binary_op: starting\n");
-    
-    
-    printf("emit_binary_op: writing operation opcode\n");
-    es_bytecode_generator_write_byte(chunk, op, 0);
-    
-    
-    if (inst->result.type != ES_IR_VALUE_VOID) {
-        printf("emit_binary_op: storing result, result.type=%d\n", inst->result.type);
-        int index;
-        if (inst->result.type == ES_IR_VALUE_TEMP) {
-            index = get_temp_index(ctx, inst->result.data.index);
-        } else {
-            index = get_local_index(ctx, inst->result.data.name);
-        }
-        es_bytecode_generator_write_byte(chunk, OP_SET_LOCAL, 0);
-        es_bytecode_generator_write_byte(chunk, (uint8_t)index, 0);
-        es_bytecode_generator_write_byte(chunk, OP_POP, 0); 
+static void emit_store_top(CodegenContext* ctx, EsChunk* chunk, EsIRValue dest) {
+    if (!is_slot_value(dest)) {
+        es_bytecode_generator_write_byte(chunk, OP_POP, 0);
+        return;
     }
-    printf("emit_binary_op: done\n");
+    int index = get_value_slot(ctx, dest);
+    es_bytecode_generator_write_byte(chunk, OP_SET_LOCAL, 0);
+    es_bytecode_generator_write_byte(chunk, (uint8_t)index, 0);
+    es_bytecode_generator_write_byte(chunk, OP_POP, 0);
 }
 
-static void emit_assignment(CodegenContext* ctx, EsChunk* chunk, EsIRInst* inst) {
-    
-    emit_value_push(ctx, chunk, inst->operands[0]);
-    
-    
-    if (inst->result.type == ES_IR_VALUE_VAR) {
-        int dest_index = get_local_index(ctx, inst->result.data.name);
-        es_bytecode_generator_write_byte(chunk, OP_SET_LOCAL, 0);
-        es_bytecode_generator_write_byte(chunk, (uint8_t)dest_index, 0);
-        es_bytecode_generator_write_byte(chunk, OP_POP, 0);
-    } else if (inst->result.type == ES_IR_VALUE_TEMP) {
-        int dest_index = get_temp_index(ctx, inst->result.data.index);
+static void emit_add_local_const(CodegenContext* ctx, EsChunk* chunk, EsIRValue dest, EsIRValue src, double imm) {
+    int dest_slot = get_value_slot(ctx, dest);
+    int src_slot = get_value_slot(ctx, src);
+    if (dest_slot == src_slot && imm == 1.0) {
+        es_bytecode_generator_write_byte(chunk, OP_INC_LOCAL, 0);
+        es_bytecode_generator_write_byte(chunk, (uint8_t)dest_slot, 0);
+        return;
+    }
+    int constant = es_bytecode_generator_add_constant(chunk, NUMBER_VAL(imm));
+    if (constant > 255) {
+        es_bytecode_generator_write_byte(chunk, OP_GET_LOCAL, 0);
+        es_bytecode_generator_write_byte(chunk, (uint8_t)src_slot, 0);
+        es_bytecode_generator_write_constant(chunk, constant, 0);
+        es_bytecode_generator_write_byte(chunk, OP_ADD, 0);
         es_bytecode_generator_write_byte(chunk, OP_SET_LOCAL, 0);
-        es_bytecode_generator_write_byte(chunk, (uint8_t)dest_index, 0);
+        es_bytecode_generator_write_byte(chunk, (uint8_t)dest_slot, 0);
         es_bytecode_generator_write_byte(chunk, OP_POP, 0);
+        return;
     }
+    es_bytecode_generator_write_byte(chunk, OP_ADD_LOCAL_CONST, 0);
+    es_bytecode_generator_write_byte(chunk, (uint8_t)dest_slot, 0);
+    es_bytecode_generator_write_byte(chunk, (uint8_t)src_slot, 0);
+    es_bytecode_generator_write_byte(chunk, (uint8_t)constant, 0);
+}
+
+static void emit_binary_op(CodegenContext* ctx, EsChunk* chunk, EsIRInst* inst, EsOpCode op) {
+    if (inst->operand_count >= 2) {
+        emit_value_push(ctx, chunk, inst->operands[0]);
+        emit_value_push(ctx, chunk, inst->operands[1]);
+    }
+    es_bytecode_generator_write_byte(chunk, op, 0);
+    emit_store_top(ctx, chunk, inst->result);
+}
+
+static void emit_assignment(CodegenContext* ctx, EsChunk* chunk, EsIRInst* inst) {
+    if (inst->operand_count < 2) {
+        return;
+    }
+    emit_value_push(ctx, chunk, inst->operands[1]);
+    emit_store_top(ctx, chunk, inst->operands[0]);
+}
+
+static void emit_move(CodegenContext* ctx, EsChunk* chunk, EsIRInst* inst) {
+    if (inst->operand_count < 1 || inst->result.type == ES_IR_VALUE_VOID) {
+        return;
+    }
+    emit_value_push(ctx, chunk, inst->operands[0]);
+    emit_store_top(ctx, chunk, inst->result);
 }
 
 static void emit_function_call(CodegenContext* ctx, EsChunk* chunk, EsIRInst* inst) {
-    
+
     for (int i = inst->operand_count - 1; i >= 0; i--) {
         emit_value_push(ctx, chunk, inst->operands[i]);
     }
-    
-    
+
+
     es_bytecode_generator_write_byte(chunk, OP_CALL, 0);
     es_bytecode_generator_write_byte(chunk, (uint8_t)(inst->operand_count - 1), 0);
-    
-    
+
+
     if (inst->result.type != ES_IR_VALUE_VOID) {
         if (inst->result.type == ES_IR_VALUE_VAR) {
             int dest_index = get_local_index(ctx, inst->result.data.name);
             es_bytecode_generator_write_byte(chunk, OP_SET_LOCAL, 0);
             es_bytecode_generator_write_byte(chunk, (uint8_t)dest_index, 0);
-            es_bytecode_generator_write_byte(chunk, OP_POP, 0); 
+            es_bytecode_generator_write_byte(chunk, OP_POP, 0);
         }
         es_bytecode_generator_write_byte(chunk, OP_POP, 0);
     }
@@ -203,31 +348,92 @@ static void emit_return(CodegenContext* ctx, EsChunk* chunk, EsIRInst* inst) {
     } else {
         es_bytecode_generator_write_byte(chunk, OP_NULL, 0);
     }
-    
+
     es_bytecode_generator_write_byte(chunk, OP_RETURN, 0);
 }
 
+static void emit_branch(CodegenContext* ctx, EsChunk* chunk, EsIRBasicBlock* block, EsIRInst* inst, uint8_t jump_op) {
+    const char* true_label = inst->operands[1].data.name;
+    const char* false_label = inst->operands[2].data.name;
+    emit_cond_jump_to(ctx, chunk, jump_op, false_label);
+    if (!block->next || !block->next->label || strcmp(block->next->label, true_label) != 0) {
+        emit_jump_to(ctx, chunk, true_label);
+    }
+}
+
+static EsIRInst* try_emit_fused(CodegenContext* ctx, EsChunk* chunk, EsIRBasicBlock* block, EsIRInst* inst) {
+    EsIRInst* next = inst->next;
+
+    if (inst->opcode == ES_IR_LOAD && next && next->opcode == ES_IR_ADD &&
+        next->next && next->next->opcode == ES_IR_STORE &&
+        inst->operand_count >= 1 && next->operand_count >= 2 && next->next->operand_count >= 2) {
+        EsIRInst* add = next;
+        EsIRInst* store = next->next;
+        if (is_single_use_temp(ctx, inst->result) && is_single_use_temp(ctx, add->result) &&
+            add->operands[0].type == ES_IR_VALUE_TEMP && add->operands[0].data.index == inst->result.data.index &&
+            is_imm(add->operands[1]) &&
+            store->operands[1].type == ES_IR_VALUE_TEMP && store->operands[1].data.index == add->result.data.index &&
+            store->operands[0].type == ES_IR_VALUE_VAR && inst->operands[0].type == ES_IR_VALUE_VAR &&
+            strcmp(store->operands[0].data.name, inst->operands[0].data.name) == 0) {
+            emit_add_local_const(ctx, chunk, store->operands[0], inst->operands[0], add->operands[1].data.imm);
+            return store;
+        }
+    }
+
+    if (inst->opcode == ES_IR_LOAD && inst->operand_count >= 1 && next &&
+        inst->operands[0].type == ES_IR_VALUE_VAR && is_single_use_temp(ctx, inst->result)) {
+        for (int i = 0; i < next->operand_count; i++) {
+            if (next->operands[i].type == ES_IR_VALUE_TEMP && next->operands[i].data.index == inst->result.data.index) {
+                ctx->temp_slots[inst->result.data.index] = get_local_index(ctx, inst->operands[0].data.name);
+                return inst;
+            }
+        }
+    }
+
+    if (inst->opcode == ES_IR_ADD && inst->operand_count >= 2 && is_slot_value(inst->result)) {
+        if (is_slot_value(inst->operands[0]) && is_imm(inst->operands[1])) {
+            emit_add_local_const(ctx, chunk, inst->result, inst->operands[0], inst->operands[1].data.imm);
+            return inst;
+        }
+        if (is_imm(inst->operands[0]) && is_slot_value(inst->operands[1])) {
+            emit_add_local_const(ctx, chunk, inst->result, inst->operands[1], inst->operands[0].data.imm);
+            return inst;
+        }
+    }
+
+    if (inst->opcode == ES_IR_LT && inst->operand_count >= 2 && next && next->opcode == ES_IR_BRANCH &&
+        next->operand_count >= 3 && next->operands[0].type == ES_IR_VALUE_TEMP &&
+        inst->result.type == ES_IR_VALUE_TEMP && next->operands[0].data.index == inst->result.data.index &&
+        is_single_use_temp(ctx, inst->result)) {
+        emit_value_push(ctx, chunk, inst->operands[0]);
+        emit_value_push(ctx, chunk, inst->operands[1]);
+        emit_branch(ctx, chunk, block, next, OP_LESS_JUMP_IF_FALSE);
+        return next;
+    }
+
+    return NULL;
+}
+
 static void generate_function(CodegenContext* ctx, EsIRFunction* func, EsChunk* chunk) {
-    printf("generate_function: starting\n");
     ctx->current_function = func;
-    
-    
-    printf("generate_function: registering %d parameters\n", func->param_count);
+
+
     for (int i = 0; i < func->param_count; i++) {
-        printf("generate_function: registering parameter %d: %s\n", i, func->params[i].name);
         get_local_index(ctx, func->params[i].name);
     }
-    
-    
-    printf("generate_function: generating function body\n");
+    count_temp_uses(ctx, func);
+
+
     EsIRBasicBlock* block = func->entry_block;
-    int block_count = 0;
     while (block) {
-        printf("generate_function: processing block %d\n", block_count++);
+        define_label(ctx, block->label, chunk->count);
         EsIRInst* inst = block->first_inst;
-        int inst_count = 0;
         while (inst) {
-            printf("generate_function: processing instruction %d: opcode=%d\n", inst_count++, inst->opcode);
+            EsIRInst* fused_last = try_emit_fused(ctx, chunk, block, inst);
+            if (fused_last) {
+                inst = fused_last->next;
+                continue;
+            }
             switch (inst->opcode) {
                 case ES_IR_ADD:
                     emit_binary_op(ctx, chunk, inst, OP_ADD);
@@ -259,31 +465,33 @@ static void generate_function(CodegenContext* ctx, EsIRFunction* func, EsChunk*
                 case ES_IR_RETURN:
                     emit_return(ctx, chunk, inst);
                     break;
+                case ES_IR_JUMP:
+                    if (inst->operand_count >= 1 &&
+                        !(block->next && block->next->label && strcmp(block->next->label, inst->operands[0].data.name) == 0)) {
+                        emit_jump_to(ctx, chunk, inst->operands[0].data.name);
+                    }
+                    break;
+                case ES_IR_BRANCH:
+                    if (inst->operand_count >= 3) {
+                        emit_value_push(ctx, chunk, inst->operands[0]);
+                        emit_branch(ctx, chunk, block, inst, OP_JUMP_IF_FALSE);
+                    }
+                    break;
                 case ES_IR_INT_TO_STRING:
                     emit_value_push(ctx, chunk, inst->operands[0]);
                     es_bytecode_generator_write_byte(chunk, OP_INT_TO_STRING, 0);
-                    
-                    
-                    if (inst->result.type != ES_IR_VALUE_VOID) {
-                        int index = get_local_index(ctx, inst->result.data.name);
-                        es_bytecode_generator_write_byte(chunk, OP_SET_LOCAL, 0);
-                        es_bytecode_generator_write_byte(chunk, (uint8_t)index, 0);
-                        es_bytecode_generator_write_byte(chunk, OP_POP, 0); 
-                    }
+                    emit_store_top(ctx, chunk, inst->result);
                     break;
                 case ES_IR_ALLOC:
-                    
+
                     break;
                 case ES_IR_LOAD:
-                    
-                    emit_value_push(ctx, chunk, inst->operands[0]);
-                    break;
                 case ES_IR_IMM:
-                    
-                    emit_value_push(ctx, chunk, inst->operands[0]);
+                case ES_IR_COPY:
+                    emit_move(ctx, chunk, inst);
                     break;
                 default:
-                    
+
                     break;
             }
             inst = inst->next;
@@ -293,40 +501,29 @@ static void generate_function(CodegenContext* ctx, EsIRFunction* func, EsChunk*
 }
 
 void es_vm_codegen_generate(EsIRModule* ir_module, EsChunk* chunk) {
-    printf("es_vm_codegen_generate: starting\n");
-    
     CodegenContext ctx;
-    printf("es_vm_codegen_generate: initializing context\n");
     init_context(&ctx, ir_module);
-    
-    
-    printf("es_vm_codegen_generate: initializing chunk\n");
+
+
     es_bytecode_generator_init_chunk(chunk);
-    printf("es_vm_codegen_generate: chunk initialized\n");
-    
-    
+
+
     if (ir_module->main_function) {
-        printf("es_vm_codegen_generate: found main function\n");
         EsIRFunction* main_func = ir_module->main_function;
-        
-        
-        int local_count = main_func->param_count + 10; 
-        printf("es_vm_codegen_generate: writing STK_ADJ with local_count=%d\n", local_count);
+
+
         es_bytecode_generator_write_byte(chunk, OP_STK_ADJ, 0);
-        es_bytecode_generator_write_byte(chunk, local_count, 0);
-        
-        
-        printf("es_vm_codegen_generate: generating function body\n");
+        int slot_count_address = chunk->count;
+        es_bytecode_generator_write_byte(chunk, 0, 0);
+
+
         generate_function(&ctx, main_func, chunk);
-        printf("es_vm_codegen_generate: function body generated\n");
+        patch_pending_jumps(&ctx, chunk);
+        chunk->code[slot_count_address] = (uint8_t)(ctx.slot_count > 255 ? 255 : ctx.slot_count);
     }
-    
-    
-    printf("es_vm_codegen_generate: writing HALT\n");
+
+
     es_bytecode_generator_write_byte(chunk, OP_HALT, 0);
-    printf("es_vm_codegen_generate: HALT written\n");
-    
-    printf("es_vm_codegen_generate: freeing context\n");
+
     free_context(&ctx);
-    printf("es_vm_codegen_generate: done\n");
-}
\ No newline at end of file
+}
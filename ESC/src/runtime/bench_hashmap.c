@@ -0,0 +1,264 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "runtime.h"
+
+
+#define BENCH_DEFAULT_COUNT 20000
+#define BENCH_LEGACY_BUCKETS 16
+
+
+typedef struct LegacyItem {
+    void* key;
+    void* value;
+    ES_HashMapType key_type;
+    struct LegacyItem* next;
+} LegacyItem;
+
+typedef struct {
+    LegacyItem** buckets;
+    size_t capacity;
+    size_t size;
+} LegacyMap;
+
+
+static unsigned int legacy_hash(const void* key, ES_HashMapType type) {
+    if (type == ES_HASHMAP_TYPE_STRING) {
+        const char* str = (const char*)key;
+        unsigned int hash = 5381;
+        int c;
+        while ((c = *str++)) {
+            hash = ((hash << 5) + hash) + c;
+        }
+        return hash;
+    }
+    return (unsigned int)*(const int*)key;
+}
+
+static int legacy_equal(const LegacyItem* item, const void* key, ES_HashMapType type) {
+    if (item->key_type != type) return 0;
+    if (type == ES_HASHMAP_TYPE_STRING) {
+        return strcmp((const char*)item->key, (const char*)key) == 0;
+    }
+    return *(const int*)item->key == *(const int*)key;
+}
+
+static void* legacy_clone(const void* data, ES_HashMapType type) {
+    if (type == ES_HASHMAP_TYPE_STRING) {
+        size_t len = strlen((const char*)data) + 1;
+        char* copy = (char*)malloc(len);
+        if (copy) memcpy(copy, data, len);
+        return copy;
+    }
+    int* copy = (int*)malloc(sizeof(int));
+    if (copy) *copy = *(const int*)data;
+    return copy;
+}
+
+static LegacyMap* legacy_create(void) {
+    LegacyMap* map = (LegacyMap*)malloc(sizeof(LegacyMap));
+    if (!map) return NULL;
+    map->buckets = (LegacyItem**)calloc(BENCH_LEGACY_BUCKETS, sizeof(LegacyItem*));
+    if (!map->buckets) {
+        free(map);
+        return NULL;
+    }
+    map->capacity = BENCH_LEGACY_BUCKETS;
+    map->size = 0;
+    return map;
+}
+
+static void legacy_destroy(LegacyMap* map) {
+    for (size_t i = 0; i < map->capacity; i++) {
+        LegacyItem* item = map->buckets[i];
+        while (item) {
+            LegacyItem* next = item->next;
+            free(item->key);
+            free(item->value);
+            free(item);
+            item = next;
+        }
+    }
+    free(map->buckets);
+    free(map);
+}
+
+static int legacy_put(LegacyMap* map, const void* key, ES_HashMapType key_type, int value) {
+    size_t index = legacy_hash(key, key_type) % map->capacity;
+    LegacyItem* item = map->buckets[index];
+
+    while (item) {
+        if (legacy_equal(item, key, key_type)) {
+            free(item->value);
+            item->value = legacy_clone(&value, ES_HASHMAP_TYPE_INT);
+            return item->value ? 0 : -1;
+        }
+        item = item->next;
+    }
+
+    item = (LegacyItem*)malloc(sizeof(LegacyItem));
+    if (!item) return -1;
+    item->key = legacy_clone(key, key_type);
+    item->value = legacy_clone(&value, ES_HASHMAP_TYPE_INT);
+    item->key_type = key_type;
+    item->next = map->buckets[index];
+    map->buckets[index] = item;
+    map->size++;
+    return 0;
+}
+
+static int legacy_get(LegacyMap* map, const void* key, ES_HashMapType key_type, int* out_value) {
+    size_t index = legacy_hash(key, key_type) % map->capacity;
+
+    for (LegacyItem* item = map->buckets[index]; item; item = item->next) {
+        if (legacy_equal(item, key, key_type)) {
+            int* copy = (int*)legacy_clone(item->value, ES_HASHMAP_TYPE_INT);
+            if (!copy) return -1;
+            *out_value = *copy;
+            free(copy);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+
+static double bench_rate(int count, clock_t start, clock_t end) {
+    double seconds = (double)(end - start) / CLOCKS_PER_SEC;
+    if (seconds <= 0.0) seconds = 1.0 / CLOCKS_PER_SEC;
+    return (double)count / seconds / 1e6;
+}
+
+static void bench_report(const char* name, const char* op, int count,
+                         clock_t start, clock_t end, long long checksum) {
+    printf("%-8s %-16s %10.3f M ops/s  (checksum %lld)\n",
+           name, op, bench_rate(count, start, end), checksum);
+}
+
+static void bench_legacy(int count) {
+    LegacyMap* map = legacy_create();
+    char key[32];
+    long long checksum = 0;
+    int value;
+
+    if (!map) return;
+
+    clock_t start = clock();
+    for (int i = 0; i < count; i++) {
+        legacy_put(map, &i, ES_HASHMAP_TYPE_INT, i);
+    }
+    clock_t end = clock();
+    bench_report("chained", "int put", count, start, end, (long long)map->size);
+
+    start = clock();
+    for (int i = 0; i < count; i++) {
+        if (legacy_get(map, &i, ES_HASHMAP_TYPE_INT, &value) == 0) checksum += value;
+    }
+    end = clock();
+    bench_report("chained", "int get", count, start, end, checksum);
+
+    start = clock();
+    for (int i = 0; i < count; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        legacy_put(map, key, ES_HASHMAP_TYPE_STRING, i);
+    }
+    end = clock();
+    bench_report("chained", "string put", count, start, end, (long long)map->size);
+
+    checksum = 0;
+    start = clock();
+    for (int i = 0; i < count; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        if (legacy_get(map, key, ES_HASHMAP_TYPE_STRING, &value) == 0) checksum += value;
+    }
+    end = clock();
+    bench_report("chained", "string get", count, start, end, checksum);
+
+    legacy_destroy(map);
+}
+
+static void bench_current(int count) {
+    ES_HashMap* map = hashmap_create(0);
+    char key[32];
+    long long checksum = 0;
+    void* out;
+    ES_HashMapType out_type;
+    int value;
+
+    if (!map) return;
+
+    clock_t start = clock();
+    for (int i = 0; i < count; i++) {
+        hashmap_put(map, &i, ES_HASHMAP_TYPE_INT, &i, ES_HASHMAP_TYPE_INT);
+    }
+    clock_t end = clock();
+    bench_report("open", "int put", count, start, end, (long long)map->size);
+
+    start = clock();
+    for (int i = 0; i < count; i++) {
+        if (hashmap_get(map, &i, ES_HASHMAP_TYPE_INT, &out, &out_type) == 0) {
+            checksum += *(int*)out;
+            es_free(out);
+        }
+    }
+    end = clock();
+    bench_report("open", "int get", count, start, end, checksum);
+
+    start = clock();
+    for (int i = 0; i < count; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        hashmap_put(map, key, ES_HASHMAP_TYPE_STRING, &i, ES_HASHMAP_TYPE_INT);
+    }
+    end = clock();
+    bench_report("open", "string put", count, start, end, (long long)map->size);
+
+    checksum = 0;
+    start = clock();
+    for (int i = 0; i < count; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        if (hashmap_get(map, key, ES_HASHMAP_TYPE_STRING, &out, &out_type) == 0) {
+            checksum += *(int*)out;
+            es_free(out);
+        }
+    }
+    end = clock();
+    bench_report("open", "string get", count, start, end, checksum);
+
+    hashmap_ES_FREE(map);
+
+    map = hashmap_create(0);
+    if (!map) return;
+
+    start = clock();
+    for (int i = 0; i < count; i++) {
+        hashmap_put_int(map, i, i);
+    }
+    end = clock();
+    bench_report("open", "int put (typed)", count, start, end, (long long)map->size);
+
+    checksum = 0;
+    start = clock();
+    for (int i = 0; i < count; i++) {
+        if (hashmap_get_int(map, i, &value) == 0) checksum += value;
+    }
+    end = clock();
+    bench_report("open", "int get (typed)", count, start, end, checksum);
+
+    hashmap_ES_FREE(map);
+}
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_COUNT;
+
+    if (count <= 0) {
+        fprintf(stderr, "usage: %s [count]\n", argv[0]);
+        return 1;
+    }
+
+    printf("ES_HashMap benchmark, %d entries per phase\n", count);
+    bench_legacy(count);
+    bench_current(count);
+    return 0;
+}
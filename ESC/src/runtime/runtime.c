@@ -9,6 +9,7 @@
 #if !defined(_WIN32) && !defined(__MINGW32__)
 #include <sys/types.h>
 #include <sys/sysinfo.h>
+#include <sched.h>
 #include <unistd.h>
 #endif
 
@@ -37,54 +38,244 @@ extern int memcmp(const void *s1, const void *s2, size_t n);
 #endif
 
 
-ES_RUNTIME_EXPORT void ES_API _print_string(const char* str) {
-    if (!str) return;
-    
+#define ES_OUTPUT_BUFFER_SIZE 8192
+#define ES_OUTPUT_MAX_BUFFERS 64
+
+#if defined(_MSC_VER)
+    #define ES_THREAD_LOCAL __declspec(thread)
+    #define es_output_try_claim(flag) (InterlockedCompareExchange((volatile LONG*)(flag), 1, 0) == 0)
+    #define es_output_release(flag) InterlockedExchange((volatile LONG*)(flag), 0)
+    #define es_output_load(flag) InterlockedCompareExchange((volatile LONG*)(flag), 0, 0)
+#else
+    #define ES_THREAD_LOCAL __thread
+    #define es_output_try_claim(flag) __sync_bool_compare_and_swap((flag), 0, 1)
+    #define es_output_release(flag) __sync_lock_release(flag)
+    #define es_output_load(flag) __sync_fetch_and_add((flag), 0)
+#endif
+
 #ifdef _WIN32
+    #define es_output_yield() SwitchToThread()
+#else
+    #define es_output_yield() sched_yield()
+#endif
+
+typedef struct {
+    char data[ES_OUTPUT_BUFFER_SIZE];
+    size_t length;
+    volatile long in_use;
+    volatile long locked;
+} EsOutputBuffer;
+
+static EsOutputBuffer es_output_buffers[ES_OUTPUT_MAX_BUFFERS];
+static ES_THREAD_LOCAL EsOutputBuffer* es_output_current = NULL;
+static ES_THREAD_LOCAL int es_output_unbuffered = 0;
+static volatile long es_output_exit_registered = 0;
+static ES_THREAD_LOCAL int es_output_is_tty = -1;
+
+#ifdef _WIN32
+static int es_output_console = -1;
+
+static void es_output_init_console(void) {
+    HANDLE hStdOut = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
     
-    static int console_initialized = 0;
-    if (!console_initialized) {
-        SetConsoleOutputCP(CP_UTF8);
-        SetConsoleCP(CP_UTF8);
-        
-        
-        HANDLE hStdOut = GetStdHandle(STD_OUTPUT_HANDLE);
-        DWORD mode = 0;
-        if (GetConsoleMode(hStdOut, &mode)) {
-            SetConsoleMode(hStdOut, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
-        }
-        
-        console_initialized = 1;
+    SetConsoleOutputCP(CP_UTF8);
+    SetConsoleCP(CP_UTF8);
+    
+    es_output_console = GetConsoleMode(hStdOut, &mode) ? 1 : 0;
+    if (es_output_console) {
+        SetConsoleMode(hStdOut, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    }
+}
+
+static size_t es_output_utf8_complete(const char* data, size_t length) {
+    size_t i = length;
+    int continuation = 0;
+    
+    while (i > 0 && continuation < 3 && ((unsigned char)data[i - 1] & 0xC0) == 0x80) {
+        i--;
+        continuation++;
     }
+    if (i == 0) return length;
     
+    unsigned char lead = (unsigned char)data[i - 1];
+    int expected = 0;
+    if ((lead & 0xE0) == 0xC0) expected = 1;
+    else if ((lead & 0xF0) == 0xE0) expected = 2;
+    else if ((lead & 0xF8) == 0xF0) expected = 3;
+    
+    return (expected > continuation) ? i - 1 : length;
+}
+#endif
+
+static void es_output_write(const char* data, size_t length) {
+    if (length == 0) return;
     
+#ifdef _WIN32
     HANDLE hStdOut = GetStdHandle(STD_OUTPUT_HANDLE);
     DWORD written;
     
+    if (es_output_console < 0) {
+        es_output_init_console();
+    }
     
-    size_t len = 0;
-    while (str[len]) len++;
-    
+    if (es_output_console) {
+        int wlen = MultiByteToWideChar(CP_UTF8, 0, data, (int)length, NULL, 0);
+        if (wlen > 0) {
+            wchar_t* wstr = (wchar_t*)malloc(wlen * sizeof(wchar_t));
+            if (wstr) {
+                MultiByteToWideChar(CP_UTF8, 0, data, (int)length, wstr, wlen);
+                WriteConsoleW(hStdOut, wstr, wlen, &written, NULL);
+                free(wstr);
+                return;
+            }
+        }
+        WriteConsole(hStdOut, data, (DWORD)length, &written, NULL);
+        return;
+    }
     
-    int wlen = MultiByteToWideChar(CP_UTF8, 0, str, (int)len, NULL, 0);
-    if (wlen > 0) {
-        wchar_t* wstr = (wchar_t*)malloc(wlen * sizeof(wchar_t));
-        if (wstr) {
-            MultiByteToWideChar(CP_UTF8, 0, str, (int)len, wstr, wlen);
-            WriteConsoleW(hStdOut, wstr, wlen, &written, NULL);
-            free(wstr);
+    while (length > 0) {
+        if (!WriteFile(hStdOut, data, (DWORD)length, &written, NULL) || written == 0) {
             return;
         }
+        data += written;
+        length -= written;
     }
+#else
+    while (length > 0) {
+        ssize_t written;
+        es_write_console(ES_STDOUT_HANDLE, data, length, &written);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return;
+        data += written;
+        length -= (size_t)written;
+    }
+#endif
+}
+
+static void es_output_flush_buffer(EsOutputBuffer* buffer, int final) {
+    size_t length = buffer->length;
+    if (length == 0) return;
+    
+#ifdef _WIN32
+    if (!final && es_output_console) {
+        length = es_output_utf8_complete(buffer->data, length);
+    }
+#else
+    (void)final;
+#endif
     
+    es_output_write(buffer->data, length);
+    if (length < buffer->length) {
+        memmove(buffer->data, buffer->data + length, buffer->length - length);
+    }
+    buffer->length -= length;
+}
+
+static void es_output_lock(EsOutputBuffer* buffer) {
+    while (!es_output_try_claim(&buffer->locked)) {
+        es_output_yield();
+    }
+}
+
+static void es_output_unlock(EsOutputBuffer* buffer) {
+    es_output_release(&buffer->locked);
+}
+
+static void es_output_flush_all(void) {
+    for (int i = 0; i < ES_OUTPUT_MAX_BUFFERS; i++) {
+        EsOutputBuffer* buffer = &es_output_buffers[i];
+        if (es_output_load(&buffer->in_use)) {
+            es_output_lock(buffer);
+            es_output_flush_buffer(buffer, 1);
+            es_output_unlock(buffer);
+        }
+    }
+}
+
+static EsOutputBuffer* es_output_acquire(void) {
+    if (es_output_current || es_output_unbuffered) {
+        return es_output_current;
+    }
     
-    WriteConsole(hStdOut, str, (DWORD)len, &written, NULL);
+    if (es_output_is_tty < 0) {
+#ifdef _WIN32
+        DWORD mode;
+        es_output_is_tty = GetConsoleMode(GetStdHandle(STD_OUTPUT_HANDLE), &mode) ? 1 : 0;
 #else
-    size_t len = 0;
-    while (str[len]) len++;
-    size_t written;
-    es_write_console(ES_STDOUT_HANDLE, str, len, &written);
+        es_output_is_tty = isatty(ES_STDOUT_HANDLE) ? 1 : 0;
 #endif
+    }
+    
+    if (es_output_try_claim(&es_output_exit_registered)) {
+        atexit(es_output_flush_all);
+    }
+    
+    for (int i = 0; i < ES_OUTPUT_MAX_BUFFERS; i++) {
+        if (es_output_try_claim(&es_output_buffers[i].in_use)) {
+            es_output_lock(&es_output_buffers[i]);
+            es_output_buffers[i].length = 0;
+            es_output_unlock(&es_output_buffers[i]);
+            es_output_current = &es_output_buffers[i];
+            return es_output_current;
+        }
+    }
+    
+    es_output_unbuffered = 1;
+    return NULL;
+}
+
+static void es_output_append(const char* data, size_t length) {
+    EsOutputBuffer* buffer = es_output_acquire();
+    
+    if (!buffer) {
+        es_output_write(data, length);
+        return;
+    }
+    
+    es_output_lock(buffer);
+    
+    if (buffer->length + length > ES_OUTPUT_BUFFER_SIZE) {
+        es_output_flush_buffer(buffer, 0);
+        if (buffer->length + length > ES_OUTPUT_BUFFER_SIZE) {
+            es_output_flush_buffer(buffer, 1);
+            es_output_write(data, length);
+            es_output_unlock(buffer);
+            return;
+        }
+    }
+    
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    
+    if (es_output_is_tty && memchr(data, '\n', length)) {
+        es_output_flush_buffer(buffer, 0);
+    }
+    
+    es_output_unlock(buffer);
+}
+
+ES_RUNTIME_EXPORT void ES_API es_flush_output(void) {
+    if (es_output_current) {
+        es_output_lock(es_output_current);
+        es_output_flush_buffer(es_output_current, 1);
+        es_output_unlock(es_output_current);
+    }
+}
+
+static void es_output_thread_exit(void) {
+    if (es_output_current) {
+        es_output_lock(es_output_current);
+        es_output_flush_buffer(es_output_current, 1);
+        es_output_unlock(es_output_current);
+        es_output_release(&es_output_current->in_use);
+        es_output_current = NULL;
+    }
+}
+
+ES_RUNTIME_EXPORT void ES_API _print_string(const char* str) {
+    if (!str) return;
+    es_output_append(str, strlen(str));
 }
 
 ES_RUNTIME_EXPORT void ES_API _print_number(int num) {
@@ -210,13 +401,7 @@ ES_RUNTIME_EXPORT void ES_API _print_float(double num) {
 }
 
 ES_RUNTIME_EXPORT void ES_API _print_char(char c) {
-#ifdef _WIN32
-    DWORD written;
-    es_write_console(ES_STDOUT_HANDLE, &c, 1, &written);
-#else
-    size_t written;
-    es_write_console(ES_STDOUT_HANDLE, &c, 1, &written);
-#endif
+    es_output_append(&c, 1);
 }
 
 ES_RUNTIME_EXPORT void ES_API _print_newline(void) {
@@ -224,6 +409,7 @@ ES_RUNTIME_EXPORT void ES_API _print_newline(void) {
 }
 
 ES_RUNTIME_EXPORT int ES_API _read_char(void) {
+    es_flush_output();
 #ifdef _WIN32
     char c;
     DWORD read;
@@ -475,6 +661,7 @@ ES_RUNTIME_EXPORT void ES_API es_sleep(int seconds) {
 
 
 ES_RUNTIME_EXPORT void ES_API es_exit(int code) {
+    es_output_flush_all();
 #ifdef _WIN32
     ExitProcess(code);
 #else
@@ -1106,243 +1293,362 @@ ES_RUNTIME_EXPORT const char* ES_API es_strerror(ES_ErrorCode code) {
 
 
 
-struct ES_HashMap {
-    ES_HashMapItem** buckets;
-    size_t capacity;
-    size_t size;
-};
+#define ES_HASHMAP_GROUP_WIDTH 8
+#define ES_HASHMAP_CTRL_EMPTY 0x80
+#define ES_HASHMAP_CTRL_DELETED 0xFE
+#define ES_HASHMAP_LSBS 0x0101010101010101ULL
+#define ES_HASHMAP_MSBS 0x8080808080808080ULL
+#define ES_HASHMAP_H1(hash) ((hash) >> 7)
+#define ES_HASHMAP_H2(hash) ((uint8_t)((hash) & 0x7F))
+
+
+static uint64_t hash_mix(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
 
 
-static unsigned int string_hash(const char* str) {
-    unsigned int hash = 5381;
-    int c;
+static uint64_t string_hash(const char* str) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
     
-    while ((c = *str++)) {
-        hash = ((hash << 5) + hash) + c; 
+    while (*str) {
+        hash ^= (unsigned char)*str++;
+        hash *= 0x100000001b3ULL;
     }
     
-    return hash;
+    return hash_mix(hash);
 }
 
 
-static unsigned int int_hash(int value) {
-    return (unsigned int)value;
+static uint64_t int_hash(int value) {
+    return hash_mix((uint64_t)(uint32_t)value);
 }
 
 
-static unsigned int double_hash(double value) {
-    union {
-        double d;
-        unsigned int u[2];
-    } converter;
+static uint64_t double_hash(double value) {
+    uint64_t bits;
     
-    converter.d = value;
-    return converter.u[0] ^ converter.u[1];
+    if (value == 0.0) value = 0.0;
+    memcpy(&bits, &value, sizeof(bits));
+    return hash_mix(bits);
 }
 
 
-static unsigned int get_hash_value(const void* key, ES_HashMapType type) {
-    switch (type) {
-        case ES_HASHMAP_TYPE_INT:
-            return int_hash(*(int*)key);
-        case ES_HASHMAP_TYPE_DOUBLE:
-            return double_hash(*(double*)key);
-        case ES_HASHMAP_TYPE_STRING:
-            return string_hash((const char*)key);
-        default:
-            return 0;
-    }
+static int hashmap_inline_type(ES_HashMapType type) {
+    return type == ES_HASHMAP_TYPE_INT || type == ES_HASHMAP_TYPE_DOUBLE || type == ES_HASHMAP_TYPE_STRING;
 }
 
 
-static int keys_equal(const void* key1, ES_HashMapType type1, 
-                     const void* key2, ES_HashMapType type2) {
-    if (type1 != type2) {
-        return 0;
-    }
-    
-    switch (type1) {
+static int load_scalar(ES_HashMapScalar* out, const void* src, ES_HashMapType type) {
+    switch (type) {
         case ES_HASHMAP_TYPE_INT:
-            return *(int*)key1 == *(int*)key2;
+            out->i = *(const int*)src;
+            return 0;
         case ES_HASHMAP_TYPE_DOUBLE:
-            return *(double*)key1 == *(double*)key2;
+            out->d = *(const double*)src;
+            return 0;
         case ES_HASHMAP_TYPE_STRING:
-            return es_strcmp((const char*)key1, (const char*)key2) == 0;
+            out->s = es_strdup((const char*)src);
+            return out->s ? 0 : -1;
         default:
-            return 0;
+            return -1;
     }
 }
 
 
-static void* clone_key(const void* key, ES_HashMapType type) {
+static void* clone_scalar(const ES_HashMapScalar* scalar, ES_HashMapType type) {
     switch (type) {
         case ES_HASHMAP_TYPE_INT: {
-            int* new_key = (int*)es_malloc(sizeof(int));
-            if (new_key) *new_key = *(int*)key;
-            return new_key;
+            int* copy = (int*)es_malloc(sizeof(int));
+            if (copy) *copy = scalar->i;
+            return copy;
         }
         case ES_HASHMAP_TYPE_DOUBLE: {
-            double* new_key = (double*)es_malloc(sizeof(double));
-            if (new_key) *new_key = *(double*)key;
-            return new_key;
+            double* copy = (double*)es_malloc(sizeof(double));
+            if (copy) *copy = scalar->d;
+            return copy;
         }
         case ES_HASHMAP_TYPE_STRING:
-            return es_strdup((const char*)key);
+            return es_strdup(scalar->s);
         default:
             return NULL;
     }
 }
 
 
-static void* clone_value(const void* value, ES_HashMapType type) {
-    switch (type) {
-        case ES_HASHMAP_TYPE_INT: {
-            int* new_value = (int*)es_malloc(sizeof(int));
-            if (new_value) *new_value = *(int*)value;
-            return new_value;
-        }
-        case ES_HASHMAP_TYPE_DOUBLE: {
-            double* new_value = (double*)es_malloc(sizeof(double));
-            if (new_value) *new_value = *(double*)value;
-            return new_value;
-        }
-        case ES_HASHMAP_TYPE_STRING:
-            return es_strdup((const char*)value);
-        default:
-            return NULL;
+static void free_scalar(ES_HashMapScalar* scalar, ES_HashMapType type) {
+    if (type == ES_HASHMAP_TYPE_STRING) {
+        es_free(scalar->s);
+        scalar->s = NULL;
     }
 }
 
 
-static void free_key(void* key, ES_HashMapType type) {
+static uint64_t get_hash_value(const void* key, ES_HashMapType type) {
     switch (type) {
         case ES_HASHMAP_TYPE_INT:
+            return int_hash(*(const int*)key);
         case ES_HASHMAP_TYPE_DOUBLE:
-            ES_FREE(key);
-            break;
+            return double_hash(*(const double*)key);
         case ES_HASHMAP_TYPE_STRING:
-            ES_FREE(key);
-            break;
+            return string_hash((const char*)key);
         default:
-            break;
+            return 0;
     }
 }
 
 
-static void free_value(void* value, ES_HashMapType type) {
-    switch (type) {
+static int slot_key_equals(const ES_HashMapSlot* slot, const void* key, ES_HashMapType key_type, uint64_t hash) {
+    if (slot->hash != hash || slot->key_type != key_type) {
+        return 0;
+    }
+    
+    switch (key_type) {
         case ES_HASHMAP_TYPE_INT:
+            return slot->key.i == *(const int*)key;
         case ES_HASHMAP_TYPE_DOUBLE:
-            es_free(value);
-            break;
+            return slot->key.d == *(const double*)key;
         case ES_HASHMAP_TYPE_STRING:
-            ES_FREE(value);
-            break;
+            return es_strcmp(slot->key.s, (const char*)key) == 0;
         default:
-            break;
+            return 0;
     }
 }
 
 
-ES_RUNTIME_EXPORT ES_HashMap* ES_API hashmap_create(size_t initial_capacity) {
-    if (initial_capacity == 0) {
-        initial_capacity = 16; 
+static uint64_t group_load(const uint8_t* ctrl) {
+    uint64_t group;
+    memcpy(&group, ctrl, sizeof(group));
+    return group;
+}
+
+
+static uint64_t group_match(uint64_t group, uint8_t h2) {
+    uint64_t x = group ^ (ES_HASHMAP_LSBS * h2);
+    return (x - ES_HASHMAP_LSBS) & ~x & ES_HASHMAP_MSBS;
+}
+
+
+static uint64_t group_match_empty(uint64_t group) {
+    return group & (~group << 6) & ES_HASHMAP_MSBS;
+}
+
+
+static uint64_t group_match_empty_or_deleted(uint64_t group) {
+    return group & (~group << 7) & ES_HASHMAP_MSBS;
+}
+
+
+static size_t group_first(uint64_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (size_t)(index >> 3);
+#else
+    return (size_t)(__builtin_ctzll(mask) >> 3);
+#endif
+}
+
+
+static size_t hashmap_capacity_for(size_t requested) {
+    size_t capacity = ES_HASHMAP_GROUP_WIDTH;
+    while (capacity - capacity / 8 < requested) {
+        capacity <<= 1;
     }
+    return capacity;
+}
+
+
+static int hashmap_alloc_table(ES_HashMap* map, size_t capacity) {
+    uint8_t* ctrl = (uint8_t*)es_malloc(capacity);
+    if (!ctrl) return -1;
     
-    ES_HashMap* map = (ES_HashMap*)es_malloc(sizeof(ES_HashMap));
-    if (!map) return NULL;
-    
-    map->buckets = (ES_HashMapItem**)es_calloc(initial_capacity, sizeof(ES_HashMapItem*));
-    if (!map->buckets) {
-        ES_FREE(map);
-        return NULL;
+    ES_HashMapSlot* slots = (ES_HashMapSlot*)es_malloc(capacity * sizeof(ES_HashMapSlot));
+    if (!slots) {
+        es_free(ctrl);
+        return -1;
     }
     
-    map->capacity = initial_capacity;
-    map->size = 0;
-    
-    return map;
+    memset(ctrl, ES_HASHMAP_CTRL_EMPTY, capacity);
+    map->ctrl = ctrl;
+    map->slots = slots;
+    map->capacity = capacity;
+    map->growth_left = capacity - capacity / 8 - map->size;
+    return 0;
 }
 
 
-ES_RUNTIME_EXPORT void ES_API hashmap_ES_FREE(ES_HashMap* map) {
-    if (!map) return;
+static size_t hashmap_find_insert_slot(const uint8_t* ctrl, size_t capacity, uint64_t hash) {
+    size_t group_mask = capacity / ES_HASHMAP_GROUP_WIDTH - 1;
+    size_t group_index = (size_t)ES_HASHMAP_H1(hash) & group_mask;
     
+    for (size_t step = 1; ; step++) {
+        size_t base = group_index * ES_HASHMAP_GROUP_WIDTH;
+        uint64_t mask = group_match_empty_or_deleted(group_load(ctrl + base));
+        if (mask) {
+            return base + group_first(mask);
+        }
+        group_index = (group_index + step) & group_mask;
+    }
+}
+
+
+static long hashmap_find(const ES_HashMap* map, const void* key, ES_HashMapType key_type, uint64_t hash) {
+    size_t group_mask = map->capacity / ES_HASHMAP_GROUP_WIDTH - 1;
+    size_t group_index = (size_t)ES_HASHMAP_H1(hash) & group_mask;
+    uint8_t h2 = ES_HASHMAP_H2(hash);
     
-    for (size_t i = 0; i < map->capacity; i++) {
-        ES_HashMapItem* item = map->buckets[i];
-        while (item) {
-            ES_HashMapItem* next = item->next;
-            
-            
-            free_key(item->key, item->key_type);
-            free_value(item->value, item->value_type);
-            
-            
-            ES_FREE(item);
-            
-            item = next;
+    for (size_t step = 1; step <= group_mask + 1; step++) {
+        size_t base = group_index * ES_HASHMAP_GROUP_WIDTH;
+        uint64_t group = group_load(map->ctrl + base);
+        
+        for (uint64_t mask = group_match(group, h2); mask; mask &= mask - 1) {
+            size_t index = base + group_first(mask);
+            if (map->ctrl[index] == h2 && slot_key_equals(&map->slots[index], key, key_type, hash)) {
+                return (long)index;
+            }
         }
+        
+        if (group_match_empty(group)) {
+            return -1;
+        }
+        group_index = (group_index + step) & group_mask;
     }
     
+    return -1;
+}
+
+
+static int hashmap_rehash(ES_HashMap* map, size_t capacity) {
+    uint8_t* old_ctrl = map->ctrl;
+    ES_HashMapSlot* old_slots = map->slots;
+    size_t old_capacity = map->capacity;
     
-    ES_FREE(map->buckets);
+    if (hashmap_alloc_table(map, capacity) != 0) {
+        return -1;
+    }
     
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old_ctrl[i] & 0x80) continue;
+        
+        size_t index = hashmap_find_insert_slot(map->ctrl, map->capacity, old_slots[i].hash);
+        map->ctrl[index] = ES_HASHMAP_H2(old_slots[i].hash);
+        map->slots[index] = old_slots[i];
+    }
     
-    ES_FREE(map);
+    es_free(old_ctrl);
+    es_free(old_slots);
+    return 0;
 }
 
 
-ES_RUNTIME_EXPORT int ES_API hashmap_put(ES_HashMap* map, const void* key, ES_HashMapType key_type, 
-                                         const void* value, ES_HashMapType value_type) {
-    if (!map || !key || !value) return -1;
+static ES_HashMapSlot* hashmap_insert_slot(ES_HashMap* map, uint64_t hash) {
+    if (map->growth_left == 0) {
+        size_t capacity = map->capacity;
+        if (map->size * 2 >= capacity - capacity / 8) {
+            capacity <<= 1;
+        }
+        if (hashmap_rehash(map, capacity) != 0) {
+            return NULL;
+        }
+    }
     
+    size_t index = hashmap_find_insert_slot(map->ctrl, map->capacity, hash);
+    if (map->ctrl[index] == ES_HASHMAP_CTRL_EMPTY) {
+        map->growth_left--;
+    }
+    map->ctrl[index] = ES_HASHMAP_H2(hash);
+    map->size++;
     
-    unsigned int hash = get_hash_value(key, key_type);
-    size_t index = hash % map->capacity;
+    ES_HashMapSlot* slot = &map->slots[index];
+    slot->hash = hash;
+    return slot;
+}
+
+
+static void hashmap_erase_at(ES_HashMap* map, size_t index) {
+    size_t base = index & ~(size_t)(ES_HASHMAP_GROUP_WIDTH - 1);
     
+    if (group_match_empty(group_load(map->ctrl + base))) {
+        map->ctrl[index] = ES_HASHMAP_CTRL_EMPTY;
+        map->growth_left++;
+    } else {
+        map->ctrl[index] = ES_HASHMAP_CTRL_DELETED;
+    }
+    map->size--;
+}
+
+
+ES_RUNTIME_EXPORT ES_HashMap* ES_API hashmap_create(size_t initial_capacity) {
+    ES_HashMap* map = (ES_HashMap*)es_malloc(sizeof(ES_HashMap));
+    if (!map) return NULL;
     
-    ES_HashMapItem* item = map->buckets[index];
-    while (item) {
-        if (keys_equal(item->key, item->key_type, key, key_type)) {
-            
-            free_value(item->value, item->value_type);
-            
-            item->value = clone_value(value, value_type);
-            if (!item->value) return -1;
-            
-            item->value_type = value_type;
-            return 0; 
-        }
-        item = item->next;
+    map->size = 0;
+    if (hashmap_alloc_table(map, hashmap_capacity_for(initial_capacity)) != 0) {
+        es_free(map);
+        return NULL;
     }
     
+    return map;
+}
+
+
+ES_RUNTIME_EXPORT void ES_API hashmap_ES_FREE(ES_HashMap* map) {
+    if (!map) return;
     
-    ES_HashMapItem* new_item = (ES_HashMapItem*)es_malloc(sizeof(ES_HashMapItem));
-    if (!new_item) return -1;
+    for (size_t i = 0; i < map->capacity; i++) {
+        if (map->ctrl[i] & 0x80) continue;
+        
+        free_scalar(&map->slots[i].key, map->slots[i].key_type);
+        free_scalar(&map->slots[i].value, map->slots[i].value_type);
+    }
     
-    new_item->key = clone_key(key, key_type);
-    if (!new_item->key) {
-        ES_FREE(new_item);
-        return -1;
+    es_free(map->ctrl);
+    es_free(map->slots);
+    es_free(map);
+}
+
+
+ES_RUNTIME_EXPORT int ES_API hashmap_put(ES_HashMap* map, const void* key, ES_HashMapType key_type, 
+                                         const void* value, ES_HashMapType value_type) {
+    if (!map || !key || !value) return -1;
+    if (!hashmap_inline_type(key_type) || !hashmap_inline_type(value_type)) return -1;
+    
+    ES_HashMapScalar new_value;
+    if (load_scalar(&new_value, value, value_type) != 0) return -1;
+    
+    uint64_t hash = get_hash_value(key, key_type);
+    long index = hashmap_find(map, key, key_type, hash);
+    if (index >= 0) {
+        ES_HashMapSlot* slot = &map->slots[index];
+        free_scalar(&slot->value, slot->value_type);
+        slot->value = new_value;
+        slot->value_type = value_type;
+        return 0;
     }
     
-    new_item->value = clone_value(value, value_type);
-    if (!new_item->value) {
-        free_key(new_item->key, key_type);
-        ES_FREE(new_item);
+    ES_HashMapScalar new_key;
+    if (load_scalar(&new_key, key, key_type) != 0) {
+        free_scalar(&new_value, value_type);
         return -1;
     }
     
-    new_item->key_type = key_type;
-    new_item->value_type = value_type;
-    new_item->next = map->buckets[index];
-    
-    
-    map->buckets[index] = new_item;
-    map->size++;
+    ES_HashMapSlot* slot = hashmap_insert_slot(map, hash);
+    if (!slot) {
+        free_scalar(&new_key, key_type);
+        free_scalar(&new_value, value_type);
+        return -1;
+    }
     
-    return 0; 
+    slot->key = new_key;
+    slot->key_type = key_type;
+    slot->value = new_value;
+    slot->value_type = value_type;
+    return 0;
 }
 
 
@@ -1350,25 +1656,16 @@ ES_RUNTIME_EXPORT int ES_API hashmap_get(ES_HashMap* map, const void* key, ES_Ha
                                         void** out_value, ES_HashMapType* out_value_type) {
     if (!map || !key || !out_value || !out_value_type) return -1;
     
-    
-    unsigned int hash = get_hash_value(key, key_type);
-    size_t index = hash % map->capacity;
-    
-    
-    ES_HashMapItem* item = map->buckets[index];
-    while (item) {
-        if (keys_equal(item->key, item->key_type, key, key_type)) {
-            
-            *out_value = clone_value(item->value, item->value_type);
-            if (!*out_value) return -1;
-            
-            *out_value_type = item->value_type;
-            return 0; 
-        }
-        item = item->next;
+    long index = hashmap_find(map, key, key_type, get_hash_value(key, key_type));
+    if (index >= 0) {
+        ES_HashMapSlot* slot = &map->slots[index];
+        *out_value = clone_scalar(&slot->value, slot->value_type);
+        if (!*out_value) return -1;
+        
+        *out_value_type = slot->value_type;
+        return 0;
     }
     
-    
     *out_value = NULL;
     *out_value_type = ES_HASHMAP_TYPE_INT; 
     return -1;
@@ -1378,40 +1675,74 @@ ES_RUNTIME_EXPORT int ES_API hashmap_get(ES_HashMap* map, const void* key, ES_Ha
 ES_RUNTIME_EXPORT int ES_API hashmap_remove(ES_HashMap* map, const void* key, ES_HashMapType key_type) {
     if (!map || !key) return -1;
     
+    long index = hashmap_find(map, key, key_type, get_hash_value(key, key_type));
+    if (index < 0) return -1;
     
-    unsigned int hash = get_hash_value(key, key_type);
-    size_t index = hash % map->capacity;
-    
+    ES_HashMapSlot* slot = &map->slots[index];
+    free_scalar(&slot->key, slot->key_type);
+    free_scalar(&slot->value, slot->value_type);
+    hashmap_erase_at(map, (size_t)index);
+    return 0;
+}
+
+
+static int hashmap_put_int_value(ES_HashMap* map, const void* key, ES_HashMapType key_type, uint64_t hash, int value) {
+    long index = hashmap_find(map, key, key_type, hash);
+    if (index >= 0) {
+        ES_HashMapSlot* slot = &map->slots[index];
+        free_scalar(&slot->value, slot->value_type);
+        slot->value.i = value;
+        slot->value_type = ES_HASHMAP_TYPE_INT;
+        return 0;
+    }
     
-    ES_HashMapItem* item = map->buckets[index];
-    ES_HashMapItem* prev = NULL;
+    ES_HashMapScalar new_key;
+    if (load_scalar(&new_key, key, key_type) != 0) return -1;
     
-    while (item) {
-        if (keys_equal(item->key, item->key_type, key, key_type)) {
-            
-            if (prev) {
-                prev->next = item->next;
-            } else {
-                map->buckets[index] = item->next;
-            }
-            
-            
-            free_key(item->key, item->key_type);
-            free_value(item->value, item->value_type);
-            
-            
-            ES_FREE(item);
-            
-            map->size--;
-            return 0; 
-        }
-        
-        prev = item;
-        item = item->next;
+    ES_HashMapSlot* slot = hashmap_insert_slot(map, hash);
+    if (!slot) {
+        free_scalar(&new_key, key_type);
+        return -1;
     }
     
+    slot->key = new_key;
+    slot->key_type = key_type;
+    slot->value.i = value;
+    slot->value_type = ES_HASHMAP_TYPE_INT;
+    return 0;
+}
+
+
+static int hashmap_get_int_value(ES_HashMap* map, const void* key, ES_HashMapType key_type, uint64_t hash, int* out_value) {
+    long index = hashmap_find(map, key, key_type, hash);
+    if (index < 0 || map->slots[index].value_type != ES_HASHMAP_TYPE_INT) return -1;
     
-    return -1;
+    *out_value = map->slots[index].value.i;
+    return 0;
+}
+
+
+ES_RUNTIME_EXPORT int ES_API hashmap_put_int(ES_HashMap* map, int key, int value) {
+    if (!map) return -1;
+    return hashmap_put_int_value(map, &key, ES_HASHMAP_TYPE_INT, int_hash(key), value);
+}
+
+
+ES_RUNTIME_EXPORT int ES_API hashmap_get_int(ES_HashMap* map, int key, int* out_value) {
+    if (!map || !out_value) return -1;
+    return hashmap_get_int_value(map, &key, ES_HASHMAP_TYPE_INT, int_hash(key), out_value);
+}
+
+
+ES_RUNTIME_EXPORT int ES_API hashmap_put_string_int(ES_HashMap* map, const char* key, int value) {
+    if (!map || !key) return -1;
+    return hashmap_put_int_value(map, key, ES_HASHMAP_TYPE_STRING, string_hash(key), value);
+}
+
+
+ES_RUNTIME_EXPORT int ES_API hashmap_get_string_int(ES_HashMap* map, const char* key, int* out_value) {
+    if (!map || !key || !out_value) return -1;
+    return hashmap_get_int_value(map, key, ES_HASHMAP_TYPE_STRING, string_hash(key), out_value);
 }
 
 
@@ -1914,6 +2245,7 @@ DWORD WINAPI thread_wrapper(LPVOID arg) {
     ES_FREE(params);
     
     func(func_arg);
+    es_output_thread_exit();
     return 0;
 }
 #else
@@ -1924,6 +2256,7 @@ void* thread_wrapper(void* arg) {
     ES_FREE(params);
     
     func(func_arg);
+    es_output_thread_exit();
     return NULL;
 }
 #endif
@@ -51,19 +51,28 @@ typedef enum {
 } ES_HashMapType;
 
 
-typedef struct ES_HashMapItem {
-    void* key;
-    void* value;
+typedef union {
+    int i;
+    double d;
+    char* s;
+} ES_HashMapScalar;
+
+
+typedef struct {
+    ES_HashMapScalar key;
+    ES_HashMapScalar value;
+    uint64_t hash;
     ES_HashMapType key_type;
     ES_HashMapType value_type;
-    struct ES_HashMapItem* next;
-} ES_HashMapItem;
+} ES_HashMapSlot;
 
 
 typedef struct {
-    ES_HashMapItem** buckets;
+    uint8_t* ctrl;
+    ES_HashMapSlot* slots;
     size_t capacity;
     size_t size;
+    size_t growth_left;
 } ES_HashMap;
 
 
@@ -98,6 +107,7 @@ ES_RUNTIME_EXPORT void ES_API _print_double(double num);
 ES_RUNTIME_EXPORT void ES_API _print_float(double num);
 ES_RUNTIME_EXPORT void ES_API _print_char(char c);
 ES_RUNTIME_EXPORT void ES_API _print_newline(void);
+ES_RUNTIME_EXPORT void ES_API es_flush_output(void);
 ES_RUNTIME_EXPORT int ES_API _read_char(void);
 ES_RUNTIME_EXPORT int ES_API _pow_int(int base, int exp);
 
@@ -211,6 +221,10 @@ ES_RUNTIME_EXPORT void ES_API hashmap_ES_FREE(ES_HashMap* map);
 ES_RUNTIME_EXPORT int ES_API hashmap_put(ES_HashMap* map, const void* key, ES_HashMapType key_type, const void* value, ES_HashMapType value_type);
 ES_RUNTIME_EXPORT int ES_API hashmap_get(ES_HashMap* map, const void* key, ES_HashMapType key_type, void** value, ES_HashMapType* out_value_type);
 ES_RUNTIME_EXPORT int ES_API hashmap_remove(ES_HashMap* map, const void* key, ES_HashMapType key_type);
+ES_RUNTIME_EXPORT int ES_API hashmap_put_int(ES_HashMap* map, int key, int value);
+ES_RUNTIME_EXPORT int ES_API hashmap_get_int(ES_HashMap* map, int key, int* out_value);
+ES_RUNTIME_EXPORT int ES_API hashmap_put_string_int(ES_HashMap* map, const char* key, int value);
+ES_RUNTIME_EXPORT int ES_API hashmap_get_string_int(ES_HashMap* map, const char* key, int* out_value);
 
 
 ES_RUNTIME_EXPORT ES_Socket ES_API es_socket(int domain, int type, int protocol);
@@ -7,10 +7,20 @@ void es_chunk_init(EsChunk* chunk) {
     chunk->capacity = 0;
     chunk->code = NULL;
     chunk->lines = NULL;
+    chunk->line_runs = NULL;
+    chunk->line_run_count = 0;
+    chunk->mapping = NULL;
+    chunk->mapping_size = 0;
     es_value_array_init(&chunk->constants);
 }
 
 void es_chunk_free(EsChunk* chunk) {
+    if (chunk->mapping) {
+        es_value_array_free(&chunk->constants);
+        es_chunk_init(chunk);
+        return;
+    }
+
     ES_FREE(chunk->code);
     ES_FREE(chunk->lines);
     
@@ -57,3 +67,16 @@ int es_chunk_add_string_constant(EsChunk* chunk, const char* s) {
     EsValue value = STRING_VAL(copy);
     return es_chunk_add_constant(chunk, value);
 }
+
+int es_chunk_get_line(EsChunk* chunk, int offset) {
+    if (chunk->lines) {
+        return chunk->lines[offset];
+    }
+    for (int i = 0; i < chunk->line_run_count; i++) {
+        if (offset < (int)chunk->line_runs[i].count) {
+            return (int)chunk->line_runs[i].line;
+        }
+        offset -= (int)chunk->line_runs[i].count;
+    }
+    return 0;
+}
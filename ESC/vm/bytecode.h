@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "value.h"
+#include "../shared/ebc_format.h"
 
 
 
@@ -47,7 +48,13 @@ typedef enum {
     
     OP_INT_TO_STRING, 
     
-    OP_HALT           
+    OP_HALT,
+    
+    OP_ADD_LOCAL_CONST,
+    OP_INC_LOCAL,
+    OP_LESS_JUMP_IF_FALSE,
+    
+    OP_CONSTANT_LONG
 } EsOpCode;
 
 
@@ -59,7 +66,11 @@ typedef struct {
     int capacity;
     uint8_t* code;
     int* lines;       
+    const EsEbcLineRun* line_runs;
+    int line_run_count;
     EsValueArray constants; 
+    void* mapping;
+    size_t mapping_size;
 } EsChunk;
 
 void es_chunk_init(EsChunk* chunk);
@@ -67,5 +78,6 @@ void es_chunk_write(EsChunk* chunk, uint8_t byte, int line);
 void es_chunk_free(EsChunk* chunk);
 int es_chunk_add_constant(EsChunk* chunk, EsValue value);
 int es_chunk_add_string_constant(EsChunk* chunk, const char* s);
+int es_chunk_get_line(EsChunk* chunk, int offset);
 
 #endif 
@@ -23,18 +23,54 @@ static int constant_instruction(const char* name, EsChunk* chunk, int offset) {
     return offset + 2;
 }
 
+static int byte_instruction(const char* name, EsChunk* chunk, int offset) {
+    uint8_t slot = chunk->code[offset + 1];
+    printf("%-16s %4d\n", name, slot);
+    return offset + 2;
+}
+
+static int jump_instruction(const char* name, int sign, EsChunk* chunk, int offset) {
+    uint16_t jump = (uint16_t)(chunk->code[offset + 1] << 8);
+    jump |= chunk->code[offset + 2];
+    printf("%-16s %4d -> %d\n", name, offset, offset + 3 + sign * jump);
+    return offset + 3;
+}
+
+static int add_local_const_instruction(const char* name, EsChunk* chunk, int offset) {
+    uint8_t dest = chunk->code[offset + 1];
+    uint8_t src = chunk->code[offset + 2];
+    uint8_t constant = chunk->code[offset + 3];
+    printf("%-16s %4d %4d '", name, dest, src);
+    es_value_print(chunk->constants.values[constant]);
+    printf("'\n");
+    return offset + 4;
+}
+
+static int constant_long_instruction(const char* name, EsChunk* chunk, int offset) {
+    uint32_t constant = ((uint32_t)chunk->code[offset + 1] << 16) |
+                        ((uint32_t)chunk->code[offset + 2] << 8) |
+                        chunk->code[offset + 3];
+    printf("%-16s %4u '", name, constant);
+    es_value_print(chunk->constants.values[constant]);
+    printf("'\n");
+    return offset + 4;
+}
+
 int es_disassemble_instruction(EsChunk* chunk, int offset) {
     printf("%04d ", offset);
-    if (offset > 0 && chunk->lines[offset] == chunk->lines[offset - 1]) {
+    int line = es_chunk_get_line(chunk, offset);
+    if (offset > 0 && line == es_chunk_get_line(chunk, offset - 1)) {
         printf("   | ");
     } else {
-        printf("%4d ", chunk->lines[offset]);
+        printf("%4d ", line);
     }
 
     uint8_t instruction = chunk->code[offset];
     switch (instruction) {
         case OP_CONSTANT:
             return constant_instruction("OP_CONSTANT", chunk, offset);
+        case OP_CONSTANT_LONG:
+            return constant_long_instruction("OP_CONSTANT_LONG", chunk, offset);
         case OP_NULL:
             return simple_instruction("OP_NULL", offset);
         case OP_TRUE:
@@ -65,8 +101,28 @@ int es_disassemble_instruction(EsChunk* chunk, int offset) {
             return simple_instruction("OP_PRINT", offset);
         case OP_RETURN:
             return simple_instruction("OP_RETURN", offset);
+        case OP_GET_LOCAL:
+            return byte_instruction("OP_GET_LOCAL", chunk, offset);
+        case OP_SET_LOCAL:
+            return byte_instruction("OP_SET_LOCAL", chunk, offset);
+        case OP_STK_ADJ:
+            return byte_instruction("OP_STK_ADJ", chunk, offset);
+        case OP_JUMP:
+            return jump_instruction("OP_JUMP", 1, chunk, offset);
+        case OP_JUMP_IF_FALSE:
+            return jump_instruction("OP_JUMP_IF_FALSE", 1, chunk, offset);
+        case OP_LOOP:
+            return jump_instruction("OP_LOOP", -1, chunk, offset);
+        case OP_INT_TO_STRING:
+            return simple_instruction("OP_INT_TO_STRING", offset);
         case OP_HALT:
             return simple_instruction("OP_HALT", offset);
+        case OP_ADD_LOCAL_CONST:
+            return add_local_const_instruction("OP_ADD_LOCAL_CONST", chunk, offset);
+        case OP_INC_LOCAL:
+            return byte_instruction("OP_INC_LOCAL", chunk, offset);
+        case OP_LESS_JUMP_IF_FALSE:
+            return jump_instruction("OP_LESS_JUMP_IF_FALSE", 1, chunk, offset);
         default:
             printf("Unknown opcode %d\n", instruction);
             return offset + 1;
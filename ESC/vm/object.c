@@ -6,13 +6,17 @@
     (type*)allocate_object(vm, sizeof(type), objectType)
 
 static struct EsObject* allocate_object(EsVM* vm, size_t size, EsObjType type) {
+    es_vm_maybe_collect(vm);
+
     struct EsObject* object = (struct EsObject*)es_vm_reallocate(vm, NULL, 0, size);
     object->type = type;
     object->is_marked = false;
+    object->is_old = false;
+    object->is_remembered = false;
     
     
-    object->next = vm->objects;
-    vm->objects = object;
+    object->next = vm->young_objects;
+    vm->young_objects = object;
     
     return object;
 }
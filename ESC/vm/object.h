@@ -17,6 +17,8 @@ typedef enum {
 struct EsObject {
     EsObjType type;
     bool is_marked;
+    bool is_old;
+    bool is_remembered;
     struct EsObject* next; 
 };
 
@@ -35,16 +37,14 @@ static inline bool is_obj_type(EsValue value, EsObjType type) {
 }
 
 #define IS_STRING(value) (is_obj_type(value, OBJ_STRING))
-#define IS_STRING_LIT(value) ((value).type == VAL_STRING_LITERAL)
 #define IS_STRING_VAL(value) (IS_STRING(value) || IS_STRING_LIT(value))
 
 
 #define AS_STRING(value) ((EsString*)AS_OBJ(value))
-#define AS_STRING_LIT(value) ((value).as.string_literal)
 #define AS_CSTRING(value) (IS_STRING_LIT(value) ? AS_STRING_LIT(value) : (IS_STRING(value) ? AS_STRING(value)->chars : ""))
 #define AS_STRING_LEN(value) (IS_STRING_LIT(value) ? (int)strlen(AS_STRING_LIT(value)) : (IS_STRING(value) ? AS_STRING(value)->length : 0))
 
-#define OBJ_TYPE(value) (AS_OBJ(value)->type)
+#define OBJ_TYPE(value) (((struct EsObject*)AS_OBJ(value))->type)
 
 
 EsString* es_object_new_string(void* vm, const char* chars, int length);
@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <string.h>
+#include "vm.h"
+#include "object.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+static EsString* push_string(EsVM* vm, const char* text) {
+    EsString* string = es_object_new_string(vm, text, (int)strlen(text));
+    es_vm_push(vm, OBJ_VAL(string));
+    return string;
+}
+
+static int count_objects(struct EsObject* list) {
+    int count = 0;
+    for (; list != NULL; list = list->next) count++;
+    return count;
+}
+
+static void test_major_keeps_rooted_young(void) {
+    EsVM vm;
+    es_vm_init(&vm);
+
+    push_string(&vm, "young-0");
+    push_string(&vm, "young-1");
+    es_object_new_string(&vm, "garbage", 7);
+    push_string(&vm, "young-2");
+
+    es_vm_collect_garbage(&vm);
+
+    CHECK(vm.young_objects == NULL);
+    CHECK(count_objects(vm.objects) == 3);
+    for (int i = 0; i < 3; i++) {
+        char expected[16];
+        snprintf(expected, sizeof(expected), "young-%d", i);
+        EsValue value = vm.stack[i];
+        CHECK(IS_STRING(value));
+        CHECK(strcmp(AS_CSTRING(value), expected) == 0);
+        CHECK(((struct EsObject*)AS_OBJ(value))->is_old);
+    }
+
+    es_vm_collect_garbage(&vm);
+    CHECK(count_objects(vm.objects) == 3);
+    CHECK(strcmp(AS_CSTRING(vm.stack[2]), "young-2") == 0);
+
+    es_vm_free(&vm);
+}
+
+static void test_major_with_old_and_young(void) {
+    EsVM vm;
+    es_vm_init(&vm);
+
+    push_string(&vm, "old");
+    es_vm_collect_nursery(&vm);
+    CHECK(count_objects(vm.objects) == 1);
+
+    push_string(&vm, "young");
+    es_object_new_string(&vm, "garbage", 7);
+    es_vm_collect_garbage(&vm);
+
+    CHECK(count_objects(vm.objects) == 2);
+    CHECK(strcmp(AS_CSTRING(vm.stack[0]), "old") == 0);
+    CHECK(strcmp(AS_CSTRING(vm.stack[1]), "young") == 0);
+
+    es_vm_pop(&vm);
+    es_vm_collect_garbage(&vm);
+    CHECK(count_objects(vm.objects) == 1);
+    CHECK(strcmp(AS_CSTRING(vm.stack[0]), "old") == 0);
+
+    es_vm_free(&vm);
+}
+
+int main(void) {
+    test_major_keeps_rooted_young();
+    test_major_with_old_and_young();
+
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("gc tests passed\n");
+    return 0;
+}
@@ -25,7 +25,7 @@ void es_value_array_free(EsValueArray* array) {
 }
 
 void es_value_print(EsValue value) {
-    switch (value.type) {
+    switch (VALUE_TYPE(value)) {
         case VAL_BOOL:   printf(AS_BOOL(value) ? "true" : "false"); break;
         case VAL_NULL:   printf("null"); break;
         case VAL_NUMBER: printf("%g", AS_NUMBER(value)); break;
@@ -17,6 +17,63 @@ typedef enum {
 
 
 
+#ifdef ES_NAN_BOXING
+
+typedef uint64_t EsValue;
+
+typedef char es_nan_boxing_requires_64bit_pointers[sizeof(void*) == 8 ? 1 : -1];
+
+#define ES_SIGN_BIT          ((uint64_t)0x8000000000000000)
+#define ES_QNAN              ((uint64_t)0x7ffc000000000000)
+#define ES_TAG_STRING_LIT    ((uint64_t)0x0001000000000000)
+#define ES_PAYLOAD_MASK      ((uint64_t)0x0000ffffffffffff)
+#define ES_BOXED_TAG_MASK    (ES_SIGN_BIT | ES_QNAN | ES_TAG_STRING_LIT)
+
+#define ES_TAG_NULL  1
+#define ES_TAG_FALSE 2
+#define ES_TAG_TRUE  3
+
+static inline EsValue es_value_from_number(double number) {
+    EsValue value;
+    memcpy(&value, &number, sizeof(double));
+    return value;
+}
+
+static inline double es_value_to_number(EsValue value) {
+    double number;
+    memcpy(&number, &value, sizeof(double));
+    return number;
+}
+
+#define NULL_VAL          ((EsValue)(ES_QNAN | ES_TAG_NULL))
+#define FALSE_VAL         ((EsValue)(ES_QNAN | ES_TAG_FALSE))
+#define TRUE_VAL          ((EsValue)(ES_QNAN | ES_TAG_TRUE))
+#define BOOL_VAL(value)   ((value) ? TRUE_VAL : FALSE_VAL)
+#define NUMBER_VAL(value) es_value_from_number(value)
+#define OBJ_VAL(object)   ((EsValue)(ES_SIGN_BIT | ES_QNAN | (uint64_t)(uintptr_t)(object)))
+#define STRING_VAL(chars) ((EsValue)(ES_SIGN_BIT | ES_QNAN | ES_TAG_STRING_LIT | (uint64_t)(uintptr_t)(chars)))
+
+#define IS_BOOL(value)    (((value) | 1) == TRUE_VAL)
+#define IS_NULL(value)    ((value) == NULL_VAL)
+#define IS_NUMBER(value)  (((value) & ES_QNAN) != ES_QNAN)
+#define IS_OBJ(value)     (((value) & ES_BOXED_TAG_MASK) == (ES_SIGN_BIT | ES_QNAN))
+#define IS_STRING_LIT(value) (((value) & ES_BOXED_TAG_MASK) == ES_BOXED_TAG_MASK)
+
+#define AS_BOOL(value)    ((value) == TRUE_VAL)
+#define AS_NUMBER(value)  es_value_to_number(value)
+#define AS_OBJ(value)     ((void*)(uintptr_t)((value) & ES_PAYLOAD_MASK))
+#define AS_STRING_LIT(value) ((const char*)(uintptr_t)((value) & ES_PAYLOAD_MASK))
+
+static inline EsValueType es_value_type(EsValue value) {
+    if (IS_NUMBER(value)) return VAL_NUMBER;
+    if (IS_BOOL(value)) return VAL_BOOL;
+    if (IS_OBJ(value)) return VAL_OBJ;
+    if (IS_STRING_LIT(value)) return VAL_STRING_LITERAL;
+    return VAL_NULL;
+}
+
+#else
+
 typedef struct EsValue {
     EsValueType type;
     union {
@@ -47,6 +104,14 @@ typedef struct EsValue {
 #define AS_OBJ(value)     ((value).as.obj)
 #define AS_STRING_LIT(value) ((value).as.string_literal)
 
+static inline EsValueType es_value_type(EsValue value) {
+    return value.type;
+}
+
+#endif
+
+#define VALUE_TYPE(value) es_value_type(value)
+
 
 
 
@@ -4,19 +4,95 @@
 #include <stdarg.h>
 
 void es_vm_init(EsVM* vm) {
+    vm->chunk = NULL;
+    vm->ip = NULL;
+    vm->stack = (EsValue*)ES_MALLOC(sizeof(EsValue) * STACK_INITIAL);
+    vm->stack_capacity = vm->stack ? STACK_INITIAL : 0;
     vm->stack_top = vm->stack;
+    vm->stack_end = vm->stack + vm->stack_capacity;
+    vm->frames = (EsCallFrame*)ES_MALLOC(sizeof(EsCallFrame) * FRAMES_INITIAL);
+    vm->frame_capacity = vm->frames ? FRAMES_INITIAL : 0;
     vm->frame_count = 0;
     vm->objects = NULL;
+    vm->young_objects = NULL;
     vm->bytes_allocated = 0;
     vm->next_gc = 1024 * 1024; 
+    vm->nursery_bytes = 0;
+    vm->nursery_limit = GC_NURSERY_SIZE;
+    vm->gray_stack = NULL;
+    vm->gray_count = 0;
+    vm->gray_capacity = 0;
+    vm->remembered = NULL;
+    vm->remembered_count = 0;
+    vm->remembered_capacity = 0;
+    memset(&vm->gc_stats, 0, sizeof(EsGCStats));
+}
+
+static void reset_stack(EsVM* vm) {
+    vm->stack_top = vm->stack;
+    vm->frame_count = 0;
+}
+
+bool es_vm_ensure_stack(EsVM* vm, int needed) {
+    size_t used = (size_t)(vm->stack_top - vm->stack);
+    if (used + (size_t)needed <= (size_t)vm->stack_capacity) {
+        return true;
+    }
+    if (used + (size_t)needed > STACK_LIMIT) {
+        return false;
+    }
+
+    int new_capacity = vm->stack_capacity < STACK_INITIAL ? STACK_INITIAL : vm->stack_capacity;
+    while ((size_t)new_capacity < used + (size_t)needed) {
+        new_capacity *= 2;
+    }
+    if (new_capacity > STACK_LIMIT) {
+        new_capacity = STACK_LIMIT;
+    }
+
+    EsValue* old_stack = vm->stack;
+    EsValue* new_stack = (EsValue*)ES_REALLOC(old_stack, sizeof(EsValue) * new_capacity);
+    if (!new_stack) {
+        return false;
+    }
+
+    if (new_stack != old_stack) {
+        for (int i = 0; i < vm->frame_count; i++) {
+            vm->frames[i].slots = new_stack + (vm->frames[i].slots - old_stack);
+        }
+    }
+    vm->stack = new_stack;
+    vm->stack_top = new_stack + used;
+    vm->stack_capacity = new_capacity;
+    vm->stack_end = new_stack + new_capacity;
+    return true;
+}
+
+static bool ensure_frames(EsVM* vm) {
+    if (vm->frame_count < vm->frame_capacity) {
+        return true;
+    }
+    if (vm->frame_capacity >= FRAMES_LIMIT) {
+        return false;
+    }
+
+    int new_capacity = vm->frame_capacity < FRAMES_INITIAL ? FRAMES_INITIAL : vm->frame_capacity * 2;
+    if (new_capacity > FRAMES_LIMIT) {
+        new_capacity = FRAMES_LIMIT;
+    }
+    EsCallFrame* frames = (EsCallFrame*)ES_REALLOC(vm->frames, sizeof(EsCallFrame) * new_capacity);
+    if (!frames) {
+        return false;
+    }
+    vm->frames = frames;
+    vm->frame_capacity = new_capacity;
+    return true;
 }
 
 void* es_vm_reallocate(EsVM* vm, void* pointer, size_t old_size, size_t new_size) {
     vm->bytes_allocated += new_size - old_size;
     if (new_size > old_size) {
-        if (vm->bytes_allocated > vm->next_gc) {
-            es_vm_collect_garbage(vm);
-        }
+        vm->nursery_bytes += new_size - old_size;
     }
 
     if (new_size == 0) {
@@ -40,8 +116,7 @@ static void free_object(EsVM* vm, struct EsObject* object) {
     }
 }
 
-void es_vm_free(EsVM* vm) {
-    struct EsObject* object = vm->objects;
+static void free_object_list(EsVM* vm, struct EsObject* object) {
     while (object != NULL) {
         struct EsObject* next = object->next;
         free_object(vm, object);
@@ -49,29 +124,116 @@ void es_vm_free(EsVM* vm) {
     }
 }
 
-static void mark_object(struct EsObject* object) {
+void es_vm_free(EsVM* vm) {
+    free_object_list(vm, vm->young_objects);
+    free_object_list(vm, vm->objects);
+    vm->young_objects = NULL;
+    vm->objects = NULL;
+
+    ES_FREE(vm->gray_stack);
+    ES_FREE(vm->remembered);
+    vm->gray_stack = NULL;
+    vm->gray_count = 0;
+    vm->gray_capacity = 0;
+    vm->remembered = NULL;
+    vm->remembered_count = 0;
+    vm->remembered_capacity = 0;
+
+    ES_FREE(vm->stack);
+    ES_FREE(vm->frames);
+    vm->stack = NULL;
+    vm->stack_top = NULL;
+    vm->stack_end = NULL;
+    vm->stack_capacity = 0;
+    vm->frames = NULL;
+    vm->frame_capacity = 0;
+    vm->frame_count = 0;
+}
+
+static void push_gray(EsVM* vm, struct EsObject* object) {
+    if (vm->gray_count >= vm->gray_capacity) {
+        int new_capacity = vm->gray_capacity < 64 ? 64 : vm->gray_capacity * 2;
+        struct EsObject** gray_stack = (struct EsObject**)ES_REALLOC(vm->gray_stack, sizeof(struct EsObject*) * new_capacity);
+        if (gray_stack == NULL) exit(1);
+        vm->gray_stack = gray_stack;
+        vm->gray_capacity = new_capacity;
+    }
+    vm->gray_stack[vm->gray_count++] = object;
+}
+
+static void mark_object(EsVM* vm, struct EsObject* object, bool minor) {
     if (object == NULL || object->is_marked) return;
+    if (minor && object->is_old) return;
     object->is_marked = true;
+    push_gray(vm, object);
 }
 
-static void mark_value(EsValue value) {
-    if (IS_OBJ(value)) mark_object((struct EsObject*)AS_OBJ(value));
+static void mark_value(EsVM* vm, EsValue value, bool minor) {
+    if (IS_OBJ(value)) mark_object(vm, (struct EsObject*)AS_OBJ(value), minor);
 }
 
-static void mark_roots(EsVM* vm) {
+static void blacken_object(EsVM* vm, struct EsObject* object, bool minor) {
+    (void)vm;
+    (void)minor;
+    switch (object->type) {
+        case OBJ_STRING:
+            break;
+    }
+}
+
+static void trace_references(EsVM* vm, bool minor) {
+    while (vm->gray_count > 0) {
+        struct EsObject* object = vm->gray_stack[--vm->gray_count];
+        blacken_object(vm, object, minor);
+    }
+}
+
+static void mark_roots(EsVM* vm, bool minor) {
     for (EsValue* slot = vm->stack; slot < vm->stack_top; slot++) {
-        mark_value(*slot);
+        mark_value(vm, *slot, minor);
     }
     
     
     if (vm->chunk) {
         for (int i = 0; i < vm->chunk->constants.count; i++) {
-            mark_value(vm->chunk->constants.values[i]);
+            mark_value(vm, vm->chunk->constants.values[i], minor);
+        }
+    }
+
+    if (minor) {
+        for (int i = 0; i < vm->remembered_count; i++) {
+            blacken_object(vm, vm->remembered[i], true);
+        }
+    }
+}
+
+static void clear_remembered_set(EsVM* vm) {
+    for (int i = 0; i < vm->remembered_count; i++) {
+        vm->remembered[i]->is_remembered = false;
+    }
+    vm->remembered_count = 0;
+}
+
+static void sweep_young(EsVM* vm) {
+    struct EsObject* object = vm->young_objects;
+    while (object != NULL) {
+        struct EsObject* next = object->next;
+        if (object->is_marked) {
+            object->is_marked = false;
+            object->is_old = true;
+            object->next = vm->objects;
+            vm->objects = object;
+            vm->gc_stats.objects_promoted++;
+        } else {
+            free_object(vm, object);
+            vm->gc_stats.objects_freed++;
         }
+        object = next;
     }
+    vm->young_objects = NULL;
 }
 
-static void sweep(EsVM* vm) {
+static void sweep_old(EsVM* vm) {
     struct EsObject* previous = NULL;
     struct EsObject* object = vm->objects;
     while (object != NULL) {
@@ -88,19 +250,98 @@ static void sweep(EsVM* vm) {
                 vm->objects = object;
             }
             free_object(vm, unreached);
+            vm->gc_stats.objects_freed++;
         }
     }
 }
 
+static void record_pause(EsVM* vm, double start, size_t before) {
+    double pause_ms = (es_get_time() - start) * 1000.0;
+    vm->gc_stats.total_pause_ms += pause_ms;
+    if (pause_ms > vm->gc_stats.max_pause_ms) {
+        vm->gc_stats.max_pause_ms = pause_ms;
+    }
+    if (before > vm->bytes_allocated) {
+        vm->gc_stats.bytes_reclaimed += before - vm->bytes_allocated;
+    }
+}
+
+void es_vm_collect_nursery(EsVM* vm) {
+    double start = es_get_time();
+    size_t before = vm->bytes_allocated;
+
+    mark_roots(vm, true);
+    trace_references(vm, true);
+    sweep_young(vm);
+    clear_remembered_set(vm);
+
+    vm->nursery_bytes = 0;
+    vm->gc_stats.minor_collections++;
+    record_pause(vm, start, before);
+}
+
 void es_vm_collect_garbage(EsVM* vm) {
+    double start = es_get_time();
     size_t before = vm->bytes_allocated;
-    mark_roots(vm);
-    sweep(vm);
-    
-    vm->next_gc = vm->bytes_allocated * 2;
+
+    mark_roots(vm, false);
+    trace_references(vm, false);
+    sweep_old(vm);
+    sweep_young(vm);
+    clear_remembered_set(vm);
+
+    vm->nursery_bytes = 0;
+    vm->next_gc = vm->bytes_allocated * GC_HEAP_GROW_FACTOR;
+    if (vm->next_gc < 1024 * 1024) {
+        vm->next_gc = 1024 * 1024;
+    }
+    vm->gc_stats.major_collections++;
+    record_pause(vm, start, before);
+}
+
+void es_vm_maybe_collect(EsVM* vm) {
+    if (vm->bytes_allocated > vm->next_gc) {
+        es_vm_collect_garbage(vm);
+    } else if (vm->nursery_bytes > vm->nursery_limit) {
+        es_vm_collect_nursery(vm);
+    }
+}
+
+void es_vm_write_barrier(EsVM* vm, struct EsObject* owner, EsValue value) {
+    if (!owner->is_old || owner->is_remembered || !IS_OBJ(value)) return;
+    if (((struct EsObject*)AS_OBJ(value))->is_old) return;
+
+    if (vm->remembered_count >= vm->remembered_capacity) {
+        int new_capacity = vm->remembered_capacity < 16 ? 16 : vm->remembered_capacity * 2;
+        struct EsObject** remembered = (struct EsObject**)ES_REALLOC(vm->remembered, sizeof(struct EsObject*) * new_capacity);
+        if (remembered == NULL) exit(1);
+        vm->remembered = remembered;
+        vm->remembered_capacity = new_capacity;
+    }
+    owner->is_remembered = true;
+    vm->remembered[vm->remembered_count++] = owner;
+}
+
+void es_vm_print_gc_stats(EsVM* vm, FILE* out) {
+    EsGCStats* stats = &vm->gc_stats;
+    size_t collections = stats->minor_collections + stats->major_collections;
+    fprintf(out, "GC statistics:\n");
+    fprintf(out, "  minor collections : %zu\n", stats->minor_collections);
+    fprintf(out, "  major collections : %zu\n", stats->major_collections);
+    fprintf(out, "  bytes reclaimed   : %zu\n", stats->bytes_reclaimed);
+    fprintf(out, "  objects freed     : %zu\n", stats->objects_freed);
+    fprintf(out, "  objects promoted  : %zu\n", stats->objects_promoted);
+    fprintf(out, "  total pause       : %.3f ms\n", stats->total_pause_ms);
+    fprintf(out, "  max pause         : %.3f ms\n", stats->max_pause_ms);
+    fprintf(out, "  avg pause         : %.3f ms\n", collections ? stats->total_pause_ms / collections : 0.0);
+    fprintf(out, "  heap in use       : %zu bytes\n", vm->bytes_allocated);
 }
 
 void es_vm_push(EsVM* vm, EsValue value) {
+    if (ES_VM_UNLIKELY(vm->stack_top >= vm->stack_end) && !es_vm_ensure_stack(vm, 1)) {
+        fprintf(stderr, "Stack overflow (value stack limit %d reached).\n", STACK_LIMIT);
+        return;
+    }
     *vm->stack_top = value;
     vm->stack_top++;
 }
@@ -118,9 +359,9 @@ static void runtime_error(EsVM* vm, const char* format, ...) {
     fputs("\n", stderr);
 
     size_t instruction = vm->ip - vm->chunk->code - 1;
-    int line = vm->chunk->lines[instruction];
+    int line = es_chunk_get_line(vm->chunk, (int)instruction);
     fprintf(stderr, "[line %d] in script\n", line);
-    es_vm_init(vm);
+    reset_stack(vm);
 }
 
 static EsInterpretResult run(EsVM* vm) {
@@ -128,16 +369,27 @@ static EsInterpretResult run(EsVM* vm) {
 #define READ_SHORT() \
     (vm->ip += 2, (uint16_t)((vm->ip[-2] << 8) | vm->ip[-1]))
 #define READ_CONSTANT() (vm->chunk->constants.values[READ_BYTE()])
+#define READ_CONSTANT_LONG() \
+    (vm->ip += 3, vm->chunk->constants.values[(vm->ip[-3] << 16) | (vm->ip[-2] << 8) | vm->ip[-1]])
+#define PUSH(value) \
+    do { \
+        EsValue pushed_value = (value); \
+        if (ES_VM_UNLIKELY(vm->stack_top >= vm->stack_end) && !es_vm_ensure_stack(vm, 1)) { \
+            runtime_error(vm, "Stack overflow (value stack limit %d reached).", STACK_LIMIT); \
+            return INTERPRET_RUNTIME_ERROR; \
+        } \
+        *vm->stack_top++ = pushed_value; \
+    } while (false)
 #define BINARY_OP(value_type, op) \
     do { \
         if (!IS_NUMBER(vm->stack_top[-1]) || !IS_NUMBER(vm->stack_top[-2])) { \
             runtime_error(vm, "Operands must be numbers. (Types: %d, %d)", \
-                          vm->stack_top[-1].type, vm->stack_top[-2].type); \
+                          VALUE_TYPE(vm->stack_top[-1]), VALUE_TYPE(vm->stack_top[-2])); \
             return INTERPRET_RUNTIME_ERROR; \
         } \
         double b = AS_NUMBER(es_vm_pop(vm)); \
         double a = AS_NUMBER(es_vm_pop(vm)); \
-        es_vm_push(vm, value_type(a op b)); \
+        PUSH(value_type(a op b)); \
     } while (false)
 
     for (;;) {
@@ -145,19 +397,24 @@ static EsInterpretResult run(EsVM* vm) {
         switch (instruction = READ_BYTE()) {
             case OP_CONSTANT: {
                 EsValue constant = READ_CONSTANT();
-                es_vm_push(vm, constant);
+                PUSH(constant);
+                break;
+            }
+            case OP_CONSTANT_LONG: {
+                EsValue constant = READ_CONSTANT_LONG();
+                PUSH(constant);
                 break;
             }
-            case OP_NULL:  es_vm_push(vm, NULL_VAL); break;
-            case OP_TRUE:  es_vm_push(vm, BOOL_VAL(true)); break;
-            case OP_FALSE: es_vm_push(vm, BOOL_VAL(false)); break;
+            case OP_NULL:  PUSH(NULL_VAL); break;
+            case OP_TRUE:  PUSH(BOOL_VAL(true)); break;
+            case OP_FALSE: PUSH(BOOL_VAL(false)); break;
             
             case OP_POP: es_vm_pop(vm); break;
 
             case OP_GET_LOCAL: {
                 uint8_t slot = READ_BYTE();
                 EsValue* slots = vm->frames[vm->frame_count - 1].slots;
-                es_vm_push(vm, slots[slot]);
+                PUSH(slots[slot]);
                 break;
             }
 
@@ -172,7 +429,7 @@ static EsInterpretResult run(EsVM* vm) {
                 EsValue b = es_vm_pop(vm);
                 EsValue a = es_vm_pop(vm);
                 bool eq = false;
-                if (a.type == b.type || (IS_STRING_VAL(a) && IS_STRING_VAL(b))) {
+                if (VALUE_TYPE(a) == VALUE_TYPE(b) || (IS_STRING_VAL(a) && IS_STRING_VAL(b))) {
                     if (IS_STRING_VAL(a) && IS_STRING_VAL(b)) {
                         const char* s1 = AS_CSTRING(a);
                         const char* s2 = AS_CSTRING(b);
@@ -180,7 +437,7 @@ static EsInterpretResult run(EsVM* vm) {
                         int len2 = AS_STRING_LEN(b);
                         eq = (len1 == len2) && (memcmp(s1, s2, len1) == 0);
                     } else {
-                        switch (a.type) {
+                        switch (VALUE_TYPE(a)) {
                             case VAL_BOOL:   eq = AS_BOOL(a) == AS_BOOL(b); break;
                             case VAL_NULL:   eq = true; break;
                             case VAL_NUMBER: eq = AS_NUMBER(a) == AS_NUMBER(b); break;
@@ -188,7 +445,7 @@ static EsInterpretResult run(EsVM* vm) {
                         }
                     }
                 }
-                es_vm_push(vm, BOOL_VAL(eq));
+                PUSH(BOOL_VAL(eq));
                 break;
             }
             
@@ -217,11 +474,11 @@ static EsInterpretResult run(EsVM* vm) {
                     es_vm_pop(vm);
                     es_vm_pop(vm);
                     
-                    es_vm_push(vm, OBJ_VAL(result));
+                    PUSH(OBJ_VAL(result));
                 } else if (IS_NUMBER(vm->stack_top[-1]) && IS_NUMBER(vm->stack_top[-2])) {
                     double b = AS_NUMBER(es_vm_pop(vm));
                     double a = AS_NUMBER(es_vm_pop(vm));
-                    es_vm_push(vm, NUMBER_VAL(a + b));
+                    PUSH(NUMBER_VAL(a + b));
                 } else {
                     runtime_error(vm, "Operands must be two numbers or two strings.");
                     return INTERPRET_RUNTIME_ERROR;
@@ -241,7 +498,7 @@ static EsInterpretResult run(EsVM* vm) {
                     runtime_error(vm, "Operand must be a number.");
                     return INTERPRET_RUNTIME_ERROR;
                 }
-                vm->stack_top[-1].as.number = -vm->stack_top[-1].as.number;
+                vm->stack_top[-1] = NUMBER_VAL(-AS_NUMBER(vm->stack_top[-1]));
                 break;
 
             case OP_PRINT: {
@@ -261,7 +518,7 @@ static EsInterpretResult run(EsVM* vm) {
                 char buffer[32];
                 int len = snprintf(buffer, sizeof(buffer), "%g", AS_NUMBER(val));
                 EsString* str = es_object_new_string(vm, buffer, len);
-                es_vm_push(vm, OBJ_VAL(str));
+                PUSH(OBJ_VAL(str));
                 break;
             }
 
@@ -289,59 +546,95 @@ static EsInterpretResult run(EsVM* vm) {
             case OP_CALL: {
                 uint8_t arg_count = READ_BYTE();
                 int16_t offset = (int16_t)READ_SHORT();
-                
-            
-            if (vm->frame_count >= FRAMES_MAX) {
-                runtime_error(vm, "Stack overflow (too many call frames).");
-                return INTERPRET_RUNTIME_ERROR;
-            }
-            
-            
-            
-            
-            EsCallFrame* frame = &vm->frames[vm->frame_count++];
-            frame->ip = vm->ip;
-            frame->slots = vm->stack_top - arg_count;
-            
-            
-            vm->ip += offset;
-            break;
+
+                if (ES_VM_UNLIKELY(vm->frame_count >= vm->frame_capacity) && !ensure_frames(vm)) {
+                    runtime_error(vm, "Stack overflow (call depth limit %d reached).", FRAMES_LIMIT);
+                    return INTERPRET_RUNTIME_ERROR;
+                }
+
+                EsCallFrame* frame = &vm->frames[vm->frame_count++];
+                frame->ip = vm->ip;
+                frame->slots = vm->stack_top - arg_count;
+
+                vm->ip += offset;
+                break;
             }
 
             case OP_RETURN: {
                 EsValue result = es_vm_pop(vm);
                 vm->frame_count--;
-                
-                
-                
+
                 vm->stack_top = vm->frames[vm->frame_count].slots;
                 vm->ip = vm->frames[vm->frame_count].ip;
-                
-                
-                es_vm_push(vm, result);
-                
+
+                PUSH(result);
+
                 if (vm->frame_count == 0) {
-                    
-                    
+                    return INTERPRET_OK;
                 }
                 break;
             }
 
             case OP_STK_ADJ: {
                 uint8_t count = READ_BYTE();
+                if (ES_VM_UNLIKELY(vm->stack_top + count > vm->stack_end) && !es_vm_ensure_stack(vm, count)) {
+                    runtime_error(vm, "Stack overflow (value stack limit %d reached).", STACK_LIMIT);
+                    return INTERPRET_RUNTIME_ERROR;
+                }
                 for (int i = 0; i < count; i++) {
-                    es_vm_push(vm, NULL_VAL);
+                    PUSH(NULL_VAL);
                 }
                 break;
             }
             
+            case OP_ADD_LOCAL_CONST: {
+                uint8_t dest = READ_BYTE();
+                uint8_t src = READ_BYTE();
+                EsValue constant = READ_CONSTANT();
+                EsValue* slots = vm->frames[vm->frame_count - 1].slots;
+                if (!IS_NUMBER(slots[src]) || !IS_NUMBER(constant)) {
+                    runtime_error(vm, "Operands must be numbers.");
+                    return INTERPRET_RUNTIME_ERROR;
+                }
+                slots[dest] = NUMBER_VAL(AS_NUMBER(slots[src]) + AS_NUMBER(constant));
+                break;
+            }
+
+            case OP_INC_LOCAL: {
+                uint8_t slot = READ_BYTE();
+                EsValue* slots = vm->frames[vm->frame_count - 1].slots;
+                if (!IS_NUMBER(slots[slot])) {
+                    runtime_error(vm, "Operand must be a number.");
+                    return INTERPRET_RUNTIME_ERROR;
+                }
+                slots[slot] = NUMBER_VAL(AS_NUMBER(slots[slot]) + 1);
+                break;
+            }
+
+            case OP_LESS_JUMP_IF_FALSE: {
+                uint16_t offset = READ_SHORT();
+                if (!IS_NUMBER(vm->stack_top[-1]) || !IS_NUMBER(vm->stack_top[-2])) {
+                    runtime_error(vm, "Operands must be numbers.");
+                    return INTERPRET_RUNTIME_ERROR;
+                }
+                double b = AS_NUMBER(es_vm_pop(vm));
+                double a = AS_NUMBER(es_vm_pop(vm));
+                if (!(a < b)) {
+                    vm->ip += offset;
+                }
+                break;
+            }
+
             case OP_HALT:
                 return INTERPRET_OK;
         }
     }
 
 #undef READ_BYTE
+#undef READ_SHORT
 #undef READ_CONSTANT
+#undef READ_CONSTANT_LONG
+#undef PUSH
 #undef BINARY_OP
 }
 
@@ -350,7 +643,7 @@ EsInterpretResult es_vm_interpret(EsVM* vm, EsChunk* chunk) {
     
     
     
-    for (int i = 0; i < chunk->constants.count; i++) {
+    for (int i = 0; i < chunk->constants.count && !chunk->mapping; i++) {
         if (IS_STRING_LIT(chunk->constants.values[i])) {
             char* s = (char*)AS_STRING_LIT(chunk->constants.values[i]);
             int length = (int)strlen(s);
@@ -360,6 +653,14 @@ EsInterpretResult es_vm_interpret(EsVM* vm, EsChunk* chunk) {
         }
     }
     
+    if (!vm->stack || !vm->frames) {
+        return INTERPRET_RUNTIME_ERROR;
+    }
+    reset_stack(vm);
+    vm->frames[0].ip = NULL;
+    vm->frames[0].slots = vm->stack;
+    vm->frame_count = 1;
+
     vm->ip = vm->chunk->code;
     return run(vm);
 }
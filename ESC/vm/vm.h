@@ -4,8 +4,21 @@
 #include "bytecode.h"
 #include "value.h"
 
-#define STACK_MAX 256
-#define FRAMES_MAX 64
+#define STACK_INITIAL 256
+#define STACK_LIMIT (1024 * 1024)
+#define FRAMES_INITIAL 64
+#define FRAMES_LIMIT (64 * 1024)
+
+#define GC_NURSERY_SIZE (256 * 1024)
+#define GC_HEAP_GROW_FACTOR 2
+
+#ifndef ES_VM_UNLIKELY
+    #ifdef __GNUC__
+        #define ES_VM_UNLIKELY(x) __builtin_expect(!!(x), 0)
+    #else
+        #define ES_VM_UNLIKELY(x) (x)
+    #endif
+#endif
 
 
 
@@ -18,19 +31,48 @@ typedef struct {
 
 
 
+typedef struct {
+    size_t minor_collections;
+    size_t major_collections;
+    size_t bytes_reclaimed;
+    size_t objects_freed;
+    size_t objects_promoted;
+    double total_pause_ms;
+    double max_pause_ms;
+} EsGCStats;
+
+
+
+
 typedef struct {
     EsChunk* chunk;
     uint8_t* ip;          
     
-    EsValue stack[STACK_MAX];
+    EsValue* stack;
     EsValue* stack_top;   
+    EsValue* stack_end;
+    int stack_capacity;
 
-    EsCallFrame frames[FRAMES_MAX];
+    EsCallFrame* frames;
     int frame_count;
+    int frame_capacity;
 
     size_t bytes_allocated;
     size_t next_gc;
+    size_t nursery_bytes;
+    size_t nursery_limit;
     struct EsObject* objects; 
+    struct EsObject* young_objects;
+
+    struct EsObject** gray_stack;
+    int gray_count;
+    int gray_capacity;
+
+    struct EsObject** remembered;
+    int remembered_count;
+    int remembered_capacity;
+
+    EsGCStats gc_stats;
 } EsVM;
 
 typedef enum {
@@ -44,11 +86,16 @@ void es_vm_free(EsVM* vm);
 EsInterpretResult es_vm_interpret(EsVM* vm, EsChunk* chunk);
 
 
+bool es_vm_ensure_stack(EsVM* vm, int needed);
 void es_vm_push(EsVM* vm, EsValue value);
 EsValue es_vm_pop(EsVM* vm);
 
 
 void* es_vm_reallocate(EsVM* vm, void* pointer, size_t old_size, size_t new_size);
 void es_vm_collect_garbage(EsVM* vm);
+void es_vm_collect_nursery(EsVM* vm);
+void es_vm_maybe_collect(EsVM* vm);
+void es_vm_write_barrier(EsVM* vm, struct EsObject* owner, EsValue value);
+void es_vm_print_gc_stats(EsVM* vm, FILE* out);
 
 #endif 
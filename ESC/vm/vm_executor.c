@@ -3,6 +3,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
 VMExecutor* vm_executor_create(const char* bytecode_file_path, int verbose) {
     if (!bytecode_file_path) {
         return NULL;
@@ -46,11 +55,139 @@ void vm_executor_destroy(VMExecutor* executor) {
     ES_FREE(executor);
 }
 
-EsChunk* vm_executor_load_bytecode(VMExecutor* executor) {
-    if (!executor || !executor->bytecode_file_path) {
+static void* map_file(const char* path, size_t* size) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
         return NULL;
     }
-    
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return NULL;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping) {
+        return NULL;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) {
+        return NULL;
+    }
+    *size = (size_t)file_size.QuadPart;
+    return view;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    void* view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        return NULL;
+    }
+    *size = (size_t)st.st_size;
+    return view;
+#endif
+}
+
+static void unmap_file(void* view, size_t size) {
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(view);
+#else
+    munmap(view, size);
+#endif
+}
+
+static bool section_in_bounds(uint32_t offset, uint64_t size, size_t file_size) {
+    return (uint64_t)offset + size <= (uint64_t)file_size;
+}
+
+static EsChunk* load_bytecode_mapped(VMExecutor* executor, void* view, size_t size) {
+    const uint8_t* base = (const uint8_t*)view;
+    EsEbcHeader header;
+    memcpy(&header, base, sizeof(header));
+
+    if (header.file_size > size ||
+        !section_in_bounds(header.code_offset, header.code_size, size) ||
+        !section_in_bounds(header.lines_offset, (uint64_t)header.line_run_count * sizeof(EsEbcLineRun), size) ||
+        !section_in_bounds(header.constants_offset, (uint64_t)header.constant_count * sizeof(EsEbcConstant), size) ||
+        !section_in_bounds(header.strings_offset, header.strings_size, size) ||
+        header.lines_offset % ES_EBC_SECTION_ALIGN != 0 ||
+        header.constants_offset % ES_EBC_SECTION_ALIGN != 0) {
+        if (executor->verbose) {
+            fprintf(stderr, "字节码文件段越界: %s\n", executor->bytecode_file_path);
+        }
+        return NULL;
+    }
+
+    EsChunk* chunk = (EsChunk*)ES_MALLOC(sizeof(EsChunk));
+    if (!chunk) {
+        return NULL;
+    }
+    es_chunk_init(chunk);
+
+    chunk->code = (uint8_t*)(base + header.code_offset);
+    chunk->count = (int)header.code_size;
+    chunk->capacity = (int)header.code_size;
+    chunk->line_runs = (const EsEbcLineRun*)(base + header.lines_offset);
+    chunk->line_run_count = (int)header.line_run_count;
+
+    if (header.constant_count > 0) {
+        chunk->constants.values = (EsValue*)ES_MALLOC(header.constant_count * sizeof(EsValue));
+        if (!chunk->constants.values) {
+            ES_FREE(chunk);
+            return NULL;
+        }
+    }
+
+    const EsEbcConstant* constants = (const EsEbcConstant*)(base + header.constants_offset);
+    const char* strings = (const char*)(base + header.strings_offset);
+    for (uint32_t i = 0; i < header.constant_count; i++) {
+        EsValue value = NULL_VAL;
+        switch ((EsValueType)constants[i].type) {
+            case VAL_BOOL:
+                value = BOOL_VAL(constants[i].as.boolean != 0);
+                break;
+            case VAL_NUMBER:
+                value = NUMBER_VAL(constants[i].as.number);
+                break;
+            case VAL_STRING_LITERAL: {
+                uint64_t end = constants[i].as.string_offset + constants[i].length;
+                if (end >= header.strings_size || strings[end] != '\0') {
+                    if (executor->verbose) {
+                        fprintf(stderr, "字节码字符串池损坏: %s\n", executor->bytecode_file_path);
+                    }
+                    ES_FREE(chunk->constants.values);
+                    ES_FREE(chunk);
+                    return NULL;
+                }
+                value = STRING_VAL(strings + constants[i].as.string_offset);
+                break;
+            }
+            case VAL_NULL:
+            case VAL_OBJ:
+                break;
+        }
+        chunk->constants.values[i] = value;
+    }
+    chunk->constants.count = (int)header.constant_count;
+    chunk->constants.capacity = (int)header.constant_count;
+
+    chunk->mapping = view;
+    chunk->mapping_size = size;
+    return chunk;
+}
+
+static EsChunk* load_bytecode_stream(VMExecutor* executor) {
     FILE* file = fopen(executor->bytecode_file_path, "rb");
     if (!file) {
         if (executor->verbose) {
@@ -72,7 +209,7 @@ EsChunk* vm_executor_load_bytecode(VMExecutor* executor) {
     }
     
     
-    if (magic != 0x45534243) { 
+    if (magic != ES_EBC_MAGIC) { 
         fclose(file);
         if (executor->verbose) {
             fprintf(stderr, "无效的字节码文件格式: %s\n", executor->bytecode_file_path);
@@ -81,7 +218,7 @@ EsChunk* vm_executor_load_bytecode(VMExecutor* executor) {
     }
     
     
-    if (version != 1) {
+    if (version != ES_EBC_VERSION_STREAM) {
         fclose(file);
         if (executor->verbose) {
             fprintf(stderr, "不支持的字节码文件版本: %s (版本 %d)\n", executor->bytecode_file_path, version);
@@ -153,31 +290,38 @@ EsChunk* vm_executor_load_bytecode(VMExecutor* executor) {
         
         
         for (int i = 0; i < constant_count; i++) {
-            EsValue value;
-            if (fread(&value.type, sizeof(EsValueType), 1, file) != 1) {
+            EsValue value = NULL_VAL;
+            EsValueType type;
+            if (fread(&type, sizeof(EsValueType), 1, file) != 1) {
                 fclose(file);
                 es_chunk_free(chunk);
                 ES_FREE(chunk);
                 return NULL;
             }
             
-            switch (value.type) {
-                case VAL_BOOL:
-                    if (fread(&value.as.boolean, sizeof(bool), 1, file) != 1) {
+            switch (type) {
+                case VAL_BOOL: {
+                    bool boolean;
+                    if (fread(&boolean, sizeof(bool), 1, file) != 1) {
                         fclose(file);
                         es_chunk_free(chunk);
                         ES_FREE(chunk);
                         return NULL;
                     }
+                    value = BOOL_VAL(boolean);
                     break;
-                case VAL_NUMBER:
-                    if (fread(&value.as.number, sizeof(double), 1, file) != 1) {
+                }
+                case VAL_NUMBER: {
+                    double number;
+                    if (fread(&number, sizeof(double), 1, file) != 1) {
                         fclose(file);
                         es_chunk_free(chunk);
                         ES_FREE(chunk);
                         return NULL;
                     }
+                    value = NUMBER_VAL(number);
                     break;
+                }
                 case VAL_STRING_LITERAL: {
                     uint16_t length;
                     if (fread(&length, sizeof(uint16_t), 1, file) != 1) {
@@ -204,7 +348,7 @@ EsChunk* vm_executor_load_bytecode(VMExecutor* executor) {
                     }
                     
                     string[length] = '\0';
-                    value.as.string_literal = string;
+                    value = STRING_VAL(string);
                     break;
                 }
                 case VAL_NULL:
@@ -223,12 +367,42 @@ EsChunk* vm_executor_load_bytecode(VMExecutor* executor) {
     fclose(file);
     return chunk;
 }
+
+EsChunk* vm_executor_load_bytecode(VMExecutor* executor) {
+    if (!executor || !executor->bytecode_file_path) {
+        return NULL;
+    }
+
+    size_t size = 0;
+    void* view = map_file(executor->bytecode_file_path, &size);
+    if (view && size >= sizeof(EsEbcHeader)) {
+        const EsEbcHeader* header = (const EsEbcHeader*)view;
+        if (header->magic == ES_EBC_MAGIC && header->version == ES_EBC_VERSION_MAPPED) {
+            EsChunk* chunk = load_bytecode_mapped(executor, view, size);
+            if (!chunk) {
+                unmap_file(view, size);
+            }
+            return chunk;
+        }
+    }
+    if (view) {
+        unmap_file(view, size);
+    }
+
+    return load_bytecode_stream(executor);
+}
+
 void vm_executor_free_chunk(VMExecutor* executor, EsChunk* chunk) {
     if (!executor || !chunk) {
         return;
     }
     
+    void* mapping = chunk->mapping;
+    size_t mapping_size = chunk->mapping_size;
     es_chunk_free(chunk);
+    if (mapping) {
+        unmap_file(mapping, mapping_size);
+    }
     ES_FREE(chunk);
 }
 
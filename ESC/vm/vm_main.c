@@ -8,6 +8,7 @@ static void print_usage(const char* program_name) {
     printf("用法: %s [选项] <字节码文件>\n", program_name);
     printf("选项:\n");
     printf("  -v, --verbose    显示详细输出\n");
+    printf("  --gc-stats       执行结束后输出垃圾回收统计信息\n");
     printf("  -h, --help       显示此帮助信息\n");
 }
 
@@ -19,6 +20,7 @@ int main(int argc, char* argv[]) {
     
     const char* bytecode_file = NULL;
     int verbose = 0;
+    int gc_stats = 0;
     
     
     for (int i = 1; i < argc; i++) {
@@ -27,6 +29,8 @@ int main(int argc, char* argv[]) {
             return 0;
         } else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0) {
             verbose = 1;
+        } else if (strcmp(argv[i], "--gc-stats") == 0) {
+            gc_stats = 1;
         } else if (argv[i][0] != '-') {
             if (bytecode_file == NULL) {
                 bytecode_file = argv[i];
@@ -55,6 +59,10 @@ int main(int argc, char* argv[]) {
     
     EsInterpretResult result = vm_executor_execute(executor);
     
+    if (gc_stats) {
+        es_vm_print_gc_stats(&executor->vm, stderr);
+    }
+    
     
     vm_executor_destroy(executor);
     
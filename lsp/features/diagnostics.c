@@ -8,6 +8,7 @@
 #include "../../../src/compiler/frontend/parser/ast.h"
 #include "../../../src/compiler/frontend/semantic/symbol_table.h"
 #include "../lsp_log.h"
+#include "../lsp_analysis.h"
 
 static const char* es_keywords[] = {
     "function", "var", "if", "else", "while", "for", "foreach", "in",
@@ -28,108 +29,81 @@ static int is_keyword(const char* word) {
     return 0;
 }
 
-LspDiagnosticList* lsp_analyze_document(const char* uri, const char* content) {
-    if (!content) return NULL;
+static const char* symbol_kind_label(SymbolType type) {
+    switch (type) {
+        case SYMBOL_FUNCTION: return "Function";
+        case SYMBOL_VARIABLE: return "Variable";
+        case SYMBOL_CLASS: return "Class";
+        case SYMBOL_NAMESPACE: return "Namespace";
+        default: return "Symbol";
+    }
+}
+
+const LspDiagnosticList* lsp_analyze_document(LspDocument* doc) {
+    return lsp_analysis_get_diagnostics(lsp_document_get_analysis(doc));
+}
+
+const LspDiagnosticList* lsp_analysis_get_diagnostics(struct LspAnalysis* analysis) {
+    if (!analysis) return NULL;
+    if (analysis->diagnostics) return analysis->diagnostics;
     
     LspDiagnosticList* list = lsp_diagnostic_list_create();
     if (!list) return NULL;
     
-    Lexer* lexer = lexer_create(content);
-    if (!lexer) {
-        lsp_diagnostic_list_destroy(list);
-        return NULL;
-    }
-    
-    Token prev_token;
-    prev_token.type = TOKEN_EOF;
-    prev_token.value = NULL;
-    prev_token.line = 0;
-    prev_token.column = 0;
-    
-    Token token;
-    do {
-        token = lexer_next_token(lexer);
+    for (int i = 0; i < analysis->token_count; i++) {
+        const Token* token = &analysis->tokens[i];
         
-        if (token.type == TOKEN_UNKNOWN) {
+        if (token->type == TOKEN_UNKNOWN) {
             LspDiagnostic diag = {0};
-            diag.start_line = token.line - 1;
-            diag.start_char = token.column - 1;
-            diag.end_line = token.line - 1;
-            diag.end_char = token.column;
+            diag.start_line = token->line - 1;
+            diag.start_char = token->column - 1;
+            diag.end_line = token->line - 1;
+            diag.end_char = token->column;
             diag.severity = LSP_SEVERITY_ERROR;
             diag.source = strdup("E#");
             diag.message = strdup("Unknown token");
             lsp_diagnostic_list_add(list, &diag);
         }
         
-        if (prev_token.type == TOKEN_IDENTIFIER && token.type == TOKEN_IDENTIFIER) {
+        if (i > 0 && analysis->tokens[i - 1].type == TOKEN_IDENTIFIER && token->type == TOKEN_IDENTIFIER) {
             LspDiagnostic diag = {0};
-            diag.start_line = token.line - 1;
-            diag.start_char = token.column - 1;
-            diag.end_line = token.line - 1;
-            diag.end_char = token.column + (int)strlen(token.value);
+            diag.start_line = token->line - 1;
+            diag.start_char = token->column - 1;
+            diag.end_line = token->line - 1;
+            diag.end_char = token->column + (int)strlen(token->value);
             diag.severity = LSP_SEVERITY_ERROR;
             diag.source = strdup("E#");
             diag.message = strdup("Missing semicolon or operator between identifiers");
             lsp_diagnostic_list_add(list, &diag);
         }
-        
-        if (prev_token.value) {
-            free(prev_token.value);
-        }
-        prev_token = token;
-        prev_token.value = token.value ? strdup(token.value) : NULL;
-        
-        if (token.value && token.type == TOKEN_IDENTIFIER) {
-            free(token.value);
-        }
-    } while (token.type != TOKEN_EOF);
-    
-    if (prev_token.value) {
-        free(prev_token.value);
     }
     
-    lexer_reset(lexer);
-    Parser* parser = parser_create(lexer);
-    if (parser) {
-        ASTNode* ast = parser_parse(parser);
-        if (!ast) {
-            LspDiagnostic diag = {0};
-            diag.start_line = 0;
-            diag.start_char = 0;
-            diag.end_line = 0;
-            diag.end_char = 1;
-            diag.severity = LSP_SEVERITY_ERROR;
-            diag.source = strdup("E#");
-            diag.message = strdup("Parse error");
-            lsp_diagnostic_list_add(list, &diag);
-        } else {
-            SymbolTable* sym_table = symbol_table_create();
-            if (sym_table) {
-                
-                
-                
-                int errors = symbol_table_get_error_count(sym_table);
-                if (errors > 0) {
-                    LSP_LOG_DEBUG("Symbol table has %d errors", errors);
-                }
-                
-                symbol_table_destroy(sym_table);
-            }
-            ast_destroy_node(ast);
+    if (!analysis->ast) {
+        LspDiagnostic diag = {0};
+        diag.start_line = 0;
+        diag.start_char = 0;
+        diag.end_line = 0;
+        diag.end_char = 1;
+        diag.severity = LSP_SEVERITY_ERROR;
+        diag.source = strdup("E#");
+        diag.message = strdup("Parse error");
+        lsp_diagnostic_list_add(list, &diag);
+    } else if (analysis->symbols) {
+        int errors = symbol_table_get_error_count(analysis->symbols);
+        if (errors > 0) {
+            LSP_LOG_DEBUG("Symbol table has %d errors", errors);
         }
-        parser_destroy(parser);
     }
     
-    lexer_destroy(lexer);
-    
     LSP_LOG_DEBUG("Analysis complete: %d diagnostics", list->count);
     
+    analysis->diagnostics = list;
     return list;
 }
 
-LspCompletionList* lsp_get_completions(const char* content, int line, int col) {
-    if (!content) return NULL;
+LspCompletionList* lsp_get_completions(LspDocument* doc, int line, int col) {
+    LspAnalysis* analysis = lsp_document_get_analysis(doc);
+    if (!analysis) return NULL;
     
     LspCompletionList* list = lsp_completion_list_create();
     if (!list) return NULL;
@@ -144,38 +118,33 @@ LspCompletionList* lsp_get_completions(const char* content, int line, int col) {
         lsp_completion_list_add(list, &item);
     }
     
-    Lexer* lexer = lexer_create(content);
-    if (lexer) {
-        Token token;
-        do {
-            token = lexer_next_token(lexer);
-            if (token.type == TOKEN_IDENTIFIER && token.value) {
-                int exists = 0;
-                for (int i = 0; i < list->count; i++) {
-                    if (list->items[i].label && strcmp(list->items[i].label, token.value) == 0) {
-                        exists = 1;
-                        break;
-                    }
-                }
-                if (!exists) {
-                    LspCompletionItem item = {0};
-                    item.label = strdup(token.value);
-                    item.kind = LSP_COMPLETION_ITEM_KIND_VARIABLE;
-                    item.insert_text = strdup(token.value);
-                    item.insert_text_format = LSP_INSERT_TEXT_FORMAT_PLAIN_TEXT;
-                    item.detail = strdup("Symbol");
-                    lsp_completion_list_add(list, &item);
+    for (int t = 0; t < analysis->token_count; t++) {
+        const Token* token = &analysis->tokens[t];
+        if (token->type == TOKEN_IDENTIFIER && token->value) {
+            int exists = 0;
+            for (int i = 0; i < list->count; i++) {
+                if (list->items[i].label && strcmp(list->items[i].label, token->value) == 0) {
+                    exists = 1;
+                    break;
                 }
             }
-            if (token.value) free(token.value);
-        } while (token.type != TOKEN_EOF);
-        lexer_destroy(lexer);
+            if (!exists) {
+                LspCompletionItem item = {0};
+                item.label = strdup(token->value);
+                item.kind = LSP_COMPLETION_ITEM_KIND_VARIABLE;
+                item.insert_text = strdup(token->value);
+                item.insert_text_format = LSP_INSERT_TEXT_FORMAT_PLAIN_TEXT;
+                item.detail = strdup("Symbol");
+                lsp_completion_list_add(list, &item);
+            }
+        }
     }
     
     return list;
 }
 
-char* lsp_get_hover_info(const char* content, int line, int col) {
+char* lsp_get_hover_info(LspDocument* doc, int line, int col) {
+    const char* content = lsp_document_get_content(doc);
     if (!content) return NULL;
     
     const char** lines = NULL;
@@ -220,6 +189,8 @@ char* lsp_get_hover_info(const char* content, int line, int col) {
     line_text[line_len] = '\0';
     free(lines);
     
+    if (col < 0) col = 0;
+    if (col > (int)line_len) col = (int)line_len;
     int start = col;
     while (start > 0 && (isalnum((unsigned char)line_text[start - 1]) || line_text[start - 1] == '_')) {
         start--;
@@ -250,23 +221,18 @@ char* lsp_get_hover_info(const char* content, int line, int col) {
             sprintf(result, "**%s**\n\nE# keyword", word);
         }
     } else {
-        Lexer* lexer = lexer_create(content);
-        if (lexer) {
-            Parser* parser = parser_create(lexer);
-            if (parser) {
-                ASTNode* ast = parser_parse(parser);
-                if (ast) {
-                    
-                    ast_destroy_node(ast);
-                }
-                parser_destroy(parser);
+        const char* kind = "Symbol";
+        LspAnalysis* analysis = lsp_document_get_analysis(doc);
+        if (analysis && analysis->symbols) {
+            SymbolEntry* entry = symbol_table_lookup(analysis->symbols, word);
+            if (entry) {
+                kind = symbol_kind_label(entry->type);
             }
-            lexer_destroy(lexer);
         }
         
-        result = (char*)malloc(strlen(word) + 64);
+        result = (char*)malloc(strlen(word) + strlen(kind) + 64);
         if (result) {
-            sprintf(result, "**%s**\n\nSymbol", word);
+            sprintf(result, "**%s**\n\n%s", word, kind);
         }
     }
     
@@ -274,7 +240,8 @@ char* lsp_get_hover_info(const char* content, int line, int col) {
     return result;
 }
 
-LspLocation* lsp_get_definition(const char* content, int line, int col) {
+LspLocation* lsp_get_definition(LspDocument* doc, int line, int col) {
+    const char* content = lsp_document_get_content(doc);
     if (!content) return NULL;
     
     const char** lines = NULL;
@@ -319,6 +286,8 @@ LspLocation* lsp_get_definition(const char* content, int line, int col) {
     line_text[line_len] = '\0';
     free(lines);
     
+    if (col < 0) col = 0;
+    if (col > (int)line_len) col = (int)line_len;
     int start = col;
     while (start > 0 && (isalnum((unsigned char)line_text[start - 1]) || line_text[start - 1] == '_')) {
         start--;
@@ -344,21 +313,17 @@ LspLocation* lsp_get_definition(const char* content, int line, int col) {
     
     LspLocation* location = NULL;
     
-    Lexer* lexer = lexer_create(content);
-    if (lexer) {
-        Parser* parser = parser_create(lexer);
-        if (parser) {
-            ASTNode* ast = parser_parse(parser);
-            if (ast) {
-                
-                
-                
-                
-                ast_destroy_node(ast);
-            }
-            parser_destroy(parser);
+    LspAnalysis* analysis = lsp_document_get_analysis(doc);
+    SymbolEntry* entry = (analysis && analysis->symbols) ? symbol_table_lookup(analysis->symbols, word) : NULL;
+    if (entry && entry->declaration_line > 0) {
+        location = (LspLocation*)calloc(1, sizeof(LspLocation));
+        if (location) {
+            location->uri = strdup(doc->uri);
+            location->range.start.line = entry->declaration_line - 1;
+            location->range.start.character = 0;
+            location->range.end.line = entry->declaration_line - 1;
+            location->range.end.character = 0;
         }
-        lexer_destroy(lexer);
     }
     
     free(word);
@@ -2,10 +2,12 @@
 #define LSP_FEATURES_DIAGNOSTICS_H
 
 #include "../protocol/lsp_messages.h"
+#include "../lsp_document.h"
 
-LspDiagnosticList* lsp_analyze_document(const char* uri, const char* content);
-LspCompletionList* lsp_get_completions(const char* content, int line, int col);
-char* lsp_get_hover_info(const char* content, int line, int col);
-LspLocation* lsp_get_definition(const char* content, int line, int col);
+const LspDiagnosticList* lsp_analyze_document(LspDocument* doc);
+const LspDiagnosticList* lsp_analysis_get_diagnostics(struct LspAnalysis* analysis);
+LspCompletionList* lsp_get_completions(LspDocument* doc, int line, int col);
+char* lsp_get_hover_info(LspDocument* doc, int line, int col);
+LspLocation* lsp_get_definition(LspDocument* doc, int line, int col);
 
 #endif
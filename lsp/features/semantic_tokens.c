@@ -0,0 +1,442 @@
+#include "semantic_tokens.h"
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+#include "../lsp_analysis.h"
+#include "../lsp_text_buffer.h"
+#include "../protocol/json_rpc.h"
+
+#define SEMANTIC_MAX_PARAMETERS 32
+
+typedef struct {
+    int* data;
+    int count;
+    int capacity;
+    int prev_line;
+    int prev_char;
+} TokenEncoder;
+
+typedef struct {
+    const char* names[SEMANTIC_MAX_PARAMETERS];
+    int count;
+    int pending_function;
+    int paren_depth;
+    int awaiting_body;
+    int brace_depth;
+    int body_depth;
+} ParameterScope;
+
+void lsp_semantic_tokens_destroy(LspSemanticTokens* tokens) {
+    if (!tokens) return;
+    free(tokens->data);
+    free(tokens);
+}
+
+static int encoder_push(TokenEncoder* encoder, int line, int character, int length, int type, int modifiers) {
+    if (encoder->count + 5 > encoder->capacity) {
+        int capacity = encoder->capacity ? encoder->capacity * 2 : 640;
+        int* data = (int*)realloc(encoder->data, capacity * sizeof(int));
+        if (!data) return -1;
+        encoder->data = data;
+        encoder->capacity = capacity;
+    }
+
+    int delta_line = line - encoder->prev_line;
+    int delta_char = delta_line == 0 ? character - encoder->prev_char : character;
+
+    int* out = encoder->data + encoder->count;
+    out[0] = delta_line;
+    out[1] = delta_char;
+    out[2] = length;
+    out[3] = type;
+    out[4] = modifiers;
+    encoder->count += 5;
+    encoder->prev_line = line;
+    encoder->prev_char = character;
+    return 0;
+}
+
+static int classify_keyword(EsTokenType type) {
+    switch (type) {
+        case TOKEN_EOF:
+        case TOKEN_IDENTIFIER:
+        case TOKEN_LEFT_PAREN:
+        case TOKEN_RIGHT_PAREN:
+        case TOKEN_LEFT_BRACE:
+        case TOKEN_RIGHT_BRACE:
+        case TOKEN_LEFT_BRACKET:
+        case TOKEN_RIGHT_BRACKET:
+        case TOKEN_COMMA:
+        case TOKEN_SEMICOLON:
+        case TOKEN_COLON:
+        case TOKEN_DOUBLE_COLON:
+        case TOKEN_DOT:
+        case TOKEN_ATTRIBUTE:
+        case TOKEN_UNKNOWN:
+            return -1;
+        case TOKEN_NUMBER:
+            return LSP_SEMANTIC_NUMBER;
+        case TOKEN_STRING:
+            return LSP_SEMANTIC_STRING;
+        case TOKEN_TYPE_STRING:
+        case TOKEN_INT8:
+        case TOKEN_INT16:
+        case TOKEN_INT32:
+        case TOKEN_INT64:
+        case TOKEN_UINT8:
+        case TOKEN_UINT16:
+        case TOKEN_UINT32:
+        case TOKEN_UINT64:
+        case TOKEN_FLOAT32:
+        case TOKEN_FLOAT64:
+        case TOKEN_BOOL:
+        case TOKEN_CHAR:
+        case TOKEN_VOID:
+        case TOKEN_EXCEPTION:
+            return LSP_SEMANTIC_TYPE;
+        case TOKEN_PLUS:
+        case TOKEN_MINUS:
+        case TOKEN_MULTIPLY:
+        case TOKEN_DIVIDE:
+        case TOKEN_MODULO:
+        case TOKEN_ASSIGN:
+        case TOKEN_EQUAL:
+        case TOKEN_NOT_EQUAL:
+        case TOKEN_LESS:
+        case TOKEN_GREATER:
+        case TOKEN_LESS_EQUAL:
+        case TOKEN_GREATER_EQUAL:
+        case TOKEN_ARROW:
+        case TOKEN_AND:
+        case TOKEN_OR:
+        case TOKEN_NOT:
+        case TOKEN_INCREMENT:
+        case TOKEN_DECREMENT:
+        case TOKEN_PLUS_ASSIGN:
+        case TOKEN_MINUS_ASSIGN:
+        case TOKEN_MUL_ASSIGN:
+        case TOKEN_DIV_ASSIGN:
+        case TOKEN_MOD_ASSIGN:
+        case TOKEN_TILDE:
+        case TOKEN_BITWISE_AND:
+        case TOKEN_BITWISE_OR:
+        case TOKEN_BITWISE_XOR:
+        case TOKEN_LSHIFT:
+        case TOKEN_RSHIFT:
+        case TOKEN_POWER:
+        case TOKEN_QUESTION:
+        case TOKEN_QUESTION_COLON:
+        case TOKEN_LAMBDA:
+            return LSP_SEMANTIC_OPERATOR;
+        default:
+            return LSP_SEMANTIC_KEYWORD;
+    }
+}
+
+static int is_parameter(const ParameterScope* scope, const char* name) {
+    for (int i = 0; i < scope->count; i++) {
+        if (strcmp(scope->names[i], name) == 0) return 1;
+    }
+    return 0;
+}
+
+static void track_scope(ParameterScope* scope, const Token* token, const Token* next) {
+    switch (token->type) {
+        case TOKEN_FUNCTION:
+            if (next->type == TOKEN_IDENTIFIER) scope->pending_function = 1;
+            break;
+        case TOKEN_LEFT_PAREN:
+            if (scope->pending_function) {
+                scope->pending_function = 0;
+                scope->count = 0;
+                scope->body_depth = -1;
+                scope->paren_depth = 1;
+            } else if (scope->paren_depth > 0) {
+                scope->paren_depth++;
+            }
+            break;
+        case TOKEN_RIGHT_PAREN:
+            if (scope->paren_depth > 0 && --scope->paren_depth == 0) scope->awaiting_body = 1;
+            break;
+        case TOKEN_LEFT_BRACE:
+            scope->brace_depth++;
+            if (scope->awaiting_body) {
+                scope->awaiting_body = 0;
+                scope->body_depth = scope->brace_depth;
+            }
+            break;
+        case TOKEN_RIGHT_BRACE:
+            if (scope->brace_depth == scope->body_depth) {
+                scope->count = 0;
+                scope->body_depth = -1;
+            }
+            scope->brace_depth--;
+            break;
+        case TOKEN_SEMICOLON:
+            scope->awaiting_body = 0;
+            break;
+        default:
+            break;
+    }
+}
+
+static int classify_type_name(const LspAnalysis* analysis, const Token* token) {
+    SymbolEntry* entry = analysis->symbols ? symbol_table_lookup(analysis->symbols, token->value) : NULL;
+    return entry && entry->type == SYMBOL_CLASS ? LSP_SEMANTIC_CLASS : LSP_SEMANTIC_TYPE;
+}
+
+static int is_parameter_declaration(const ParameterScope* scope, const Token* prev, const Token* next) {
+    if (scope->paren_depth != 1 || !prev) return 0;
+
+    switch (next->type) {
+        case TOKEN_COLON:
+        case TOKEN_COMMA:
+        case TOKEN_RIGHT_PAREN:
+        case TOKEN_ASSIGN:
+            break;
+        default:
+            return 0;
+    }
+
+    switch (prev->type) {
+        case TOKEN_LEFT_PAREN:
+        case TOKEN_COMMA:
+        case TOKEN_IDENTIFIER:
+        case TOKEN_RIGHT_BRACKET:
+        case TOKEN_GREATER:
+            return 1;
+        default:
+            return classify_keyword(prev->type) == LSP_SEMANTIC_TYPE;
+    }
+}
+
+static int classify_identifier(const LspAnalysis* analysis, ParameterScope* scope,
+                               const Token* prev, const Token* token, const Token* next, int* modifiers) {
+    *modifiers = 0;
+
+    if (scope->paren_depth > 0) {
+        if ((prev && prev->type == TOKEN_COLON) || next->type == TOKEN_IDENTIFIER) {
+            return classify_type_name(analysis, token);
+        }
+        if (is_parameter_declaration(scope, prev, next)) {
+            if (scope->count < SEMANTIC_MAX_PARAMETERS) scope->names[scope->count++] = token->value;
+            *modifiers = LSP_SEMANTIC_MOD_DECLARATION;
+            return LSP_SEMANTIC_PARAMETER;
+        }
+    }
+
+    if (prev) {
+        switch (prev->type) {
+            case TOKEN_FUNCTION:
+                *modifiers = LSP_SEMANTIC_MOD_DECLARATION;
+                return LSP_SEMANTIC_FUNCTION;
+            case TOKEN_CLASS:
+            case TOKEN_STRUCT:
+            case TOKEN_INTERFACE:
+            case TOKEN_ENUM:
+                *modifiers = LSP_SEMANTIC_MOD_DECLARATION;
+                return LSP_SEMANTIC_CLASS;
+            case TOKEN_NAMESPACE:
+                *modifiers = LSP_SEMANTIC_MOD_DECLARATION;
+                return LSP_SEMANTIC_NAMESPACE;
+            case TOKEN_VAR:
+                *modifiers = LSP_SEMANTIC_MOD_DECLARATION;
+                return LSP_SEMANTIC_VARIABLE;
+            case TOKEN_NEW:
+                return LSP_SEMANTIC_CLASS;
+            case TOKEN_DOT:
+                return next->type == TOKEN_LEFT_PAREN ? LSP_SEMANTIC_FUNCTION : LSP_SEMANTIC_PROPERTY;
+            default:
+                break;
+        }
+    }
+
+    if (scope->count > 0 && is_parameter(scope, token->value)) return LSP_SEMANTIC_PARAMETER;
+
+    SymbolEntry* entry = analysis->symbols ? symbol_table_lookup(analysis->symbols, token->value) : NULL;
+    if (entry) {
+        switch (entry->type) {
+            case SYMBOL_FUNCTION: return LSP_SEMANTIC_FUNCTION;
+            case SYMBOL_CLASS: return LSP_SEMANTIC_CLASS;
+            case SYMBOL_TYPE: return LSP_SEMANTIC_TYPE;
+            case SYMBOL_NAMESPACE: return LSP_SEMANTIC_NAMESPACE;
+            case SYMBOL_FIELD: return LSP_SEMANTIC_PROPERTY;
+            case SYMBOL_STATIC_FIELD:
+                *modifiers = LSP_SEMANTIC_MOD_STATIC;
+                return LSP_SEMANTIC_PROPERTY;
+            default: return LSP_SEMANTIC_VARIABLE;
+        }
+    }
+
+    return next->type == TOKEN_LEFT_PAREN ? LSP_SEMANTIC_FUNCTION : LSP_SEMANTIC_VARIABLE;
+}
+
+static int string_token_length(LspDocument* doc, int line, int character) {
+    int start = lsp_text_buffer_offset_from_line_col(doc->text, line, character);
+    int end = lsp_text_buffer_offset_from_line_col(doc->text, line, INT_MAX);
+    if (end <= start) return 0;
+
+    char* text = lsp_text_buffer_substring(doc->text, start, end);
+    if (!text) return end - start;
+
+    int length = end - start;
+    for (int i = 1; i < end - start; i++) {
+        if (text[i] == '\\' && i + 1 < end - start) {
+            i++;
+        } else if (text[i] == '"') {
+            length = i + 1;
+            break;
+        }
+    }
+    free(text);
+    return length;
+}
+
+static LspSemanticTokens* compute_tokens(LspDocument* doc, int result_id) {
+    LspAnalysis* analysis = lsp_document_get_analysis(doc);
+    if (!analysis) return NULL;
+
+    LspSemanticTokens* result = (LspSemanticTokens*)calloc(1, sizeof(LspSemanticTokens));
+    if (!result) return NULL;
+
+    TokenEncoder encoder;
+    memset(&encoder, 0, sizeof(encoder));
+    ParameterScope scope;
+    memset(&scope, 0, sizeof(scope));
+    scope.body_depth = -1;
+
+    int last = analysis->token_count - 1;
+    for (int i = 0; i < analysis->token_count; i++) {
+        const Token* token = &analysis->tokens[i];
+        if (token->type == TOKEN_EOF) break;
+
+        const Token* prev = i > 0 ? &analysis->tokens[i - 1] : NULL;
+        const Token* next = &analysis->tokens[i < last ? i + 1 : last];
+        int line = token->line > 0 ? token->line - 1 : 0;
+        int character = token->column > 0 ? token->column - 1 : 0;
+        int modifiers = 0;
+        int type;
+        int length;
+
+        if (token->type == TOKEN_IDENTIFIER) {
+            type = classify_identifier(analysis, &scope, prev, token, next, &modifiers);
+            length = token->value ? (int)strlen(token->value) : 0;
+        } else {
+            type = classify_keyword(token->type);
+            if (token->type == TOKEN_STRING) {
+                length = string_token_length(doc, line, character);
+            } else {
+                length = token->value ? (int)strlen(token->value) : 0;
+            }
+        }
+
+        track_scope(&scope, token, next);
+
+        if (type < 0 || length <= 0) continue;
+        if (encoder_push(&encoder, line, character, length, type, modifiers) != 0) {
+            free(encoder.data);
+            free(result);
+            return NULL;
+        }
+    }
+
+    result->data = encoder.data;
+    result->count = encoder.count;
+    result->version = doc->version;
+    result->result_id = result_id;
+    return result;
+}
+
+static LspSemanticTokens* current_tokens(LspDocument* doc) {
+    LspSemanticTokens* cached = doc->semantic_tokens;
+    if (cached && cached->version == doc->version) return cached;
+
+    LspSemanticTokens* tokens = compute_tokens(doc, cached ? cached->result_id + 1 : 1);
+    if (!tokens) return NULL;
+
+    lsp_semantic_tokens_destroy(cached);
+    doc->semantic_tokens = tokens;
+    return tokens;
+}
+
+static void append_data(LspBuffer* out, const int* data, int count) {
+    lsp_buffer_append(out, "[", 1);
+    for (int i = 0; i < count; i++) {
+        if (i > 0) lsp_buffer_append(out, ",", 1);
+        lsp_buffer_append_int(out, data[i]);
+    }
+    lsp_buffer_append(out, "]", 1);
+}
+
+char* lsp_semantic_tokens_full(LspDocument* doc) {
+    if (!doc) return NULL;
+
+    LspSemanticTokens* tokens = current_tokens(doc);
+    if (!tokens) return NULL;
+
+    LspBuffer out;
+    lsp_buffer_init(&out);
+    lsp_buffer_append_str(&out, "{\"resultId\":\"");
+    lsp_buffer_append_int(&out, tokens->result_id);
+    lsp_buffer_append_str(&out, "\",\"data\":");
+    append_data(&out, tokens->data, tokens->count);
+    lsp_buffer_append(&out, "}", 1);
+    return out.data;
+}
+
+char* lsp_semantic_tokens_delta(LspDocument* doc, const char* previous_result_id) {
+    if (!doc) return NULL;
+
+    LspSemanticTokens* previous = doc->semantic_tokens;
+    char previous_id[16];
+    if (previous) snprintf(previous_id, sizeof(previous_id), "%d", previous->result_id);
+    if (!previous || !previous_result_id || strcmp(previous_id, previous_result_id) != 0) {
+        return lsp_semantic_tokens_full(doc);
+    }
+
+    LspSemanticTokens* current = previous;
+    if (previous->version != doc->version) {
+        current = compute_tokens(doc, previous->result_id + 1);
+        if (!current) return NULL;
+        doc->semantic_tokens = current;
+    }
+
+    LspBuffer out;
+    lsp_buffer_init(&out);
+    lsp_buffer_append_str(&out, "{\"resultId\":\"");
+    lsp_buffer_append_int(&out, current->result_id);
+    lsp_buffer_append_str(&out, "\",\"edits\":[");
+
+    if (current != previous) {
+        int prefix = 0;
+        while (prefix < previous->count && prefix < current->count &&
+               previous->data[prefix] == current->data[prefix]) {
+            prefix++;
+        }
+        prefix -= prefix % 5;
+
+        int suffix = 0;
+        while (suffix < previous->count - prefix && suffix < current->count - prefix &&
+               previous->data[previous->count - 1 - suffix] == current->data[current->count - 1 - suffix]) {
+            suffix++;
+        }
+        suffix -= suffix % 5;
+
+        int delete_count = previous->count - prefix - suffix;
+        int insert_count = current->count - prefix - suffix;
+        if (delete_count > 0 || insert_count > 0) {
+            lsp_buffer_append_str(&out, "{\"start\":");
+            lsp_buffer_append_int(&out, prefix);
+            lsp_buffer_append_str(&out, ",\"deleteCount\":");
+            lsp_buffer_append_int(&out, delete_count);
+            lsp_buffer_append_str(&out, ",\"data\":");
+            append_data(&out, current->data + prefix, insert_count);
+            lsp_buffer_append(&out, "}", 1);
+        }
+        lsp_semantic_tokens_destroy(previous);
+    }
+
+    lsp_buffer_append_str(&out, "]}");
+    return out.data;
+}
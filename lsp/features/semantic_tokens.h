@@ -0,0 +1,40 @@
+#ifndef LSP_FEATURES_SEMANTIC_TOKENS_H
+#define LSP_FEATURES_SEMANTIC_TOKENS_H
+
+#include "../lsp_document.h"
+
+#define LSP_SEMANTIC_TOKEN_TYPES "[\"namespace\",\"class\",\"function\",\"variable\",\"parameter\",\"property\",\"keyword\",\"string\",\"number\",\"operator\",\"type\"]"
+#define LSP_SEMANTIC_TOKEN_MODIFIERS "[\"declaration\",\"static\"]"
+
+typedef enum {
+    LSP_SEMANTIC_NAMESPACE,
+    LSP_SEMANTIC_CLASS,
+    LSP_SEMANTIC_FUNCTION,
+    LSP_SEMANTIC_VARIABLE,
+    LSP_SEMANTIC_PARAMETER,
+    LSP_SEMANTIC_PROPERTY,
+    LSP_SEMANTIC_KEYWORD,
+    LSP_SEMANTIC_STRING,
+    LSP_SEMANTIC_NUMBER,
+    LSP_SEMANTIC_OPERATOR,
+    LSP_SEMANTIC_TYPE
+} LspSemanticTokenType;
+
+typedef enum {
+    LSP_SEMANTIC_MOD_DECLARATION = 1 << 0,
+    LSP_SEMANTIC_MOD_STATIC = 1 << 1
+} LspSemanticTokenModifier;
+
+typedef struct LspSemanticTokens {
+    int* data;
+    int count;
+    int version;
+    int result_id;
+} LspSemanticTokens;
+
+void lsp_semantic_tokens_destroy(LspSemanticTokens* tokens);
+
+char* lsp_semantic_tokens_full(LspDocument* doc);
+char* lsp_semantic_tokens_delta(LspDocument* doc, const char* previous_result_id);
+
+#endif
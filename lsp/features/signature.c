@@ -6,6 +6,7 @@
 #include "../../../src/compiler/frontend/lexer/tokenizer.h"
 #include "../../../src/compiler/frontend/parser/parser.h"
 #include "../../../src/compiler/frontend/parser/ast.h"
+#include "../lsp_analysis.h"
 
 static char* extract_function_name_at_position(const char* content, int line, int col) {
     if (!content) return NULL;
@@ -71,7 +72,49 @@ static char* extract_function_name_at_position(const char* content, int line, in
     return NULL;
 }
 
-LspSignatureHelp* lsp_get_signature_help(const char* content, int line, int col) {
+static ASTNode* find_function_declaration(ASTNode* node, const char* name, int depth) {
+    if (!node || depth > 100) return NULL;
+    
+    switch (node->type) {
+        case AST_PROGRAM:
+        case AST_BLOCK:
+            for (int i = 0; i < node->data.block.statement_count; i++) {
+                ASTNode* found = find_function_declaration(node->data.block.statements[i], name, depth + 1);
+                if (found) return found;
+            }
+            return NULL;
+        case AST_NAMESPACE_DECLARATION:
+            return find_function_declaration(node->data.namespace_decl.body, name, depth + 1);
+        case AST_CLASS_DECLARATION:
+            return find_function_declaration(node->data.class_decl.body, name, depth + 1);
+        case AST_FUNCTION_DECLARATION:
+            return strcmp(node->data.function_decl.name, name) == 0 ? node : NULL;
+        default:
+            return NULL;
+    }
+}
+
+static char* format_function_label(const ASTNode* func) {
+    size_t len = strlen(func->data.function_decl.name) + 3;
+    for (int i = 0; i < func->data.function_decl.parameter_count; i++) {
+        len += strlen(func->data.function_decl.parameters[i]) + 2;
+    }
+    
+    char* label = (char*)malloc(len);
+    if (!label) return NULL;
+    
+    strcpy(label, func->data.function_decl.name);
+    strcat(label, "(");
+    for (int i = 0; i < func->data.function_decl.parameter_count; i++) {
+        if (i > 0) strcat(label, ", ");
+        strcat(label, func->data.function_decl.parameters[i]);
+    }
+    strcat(label, ")");
+    return label;
+}
+
+LspSignatureHelp* lsp_get_signature_help(LspDocument* doc, int line, int col) {
+    const char* content = lsp_document_get_content(doc);
     if (!content) return NULL;
     
     char* func_name = extract_function_name_at_position(content, line, col);
@@ -94,27 +137,18 @@ LspSignatureHelp* lsp_get_signature_help(const char* content, int line, int col)
     help->active_parameter = 0;
     
     
-    Lexer* lexer = lexer_create(content);
-    if (lexer) {
-        Parser* parser = parser_create(lexer);
-        if (parser) {
-            ASTNode* ast = parser_parse(parser);
-            if (ast) {
-                
-                
-                
-                
-                help->signatures[0].label = (char*)malloc(strlen(func_name) + 32);
-                if (help->signatures[0].label) {
-                    sprintf(help->signatures[0].label, "%s(...)", func_name);
-                }
-                help->signatures[0].documentation = strdup("Function");
-                
-                ast_destroy_node(ast);
+    LspAnalysis* analysis = lsp_document_get_analysis(doc);
+    if (analysis && analysis->ast) {
+        ASTNode* func = find_function_declaration(analysis->ast, func_name, 0);
+        if (func) {
+            help->signatures[0].label = format_function_label(func);
+        } else {
+            help->signatures[0].label = (char*)malloc(strlen(func_name) + 32);
+            if (help->signatures[0].label) {
+                sprintf(help->signatures[0].label, "%s(...)", func_name);
             }
-            parser_destroy(parser);
         }
-        lexer_destroy(lexer);
+        help->signatures[0].documentation = strdup("Function");
     }
     
     if (!help->signatures[0].label) {
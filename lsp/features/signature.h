@@ -2,6 +2,7 @@
 #define LSP_FEATURES_SIGNATURE_H
 
 #include "../protocol/lsp_messages.h"
+#include "../lsp_document.h"
 
 typedef struct {
     char* label;
@@ -23,7 +24,7 @@ typedef struct {
     int active_parameter;
 } LspSignatureHelp;
 
-LspSignatureHelp* lsp_get_signature_help(const char* content, int line, int col);
+LspSignatureHelp* lsp_get_signature_help(LspDocument* doc, int line, int col);
 void lsp_signature_help_destroy(LspSignatureHelp* help);
 void lsp_signature_info_destroy(LspSignatureInfo* sig);
 
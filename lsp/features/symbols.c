@@ -7,6 +7,8 @@
 #include "../../../src/compiler/frontend/parser/parser.h"
 #include "../../../src/compiler/frontend/parser/ast.h"
 #include "../../../src/compiler/frontend/semantic/symbol_table.h"
+#include "../lsp_analysis.h"
+#include "../lsp_index.h"
 
 LspSymbolList* lsp_symbol_list_create(void) {
     LspSymbolList* list = (LspSymbolList*)calloc(1, sizeof(LspSymbolList));
@@ -55,12 +57,18 @@ static void extract_symbols_from_ast(ASTNode* node, const char* uri, LspSymbolLi
     if (!node || depth > 100) return;
     
     switch (node->type) {
+        case AST_PROGRAM:
+        case AST_BLOCK:
+            for (int i = 0; i < node->data.block.statement_count; i++) {
+                extract_symbols_from_ast(node->data.block.statements[i], uri, list, depth + 1);
+            }
+            break;
         case AST_FUNCTION_DECLARATION: {
             LspSymbolInfo sym = {0};
             sym.name = strdup(node->data.function_decl.name);
             sym.uri = strdup(uri);
-            sym.line = 0;
-            sym.character = 0;
+            sym.line = node->line > 0 ? node->line - 1 : 0;
+            sym.character = node->col > 0 ? node->col - 1 : 0;
             sym.kind = 12;
             sym.detail = strdup("Function");
             lsp_symbol_list_add(list, &sym);
@@ -70,8 +78,8 @@ static void extract_symbols_from_ast(ASTNode* node, const char* uri, LspSymbolLi
             LspSymbolInfo sym = {0};
             sym.name = strdup(node->data.variable_decl.name);
             sym.uri = strdup(uri);
-            sym.line = 0;
-            sym.character = 0;
+            sym.line = node->line > 0 ? node->line - 1 : 0;
+            sym.character = node->col > 0 ? node->col - 1 : 0;
             sym.kind = 13;
             sym.detail = strdup("Variable");
             lsp_symbol_list_add(list, &sym);
@@ -81,22 +89,24 @@ static void extract_symbols_from_ast(ASTNode* node, const char* uri, LspSymbolLi
             LspSymbolInfo sym = {0};
             sym.name = strdup(node->data.class_decl.name);
             sym.uri = strdup(uri);
-            sym.line = 0;
-            sym.character = 0;
+            sym.line = node->line > 0 ? node->line - 1 : 0;
+            sym.character = node->col > 0 ? node->col - 1 : 0;
             sym.kind = 5;
             sym.detail = strdup("Class");
             lsp_symbol_list_add(list, &sym);
+            extract_symbols_from_ast(node->data.class_decl.body, uri, list, depth + 1);
             break;
         }
         case AST_NAMESPACE_DECLARATION: {
             LspSymbolInfo sym = {0};
             sym.name = strdup(node->data.namespace_decl.name);
             sym.uri = strdup(uri);
-            sym.line = 0;
-            sym.character = 0;
+            sym.line = node->line > 0 ? node->line - 1 : 0;
+            sym.character = node->col > 0 ? node->col - 1 : 0;
             sym.kind = 3;
             sym.detail = strdup("Namespace");
             lsp_symbol_list_add(list, &sym);
+            extract_symbols_from_ast(node->data.namespace_decl.body, uri, list, depth + 1);
             break;
         }
         default:
@@ -106,40 +116,69 @@ static void extract_symbols_from_ast(ASTNode* node, const char* uri, LspSymbolLi
     
 }
 
-LspSymbolList* lsp_document_symbols(const char* content, const char* uri) {
-    if (!content || !uri) return NULL;
+LspSymbolList* lsp_document_symbols(LspDocument* doc) {
+    LspAnalysis* analysis = lsp_document_get_analysis(doc);
+    if (!analysis) return NULL;
     
     LspSymbolList* list = lsp_symbol_list_create();
     if (!list) return NULL;
     
-    Lexer* lexer = lexer_create(content);
-    if (!lexer) {
-        lsp_symbol_list_destroy(list);
-        return NULL;
-    }
-    
-    Parser* parser = parser_create(lexer);
-    if (!parser) {
-        lexer_destroy(lexer);
-        lsp_symbol_list_destroy(list);
-        return NULL;
-    }
-    
-    ASTNode* ast = parser_parse(parser);
-    if (ast) {
-        extract_symbols_from_ast(ast, uri, list, 0);
-        ast_destroy_node(ast);
+    if (analysis->ast) {
+        extract_symbols_from_ast(analysis->ast, doc->uri, list, 0);
     }
     
-    parser_destroy(parser);
-    lexer_destroy(lexer);
-    
     return list;
 }
 
-LspSymbolList* lsp_workspace_symbols(const char* query) {
-    (void)query;
-    return NULL;
+LspSymbolList* lsp_workspace_symbols(struct LspIndex* index, const char* query) {
+    return lsp_index_workspace_symbols(index, query, LSP_INDEX_QUERY_LIMIT);
+}
+
+char* lsp_symbol_list_to_json(const LspSymbolList* list) {
+    if (!list || list->count == 0) return strdup("[]");
+    
+    size_t buffer_size = 8192;
+    size_t length = 1;
+    char* buffer = (char*)malloc(buffer_size);
+    if (!buffer) return NULL;
+    strcpy(buffer, "[");
+    
+    for (int i = 0; i < list->count; i++) {
+        const LspSymbolInfo* sym = &list->items[i];
+        char sym_json[1024];
+        
+        char* escaped_name = lsp_json_escape(sym->name ? sym->name : "");
+        char* escaped_detail = lsp_json_escape(sym->detail ? sym->detail : "");
+        
+        int written = snprintf(sym_json, sizeof(sym_json),
+            "%s{\"name\":\"%s\",\"kind\":%d,\"location\":{\"uri\":\"%s\",\"range\":{\"start\":{\"line\":%d,\"character\":%d},\"end\":{\"line\":%d,\"character\":%d}}},\"detail\":\"%s\"}",
+            i > 0 ? "," : "", escaped_name, sym->kind, sym->uri ? sym->uri : "",
+            sym->line, sym->character, sym->line, sym->character + (int)strlen(sym->name ? sym->name : ""),
+            escaped_detail);
+        
+        free(escaped_name);
+        free(escaped_detail);
+        
+        if (written < 0) continue;
+        if ((size_t)written >= sizeof(sym_json)) written = (int)sizeof(sym_json) - 1;
+        
+        if (length + written + 2 > buffer_size) {
+            buffer_size = (length + written + 2) * 2;
+            char* new_buffer = (char*)realloc(buffer, buffer_size);
+            if (!new_buffer) {
+                free(buffer);
+                return NULL;
+            }
+            buffer = new_buffer;
+        }
+        
+        memcpy(buffer + length, sym_json, written);
+        length += written;
+    }
+    
+    buffer[length++] = ']';
+    buffer[length] = '\0';
+    return buffer;
 }
 
 LspSymbolInfo* lsp_find_symbol_at_position(const char* content, int line, int col) {
@@ -187,6 +226,8 @@ LspSymbolInfo* lsp_find_symbol_at_position(const char* content, int line, int co
     line_text[line_len] = '\0';
     free(lines);
     
+    if (col < 0) col = 0;
+    if (col > (int)line_len) col = (int)line_len;
     int start = col;
     while (start > 0 && (isalnum((unsigned char)line_text[start - 1]) || line_text[start - 1] == '_')) {
         start--;
@@ -221,34 +262,28 @@ LspSymbolInfo* lsp_find_symbol_at_position(const char* content, int line, int co
     return info;
 }
 
-LspSymbolInfo* lsp_find_symbol_definition(const char* content, const char* symbol_name) {
-    if (!content || !symbol_name) return NULL;
-    
-    Lexer* lexer = lexer_create(content);
-    if (!lexer) return NULL;
-    
-    Parser* parser = parser_create(lexer);
-    if (!parser) {
-        lexer_destroy(lexer);
-        return NULL;
+LspSymbolInfo* lsp_find_symbol_definition(LspDocument* doc, const char* symbol_name) {
+    if (!symbol_name) return NULL;
+    
+    LspAnalysis* analysis = lsp_document_get_analysis(doc);
+    if (!analysis || !analysis->symbols) return NULL;
+    
+    SymbolEntry* entry = symbol_table_lookup(analysis->symbols, symbol_name);
+    if (!entry) return NULL;
+    
+    LspSymbolInfo* result = (LspSymbolInfo*)calloc(1, sizeof(LspSymbolInfo));
+    if (!result) return NULL;
+    result->name = strdup(entry->name);
+    result->uri = strdup(doc->uri);
+    result->line = entry->declaration_line > 0 ? entry->declaration_line - 1 : 0;
+    result->character = 0;
+    switch (entry->type) {
+        case SYMBOL_FUNCTION: result->kind = 12; break;
+        case SYMBOL_CLASS: result->kind = 5; break;
+        case SYMBOL_NAMESPACE: result->kind = 3; break;
+        default: result->kind = 13; break;
     }
     
-    ASTNode* ast = parser_parse(parser);
-    if (!ast) {
-        parser_destroy(parser);
-        lexer_destroy(lexer);
-        return NULL;
-    }
-    
-    LspSymbolInfo* result = NULL;
-    
-    
-    
-    
-    ast_destroy_node(ast);
-    parser_destroy(parser);
-    lexer_destroy(lexer);
-    
     return result;
 }
 
@@ -2,6 +2,7 @@
 #define LSP_FEATURES_SYMBOLS_H
 
 #include "../protocol/lsp_messages.h"
+#include "../lsp_document.h"
 
 typedef struct {
     char* name;
@@ -23,13 +24,17 @@ LspSymbolList* lsp_symbol_list_create(void);
 void lsp_symbol_list_destroy(LspSymbolList* list);
 void lsp_symbol_list_add(LspSymbolList* list, const LspSymbolInfo* symbol);
 
-LspSymbolList* lsp_document_symbols(const char* content, const char* uri);
-LspSymbolList* lsp_workspace_symbols(const char* query);
+struct LspIndex;
+
+LspSymbolList* lsp_document_symbols(LspDocument* doc);
+LspSymbolList* lsp_workspace_symbols(struct LspIndex* index, const char* query);
 LspSymbolInfo* lsp_find_symbol_at_position(const char* content, int line, int col);
-LspSymbolInfo* lsp_find_symbol_definition(const char* content, const char* symbol_name);
+LspSymbolInfo* lsp_find_symbol_definition(LspDocument* doc, const char* symbol_name);
 
 void lsp_symbol_info_destroy(LspSymbolInfo* info);
 
+char* lsp_symbol_list_to_json(const LspSymbolList* list);
+
 char* lsp_symbol_kind_to_string(int kind);
 int lsp_symbol_type_to_kind(const char* type);
 
@@ -5,6 +5,8 @@
 #include "../features/symbols.h"
 #include "../features/signature.h"
 #include "../features/formatting.h"
+#include "../features/semantic_tokens.h"
+#include "../lsp_index.h"
 #include "../protocol/json_rpc.h"
 #include "../lsp_log.h"
 
@@ -40,55 +42,39 @@ static int extract_int_value(const char* json, const char* key, int default_val)
     return atoi(pos + strlen(pattern));
 }
 
-static int has_range_in_change(const char* change) {
-    return strstr(change, "\"range\"") != NULL;
-}
-
-static int parse_range(const char* json, int* start_line, int* start_char, int* end_line, int* end_char) {
-    if (!json) return 0;
-    
-    const char* range = strstr(json, "\"range\":");
-    if (!range) return 0;
-    range += 8;
-    
-    const char* start = strstr(range, "\"start\":");
-    if (start) {
-        *start_line = extract_int_value(start, "line", 0);
-        *start_char = extract_int_value(start, "character", 0);
-    }
-    
-    const char* end = strstr(range, "\"end\":");
-    if (end) {
-        *end_line = extract_int_value(end, "line", 0);
-        *end_char = extract_int_value(end, "character", 0);
+static int parse_params(LspJsonDocument* json, const char* params) {
+    lsp_json_document_init(json);
+    if (lsp_json_parse(json, params, strlen(params), 0) != 0) {
+        LSP_LOG_WARN("Ignoring malformed params");
+        lsp_json_document_free(json);
+        return 0;
     }
-    
     return 1;
 }
 
+static char* params_document_uri(const LspJsonDocument* json) {
+    return lsp_json_string_dup(json, lsp_json_path(json, 0, "textDocument.uri"));
+}
+
 LspMessage* lsp_handle_text_document_did_open(LspServer* server, const char* id, const char* params) {
     if (!server || !params) return NULL;
     
     LSP_LOG_DEBUG("textDocument/didOpen received");
     
-    const char* text_doc = strstr(params, "\"textDocument\":");
-    if (!text_doc) return NULL;
-    text_doc += 15;
+    LspJsonDocument json;
+    if (!parse_params(&json, params)) return NULL;
     
-    char* uri = extract_string_value(text_doc, "uri");
-    char* language_id = extract_string_value(text_doc, "languageId");
-    int version = extract_int_value(text_doc, "version", 0);
-    char* text = extract_string_value(text_doc, "text");
+    int text_doc = lsp_json_member(&json, 0, "textDocument");
+    char* uri = lsp_json_string_dup(&json, lsp_json_member(&json, text_doc, "uri"));
+    char* language_id = lsp_json_string_dup(&json, lsp_json_member(&json, text_doc, "languageId"));
+    int version = lsp_json_int(&json, lsp_json_member(&json, text_doc, "version"), 0);
+    char* text = lsp_json_string_dup(&json, lsp_json_member(&json, text_doc, "text"));
+    lsp_json_document_free(&json);
     
     if (uri && text) {
         LSP_LOG_INFO("Opening document: %s (version %d)", uri, version);
         lsp_document_store_open(server->documents, uri, language_id, version, text);
-        
-        LspDiagnosticList* diagnostics = lsp_analyze_document(uri, text);
-        if (diagnostics) {
-            lsp_publish_diagnostics(server, uri, diagnostics);
-            lsp_diagnostic_list_destroy(diagnostics);
-        }
+        lsp_server_schedule_diagnostics(server, uri);
     }
     
     free(uri);
@@ -103,84 +89,62 @@ LspMessage* lsp_handle_text_document_did_change(LspServer* server, const char* i
     
     LSP_LOG_DEBUG("textDocument/didChange received");
     
-    const char* text_doc = strstr(params, "\"textDocument\":");
-    if (!text_doc) return NULL;
-    text_doc += 15;
+    LspJsonDocument json;
+    if (!parse_params(&json, params)) return NULL;
     
-    char* uri = extract_string_value(text_doc, "uri");
-    int version = extract_int_value(text_doc, "version", 0);
+    int text_doc = lsp_json_member(&json, 0, "textDocument");
+    char* uri = lsp_json_string_dup(&json, lsp_json_member(&json, text_doc, "uri"));
+    int version = lsp_json_int(&json, lsp_json_member(&json, text_doc, "version"), 0);
     
-    const char* changes_start = strstr(params, "\"contentChanges\":");
-    if (!changes_start || !uri) {
+    int content_changes = lsp_json_member(&json, 0, "contentChanges");
+    int change_count = lsp_json_count(&json, content_changes);
+    if (!uri || lsp_json_type(&json, content_changes) != LSP_JSON_ARRAY || change_count == 0) {
         free(uri);
+        lsp_json_document_free(&json);
         return NULL;
     }
-    changes_start += 17;
     
-    while (*changes_start && isspace((unsigned char)*changes_start)) changes_start++;
-    if (*changes_start != '[') {
+    LspTextChange* changes = (LspTextChange*)calloc(change_count, sizeof(LspTextChange));
+    if (!changes) {
         free(uri);
+        lsp_json_document_free(&json);
         return NULL;
     }
-    changes_start++;
-    
-    LspTextChange changes[16];
-    int change_count = 0;
-    const char* ptr = changes_start;
     
-    while (*ptr && *ptr != ']' && change_count < 16) {
-        while (*ptr && isspace((unsigned char)*ptr)) ptr++;
-        if (*ptr != '{') break;
-        
-        int start_line = 0, start_char = 0, end_line = 0, end_char = 0;
-        int has_range = 0;
-        
-        const char* range_pos = strstr(ptr, "\"range\":");
-        if (range_pos) {
-            has_range = parse_range(ptr, &start_line, &start_char, &end_line, &end_char);
-        }
-        
-        char* text = extract_string_value(ptr, "text");
-        
-        changes[change_count].start_line = start_line;
-        changes[change_count].start_char = start_char;
-        changes[change_count].end_line = end_line;
-        changes[change_count].end_char = end_char;
-        changes[change_count].text = text ? text : strdup("");
-        change_count++;
+    int full_change = 0;
+    int count = 0;
+    for (int change = lsp_json_first_child(&json, content_changes); change >= 0 && count < change_count;
+         change = lsp_json_next(&json, change)) {
+        int range = lsp_json_member(&json, change, "range");
+        if (range < 0 && count == 0) full_change = 1;
         
-        const char* next = strchr(ptr, '}');
-        if (!next) break;
-        ptr = next + 1;
+        changes[count].start_line = lsp_json_int(&json, lsp_json_path(&json, range, "start.line"), 0);
+        changes[count].start_char = lsp_json_int(&json, lsp_json_path(&json, range, "start.character"), 0);
+        changes[count].end_line = lsp_json_int(&json, lsp_json_path(&json, range, "end.line"), 0);
+        changes[count].end_char = lsp_json_int(&json, lsp_json_path(&json, range, "end.character"), 0);
         
-        while (*ptr && isspace((unsigned char)*ptr)) ptr++;
-        if (*ptr == ',') ptr++;
+        char* text = lsp_json_string_dup(&json, lsp_json_member(&json, change, "text"));
+        changes[count].text = text ? text : strdup("");
+        count++;
     }
+    lsp_json_document_free(&json);
     
-    if (change_count > 0) {
-        if (changes[0].start_line == 0 && changes[0].start_char == 0 && 
-            changes[0].end_line == 0 && changes[0].end_char == 0 &&
-            strstr(changes_start, "\"range\"") == NULL) {
+    if (count > 0) {
+        if (full_change) {
             LSP_LOG_DEBUG("Full document change detected");
             lsp_document_store_change(server->documents, uri, version, changes[0].text);
         } else {
-            LSP_LOG_DEBUG("Incremental change detected (%d changes)", change_count);
-            lsp_document_store_change_incremental(server->documents, uri, version, changes, change_count);
+            LSP_LOG_DEBUG("Incremental change detected (%d changes)", count);
+            lsp_document_store_change_incremental(server->documents, uri, version, changes, count);
         }
         
-        char* new_content = lsp_document_store_get_content(server->documents, uri);
-        if (new_content) {
-            LspDiagnosticList* diagnostics = lsp_analyze_document(uri, new_content);
-            if (diagnostics) {
-                lsp_publish_diagnostics(server, uri, diagnostics);
-                lsp_diagnostic_list_destroy(diagnostics);
-            }
-        }
+        lsp_server_schedule_diagnostics(server, uri);
     }
     
-    for (int i = 0; i < change_count; i++) {
+    for (int i = 0; i < count; i++) {
         free(changes[i].text);
     }
+    free(changes);
     free(uri);
     
     return NULL;
@@ -191,15 +155,15 @@ LspMessage* lsp_handle_text_document_did_close(LspServer* server, const char* id
     
     LSP_LOG_DEBUG("textDocument/didClose received");
     
-    const char* text_doc = strstr(params, "\"textDocument\":");
-    if (!text_doc) return NULL;
-    text_doc += 15;
-    
-    char* uri = extract_string_value(text_doc, "uri");
+    LspJsonDocument json;
+    if (!parse_params(&json, params)) return NULL;
+    char* uri = params_document_uri(&json);
+    lsp_json_document_free(&json);
     
     if (uri) {
         LSP_LOG_INFO("Closing document: %s", uri);
         lsp_document_store_close(server->documents, uri);
+        lsp_server_discard_diagnostics(server, uri);
         
         char params_json[1024];
         snprintf(params_json, sizeof(params_json), "{\"uri\":\"%s\",\"diagnostics\":[]}", uri);
@@ -210,6 +174,24 @@ LspMessage* lsp_handle_text_document_did_close(LspServer* server, const char* id
     return NULL;
 }
 
+LspMessage* lsp_handle_text_document_did_save(LspServer* server, const char* id, const char* params) {
+    if (!server || !params) return NULL;
+    
+    LSP_LOG_DEBUG("textDocument/didSave received");
+    
+    LspJsonDocument json;
+    if (!parse_params(&json, params)) return NULL;
+    char* uri = params_document_uri(&json);
+    lsp_json_document_free(&json);
+    
+    if (uri) {
+        lsp_index_update_file(server->index, uri);
+    }
+    
+    free(uri);
+    return NULL;
+}
+
 LspMessage* lsp_handle_text_document_completion(LspServer* server, const char* id, const char* params) {
     if (!server || !params) return NULL;
     
@@ -225,7 +207,7 @@ LspMessage* lsp_handle_text_document_completion(LspServer* server, const char* i
     }
     
     LspDocument* doc = lsp_document_store_get(server->documents, uri);
-    if (!doc || !doc->content) {
+    if (!lsp_document_get_content(doc)) {
         free(uri);
         return lsp_message_create_response(id, "{\"items\":[]}");
     }
@@ -239,7 +221,7 @@ LspMessage* lsp_handle_text_document_completion(LspServer* server, const char* i
     
     LSP_LOG_DEBUG("Completion at %s:%d:%d", uri, line, character);
     
-    LspCompletionList* completions = lsp_get_completions(doc->content, line, character);
+    LspCompletionList* completions = lsp_get_completions(doc, line, character);
     if (!completions) {
         free(uri);
         return lsp_message_create_response(id, "{\"items\":[]}");
@@ -271,7 +253,7 @@ LspMessage* lsp_handle_text_document_hover(LspServer* server, const char* id, co
     }
     
     LspDocument* doc = lsp_document_store_get(server->documents, uri);
-    if (!doc || !doc->content) {
+    if (!lsp_document_get_content(doc)) {
         free(uri);
         return lsp_message_create_response(id, "null");
     }
@@ -283,7 +265,7 @@ LspMessage* lsp_handle_text_document_hover(LspServer* server, const char* id, co
         character = extract_int_value(pos, "character", 0);
     }
     
-    char* hover_content = lsp_get_hover_info(doc->content, line, character);
+    char* hover_content = lsp_get_hover_info(doc, line, character);
     free(uri);
     
     if (!hover_content) {
@@ -302,6 +284,30 @@ LspMessage* lsp_handle_text_document_hover(LspServer* server, const char* id, co
     return lsp_message_create_response(id, result);
 }
 
+static LspLocation* find_workspace_definition(LspServer* server, LspDocument* doc, int line, int character) {
+    LspSymbolInfo* word = lsp_find_symbol_at_position(lsp_document_get_content(doc), line, character);
+    if (!word) return NULL;
+    
+    LspSymbolInfo* symbol = lsp_index_find_definition(server->index, word->name);
+    lsp_symbol_info_destroy(word);
+    free(word);
+    if (!symbol) return NULL;
+    
+    LspLocation* location = (LspLocation*)calloc(1, sizeof(LspLocation));
+    if (location) {
+        location->uri = symbol->uri;
+        symbol->uri = NULL;
+        location->range.start.line = symbol->line;
+        location->range.start.character = symbol->character;
+        location->range.end.line = symbol->line;
+        location->range.end.character = symbol->character + (int)strlen(symbol->name);
+    }
+    
+    lsp_symbol_info_destroy(symbol);
+    free(symbol);
+    return location;
+}
+
 LspMessage* lsp_handle_text_document_definition(LspServer* server, const char* id, const char* params) {
     if (!server || !params) return NULL;
     
@@ -317,7 +323,7 @@ LspMessage* lsp_handle_text_document_definition(LspServer* server, const char* i
     }
     
     LspDocument* doc = lsp_document_store_get(server->documents, uri);
-    if (!doc || !doc->content) {
+    if (!lsp_document_get_content(doc)) {
         free(uri);
         return lsp_message_create_response(id, "null");
     }
@@ -329,9 +335,13 @@ LspMessage* lsp_handle_text_document_definition(LspServer* server, const char* i
         character = extract_int_value(pos, "character", 0);
     }
     
-    LspLocation* location = lsp_get_definition(doc->content, line, character);
+    LspLocation* location = lsp_get_definition(doc, line, character);
     free(uri);
     
+    if (!location && server->index) {
+        location = find_workspace_definition(server, doc, line, character);
+    }
+    
     if (!location) {
         return lsp_message_create_response(id, "null");
     }
@@ -359,65 +369,19 @@ LspMessage* lsp_handle_text_document_document_symbol(LspServer* server, const ch
     }
     
     LspDocument* doc = lsp_document_store_get(server->documents, uri);
-    if (!doc || !doc->content) {
+    if (!lsp_document_get_content(doc)) {
         free(uri);
         return lsp_message_create_response(id, "[]");
     }
     
-    LspSymbolList* symbols = lsp_document_symbols(doc->content, uri);
+    LspSymbolList* symbols = lsp_document_symbols(doc);
     free(uri);
     
-    if (!symbols || symbols->count == 0) {
-        if (symbols) lsp_symbol_list_destroy(symbols);
-        return lsp_message_create_response(id, "[]");
-    }
-    
-    size_t buffer_size = 8192;
-    char* buffer = (char*)malloc(buffer_size);
-    if (!buffer) {
-        lsp_symbol_list_destroy(symbols);
-        return lsp_message_create_response(id, "[]");
-    }
-    
-    strcpy(buffer, "[");
-    
-    for (int i = 0; i < symbols->count; i++) {
-        LspSymbolInfo* sym = &symbols->items[i];
-        char sym_json[1024];
-        
-        char* escaped_name = lsp_json_escape(sym->name ? sym->name : "");
-        char* escaped_detail = lsp_json_escape(sym->detail ? sym->detail : "");
-        
-        snprintf(sym_json, sizeof(sym_json),
-            "{\"name\":\"%s\",\"kind\":%d,\"location\":{\"uri\":\"%s\",\"range\":{\"start\":{\"line\":%d,\"character\":%d},\"end\":{\"line\":%d,\"character\":%d}}},\"detail\":\"%s\"}",
-            escaped_name, sym->kind, sym->uri ? sym->uri : "", 
-            sym->line, sym->character, sym->line, sym->character + (int)strlen(sym->name ? sym->name : ""),
-            escaped_detail);
-        
-        free(escaped_name);
-        free(escaped_detail);
-        
-        size_t needed = strlen(buffer) + strlen(sym_json) + 10;
-        if (needed > buffer_size) {
-            buffer_size = needed * 2;
-            buffer = (char*)realloc(buffer, buffer_size);
-            if (!buffer) {
-                lsp_symbol_list_destroy(symbols);
-                return lsp_message_create_response(id, "[]");
-            }
-        }
-        
-        if (i > 0) strcat(buffer, ",");
-        strcat(buffer, sym_json);
-    }
-    
-    strcat(buffer, "]");
-    
-    LspMessage* response = lsp_message_create_response(id, buffer);
-    
-    free(buffer);
+    char* result = lsp_symbol_list_to_json(symbols);
     lsp_symbol_list_destroy(symbols);
     
+    LspMessage* response = lsp_message_create_response(id, result ? result : "[]");
+    free(result);
     return response;
 }
 
@@ -436,7 +400,7 @@ LspMessage* lsp_handle_text_document_signature_help(LspServer* server, const cha
     }
     
     LspDocument* doc = lsp_document_store_get(server->documents, uri);
-    if (!doc || !doc->content) {
+    if (!lsp_document_get_content(doc)) {
         free(uri);
         return lsp_message_create_response(id, "null");
     }
@@ -450,7 +414,7 @@ LspMessage* lsp_handle_text_document_signature_help(LspServer* server, const cha
     
     LSP_LOG_DEBUG("Signature help at %s:%d:%d", uri, line, character);
     
-    LspSignatureHelp* help = lsp_get_signature_help(doc->content, line, character);
+    LspSignatureHelp* help = lsp_get_signature_help(doc, line, character);
     free(uri);
     
     if (!help) {
@@ -493,7 +457,7 @@ LspMessage* lsp_handle_text_document_formatting(LspServer* server, const char* i
     }
     
     LspDocument* doc = lsp_document_store_get(server->documents, uri);
-    if (!doc || !doc->content) {
+    if (!lsp_document_get_content(doc)) {
         free(uri);
         return lsp_message_create_response(id, "null");
     }
@@ -501,7 +465,7 @@ LspMessage* lsp_handle_text_document_formatting(LspServer* server, const char* i
     LspFormatOptions options;
     parse_format_options(params, &options);
     
-    char* formatted = lsp_format_document(doc->content, &options);
+    char* formatted = lsp_format_document(lsp_document_get_content(doc), &options);
     free(uri);
     
     if (!formatted) {
@@ -535,7 +499,7 @@ LspMessage* lsp_handle_text_document_range_formatting(LspServer* server, const c
     }
     
     LspDocument* doc = lsp_document_store_get(server->documents, uri);
-    if (!doc || !doc->content) {
+    if (!lsp_document_get_content(doc)) {
         free(uri);
         return lsp_message_create_response(id, "null");
     }
@@ -555,7 +519,7 @@ LspMessage* lsp_handle_text_document_range_formatting(LspServer* server, const c
     LspFormatOptions options;
     parse_format_options(params, &options);
     
-    char* formatted = lsp_format_range(doc->content, start_line, start_char, end_line, end_char, &options);
+    char* formatted = lsp_format_range(lsp_document_get_content(doc), start_line, start_char, end_line, end_char, &options);
     free(uri);
     
     if (!formatted) {
@@ -589,7 +553,7 @@ LspMessage* lsp_handle_text_document_on_type_formatting(LspServer* server, const
     }
     
     LspDocument* doc = lsp_document_store_get(server->documents, uri);
-    if (!doc || !doc->content) {
+    if (!lsp_document_get_content(doc)) {
         free(uri);
         return lsp_message_create_response(id, "null");
     }
@@ -614,7 +578,7 @@ LspMessage* lsp_handle_text_document_on_type_formatting(LspServer* server, const
     LspFormatOptions options;
     parse_format_options(params, &options);
     
-    char* formatted = lsp_format_on_type(doc->content, line, character, ch, &options);
+    char* formatted = lsp_format_on_type(lsp_document_get_content(doc), line, character, ch, &options);
     free(uri);
     
     if (!formatted) {
@@ -632,3 +596,48 @@ LspMessage* lsp_handle_text_document_on_type_formatting(LspServer* server, const
     
     return lsp_message_create_response(id, result);
 }
+
+LspMessage* lsp_handle_text_document_semantic_tokens_full(LspServer* server, const char* id, const char* params) {
+    if (!server || !params) return NULL;
+    
+    LSP_LOG_DEBUG("textDocument/semanticTokens/full received");
+    
+    LspJsonDocument json;
+    if (!parse_params(&json, params)) {
+        return lsp_message_create_error(id, LSP_INVALID_PARAMS, "Invalid params");
+    }
+    char* uri = params_document_uri(&json);
+    lsp_json_document_free(&json);
+    
+    LspDocument* doc = uri ? lsp_document_store_get(server->documents, uri) : NULL;
+    free(uri);
+    
+    char* result = doc ? lsp_semantic_tokens_full(doc) : NULL;
+    LspMessage* response = lsp_message_create_response(id, result ? result : "null");
+    free(result);
+    return response;
+}
+
+LspMessage* lsp_handle_text_document_semantic_tokens_delta(LspServer* server, const char* id, const char* params) {
+    if (!server || !params) return NULL;
+    
+    LSP_LOG_DEBUG("textDocument/semanticTokens/full/delta received");
+    
+    LspJsonDocument json;
+    if (!parse_params(&json, params)) {
+        return lsp_message_create_error(id, LSP_INVALID_PARAMS, "Invalid params");
+    }
+    char* uri = params_document_uri(&json);
+    char* previous_result_id = lsp_json_string_dup(&json, lsp_json_member(&json, 0, "previousResultId"));
+    lsp_json_document_free(&json);
+    
+    LspDocument* doc = uri ? lsp_document_store_get(server->documents, uri) : NULL;
+    free(uri);
+    
+    char* result = doc ? lsp_semantic_tokens_delta(doc, previous_result_id) : NULL;
+    free(previous_result_id);
+    
+    LspMessage* response = lsp_message_create_response(id, result ? result : "null");
+    free(result);
+    return response;
+}
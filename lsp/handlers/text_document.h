@@ -6,6 +6,7 @@
 LspMessage* lsp_handle_text_document_did_open(LspServer* server, const char* id, const char* params);
 LspMessage* lsp_handle_text_document_did_change(LspServer* server, const char* id, const char* params);
 LspMessage* lsp_handle_text_document_did_close(LspServer* server, const char* id, const char* params);
+LspMessage* lsp_handle_text_document_did_save(LspServer* server, const char* id, const char* params);
 LspMessage* lsp_handle_text_document_completion(LspServer* server, const char* id, const char* params);
 LspMessage* lsp_handle_text_document_hover(LspServer* server, const char* id, const char* params);
 LspMessage* lsp_handle_text_document_definition(LspServer* server, const char* id, const char* params);
@@ -14,5 +15,7 @@ LspMessage* lsp_handle_text_document_signature_help(LspServer* server, const cha
 LspMessage* lsp_handle_text_document_formatting(LspServer* server, const char* id, const char* params);
 LspMessage* lsp_handle_text_document_range_formatting(LspServer* server, const char* id, const char* params);
 LspMessage* lsp_handle_text_document_on_type_formatting(LspServer* server, const char* id, const char* params);
+LspMessage* lsp_handle_text_document_semantic_tokens_full(LspServer* server, const char* id, const char* params);
+LspMessage* lsp_handle_text_document_semantic_tokens_delta(LspServer* server, const char* id, const char* params);
 
 #endif
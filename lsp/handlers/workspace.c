@@ -0,0 +1,61 @@
+#include "workspace.h"
+#include <stdio.h>
+#include <string.h>
+#include "../features/symbols.h"
+#include "../lsp_index.h"
+#include "../lsp_log.h"
+
+LspMessage* lsp_handle_workspace_symbol(LspServer* server, const char* id, const char* params) {
+    if (!server) return NULL;
+    
+    LSP_LOG_DEBUG("workspace/symbol received");
+    
+    char* query = NULL;
+    LspJsonDocument json;
+    lsp_json_document_init(&json);
+    if (params && lsp_json_parse(&json, params, strlen(params), 0) == 0) {
+        query = lsp_json_string_dup(&json, lsp_json_member(&json, 0, "query"));
+    }
+    lsp_json_document_free(&json);
+    
+    LspSymbolList* symbols = lsp_workspace_symbols(server->index, query ? query : "");
+    free(query);
+    
+    char* result = lsp_symbol_list_to_json(symbols);
+    lsp_symbol_list_destroy(symbols);
+    
+    LspMessage* response = lsp_message_create_response(id, result ? result : "[]");
+    free(result);
+    return response;
+}
+
+LspMessage* lsp_handle_workspace_did_change_watched_files(LspServer* server, const char* id, const char* params) {
+    if (!server || !params) return NULL;
+    
+    LSP_LOG_DEBUG("workspace/didChangeWatchedFiles received");
+    
+    LspJsonDocument json;
+    lsp_json_document_init(&json);
+    if (lsp_json_parse(&json, params, strlen(params), 0) != 0) {
+        LSP_LOG_WARN("Ignoring malformed workspace/didChangeWatchedFiles params");
+        lsp_json_document_free(&json);
+        return NULL;
+    }
+    
+    int changes = lsp_json_member(&json, 0, "changes");
+    for (int change = lsp_json_first_child(&json, changes); change >= 0; change = lsp_json_next(&json, change)) {
+        char* uri = lsp_json_string_dup(&json, lsp_json_member(&json, change, "uri"));
+        int type = lsp_json_int(&json, lsp_json_member(&json, change, "type"), 2);
+        
+        if (!uri) continue;
+        if (type == 3) {
+            lsp_index_remove_file(server->index, uri);
+        } else {
+            lsp_index_update_file(server->index, uri);
+        }
+        free(uri);
+    }
+    
+    lsp_json_document_free(&json);
+    return NULL;
+}
@@ -0,0 +1,9 @@
+#ifndef LSP_HANDLERS_WORKSPACE_H
+#define LSP_HANDLERS_WORKSPACE_H
+
+#include "../lsp_server.h"
+
+LspMessage* lsp_handle_workspace_symbol(LspServer* server, const char* id, const char* params);
+LspMessage* lsp_handle_workspace_did_change_watched_files(LspServer* server, const char* id, const char* params);
+
+#endif
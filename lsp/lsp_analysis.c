@@ -0,0 +1,683 @@
+#include "lsp_analysis.h"
+#include "lsp_log.h"
+#include "lsp_text_buffer.h"
+#include "../../src/compiler/frontend/parser/parser.h"
+#include "../../src/core/utils/es_common.h"
+
+typedef struct {
+    int line_delta;
+    int col_line;
+    int col_delta;
+} PositionShift;
+
+static Token* lex_tokens(const char* content, int* token_count) {
+    Lexer* lexer = lexer_create(content);
+    if (!lexer) return NULL;
+
+    int capacity = 256;
+    int count = 0;
+    Token* tokens = (Token*)malloc(capacity * sizeof(Token));
+    if (!tokens) {
+        lexer_destroy(lexer);
+        return NULL;
+    }
+
+    Token token;
+    do {
+        token = lexer_next_token(lexer);
+        if (count >= capacity) {
+            capacity *= 2;
+            Token* new_tokens = (Token*)realloc(tokens, capacity * sizeof(Token));
+            if (!new_tokens) {
+                token_free(&token);
+                for (int i = 0; i < count; i++) {
+                    token_free(&tokens[i]);
+                }
+                free(tokens);
+                lexer_destroy(lexer);
+                return NULL;
+            }
+            tokens = new_tokens;
+        }
+        tokens[count++] = token;
+    } while (token.type != TOKEN_EOF);
+
+    lexer_destroy(lexer);
+    *token_count = count;
+    return tokens;
+}
+
+static void free_tokens(Token* tokens, int count) {
+    for (int i = 0; i < count; i++) {
+        token_free(&tokens[i]);
+    }
+    free(tokens);
+}
+
+static ASTNode* parse_program(const char* content) {
+    ASTNode* program = NULL;
+    Lexer* lexer = lexer_create(content);
+    if (lexer) {
+        Parser* parser = parser_create(lexer);
+        if (parser) {
+            program = parser_parse(parser);
+            parser_destroy(parser);
+        }
+        lexer_destroy(lexer);
+    }
+    return program;
+}
+
+static void destroy_program(ASTNode* program) {
+    if (!program) return;
+    for (int i = 0; i < program->data.block.statement_count; i++) {
+        ast_destroy_node(program->data.block.statements[i]);
+    }
+    if (program->data.block.statements) ES_FREE(program->data.block.statements);
+    program->data.block.statements = NULL;
+    program->data.block.statement_count = 0;
+    ast_destroy_node(program);
+}
+
+static void declare_symbols(SymbolTable* table, ASTNode* node, int depth) {
+    if (!node || depth > 100) return;
+
+    switch (node->type) {
+        case AST_PROGRAM:
+        case AST_BLOCK:
+            for (int i = 0; i < node->data.block.statement_count; i++) {
+                declare_symbols(table, node->data.block.statements[i], depth + 1);
+            }
+            break;
+        case AST_FUNCTION_DECLARATION:
+            symbol_table_declare(table, node->data.function_decl.name, SYMBOL_FUNCTION, node->line);
+            break;
+        case AST_VARIABLE_DECLARATION:
+            if (depth <= 1) {
+                symbol_table_declare(table, node->data.variable_decl.name, SYMBOL_VARIABLE, node->line);
+            }
+            break;
+        case AST_CLASS_DECLARATION:
+            symbol_table_declare(table, node->data.class_decl.name, SYMBOL_CLASS, node->line);
+            break;
+        case AST_NAMESPACE_DECLARATION:
+            symbol_table_declare(table, node->data.namespace_decl.name, SYMBOL_NAMESPACE, node->line);
+            declare_symbols(table, node->data.namespace_decl.body, depth + 1);
+            break;
+        default:
+            break;
+    }
+}
+
+static void rebuild_symbols(LspAnalysis* analysis) {
+    if (analysis->symbols) symbol_table_destroy(analysis->symbols);
+    analysis->symbols = NULL;
+    if (!analysis->ast) return;
+
+    analysis->symbols = symbol_table_create();
+    if (analysis->symbols) {
+        declare_symbols(analysis->symbols, analysis->ast, 0);
+    }
+}
+
+static int compare_position(int line, int col, int other_line, int other_col) {
+    if (line != other_line) return line < other_line ? -1 : 1;
+    if (col != other_col) return col < other_col ? -1 : 1;
+    return 0;
+}
+
+static int statement_end(const Token* tokens, int count, int start) {
+    int depth = 0;
+    for (int i = start; i < count && tokens[i].type != TOKEN_EOF; i++) {
+        EsTokenType next = i + 1 < count ? tokens[i + 1].type : TOKEN_EOF;
+        switch (tokens[i].type) {
+            case TOKEN_LEFT_PAREN:
+            case TOKEN_LEFT_BRACE:
+            case TOKEN_LEFT_BRACKET:
+                depth++;
+                break;
+            case TOKEN_RIGHT_PAREN:
+            case TOKEN_RIGHT_BRACKET:
+                if (depth == 0) return -1;
+                depth--;
+                break;
+            case TOKEN_RIGHT_BRACE:
+                if (depth == 0) return -1;
+                depth--;
+                if (depth > 0 || next == TOKEN_ELSE || next == TOKEN_CATCH || next == TOKEN_FINALLY) break;
+                return next == TOKEN_SEMICOLON ? i + 1 : i;
+            case TOKEN_SEMICOLON:
+                if (depth == 0 && next != TOKEN_ELSE) return i;
+                break;
+            default:
+                break;
+        }
+    }
+    return -1;
+}
+
+static int node_within(const ASTNode* node, const Token* first, const Token* last) {
+    return compare_position(node->line, node->col, first->line, first->column) >= 0 &&
+           compare_position(node->line, node->col, last->line, last->column) <= 0;
+}
+
+static int clear_statement_index(LspAnalysis* analysis) {
+    free(analysis->statement_offsets);
+    free(analysis->statement_tokens);
+    analysis->statement_offsets = NULL;
+    analysis->statement_tokens = NULL;
+    return -1;
+}
+
+static int index_statements(LspAnalysis* analysis, const LspTextBuffer* text) {
+    ASTNode* program = analysis->ast;
+    int count = program->data.block.statement_count;
+
+    analysis->statement_offsets = (int*)malloc((count + 1) * sizeof(int));
+    analysis->statement_tokens = (int*)malloc((count + 1) * sizeof(int));
+    if (!analysis->statement_offsets || !analysis->statement_tokens) return clear_statement_index(analysis);
+
+    int token = 0;
+    for (int i = 0; i < count; i++) {
+        int last = statement_end(analysis->tokens, analysis->token_count, token);
+        if (last < 0 || !node_within(program->data.block.statements[i], &analysis->tokens[token],
+                                     &analysis->tokens[last])) {
+            return clear_statement_index(analysis);
+        }
+        analysis->statement_offsets[i] = lsp_text_buffer_offset_from_line_col(
+            text, analysis->tokens[token].line - 1, analysis->tokens[token].column - 1);
+        analysis->statement_tokens[i] = token;
+        token = last + 1;
+    }
+    if (token != analysis->token_count - 1) return clear_statement_index(analysis);
+    return 0;
+}
+
+static void update_end_position(LspAnalysis* analysis, const LspTextBuffer* text) {
+    analysis->length = lsp_text_buffer_length(text);
+    lsp_text_buffer_get_line_col(text, analysis->length, &analysis->end_line, &analysis->end_col);
+    analysis->end_line++;
+    analysis->end_col++;
+}
+
+static void shift_position(int* line, int* col, const PositionShift* shift) {
+    if (*line == shift->col_line) *col += shift->col_delta;
+    *line += shift->line_delta;
+}
+
+static void shift_node(ASTNode* node, const PositionShift* shift);
+
+static void shift_nodes(ASTNode** nodes, int count, const PositionShift* shift) {
+    if (!nodes) return;
+    for (int i = 0; i < count; i++) {
+        shift_node(nodes[i], shift);
+    }
+}
+
+static void shift_node(ASTNode* node, const PositionShift* shift) {
+    if (!node) return;
+    shift_position(&node->line, &node->col, shift);
+
+    switch (node->type) {
+        case AST_PROGRAM:
+        case AST_BLOCK:
+            shift_nodes(node->data.block.statements, node->data.block.statement_count, shift);
+            break;
+        case AST_FUNCTION_DECLARATION:
+            shift_node(node->data.function_decl.body, shift);
+            break;
+        case AST_STATIC_FUNCTION_DECLARATION:
+            shift_node(node->data.static_function_decl.body, shift);
+            break;
+        case AST_VARIABLE_DECLARATION:
+            shift_node(node->data.variable_decl.value, shift);
+            shift_node(node->data.variable_decl.array_size, shift);
+            break;
+        case AST_STATIC_VARIABLE_DECLARATION:
+            shift_node(node->data.static_variable_decl.value, shift);
+            break;
+        case AST_ASSIGNMENT:
+            shift_node(node->data.assignment.value, shift);
+            break;
+        case AST_ARRAY_ASSIGNMENT:
+            shift_node(node->data.array_assignment.array, shift);
+            shift_node(node->data.array_assignment.index, shift);
+            shift_node(node->data.array_assignment.value, shift);
+            break;
+        case AST_COMPOUND_ASSIGNMENT:
+            shift_node(node->data.compound_assignment.value, shift);
+            break;
+        case AST_ARRAY_COMPOUND_ASSIGNMENT:
+            shift_node(node->data.array_compound_assignment.array, shift);
+            shift_node(node->data.array_compound_assignment.index, shift);
+            shift_node(node->data.array_compound_assignment.value, shift);
+            break;
+        case AST_IF_STATEMENT:
+            shift_node(node->data.if_stmt.condition, shift);
+            shift_node(node->data.if_stmt.then_branch, shift);
+            shift_node(node->data.if_stmt.else_branch, shift);
+            break;
+        case AST_WHILE_STATEMENT:
+            shift_node(node->data.while_stmt.condition, shift);
+            shift_node(node->data.while_stmt.body, shift);
+            break;
+        case AST_FOR_STATEMENT:
+            shift_node(node->data.for_stmt.init, shift);
+            shift_node(node->data.for_stmt.condition, shift);
+            shift_node(node->data.for_stmt.increment, shift);
+            shift_node(node->data.for_stmt.body, shift);
+            break;
+        case AST_FOREACH_STATEMENT:
+            shift_node(node->data.foreach_stmt.iterable, shift);
+            shift_node(node->data.foreach_stmt.body, shift);
+            break;
+        case AST_RETURN_STATEMENT:
+            shift_node(node->data.return_stmt.value, shift);
+            break;
+        case AST_PRINT_STATEMENT:
+            shift_nodes(node->data.print_stmt.values, node->data.print_stmt.value_count, shift);
+            break;
+        case AST_BINARY_OPERATION:
+            shift_node(node->data.binary_op.left, shift);
+            shift_node(node->data.binary_op.right, shift);
+            break;
+        case AST_UNARY_OPERATION:
+            shift_node(node->data.unary_op.operand, shift);
+            break;
+        case AST_TERNARY_OPERATION:
+            shift_node(node->data.ternary_op.condition, shift);
+            shift_node(node->data.ternary_op.true_value, shift);
+            shift_node(node->data.ternary_op.false_value, shift);
+            break;
+        case AST_CALL:
+            shift_nodes(node->data.call.arguments, node->data.call.argument_count, shift);
+            shift_node(node->data.call.object, shift);
+            break;
+        case AST_STATIC_METHOD_CALL:
+            shift_nodes(node->data.static_call.arguments, node->data.static_call.argument_count, shift);
+            break;
+        case AST_ARRAY_ACCESS:
+            shift_node(node->data.array_access.array, shift);
+            shift_node(node->data.array_access.index, shift);
+            break;
+        case AST_ARRAY_LITERAL:
+            shift_nodes(node->data.array_literal.elements, node->data.array_literal.element_count, shift);
+            break;
+        case AST_NEW_EXPRESSION:
+            shift_nodes(node->data.new_expr.arguments, node->data.new_expr.argument_count, shift);
+            break;
+        case AST_NEW_ARRAY_EXPRESSION:
+            shift_node(node->data.new_array_expr.size, shift);
+            break;
+        case AST_NAMESPACE_DECLARATION:
+            shift_node(node->data.namespace_decl.body, shift);
+            break;
+        case AST_CLASS_DECLARATION:
+            shift_node(node->data.class_decl.body, shift);
+            shift_node(node->data.class_decl.base_class, shift);
+            shift_nodes(node->data.class_decl.constraints, node->data.class_decl.constraint_count, shift);
+            break;
+        case AST_MEMBER_ACCESS:
+            shift_node(node->data.member_access.object, shift);
+            break;
+        case AST_ACCESS_MODIFIER:
+            shift_node(node->data.access_modifier.member, shift);
+            break;
+        case AST_CONSTRUCTOR_DECLARATION:
+            shift_node(node->data.constructor_decl.body, shift);
+            break;
+        case AST_DESTRUCTOR_DECLARATION:
+            shift_node(node->data.destructor_decl.body, shift);
+            break;
+        case AST_TRY_STATEMENT:
+            shift_node(node->data.try_stmt.try_block, shift);
+            shift_nodes(node->data.try_stmt.catch_clauses, node->data.try_stmt.catch_clause_count, shift);
+            shift_node(node->data.try_stmt.finally_clause, shift);
+            break;
+        case AST_CATCH_CLAUSE:
+            shift_node(node->data.catch_clause.catch_block, shift);
+            break;
+        case AST_FINALLY_CLAUSE:
+            shift_node(node->data.finally_clause.finally_block, shift);
+            break;
+        case AST_THROW_STATEMENT:
+            shift_node(node->data.throw_stmt.exception_expr, shift);
+            break;
+        case AST_TEMPLATE_DECLARATION:
+            shift_nodes(node->data.template_decl.parameters, node->data.template_decl.parameter_count, shift);
+            shift_nodes(node->data.template_decl.constraints, node->data.template_decl.constraint_count, shift);
+            shift_node(node->data.template_decl.declaration, shift);
+            break;
+        case AST_GENERIC_CONSTRAINT:
+            shift_node(node->data.generic_constraint.interface_constraint, shift);
+            break;
+        case AST_SWITCH_STATEMENT:
+            shift_node(node->data.switch_stmt.expression, shift);
+            shift_nodes(node->data.switch_stmt.cases, node->data.switch_stmt.case_count, shift);
+            shift_node(node->data.switch_stmt.default_case, shift);
+            break;
+        case AST_CASE_CLAUSE:
+            shift_node(node->data.case_clause.value, shift);
+            shift_nodes(node->data.case_clause.statements, node->data.case_clause.statement_count, shift);
+            break;
+        case AST_DEFAULT_CLAUSE:
+            shift_nodes(node->data.default_clause.statements, node->data.default_clause.statement_count, shift);
+            break;
+        case AST_BREAK_STATEMENT:
+            shift_node(node->data.break_stmt.value, shift);
+            break;
+        case AST_CONTINUE_STATEMENT:
+            shift_node(node->data.continue_stmt.value, shift);
+            break;
+        case AST_DELETE_STATEMENT:
+            shift_node(node->data.delete_stmt.value, shift);
+            break;
+        case AST_USING_STATEMENT:
+            shift_node(node->data.using_stmt.resource, shift);
+            shift_node(node->data.using_stmt.body, shift);
+            break;
+        case AST_PROPERTY_DECLARATION:
+            shift_node(node->data.property_decl.getter, shift);
+            shift_node(node->data.property_decl.setter, shift);
+            shift_node(node->data.property_decl.initial_value, shift);
+            shift_nodes(node->data.property_decl.attributes, node->data.property_decl.attribute_count, shift);
+            break;
+        case AST_PROPERTY_GETTER:
+            shift_node(node->data.property_getter.body, shift);
+            break;
+        case AST_PROPERTY_SETTER:
+            shift_node(node->data.property_setter.body, shift);
+            break;
+        case AST_LAMBDA_EXPRESSION:
+            shift_node(node->data.lambda_expr.body, shift);
+            shift_node(node->data.lambda_expr.expression, shift);
+            break;
+        case AST_LINQ_QUERY:
+            shift_node(node->data.linq_query.from_clause, shift);
+            shift_nodes(node->data.linq_query.clauses, node->data.linq_query.clause_count, shift);
+            shift_node(node->data.linq_query.select_clause, shift);
+            break;
+        case AST_LINQ_FROM:
+            shift_node(node->data.linq_from.source, shift);
+            shift_node(node->data.linq_from.type, shift);
+            break;
+        case AST_LINQ_WHERE:
+            shift_node(node->data.linq_where.condition, shift);
+            break;
+        case AST_LINQ_SELECT:
+            shift_node(node->data.linq_select.expression, shift);
+            shift_node(node->data.linq_select.key_selector, shift);
+            break;
+        case AST_LINQ_ORDERBY:
+            shift_node(node->data.linq_orderby.expression, shift);
+            break;
+        case AST_LINQ_JOIN:
+            shift_node(node->data.linq_join.source, shift);
+            shift_node(node->data.linq_join.join_source, shift);
+            shift_node(node->data.linq_join.left_key, shift);
+            shift_node(node->data.linq_join.right_key, shift);
+            break;
+        case AST_ATTRIBUTE:
+            shift_nodes(node->data.attribute.arguments, node->data.attribute.argument_count, shift);
+            shift_node(node->data.attribute.named_arguments, shift);
+            break;
+        case AST_ATTRIBUTE_LIST:
+            shift_nodes(node->data.attribute_list.attributes, node->data.attribute_list.attribute_count, shift);
+            shift_node(node->data.attribute_list.target, shift);
+            break;
+        default:
+            break;
+    }
+}
+
+static int is_reparse_root(const ASTNode* node) {
+    return node->type == AST_FUNCTION_DECLARATION ||
+           node->type == AST_CLASS_DECLARATION ||
+           node->type == AST_NAMESPACE_DECLARATION;
+}
+
+static int find_enclosing_statement(const LspAnalysis* analysis, int offset) {
+    int low = 0;
+    int high = analysis->ast->data.block.statement_count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (analysis->statement_offsets[mid] < offset) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low - 1;
+}
+
+static Token* lex_region(const char* region, int region_length, int* token_count) {
+    char* source = (char*)malloc(region_length + 3);
+    if (!source) return NULL;
+    memcpy(source, region, region_length);
+    memcpy(source + region_length, "\n;", 3);
+
+    int count = 0;
+    Token* tokens = lex_tokens(source, &count);
+    free(source);
+    if (!tokens) return NULL;
+
+    int sentinel_line = 2;
+    for (int i = 0; i < region_length; i++) {
+        if (region[i] == '\n') sentinel_line++;
+    }
+
+    const Token* sentinel = count >= 2 ? &tokens[count - 2] : NULL;
+    if (!sentinel || sentinel->type != TOKEN_SEMICOLON || sentinel->line != sentinel_line || sentinel->column != 1) {
+        free_tokens(tokens, count);
+        return NULL;
+    }
+
+    *token_count = count - 2;
+    return tokens;
+}
+
+static int splice_tokens(LspAnalysis* analysis, int first, int last, const Token* tokens, int count,
+                         const PositionShift* region_shift, const PositionShift* tail_shift) {
+    int new_count = analysis->token_count - (last - first) + count;
+    if (count > last - first) {
+        Token* grown = (Token*)realloc(analysis->tokens, new_count * sizeof(Token));
+        if (!grown) return -1;
+        analysis->tokens = grown;
+    }
+
+    for (int i = first; i < last; i++) {
+        token_free(&analysis->tokens[i]);
+    }
+    memmove(&analysis->tokens[first + count], &analysis->tokens[last],
+            (analysis->token_count - last) * sizeof(Token));
+    memcpy(&analysis->tokens[first], tokens, count * sizeof(Token));
+    analysis->token_count = new_count;
+
+    for (int i = first; i < first + count; i++) {
+        shift_position(&analysis->tokens[i].line, &analysis->tokens[i].column, region_shift);
+    }
+    for (int i = first + count; i < new_count; i++) {
+        shift_position(&analysis->tokens[i].line, &analysis->tokens[i].column, tail_shift);
+    }
+    return 0;
+}
+
+static int lsp_analysis_reparse(LspAnalysis* analysis, LspDocument* doc) {
+    const LspEditSpan* edit = &doc->edit;
+    ASTNode* program = analysis->ast;
+    if (!edit->pending || !program || !analysis->statement_offsets) return -1;
+
+    int count = program->data.block.statement_count;
+    int old_start = edit->start;
+    int old_end = edit->end - edit->delta;
+    int index = find_enclosing_statement(analysis, old_start);
+    if (index < 0 || !is_reparse_root(program->data.block.statements[index])) return -1;
+
+    int is_last = index + 1 == count;
+    int next_offset = is_last ? analysis->length : analysis->statement_offsets[index + 1];
+    if (is_last ? old_end > next_offset : old_end >= next_offset) return -1;
+
+    int region_start = analysis->statement_offsets[index];
+    int region_end = next_offset + edit->delta;
+    char* region = lsp_text_buffer_substring(doc->text, region_start, region_end);
+    if (!region) return -1;
+
+    int region_token_count = 0;
+    Token* region_tokens = lex_region(region, region_end - region_start, &region_token_count);
+    if (!region_tokens) {
+        free(region);
+        return -1;
+    }
+
+    ASTNode* old_node = program->data.block.statements[index];
+    ASTNode* region_program = parse_program(region);
+    free(region);
+    int region_last = region_token_count - 1;
+    if (region_last > 0 && region_tokens[region_last].type == TOKEN_SEMICOLON) region_last--;
+    if (!region_program || region_program->data.block.statement_count != 1 ||
+        region_program->data.block.statements[0]->type != old_node->type ||
+        statement_end(region_tokens, region_token_count, 0) != region_token_count - 1 ||
+        region_last < 0 || region_tokens[region_last].type != TOKEN_RIGHT_BRACE ||
+        !node_within(region_program->data.block.statements[0], &region_tokens[0], &region_tokens[region_last])) {
+        destroy_program(region_program);
+        free_tokens(region_tokens, region_token_count + 2);
+        return -1;
+    }
+
+    int first_token = analysis->statement_tokens[index];
+    int last_token = is_last ? analysis->token_count - 1 : analysis->statement_tokens[index + 1];
+    const Token* start = &analysis->tokens[first_token];
+    PositionShift region_shift = { start->line - 1, 1, start->column - 1 };
+
+    int old_next_line = is_last ? analysis->end_line : analysis->tokens[last_token].line;
+    int old_next_col = is_last ? analysis->end_col : analysis->tokens[last_token].column;
+    int new_next_line = 0;
+    int new_next_col = 0;
+    lsp_text_buffer_get_line_col(doc->text, region_end, &new_next_line, &new_next_col);
+    PositionShift tail_shift = { new_next_line + 1 - old_next_line, old_next_line, new_next_col + 1 - old_next_col };
+
+    if (splice_tokens(analysis, first_token, last_token, region_tokens, region_token_count,
+                      &region_shift, &tail_shift) != 0) {
+        destroy_program(region_program);
+        free_tokens(region_tokens, region_token_count + 2);
+        return -1;
+    }
+    token_free(&region_tokens[region_token_count]);
+    token_free(&region_tokens[region_token_count + 1]);
+    free(region_tokens);
+
+    ASTNode* new_node = region_program->data.block.statements[0];
+    region_program->data.block.statement_count = 0;
+    destroy_program(region_program);
+
+    shift_node(new_node, &region_shift);
+    ast_destroy_node(old_node);
+    program->data.block.statements[index] = new_node;
+
+    int token_delta = region_token_count - (last_token - first_token);
+    for (int i = index + 1; i < count; i++) {
+        shift_node(program->data.block.statements[i], &tail_shift);
+        analysis->statement_offsets[i] += edit->delta;
+        analysis->statement_tokens[i] += token_delta;
+    }
+    update_end_position(analysis, doc->text);
+
+    if (analysis->diagnostics) lsp_diagnostic_list_destroy(analysis->diagnostics);
+    analysis->diagnostics = NULL;
+    rebuild_symbols(analysis);
+
+    LSP_LOG_DEBUG("Reparsed declaration %d of %d for version %d: %d tokens", index, count, doc->version,
+                  region_token_count);
+    return 0;
+}
+
+static LspAnalysis* lsp_analysis_create(const LspTextBuffer* text, const char* content, int version) {
+    LspAnalysis* analysis = (LspAnalysis*)calloc(1, sizeof(LspAnalysis));
+    if (!analysis) return NULL;
+    analysis->version = version;
+
+    analysis->tokens = lex_tokens(content, &analysis->token_count);
+    if (!analysis->tokens) {
+        lsp_analysis_destroy(analysis);
+        return NULL;
+    }
+
+    analysis->ast = parse_program(content);
+    if (analysis->ast) {
+        index_statements(analysis, text);
+    }
+    update_end_position(analysis, text);
+    rebuild_symbols(analysis);
+
+    LSP_LOG_DEBUG("Analyzed version %d: %d tokens, %s", version, analysis->token_count,
+                  analysis->ast ? "parsed" : "parse failed");
+    return analysis;
+}
+
+LspAnalysis* lsp_analysis_create_snapshot(const char* content, int version) {
+    if (!content) return NULL;
+
+    LspTextBuffer* text = lsp_text_buffer_create(content);
+    if (!text) return NULL;
+
+    LspAnalysis* analysis = lsp_analysis_create(text, content, version);
+    lsp_text_buffer_destroy(text);
+    return analysis;
+}
+
+void lsp_analysis_destroy(LspAnalysis* analysis) {
+    if (!analysis) return;
+    free_tokens(analysis->tokens, analysis->token_count);
+    destroy_program(analysis->ast);
+    if (analysis->symbols) symbol_table_destroy(analysis->symbols);
+    if (analysis->diagnostics) lsp_diagnostic_list_destroy(analysis->diagnostics);
+    free(analysis->statement_offsets);
+    free(analysis->statement_tokens);
+    free(analysis);
+}
+
+int lsp_document_has_analysis(const LspDocument* doc) {
+    return doc && doc->analysis && !doc->edit.pending && doc->analysis->version == doc->version;
+}
+
+LspAnalysis* lsp_document_adopt_analysis(LspDocument* doc, LspAnalysis* analysis) {
+    if (!doc || !analysis || analysis->version != doc->version || lsp_document_has_analysis(doc)) {
+        return analysis;
+    }
+
+    LspAnalysis* previous = doc->analysis;
+    doc->analysis = analysis;
+    memset(&doc->edit, 0, sizeof(doc->edit));
+    return previous;
+}
+
+LspAnalysis* lsp_document_reuse_analysis(LspDocument* doc) {
+    if (!doc || !doc->text) return NULL;
+
+    if (lsp_document_has_analysis(doc)) {
+        return doc->analysis;
+    }
+
+    if (doc->analysis && lsp_analysis_reparse(doc->analysis, doc) == 0) {
+        doc->analysis->version = doc->version;
+        memset(&doc->edit, 0, sizeof(doc->edit));
+        return doc->analysis;
+    }
+
+    return NULL;
+}
+
+LspAnalysis* lsp_document_get_analysis(LspDocument* doc) {
+    if (!doc || !doc->text) return NULL;
+
+    LspAnalysis* analysis = lsp_document_reuse_analysis(doc);
+    if (analysis) return analysis;
+
+    const char* content = lsp_document_get_content(doc);
+    if (!content) return NULL;
+
+    lsp_analysis_destroy(doc->analysis);
+    doc->analysis = lsp_analysis_create(doc->text, content, doc->version);
+    memset(&doc->edit, 0, sizeof(doc->edit));
+    return doc->analysis;
+}
@@ -0,0 +1,32 @@
+#ifndef LSP_ANALYSIS_H
+#define LSP_ANALYSIS_H
+
+#include "lsp_document.h"
+#include "protocol/lsp_messages.h"
+#include "../../src/compiler/frontend/lexer/tokenizer.h"
+#include "../../src/compiler/frontend/parser/ast.h"
+#include "../../src/compiler/frontend/semantic/symbol_table.h"
+
+typedef struct LspAnalysis {
+    int version;
+    Token* tokens;
+    int token_count;
+    ASTNode* ast;
+    SymbolTable* symbols;
+    LspDiagnosticList* diagnostics;
+    int* statement_offsets;
+    int* statement_tokens;
+    int length;
+    int end_line;
+    int end_col;
+} LspAnalysis;
+
+LspAnalysis* lsp_document_get_analysis(LspDocument* doc);
+LspAnalysis* lsp_document_reuse_analysis(LspDocument* doc);
+int lsp_document_has_analysis(const LspDocument* doc);
+LspAnalysis* lsp_document_adopt_analysis(LspDocument* doc, LspAnalysis* analysis);
+
+LspAnalysis* lsp_analysis_create_snapshot(const char* content, int version);
+void lsp_analysis_destroy(LspAnalysis* analysis);
+
+#endif
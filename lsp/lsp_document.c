@@ -1,11 +1,14 @@
 #include "lsp_document.h"
+#include "lsp_analysis.h"
+#include "lsp_text_buffer.h"
+#include "features/semantic_tokens.h"
 
 LspDocumentStore* lsp_document_store_create(void) {
     LspDocumentStore* store = (LspDocumentStore*)calloc(1, sizeof(LspDocumentStore));
     if (!store) return NULL;
     store->capacity = 16;
-    store->items = (LspDocument**)calloc(store->capacity, sizeof(LspDocument*));
-    if (!store->items) {
+    store->slots = (LspDocumentSlot*)calloc(store->capacity, sizeof(LspDocumentSlot));
+    if (!store->slots) {
         free(store);
         return NULL;
     }
@@ -14,54 +17,168 @@ LspDocumentStore* lsp_document_store_create(void) {
 
 void lsp_document_store_destroy(LspDocumentStore* store) {
     if (!store) return;
-    for (int i = 0; i < store->count; i++) {
-        lsp_document_destroy(store->items[i]);
+    for (int i = 0; i < store->capacity; i++) {
+        lsp_document_destroy(store->slots[i].doc);
+        free(store->slots[i].uri);
     }
-    free(store->items);
+    free(store->slots);
     free(store);
 }
 
+static unsigned int hash_uri(const char* uri) {
+    unsigned int hash = 5381;
+    int c;
+    while ((c = (unsigned char)*uri++)) {
+        hash = ((hash << 5) + hash) + c;
+    }
+    return hash;
+}
+
+static LspDocumentSlot* find_slot(LspDocumentSlot* slots, int capacity, const char* uri, unsigned int hash) {
+    unsigned int mask = (unsigned int)capacity - 1;
+    unsigned int index = hash & mask;
+    while (slots[index].uri) {
+        if (slots[index].hash == hash && strcmp(slots[index].uri, uri) == 0) {
+            return &slots[index];
+        }
+        index = (index + 1) & mask;
+    }
+    return &slots[index];
+}
+
+static int grow_slots(LspDocumentStore* store) {
+    int capacity = store->capacity * 2;
+    LspDocumentSlot* slots = (LspDocumentSlot*)calloc(capacity, sizeof(LspDocumentSlot));
+    if (!slots) return -1;
+    
+    for (int i = 0; i < store->capacity; i++) {
+        LspDocumentSlot* old = &store->slots[i];
+        if (!old->uri) continue;
+        *find_slot(slots, capacity, old->uri, old->hash) = *old;
+    }
+    
+    free(store->slots);
+    store->slots = slots;
+    store->capacity = capacity;
+    return 0;
+}
+
+static LspDocumentSlot* lookup_slot(LspDocumentStore* store, const char* uri) {
+    LspDocumentSlot* slot = find_slot(store->slots, store->capacity, uri, hash_uri(uri));
+    return slot->uri ? slot : NULL;
+}
+
+static LspDocumentSlot* intern_slot(LspDocumentStore* store, const char* uri) {
+    unsigned int hash = hash_uri(uri);
+    LspDocumentSlot* slot = find_slot(store->slots, store->capacity, uri, hash);
+    if (slot->uri) return slot;
+    
+    if ((store->interned + 1) * 4 > store->capacity * 3) {
+        if (grow_slots(store) != 0) return NULL;
+        slot = find_slot(store->slots, store->capacity, uri, hash);
+    }
+    
+    slot->uri = strdup(uri);
+    if (!slot->uri) return NULL;
+    slot->hash = hash;
+    slot->doc = NULL;
+    store->interned++;
+    return slot;
+}
+
+const char* lsp_document_store_intern(LspDocumentStore* store, const char* uri) {
+    if (!store || !uri) return NULL;
+    LspDocumentSlot* slot = intern_slot(store, uri);
+    return slot ? slot->uri : NULL;
+}
+
 LspDocument* lsp_document_create(const char* uri, const char* language_id, int version, const char* content) {
     if (!uri) return NULL;
     LspDocument* doc = (LspDocument*)calloc(1, sizeof(LspDocument));
     if (!doc) return NULL;
     
-    doc->uri = strdup(uri);
+    doc->uri = uri;
     doc->language_id = language_id ? strdup(language_id) : NULL;
     doc->version = version;
-    doc->content = content ? strdup(content) : NULL;
+    doc->text = content ? lsp_text_buffer_create(content) : NULL;
     
     return doc;
 }
 
+static void invalidate_content(LspDocument* doc) {
+    free(doc->content);
+    doc->content = NULL;
+}
+
+static void invalidate_analysis(LspDocument* doc) {
+    lsp_analysis_destroy(doc->analysis);
+    doc->analysis = NULL;
+    memset(&doc->edit, 0, sizeof(doc->edit));
+    invalidate_content(doc);
+}
+
+static void track_edit(LspDocument* doc, int start, int end, int inserted) {
+    LspEditSpan* span = &doc->edit;
+    int delta = inserted - (end - start);
+    
+    if (!span->pending) {
+        span->start = start;
+        span->end = start + inserted;
+        span->delta = delta;
+        span->pending = 1;
+        return;
+    }
+    
+    int span_end = span->end;
+    if (span_end > end) {
+        span_end += delta;
+    } else if (span_end > start) {
+        span_end = start + inserted;
+    }
+    
+    if (start < span->start) span->start = start;
+    span->end = span_end > start + inserted ? span_end : start + inserted;
+    span->delta += delta;
+}
+
+static void replace_text(LspDocument* doc, const char* content) {
+    invalidate_analysis(doc);
+    if (doc->semantic_tokens) doc->semantic_tokens->version = -1;
+    lsp_text_buffer_destroy(doc->text);
+    doc->text = content ? lsp_text_buffer_create(content) : NULL;
+}
+
 void lsp_document_destroy(LspDocument* doc) {
     if (!doc) return;
-    free(doc->uri);
+    invalidate_analysis(doc);
+    lsp_semantic_tokens_destroy(doc->semantic_tokens);
+    lsp_text_buffer_destroy(doc->text);
     free(doc->language_id);
-    free(doc->content);
     free(doc);
 }
 
+char* lsp_document_get_content(LspDocument* doc) {
+    if (!doc || !doc->text) return NULL;
+    if (!doc->content) {
+        doc->content = lsp_text_buffer_to_string(doc->text);
+    }
+    return doc->content;
+}
+
 int lsp_document_store_open(LspDocumentStore* store, const char* uri, const char* language_id, int version, const char* content) {
     if (!store || !uri) return -1;
     
-    LspDocument* existing = lsp_document_store_get(store, uri);
-    if (existing) {
-        free(existing->content);
-        existing->content = content ? strdup(content) : NULL;
-        existing->version = version;
-        return 0;
-    }
+    LspDocumentSlot* slot = intern_slot(store, uri);
+    if (!slot) return -1;
     
-    if (store->count >= store->capacity) {
-        store->capacity *= 2;
-        LspDocument** new_items = (LspDocument**)realloc(store->items, store->capacity * sizeof(LspDocument*));
-        if (!new_items) return -1;
-        store->items = new_items;
+    if (slot->doc) {
+        replace_text(slot->doc, content);
+        slot->doc->version = version;
+        return 0;
     }
     
-    store->items[store->count] = lsp_document_create(uri, language_id, version, content);
-    if (!store->items[store->count]) return -1;
+    slot->doc = lsp_document_create(slot->uri, language_id, version, content);
+    if (!slot->doc) return -1;
     store->count++;
     return 0;
 }
@@ -72,66 +189,11 @@ int lsp_document_store_change(LspDocumentStore* store, const char* uri, int vers
     LspDocument* doc = lsp_document_store_get(store, uri);
     if (!doc) return -1;
     
-    free(doc->content);
-    doc->content = new_content ? strdup(new_content) : NULL;
+    replace_text(doc, new_content);
     doc->version = version;
     return 0;
 }
 
-static int offset_from_line_col_internal(const char* content, int line, int col) {
-    if (!content) return 0;
-    
-    int current_line = 0;
-    int current_col = 0;
-    int offset = 0;
-    
-    for (offset = 0; content[offset]; offset++) {
-        if (current_line == line && current_col == col) {
-            return offset;
-        }
-        
-        if (content[offset] == '\n') {
-            if (current_line == line) {
-                return offset;
-            }
-            current_line++;
-            current_col = 0;
-        } else {
-            current_col++;
-        }
-    }
-    
-    return offset;
-}
-
-static char* apply_text_change(const char* content, const LspTextChange* change) {
-    if (!content || !change) return NULL;
-    
-    int start_offset = offset_from_line_col_internal(content, change->start_line, change->start_char);
-    int end_offset = offset_from_line_col_internal(content, change->end_line, change->end_char);
-    
-    if (start_offset < 0) start_offset = 0;
-    if (end_offset < start_offset) end_offset = start_offset;
-    if (end_offset > (int)strlen(content)) end_offset = (int)strlen(content);
-    
-    size_t prefix_len = start_offset;
-    size_t suffix_len = strlen(content) - end_offset;
-    size_t new_text_len = change->text ? strlen(change->text) : 0;
-    
-    size_t new_len = prefix_len + new_text_len + suffix_len;
-    char* new_content = (char*)malloc(new_len + 1);
-    if (!new_content) return NULL;
-    
-    memcpy(new_content, content, prefix_len);
-    if (change->text) {
-        memcpy(new_content + prefix_len, change->text, new_text_len);
-    }
-    memcpy(new_content + prefix_len + new_text_len, content + end_offset, suffix_len);
-    new_content[new_len] = '\0';
-    
-    return new_content;
-}
-
 int lsp_document_store_change_incremental(LspDocumentStore* store, const char* uri, int version,
                                           const LspTextChange* changes, int change_count) {
     if (!store || !uri || !changes || change_count <= 0) return -1;
@@ -139,21 +201,23 @@ int lsp_document_store_change_incremental(LspDocumentStore* store, const char* u
     LspDocument* doc = lsp_document_store_get(store, uri);
     if (!doc) return -1;
     
-    char* current_content = strdup(doc->content ? doc->content : "");
-    if (!current_content) return -1;
+    if (!doc->text) {
+        doc->text = lsp_text_buffer_create("");
+        if (!doc->text) return -1;
+    }
     
+    invalidate_content(doc);
     for (int i = 0; i < change_count; i++) {
-        char* new_content = apply_text_change(current_content, &changes[i]);
-        if (!new_content) {
-            free(current_content);
+        const LspTextChange* change = &changes[i];
+        int start_offset = lsp_text_buffer_offset_from_line_col(doc->text, change->start_line, change->start_char);
+        int end_offset = lsp_text_buffer_offset_from_line_col(doc->text, change->end_line, change->end_char);
+        if (end_offset < start_offset) end_offset = start_offset;
+        if (lsp_text_buffer_replace(doc->text, start_offset, end_offset, change->text) != 0) {
+            invalidate_analysis(doc);
             return -1;
         }
-        free(current_content);
-        current_content = new_content;
+        track_edit(doc, start_offset, end_offset, change->text ? (int)strlen(change->text) : 0);
     }
-    
-    free(doc->content);
-    doc->content = current_content;
     doc->version = version;
     
     return 0;
@@ -162,33 +226,25 @@ int lsp_document_store_change_incremental(LspDocumentStore* store, const char* u
 int lsp_document_store_close(LspDocumentStore* store, const char* uri) {
     if (!store || !uri) return -1;
     
-    for (int i = 0; i < store->count; i++) {
-        if (strcmp(store->items[i]->uri, uri) == 0) {
-            lsp_document_destroy(store->items[i]);
-            for (int j = i; j < store->count - 1; j++) {
-                store->items[j] = store->items[j + 1];
-            }
-            store->count--;
-            return 0;
-        }
-    }
-    return -1;
+    LspDocumentSlot* slot = lookup_slot(store, uri);
+    if (!slot || !slot->doc) return -1;
+    
+    lsp_document_destroy(slot->doc);
+    slot->doc = NULL;
+    store->count--;
+    return 0;
 }
 
 LspDocument* lsp_document_store_get(LspDocumentStore* store, const char* uri) {
     if (!store || !uri) return NULL;
     
-    for (int i = 0; i < store->count; i++) {
-        if (strcmp(store->items[i]->uri, uri) == 0) {
-            return store->items[i];
-        }
-    }
-    return NULL;
+    LspDocumentSlot* slot = lookup_slot(store, uri);
+    return slot ? slot->doc : NULL;
 }
 
 char* lsp_document_store_get_content(LspDocumentStore* store, const char* uri) {
     LspDocument* doc = lsp_document_store_get(store, uri);
-    return doc ? doc->content : NULL;
+    return lsp_document_get_content(doc);
 }
 
 int lsp_document_store_get_version(LspDocumentStore* store, const char* uri) {
@@ -202,20 +258,13 @@ void lsp_document_get_line_col(const LspDocument* doc, int offset, int* line, in
     *line = 0;
     *col = 0;
     
-    if (!doc->content) return;
+    if (!doc->text) return;
     
-    for (int i = 0; i < offset && doc->content[i]; i++) {
-        if (doc->content[i] == '\n') {
-            (*line)++;
-            *col = 0;
-        } else {
-            (*col)++;
-        }
-    }
+    lsp_text_buffer_get_line_col(doc->text, offset, line, col);
 }
 
 int lsp_document_offset_from_line_col(const LspDocument* doc, int line, int col) {
-    if (!doc || !doc->content) return -1;
+    if (!doc || !doc->text) return -1;
     
-    return offset_from_line_col_internal(doc->content, line, col);
+    return lsp_text_buffer_offset_from_line_col(doc->text, line, col);
 }
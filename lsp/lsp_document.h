@@ -5,17 +5,39 @@
 #include <stdlib.h>
 #include <string.h>
 
+struct LspAnalysis;
+struct LspTextBuffer;
+struct LspSemanticTokens;
+
 typedef struct {
-    char* uri;
+    int start;
+    int end;
+    int delta;
+    int pending;
+} LspEditSpan;
+
+typedef struct {
+    const char* uri;
+    struct LspTextBuffer* text;
     char* content;
     int version;
     char* language_id;
+    struct LspAnalysis* analysis;
+    struct LspSemanticTokens* semantic_tokens;
+    LspEditSpan edit;
 } LspDocument;
 
 typedef struct {
-    LspDocument** items;
-    int count;
+    char* uri;
+    unsigned int hash;
+    LspDocument* doc;
+} LspDocumentSlot;
+
+typedef struct {
+    LspDocumentSlot* slots;
     int capacity;
+    int interned;
+    int count;
 } LspDocumentStore;
 
 typedef struct {
@@ -31,6 +53,7 @@ void lsp_document_store_destroy(LspDocumentStore* store);
 
 LspDocument* lsp_document_create(const char* uri, const char* language_id, int version, const char* content);
 void lsp_document_destroy(LspDocument* doc);
+char* lsp_document_get_content(LspDocument* doc);
 
 int lsp_document_store_open(LspDocumentStore* store, const char* uri, const char* language_id, int version, const char* content);
 int lsp_document_store_change(LspDocumentStore* store, const char* uri, int version, const char* new_content);
@@ -38,6 +61,8 @@ int lsp_document_store_change_incremental(LspDocumentStore* store, const char* u
                                           const LspTextChange* changes, int change_count);
 int lsp_document_store_close(LspDocumentStore* store, const char* uri);
 
+const char* lsp_document_store_intern(LspDocumentStore* store, const char* uri);
+
 LspDocument* lsp_document_store_get(LspDocumentStore* store, const char* uri);
 char* lsp_document_store_get_content(LspDocumentStore* store, const char* uri);
 int lsp_document_store_get_version(LspDocumentStore* store, const char* uri);
@@ -0,0 +1,985 @@
+#include "lsp_index.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <direct.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include "lsp_document.h"
+#include "lsp_log.h"
+#include "../../src/compiler/driver/project.h"
+
+#define INDEX_MAGIC "ESIX"
+#define INDEX_VERSION 2
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t file_count;
+    uint32_t symbol_count;
+    uint32_t files_offset;
+    uint32_t symbols_offset;
+    uint32_t sorted_offset;
+    uint32_t strings_offset;
+    uint32_t strings_size;
+    uint32_t checksum_low;
+    uint32_t checksum_high;
+    uint32_t reserved[5];
+} IndexHeader;
+
+typedef struct {
+    uint32_t uri_offset;
+    uint32_t uri_length;
+    uint32_t first_symbol;
+    uint32_t symbol_count;
+    uint64_t hash;
+    int64_t mtime;
+    uint64_t size;
+} IndexFileRecord;
+
+typedef struct {
+    uint32_t name_offset;
+    uint32_t name_length;
+    uint32_t file;
+    uint32_t kind;
+    uint32_t line;
+    uint32_t character;
+} IndexSymbolRecord;
+
+typedef struct {
+    void* view;
+    size_t size;
+    const IndexHeader* header;
+    const IndexFileRecord* files;
+    const IndexSymbolRecord* symbols;
+    const uint32_t* sorted;
+    const char* strings;
+} IndexMap;
+
+typedef struct {
+    const char* text;
+    uint32_t length;
+    uint32_t id;
+} IndexKey;
+
+typedef struct {
+    char* uri;
+    uint64_t hash;
+    int64_t mtime;
+    uint64_t size;
+    int mapped_file;
+    LspSymbolList* symbols;
+} IndexEntry;
+
+typedef struct IndexUpdate {
+    char* uri;
+    int removed;
+    struct IndexUpdate* next;
+} IndexUpdate;
+
+struct LspIndex {
+    char* root_path;
+    char* index_path;
+    pthread_mutex_t* parse_lock;
+    pthread_t thread;
+    int thread_started;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    IndexUpdate* updates;
+    int rebuild;
+    int stopping;
+
+    pthread_rwlock_t map_lock;
+    IndexMap map;
+};
+
+static void* map_file(const char* path, size_t* size) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return NULL;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return NULL;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping) return NULL;
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) return NULL;
+    *size = (size_t)file_size.QuadPart;
+    return view;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    void* view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) return NULL;
+    *size = (size_t)st.st_size;
+    return view;
+#endif
+}
+
+static void unmap_file(void* view, size_t size) {
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(view);
+#else
+    munmap(view, size);
+#endif
+}
+
+static int replace_file(const char* from, const char* to) {
+#ifdef _WIN32
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) ? 0 : -1;
+#else
+    return rename(from, to);
+#endif
+}
+
+static int make_directory(const char* path) {
+#ifdef _WIN32
+    return _mkdir(path);
+#else
+    return mkdir(path, 0755);
+#endif
+}
+
+static uint64_t hash_bytes(const char* data, size_t length) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static uint64_t index_checksum(const void* view, size_t size) {
+    return hash_bytes((const char*)view + sizeof(IndexHeader), size - sizeof(IndexHeader));
+}
+
+static int range_in_bounds(uint64_t offset, uint64_t size, size_t file_size) {
+    return offset + size <= (uint64_t)file_size;
+}
+
+static void unmap_index(IndexMap* map) {
+    if (map->view) unmap_file(map->view, map->size);
+    memset(map, 0, sizeof(IndexMap));
+}
+
+static int map_index(const char* path, IndexMap* map) {
+    memset(map, 0, sizeof(IndexMap));
+
+    size_t size = 0;
+    void* view = map_file(path, &size);
+    if (!view) return -1;
+
+    const IndexHeader* header = (const IndexHeader*)view;
+    int valid = size >= sizeof(IndexHeader) &&
+                memcmp(header->magic, INDEX_MAGIC, 4) == 0 &&
+                header->version == INDEX_VERSION &&
+                header->files_offset % 8 == 0 &&
+                header->symbols_offset % 8 == 0 &&
+                header->sorted_offset % 4 == 0 &&
+                range_in_bounds(header->files_offset, (uint64_t)header->file_count * sizeof(IndexFileRecord), size) &&
+                range_in_bounds(header->symbols_offset, (uint64_t)header->symbol_count * sizeof(IndexSymbolRecord), size) &&
+                range_in_bounds(header->sorted_offset, (uint64_t)header->symbol_count * sizeof(uint32_t), size) &&
+                range_in_bounds(header->strings_offset, header->strings_size, size);
+
+    const uint8_t* base = (const uint8_t*)view;
+    const IndexFileRecord* files = valid ? (const IndexFileRecord*)(base + header->files_offset) : NULL;
+    const IndexSymbolRecord* symbols = valid ? (const IndexSymbolRecord*)(base + header->symbols_offset) : NULL;
+    const uint32_t* sorted = valid ? (const uint32_t*)(base + header->sorted_offset) : NULL;
+
+    for (uint32_t i = 0; valid && i < header->file_count; i++) {
+        valid = (uint64_t)files[i].uri_offset + files[i].uri_length < header->strings_size &&
+                (uint64_t)files[i].first_symbol + files[i].symbol_count <= header->symbol_count;
+    }
+    for (uint32_t i = 0; valid && i < header->symbol_count; i++) {
+        valid = (uint64_t)symbols[i].name_offset + symbols[i].name_length < header->strings_size &&
+                symbols[i].file < header->file_count &&
+                sorted[i] < header->symbol_count;
+    }
+
+    if (!valid) {
+        LSP_LOG_WARN("Ignoring malformed symbol index %s", path);
+        unmap_file(view, size);
+        return -1;
+    }
+
+    uint64_t checksum = index_checksum(view, size);
+    if (header->checksum_low != (uint32_t)checksum || header->checksum_high != (uint32_t)(checksum >> 32)) {
+        LSP_LOG_WARN("Ignoring corrupt symbol index %s: checksum mismatch", path);
+        unmap_file(view, size);
+        return -1;
+    }
+
+    map->view = view;
+    map->size = size;
+    map->header = header;
+    map->files = files;
+    map->symbols = symbols;
+    map->sorted = sorted;
+    map->strings = (const char*)(base + header->strings_offset);
+    return 0;
+}
+
+static uint32_t map_file_count(const IndexMap* map) {
+    return map->header ? map->header->file_count : 0;
+}
+
+static uint32_t map_symbol_count(const IndexMap* map) {
+    return map->header ? map->header->symbol_count : 0;
+}
+
+static int key_compare(const void* a, const void* b) {
+    const IndexKey* ka = (const IndexKey*)a;
+    const IndexKey* kb = (const IndexKey*)b;
+    uint32_t length = ka->length < kb->length ? ka->length : kb->length;
+    int cmp = memcmp(ka->text, kb->text, length);
+    if (cmp != 0) return cmp;
+    if (ka->length != kb->length) return ka->length < kb->length ? -1 : 1;
+    return ka->id < kb->id ? -1 : (ka->id > kb->id ? 1 : 0);
+}
+
+static int key_lower_bound(const IndexKey* keys, int count, const char* text, uint32_t length) {
+    IndexKey probe = { text, length, 0 };
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (key_compare(&keys[mid], &probe) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static IndexKey* build_file_keys(const IndexMap* map, int* count) {
+    *count = (int)map_file_count(map);
+    if (*count == 0) return NULL;
+
+    IndexKey* keys = (IndexKey*)malloc(*count * sizeof(IndexKey));
+    if (!keys) {
+        *count = 0;
+        return NULL;
+    }
+    for (int i = 0; i < *count; i++) {
+        keys[i].text = map->strings + map->files[i].uri_offset;
+        keys[i].length = map->files[i].uri_length;
+        keys[i].id = (uint32_t)i;
+    }
+    qsort(keys, *count, sizeof(IndexKey), key_compare);
+    return keys;
+}
+
+static int find_mapped_file(const IndexKey* keys, int count, const char* uri) {
+    uint32_t length = (uint32_t)strlen(uri);
+    int pos = key_lower_bound(keys, count, uri, length);
+    if (pos < count && keys[pos].length == length && memcmp(keys[pos].text, uri, length) == 0) {
+        return (int)keys[pos].id;
+    }
+    return -1;
+}
+
+static char* uri_to_path(const char* uri) {
+    if (strncmp(uri, "file://", 7) != 0) return strdup(uri);
+
+    const char* p = uri + 7;
+    char* path = (char*)malloc(strlen(p) + 1);
+    if (!path) return NULL;
+
+    size_t len = 0;
+    while (*p) {
+        if (p[0] == '%' && isxdigit((unsigned char)p[1]) && isxdigit((unsigned char)p[2])) {
+            char hex[3] = { p[1], p[2], '\0' };
+            path[len++] = (char)strtol(hex, NULL, 16);
+            p += 3;
+        } else {
+            path[len++] = *p++;
+        }
+    }
+    path[len] = '\0';
+
+#ifdef _WIN32
+    if (path[0] == '/' && path[1] && path[2] == ':') {
+        memmove(path, path + 1, len);
+    }
+#endif
+    return path;
+}
+
+static char* path_to_uri(const char* path) {
+    size_t length = strlen(path);
+    char* uri = (char*)malloc(length * 3 + 9);
+    if (!uri) return NULL;
+
+    size_t len = 0;
+    memcpy(uri, "file://", 7);
+    len = 7;
+    if (path[0] != '/' && path[0] != '\\') uri[len++] = '/';
+
+    for (const char* p = path; *p; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '\\') {
+            uri[len++] = '/';
+        } else if (c == ' ' || c == '%' || c == '#' || c == '?') {
+            len += sprintf(uri + len, "%%%02X", c);
+        } else {
+            uri[len++] = (char)c;
+        }
+    }
+    uri[len] = '\0';
+    return uri;
+}
+
+static char* join_path(const char* base, const char* relative) {
+    int absolute = relative[0] == '/' || relative[0] == '\\' || (relative[0] && relative[1] == ':');
+    size_t base_len = absolute || !base ? 0 : strlen(base);
+    char* path = (char*)malloc(base_len + strlen(relative) + 2);
+    if (!path) return NULL;
+
+    size_t len = 0;
+    if (base_len > 0) {
+        memcpy(path, base, base_len);
+        len = base_len;
+        if (path[len - 1] != '/' && path[len - 1] != '\\') path[len++] = '/';
+    }
+    strcpy(path + len, relative);
+
+#ifndef _WIN32
+    for (char* p = path; *p; p++) {
+        if (*p == '\\') *p = '/';
+    }
+#endif
+    return path;
+}
+
+static char* find_project_file(const char* root) {
+    char* found = NULL;
+#ifdef _WIN32
+    char* pattern = join_path(root, "*.esproj");
+    if (!pattern) return NULL;
+    WIN32_FIND_DATAA data;
+    HANDLE handle = FindFirstFileA(pattern, &data);
+    free(pattern);
+    if (handle == INVALID_HANDLE_VALUE) return NULL;
+    found = join_path(root, data.cFileName);
+    FindClose(handle);
+#else
+    DIR* dir = opendir(root);
+    if (!dir) return NULL;
+    struct dirent* entry;
+    while (!found && (entry = readdir(dir)) != NULL) {
+        const char* ext = strrchr(entry->d_name, '.');
+        if (ext && strcmp(ext, ".esproj") == 0) {
+            found = join_path(root, entry->d_name);
+        }
+    }
+    closedir(dir);
+#endif
+    return found;
+}
+
+static char* read_source(const char* path, size_t* length) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return NULL;
+
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (size < 0) {
+        fclose(fp);
+        return NULL;
+    }
+
+    char* content = (char*)malloc((size_t)size + 1);
+    if (!content) {
+        fclose(fp);
+        return NULL;
+    }
+    *length = fread(content, 1, (size_t)size, fp);
+    content[*length] = '\0';
+    fclose(fp);
+    return content;
+}
+
+static LspSymbolList* extract_symbols(LspIndex* index, const char* uri, const char* content) {
+    pthread_mutex_lock(index->parse_lock);
+    LspDocument* doc = lsp_document_create(uri, "esharp", 0, content);
+    LspSymbolList* symbols = doc ? lsp_document_symbols(doc) : NULL;
+    lsp_document_destroy(doc);
+    pthread_mutex_unlock(index->parse_lock);
+    return symbols;
+}
+
+static int load_entry(LspIndex* index, IndexEntry* entry, int mapped_file) {
+    char* path = uri_to_path(entry->uri);
+    if (!path) return -1;
+
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        free(path);
+        return -1;
+    }
+    entry->mtime = (int64_t)st.st_mtime;
+    entry->size = (uint64_t)st.st_size;
+
+    const IndexFileRecord* old = mapped_file >= 0 ? &index->map.files[mapped_file] : NULL;
+    if (old && old->mtime == entry->mtime && old->size == entry->size) {
+        entry->hash = old->hash;
+        entry->mapped_file = mapped_file;
+        free(path);
+        return 0;
+    }
+
+    size_t length = 0;
+    char* content = read_source(path, &length);
+    free(path);
+    if (!content) return -1;
+
+    entry->hash = hash_bytes(content, length);
+    if (old && old->hash == entry->hash) {
+        entry->mapped_file = mapped_file;
+    } else {
+        entry->mapped_file = -1;
+        entry->symbols = extract_symbols(index, entry->uri, content);
+    }
+    free(content);
+    return 0;
+}
+
+static void free_entries(IndexEntry* entries, int count) {
+    for (int i = 0; i < count; i++) {
+        free(entries[i].uri);
+        lsp_symbol_list_destroy(entries[i].symbols);
+    }
+    free(entries);
+}
+
+static int write_index(LspIndex* index, const IndexEntry* entries, int count, const char* path) {
+    const IndexMap* old = &index->map;
+    uint64_t symbol_count = 0;
+    uint64_t strings_size = 0;
+
+    for (int i = 0; i < count; i++) {
+        const IndexEntry* entry = &entries[i];
+        strings_size += strlen(entry->uri) + 1;
+        if (entry->mapped_file >= 0) {
+            const IndexFileRecord* file = &old->files[entry->mapped_file];
+            symbol_count += file->symbol_count;
+            for (uint32_t s = 0; s < file->symbol_count; s++) {
+                strings_size += old->symbols[file->first_symbol + s].name_length + 1;
+            }
+        } else if (entry->symbols) {
+            symbol_count += entry->symbols->count;
+            for (int s = 0; s < entry->symbols->count; s++) {
+                strings_size += strlen(entry->symbols->items[s].name) + 1;
+            }
+        }
+    }
+
+    uint64_t files_offset = sizeof(IndexHeader);
+    uint64_t symbols_offset = files_offset + (uint64_t)count * sizeof(IndexFileRecord);
+    uint64_t sorted_offset = symbols_offset + symbol_count * sizeof(IndexSymbolRecord);
+    uint64_t strings_offset = sorted_offset + symbol_count * sizeof(uint32_t);
+    uint64_t total = strings_offset + strings_size;
+    if (total > UINT32_MAX) return -1;
+
+    uint8_t* buffer = (uint8_t*)calloc(1, (size_t)total);
+    IndexKey* keys = (IndexKey*)malloc((symbol_count ? symbol_count : 1) * sizeof(IndexKey));
+    if (!buffer || !keys) {
+        free(buffer);
+        free(keys);
+        return -1;
+    }
+
+    IndexHeader* header = (IndexHeader*)buffer;
+    memcpy(header->magic, INDEX_MAGIC, 4);
+    header->version = INDEX_VERSION;
+    header->file_count = (uint32_t)count;
+    header->symbol_count = (uint32_t)symbol_count;
+    header->files_offset = (uint32_t)files_offset;
+    header->symbols_offset = (uint32_t)symbols_offset;
+    header->sorted_offset = (uint32_t)sorted_offset;
+    header->strings_offset = (uint32_t)strings_offset;
+    header->strings_size = (uint32_t)strings_size;
+
+    IndexFileRecord* files = (IndexFileRecord*)(buffer + files_offset);
+    IndexSymbolRecord* symbols = (IndexSymbolRecord*)(buffer + symbols_offset);
+    uint32_t* sorted = (uint32_t*)(buffer + sorted_offset);
+    char* strings = (char*)(buffer + strings_offset);
+    uint32_t string_pos = 0;
+    uint32_t symbol_pos = 0;
+
+    for (int i = 0; i < count; i++) {
+        const IndexEntry* entry = &entries[i];
+        IndexFileRecord* file = &files[i];
+        uint32_t uri_length = (uint32_t)strlen(entry->uri);
+
+        file->uri_offset = string_pos;
+        file->uri_length = uri_length;
+        memcpy(strings + string_pos, entry->uri, uri_length);
+        string_pos += uri_length + 1;
+        file->first_symbol = symbol_pos;
+        file->hash = entry->hash;
+        file->mtime = entry->mtime;
+        file->size = entry->size;
+
+        if (entry->mapped_file >= 0) {
+            const IndexFileRecord* source = &old->files[entry->mapped_file];
+            for (uint32_t s = 0; s < source->symbol_count; s++) {
+                const IndexSymbolRecord* from = &old->symbols[source->first_symbol + s];
+                IndexSymbolRecord* to = &symbols[symbol_pos++];
+                *to = *from;
+                to->file = (uint32_t)i;
+                to->name_offset = string_pos;
+                memcpy(strings + string_pos, old->strings + from->name_offset, from->name_length);
+                string_pos += from->name_length + 1;
+            }
+        } else if (entry->symbols) {
+            for (int s = 0; s < entry->symbols->count; s++) {
+                const LspSymbolInfo* from = &entry->symbols->items[s];
+                IndexSymbolRecord* to = &symbols[symbol_pos++];
+                uint32_t name_length = (uint32_t)strlen(from->name);
+                to->name_offset = string_pos;
+                to->name_length = name_length;
+                to->file = (uint32_t)i;
+                to->kind = (uint32_t)from->kind;
+                to->line = (uint32_t)from->line;
+                to->character = (uint32_t)from->character;
+                memcpy(strings + string_pos, from->name, name_length);
+                string_pos += name_length + 1;
+            }
+        }
+        file->symbol_count = symbol_pos - file->first_symbol;
+    }
+
+    for (uint32_t s = 0; s < symbol_pos; s++) {
+        keys[s].text = strings + symbols[s].name_offset;
+        keys[s].length = symbols[s].name_length;
+        keys[s].id = s;
+    }
+    qsort(keys, symbol_pos, sizeof(IndexKey), key_compare);
+    for (uint32_t s = 0; s < symbol_pos; s++) {
+        sorted[s] = keys[s].id;
+    }
+    free(keys);
+
+    uint64_t checksum = index_checksum(buffer, (size_t)total);
+    header->checksum_low = (uint32_t)checksum;
+    header->checksum_high = (uint32_t)(checksum >> 32);
+
+    FILE* fp = fopen(path, "wb");
+    int result = -1;
+    if (fp) {
+        result = fwrite(buffer, 1, (size_t)total, fp) == (size_t)total ? 0 : -1;
+        if (fclose(fp) != 0) result = -1;
+    }
+    free(buffer);
+    return result;
+}
+
+static void publish_entries(LspIndex* index, const IndexEntry* entries, int count) {
+    size_t path_len = strlen(index->index_path);
+    char* temp_path = (char*)malloc(path_len + 5);
+    if (!temp_path) return;
+    memcpy(temp_path, index->index_path, path_len);
+    memcpy(temp_path + path_len, ".tmp", 5);
+
+    if (write_index(index, entries, count, temp_path) != 0) {
+        LSP_LOG_ERROR("Failed to write symbol index %s", temp_path);
+        remove(temp_path);
+        free(temp_path);
+        return;
+    }
+
+    pthread_rwlock_wrlock(&index->map_lock);
+    unmap_index(&index->map);
+    if (replace_file(temp_path, index->index_path) != 0) {
+        LSP_LOG_ERROR("Failed to replace symbol index %s", index->index_path);
+        remove(temp_path);
+    }
+    map_index(index->index_path, &index->map);
+    pthread_rwlock_unlock(&index->map_lock);
+
+    LSP_LOG_INFO("Symbol index updated: %u files, %u symbols",
+                 map_file_count(&index->map), map_symbol_count(&index->map));
+    free(temp_path);
+}
+
+static int is_stopping(LspIndex* index) {
+    pthread_mutex_lock(&index->mutex);
+    int stopping = index->stopping;
+    pthread_mutex_unlock(&index->mutex);
+    return stopping;
+}
+
+static void rebuild_project(LspIndex* index) {
+    char* project_file = find_project_file(index->root_path);
+    if (!project_file) {
+        LSP_LOG_INFO("No .esproj found in %s, workspace index disabled", index->root_path);
+        return;
+    }
+
+    pthread_mutex_lock(index->parse_lock);
+    EsProject* project = es_proj_load(project_file);
+    int file_count = 0;
+    char** files = project ? es_proj_get_source_files(project, &file_count) : NULL;
+    pthread_mutex_unlock(index->parse_lock);
+    free(project_file);
+    if (!project) return;
+
+    const char* project_root = project->project_root ? project->project_root : index->root_path;
+
+    int key_count = 0;
+    IndexKey* keys = build_file_keys(&index->map, &key_count);
+    IndexEntry* entries = (IndexEntry*)calloc(file_count > 0 ? file_count : 1, sizeof(IndexEntry));
+    int entry_count = 0;
+    int reused = 0;
+
+    int stopped = 0;
+    for (int i = 0; entries && i < file_count; i++) {
+        if (is_stopping(index)) {
+            stopped = 1;
+            break;
+        }
+        char* path = join_path(project_root, files[i]);
+        IndexEntry* entry = &entries[entry_count];
+        entry->uri = path ? path_to_uri(path) : NULL;
+        free(path);
+        if (!entry->uri) continue;
+
+        int mapped_file = find_mapped_file(keys, key_count, entry->uri);
+        if (load_entry(index, entry, mapped_file) != 0) {
+            LSP_LOG_WARN("Skipping unreadable source %s", entry->uri);
+            free(entry->uri);
+            memset(entry, 0, sizeof(IndexEntry));
+            continue;
+        }
+        if (entry->mapped_file >= 0) reused++;
+        entry_count++;
+    }
+
+    if (entries) {
+        if (!stopped && (reused != entry_count || (uint32_t)entry_count != map_file_count(&index->map))) {
+            LSP_LOG_DEBUG("Indexing %d project files (%d unchanged)", entry_count, reused);
+            publish_entries(index, entries, entry_count);
+        }
+        free_entries(entries, entry_count);
+    }
+
+    free(keys);
+    pthread_mutex_lock(index->parse_lock);
+    for (int i = 0; i < file_count; i++) {
+        ES_FREE(files[i]);
+    }
+    ES_FREE(files);
+    es_proj_destroy(project);
+    pthread_mutex_unlock(index->parse_lock);
+}
+
+static int is_project_file(const char* uri) {
+    const char* ext = strrchr(uri, '.');
+    return ext && strcmp(ext, ".esproj") == 0;
+}
+
+static void apply_updates(LspIndex* index, IndexUpdate* updates) {
+    int file_count = (int)map_file_count(&index->map);
+    int key_count = 0;
+    IndexKey* keys = build_file_keys(&index->map, &key_count);
+    int* actions = (int*)calloc(file_count > 0 ? file_count : 1, sizeof(int));
+    if (!actions) {
+        free(keys);
+        return;
+    }
+
+    int changed = 0;
+    for (IndexUpdate* update = updates; update; update = update->next) {
+        if (is_project_file(update->uri)) {
+            pthread_mutex_lock(&index->mutex);
+            index->rebuild = 1;
+            pthread_mutex_unlock(&index->mutex);
+            continue;
+        }
+        int mapped_file = find_mapped_file(keys, key_count, update->uri);
+        if (mapped_file < 0) continue;
+        actions[mapped_file] = update->removed ? 2 : 1;
+        changed = 1;
+    }
+    free(keys);
+
+    if (!changed) {
+        free(actions);
+        return;
+    }
+
+    IndexEntry* entries = (IndexEntry*)calloc(file_count, sizeof(IndexEntry));
+    int entry_count = 0;
+    for (int i = 0; entries && i < file_count; i++) {
+        if (actions[i] == 2) continue;
+
+        const IndexFileRecord* file = &index->map.files[i];
+        IndexEntry* entry = &entries[entry_count];
+        entry->uri = (char*)malloc(file->uri_length + 1);
+        if (!entry->uri) continue;
+        memcpy(entry->uri, index->map.strings + file->uri_offset, file->uri_length);
+        entry->uri[file->uri_length] = '\0';
+
+        if (actions[i] == 0) {
+            entry->hash = file->hash;
+            entry->mtime = file->mtime;
+            entry->size = file->size;
+            entry->mapped_file = i;
+        } else if (load_entry(index, entry, i) != 0) {
+            free(entry->uri);
+            memset(entry, 0, sizeof(IndexEntry));
+            continue;
+        }
+        entry_count++;
+    }
+
+    if (entries) {
+        publish_entries(index, entries, entry_count);
+        free_entries(entries, entry_count);
+    }
+    free(actions);
+}
+
+static void free_updates(IndexUpdate* updates) {
+    while (updates) {
+        IndexUpdate* next = updates->next;
+        free(updates->uri);
+        free(updates);
+        updates = next;
+    }
+}
+
+static void* indexer_main(void* arg) {
+    LspIndex* index = (LspIndex*)arg;
+
+    pthread_mutex_lock(&index->mutex);
+    while (!index->stopping) {
+        if (index->rebuild) {
+            index->rebuild = 0;
+            pthread_mutex_unlock(&index->mutex);
+            rebuild_project(index);
+            pthread_mutex_lock(&index->mutex);
+            continue;
+        }
+        if (index->updates) {
+            IndexUpdate* updates = index->updates;
+            index->updates = NULL;
+            pthread_mutex_unlock(&index->mutex);
+            apply_updates(index, updates);
+            free_updates(updates);
+            pthread_mutex_lock(&index->mutex);
+            continue;
+        }
+        pthread_cond_wait(&index->cond, &index->mutex);
+    }
+    pthread_mutex_unlock(&index->mutex);
+
+    return NULL;
+}
+
+LspIndex* lsp_index_create(const char* root_uri, pthread_mutex_t* parse_lock) {
+    if (!root_uri || !parse_lock) return NULL;
+
+    LspIndex* index = (LspIndex*)calloc(1, sizeof(LspIndex));
+    if (!index) return NULL;
+
+    index->parse_lock = parse_lock;
+    index->root_path = uri_to_path(root_uri);
+    char* directory = index->root_path ? join_path(index->root_path, LSP_INDEX_DIRECTORY) : NULL;
+    index->index_path = directory ? join_path(directory, LSP_INDEX_FILE) : NULL;
+    if (directory) make_directory(directory);
+    free(directory);
+
+    if (!index->index_path) {
+        free(index->root_path);
+        free(index);
+        return NULL;
+    }
+
+    pthread_mutex_init(&index->mutex, NULL);
+    pthread_cond_init(&index->cond, NULL);
+    pthread_rwlock_init(&index->map_lock, NULL);
+
+    if (map_index(index->index_path, &index->map) == 0) {
+        LSP_LOG_INFO("Loaded symbol index %s: %u files, %u symbols", index->index_path,
+                     map_file_count(&index->map), map_symbol_count(&index->map));
+    }
+
+    index->rebuild = 1;
+    if (pthread_create(&index->thread, NULL, indexer_main, index) == 0) {
+        index->thread_started = 1;
+    } else {
+        LSP_LOG_WARN("Failed to start workspace indexer");
+    }
+
+    return index;
+}
+
+void lsp_index_destroy(LspIndex* index) {
+    if (!index) return;
+
+    pthread_mutex_lock(&index->mutex);
+    index->stopping = 1;
+    pthread_cond_signal(&index->cond);
+    pthread_mutex_unlock(&index->mutex);
+
+    if (index->thread_started) {
+        pthread_join(index->thread, NULL);
+    }
+
+    free_updates(index->updates);
+    unmap_index(&index->map);
+    pthread_rwlock_destroy(&index->map_lock);
+    pthread_cond_destroy(&index->cond);
+    pthread_mutex_destroy(&index->mutex);
+    free(index->root_path);
+    free(index->index_path);
+    free(index);
+}
+
+static void queue_update(LspIndex* index, const char* uri, int removed) {
+    if (!index || !uri) return;
+
+    IndexUpdate* update = (IndexUpdate*)calloc(1, sizeof(IndexUpdate));
+    if (!update) return;
+    update->uri = strdup(uri);
+    update->removed = removed;
+    if (!update->uri) {
+        free(update);
+        return;
+    }
+
+    pthread_mutex_lock(&index->mutex);
+    update->next = index->updates;
+    index->updates = update;
+    pthread_cond_signal(&index->cond);
+    pthread_mutex_unlock(&index->mutex);
+}
+
+void lsp_index_update_file(LspIndex* index, const char* uri) {
+    queue_update(index, uri, 0);
+}
+
+void lsp_index_remove_file(LspIndex* index, const char* uri) {
+    queue_update(index, uri, 1);
+}
+
+static char* copy_string(const char* text, uint32_t length) {
+    char* copy = (char*)malloc(length + 1);
+    if (!copy) return NULL;
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+static void fill_symbol_info(const IndexMap* map, uint32_t id, LspSymbolInfo* info) {
+    const IndexSymbolRecord* symbol = &map->symbols[id];
+    const IndexFileRecord* file = &map->files[symbol->file];
+    info->name = copy_string(map->strings + symbol->name_offset, symbol->name_length);
+    info->uri = copy_string(map->strings + file->uri_offset, file->uri_length);
+    info->line = (int)symbol->line;
+    info->character = (int)symbol->character;
+    info->kind = (int)symbol->kind;
+    info->detail = strdup(lsp_symbol_kind_to_string(info->kind));
+}
+
+static int matches_query(const char* name, uint32_t length, const char* query, size_t query_len) {
+    if (query_len == 0) return 1;
+    if (query_len > length) return 0;
+    for (uint32_t start = 0; start + query_len <= length; start++) {
+        size_t i = 0;
+        while (i < query_len && tolower((unsigned char)name[start + i]) == tolower((unsigned char)query[i])) i++;
+        if (i == query_len) return 1;
+    }
+    return 0;
+}
+
+LspSymbolList* lsp_index_workspace_symbols(LspIndex* index, const char* query, int limit) {
+    if (!index) return NULL;
+
+    LspSymbolList* list = lsp_symbol_list_create();
+    if (!list) return NULL;
+
+    size_t query_len = query ? strlen(query) : 0;
+
+    pthread_rwlock_rdlock(&index->map_lock);
+    const IndexMap* map = &index->map;
+    uint32_t symbol_count = map_symbol_count(map);
+    for (uint32_t i = 0; i < symbol_count && (limit <= 0 || list->count < limit); i++) {
+        uint32_t id = map->sorted[i];
+        const IndexSymbolRecord* symbol = &map->symbols[id];
+        if (!matches_query(map->strings + symbol->name_offset, symbol->name_length, query, query_len)) continue;
+
+        LspSymbolInfo info = {0};
+        fill_symbol_info(map, id, &info);
+        lsp_symbol_list_add(list, &info);
+    }
+    pthread_rwlock_unlock(&index->map_lock);
+
+    return list;
+}
+
+LspSymbolInfo* lsp_index_find_definition(LspIndex* index, const char* name) {
+    if (!index || !name) return NULL;
+
+    uint32_t length = (uint32_t)strlen(name);
+    LspSymbolInfo* result = NULL;
+
+    pthread_rwlock_rdlock(&index->map_lock);
+    const IndexMap* map = &index->map;
+    uint32_t symbol_count = map_symbol_count(map);
+    uint32_t lo = 0, hi = symbol_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        const IndexSymbolRecord* symbol = &map->symbols[map->sorted[mid]];
+        IndexKey a = { map->strings + symbol->name_offset, symbol->name_length, 0 };
+        IndexKey b = { name, length, 0 };
+        if (key_compare(&a, &b) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    uint32_t best = UINT32_MAX;
+    for (uint32_t i = lo; i < symbol_count; i++) {
+        uint32_t id = map->sorted[i];
+        const IndexSymbolRecord* symbol = &map->symbols[id];
+        if (symbol->name_length != length || memcmp(map->strings + symbol->name_offset, name, length) != 0) break;
+        if (best == UINT32_MAX) best = id;
+        if (symbol->kind != 13) {
+            best = id;
+            break;
+        }
+    }
+
+    if (best != UINT32_MAX) {
+        result = (LspSymbolInfo*)calloc(1, sizeof(LspSymbolInfo));
+        if (result) fill_symbol_info(map, best, result);
+    }
+    pthread_rwlock_unlock(&index->map_lock);
+
+    return result;
+}
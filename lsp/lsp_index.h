@@ -0,0 +1,22 @@
+#ifndef LSP_INDEX_H
+#define LSP_INDEX_H
+
+#include <pthread.h>
+#include "features/symbols.h"
+
+#define LSP_INDEX_DIRECTORY ".esls"
+#define LSP_INDEX_FILE "symbols.idx"
+#define LSP_INDEX_QUERY_LIMIT 256
+
+typedef struct LspIndex LspIndex;
+
+LspIndex* lsp_index_create(const char* root_uri, pthread_mutex_t* parse_lock);
+void lsp_index_destroy(LspIndex* index);
+
+void lsp_index_update_file(LspIndex* index, const char* uri);
+void lsp_index_remove_file(LspIndex* index, const char* uri);
+
+LspSymbolList* lsp_index_workspace_symbols(LspIndex* index, const char* query, int limit);
+LspSymbolInfo* lsp_index_find_definition(LspIndex* index, const char* name);
+
+#endif
@@ -2,10 +2,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
 
 static FILE* g_log_file = NULL;
 static LspLogLevel g_min_level = LSP_LOG_LEVEL_INFO;
 static int g_initialized = 0;
+static pthread_mutex_t g_log_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static const char* level_to_string(LspLogLevel level) {
     switch (level) {
@@ -57,10 +59,17 @@ int lsp_log_is_enabled(LspLogLevel level) {
 void lsp_log(LspLogLevel level, const char* file, int line, const char* fmt, ...) {
     if (!g_initialized || level < g_min_level) return;
     
+    pthread_mutex_lock(&g_log_mutex);
+    
     time_t now = time(NULL);
-    struct tm* tm_info = localtime(&now);
+    struct tm tm_info;
+#ifdef _WIN32
+    localtime_s(&tm_info, &now);
+#else
+    localtime_r(&now, &tm_info);
+#endif
     char time_buf[32];
-    strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", tm_info);
+    strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", &tm_info);
     
     const char* level_str = level_to_string(level);
     
@@ -80,4 +89,6 @@ void lsp_log(LspLogLevel level, const char* file, int line, const char* fmt, ...
     
     fprintf(output, "\n");
     fflush(output);
+    
+    pthread_mutex_unlock(&g_log_mutex);
 }
@@ -0,0 +1,397 @@
+#include "lsp_scheduler.h"
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#include "lsp_server.h"
+#include "lsp_log.h"
+#include "lsp_analysis.h"
+#include "features/diagnostics.h"
+
+typedef struct LspRequestJob {
+    LspMessage* msg;
+    int cancelled;
+    struct LspRequestJob* next;
+} LspRequestJob;
+
+typedef struct LspDiagnosticsJob {
+    const char* uri;
+    int version;
+    struct timespec due;
+    struct LspDiagnosticsJob* next;
+} LspDiagnosticsJob;
+
+struct LspScheduler {
+    LspServer* server;
+    pthread_t* workers;
+    int worker_count;
+    int debounce_ms;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int stopping;
+
+    LspRequestJob* requests_head;
+    LspRequestJob* requests_tail;
+    LspRequestJob* running;
+
+    LspDiagnosticsJob* diagnostics;
+    int diagnostics_running;
+};
+
+static void deadline_after(struct timespec* ts, int ms) {
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec += ms / 1000;
+    ts->tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+static int deadline_before(const struct timespec* a, const struct timespec* b) {
+    if (a->tv_sec != b->tv_sec) return a->tv_sec < b->tv_sec;
+    return a->tv_nsec < b->tv_nsec;
+}
+
+static void free_request_job(LspRequestJob* job) {
+    if (!job) return;
+    lsp_message_destroy(job->msg);
+    free(job);
+}
+
+static void run_request(LspScheduler* scheduler, LspRequestJob* job) {
+    LspServer* server = scheduler->server;
+
+    pthread_mutex_lock(&scheduler->mutex);
+    int cancelled = job->cancelled;
+    pthread_mutex_unlock(&scheduler->mutex);
+
+    LspMessage* response = NULL;
+    if (!cancelled) {
+        pthread_mutex_lock(&server->lock);
+        response = lsp_server_handle_message(server, job->msg);
+        pthread_mutex_unlock(&server->lock);
+
+        pthread_mutex_lock(&scheduler->mutex);
+        cancelled = job->cancelled;
+        pthread_mutex_unlock(&scheduler->mutex);
+    }
+
+    if (cancelled) {
+        LSP_LOG_DEBUG("Request %s cancelled", job->msg->method);
+        lsp_message_destroy(response);
+        response = lsp_server_create_cancelled_error(job->msg);
+    }
+
+    lsp_server_send_response(server, job->msg, response);
+}
+
+static void run_diagnostics(LspScheduler* scheduler, LspDiagnosticsJob* job) {
+    LspServer* server = scheduler->server;
+    char* content = NULL;
+
+    pthread_mutex_lock(&server->lock);
+    LspDocument* doc = lsp_document_store_get(server->documents, job->uri);
+    if (doc && doc->version == job->version) {
+        LspAnalysis* analysis = lsp_document_reuse_analysis(doc);
+        if (analysis) {
+            const LspDiagnosticList* diagnostics = lsp_analysis_get_diagnostics(analysis);
+            if (diagnostics) {
+                lsp_publish_diagnostics(server, job->uri, diagnostics);
+            }
+        } else {
+            const char* text = lsp_document_get_content(doc);
+            content = text ? strdup(text) : NULL;
+        }
+    } else {
+        LSP_LOG_DEBUG("Dropping stale diagnostics for %s (version %d)", job->uri, job->version);
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    if (!content) return;
+
+    LspAnalysis* snapshot = lsp_analysis_create_snapshot(content, job->version);
+    free(content);
+    if (!snapshot) return;
+    lsp_analysis_get_diagnostics(snapshot);
+
+    LspAnalysis* unused = snapshot;
+    pthread_mutex_lock(&server->lock);
+    doc = lsp_document_store_get(server->documents, job->uri);
+    if (doc && doc->version == job->version) {
+        unused = lsp_document_adopt_analysis(doc, snapshot);
+        const LspDiagnosticList* diagnostics = lsp_analyze_document(doc);
+        if (diagnostics) {
+            lsp_publish_diagnostics(server, job->uri, diagnostics);
+        }
+    } else {
+        LSP_LOG_DEBUG("Discarding diagnostics for %s superseded during analysis (version %d)", job->uri, job->version);
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    lsp_analysis_destroy(unused);
+}
+
+static LspDiagnosticsJob* take_due_diagnostics(LspScheduler* scheduler, struct timespec* next_due, int* has_next) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    *has_next = 0;
+    LspDiagnosticsJob** earliest = NULL;
+    for (LspDiagnosticsJob** link = &scheduler->diagnostics; *link; link = &(*link)->next) {
+        if (!earliest || deadline_before(&(*link)->due, &(*earliest)->due)) {
+            earliest = link;
+        }
+    }
+    if (!earliest) return NULL;
+
+    if (deadline_before(&now, &(*earliest)->due)) {
+        *next_due = (*earliest)->due;
+        *has_next = 1;
+        return NULL;
+    }
+
+    LspDiagnosticsJob* job = *earliest;
+    *earliest = job->next;
+    job->next = NULL;
+    return job;
+}
+
+static void* worker_main(void* arg) {
+    LspScheduler* scheduler = (LspScheduler*)arg;
+
+    pthread_mutex_lock(&scheduler->mutex);
+    for (;;) {
+        LspRequestJob* request = scheduler->requests_head;
+        if (request) {
+            scheduler->requests_head = request->next;
+            if (!scheduler->requests_head) scheduler->requests_tail = NULL;
+            request->next = scheduler->running;
+            scheduler->running = request;
+            pthread_mutex_unlock(&scheduler->mutex);
+
+            run_request(scheduler, request);
+
+            pthread_mutex_lock(&scheduler->mutex);
+            for (LspRequestJob** link = &scheduler->running; *link; link = &(*link)->next) {
+                if (*link == request) {
+                    *link = request->next;
+                    break;
+                }
+            }
+            free_request_job(request);
+            pthread_cond_broadcast(&scheduler->cond);
+            continue;
+        }
+
+        if (scheduler->stopping) break;
+
+        struct timespec next_due;
+        int has_next = 0;
+        LspDiagnosticsJob* diagnostics = NULL;
+        if (!scheduler->diagnostics_running) {
+            diagnostics = take_due_diagnostics(scheduler, &next_due, &has_next);
+        }
+        if (diagnostics) {
+            scheduler->diagnostics_running = 1;
+            pthread_mutex_unlock(&scheduler->mutex);
+
+            run_diagnostics(scheduler, diagnostics);
+            free(diagnostics);
+
+            pthread_mutex_lock(&scheduler->mutex);
+            scheduler->diagnostics_running = 0;
+            pthread_cond_broadcast(&scheduler->cond);
+            continue;
+        }
+
+        if (has_next) {
+            int rc = pthread_cond_timedwait(&scheduler->cond, &scheduler->mutex, &next_due);
+            if (rc != 0 && rc != ETIMEDOUT) break;
+        } else {
+            pthread_cond_wait(&scheduler->cond, &scheduler->mutex);
+        }
+    }
+    pthread_mutex_unlock(&scheduler->mutex);
+
+    return NULL;
+}
+
+LspScheduler* lsp_scheduler_create(LspServer* server, int worker_count, int debounce_ms) {
+    if (!server || worker_count <= 0) return NULL;
+
+    LspScheduler* scheduler = (LspScheduler*)calloc(1, sizeof(LspScheduler));
+    if (!scheduler) return NULL;
+
+    scheduler->server = server;
+    scheduler->debounce_ms = debounce_ms > 0 ? debounce_ms : 0;
+    scheduler->workers = (pthread_t*)calloc(worker_count, sizeof(pthread_t));
+    if (!scheduler->workers) {
+        free(scheduler);
+        return NULL;
+    }
+
+    pthread_mutex_init(&scheduler->mutex, NULL);
+    pthread_cond_init(&scheduler->cond, NULL);
+
+    for (int i = 0; i < worker_count; i++) {
+        if (pthread_create(&scheduler->workers[i], NULL, worker_main, scheduler) != 0) {
+            break;
+        }
+        scheduler->worker_count++;
+    }
+
+    if (scheduler->worker_count == 0) {
+        pthread_cond_destroy(&scheduler->cond);
+        pthread_mutex_destroy(&scheduler->mutex);
+        free(scheduler->workers);
+        free(scheduler);
+        return NULL;
+    }
+
+    LSP_LOG_DEBUG("Scheduler started with %d workers", scheduler->worker_count);
+    return scheduler;
+}
+
+void lsp_scheduler_destroy(LspScheduler* scheduler) {
+    if (!scheduler) return;
+
+    pthread_mutex_lock(&scheduler->mutex);
+    scheduler->stopping = 1;
+    pthread_cond_broadcast(&scheduler->cond);
+    pthread_mutex_unlock(&scheduler->mutex);
+
+    for (int i = 0; i < scheduler->worker_count; i++) {
+        pthread_join(scheduler->workers[i], NULL);
+    }
+
+    while (scheduler->requests_head) {
+        LspRequestJob* job = scheduler->requests_head;
+        scheduler->requests_head = job->next;
+        free_request_job(job);
+    }
+    while (scheduler->diagnostics) {
+        LspDiagnosticsJob* job = scheduler->diagnostics;
+        scheduler->diagnostics = job->next;
+        free(job);
+    }
+
+    pthread_cond_destroy(&scheduler->cond);
+    pthread_mutex_destroy(&scheduler->mutex);
+    free(scheduler->workers);
+    free(scheduler);
+}
+
+void lsp_scheduler_submit_request(LspScheduler* scheduler, LspMessage* msg) {
+    if (!scheduler || !msg) return;
+
+    LspRequestJob* job = (LspRequestJob*)calloc(1, sizeof(LspRequestJob));
+    if (!job) {
+        lsp_message_destroy(msg);
+        return;
+    }
+    job->msg = msg;
+
+    pthread_mutex_lock(&scheduler->mutex);
+    if (scheduler->requests_tail) {
+        scheduler->requests_tail->next = job;
+    } else {
+        scheduler->requests_head = job;
+    }
+    scheduler->requests_tail = job;
+    pthread_cond_broadcast(&scheduler->cond);
+    pthread_mutex_unlock(&scheduler->mutex);
+}
+
+void lsp_scheduler_wait_requests(LspScheduler* scheduler) {
+    if (!scheduler) return;
+
+    pthread_mutex_lock(&scheduler->mutex);
+    while (scheduler->requests_head || scheduler->running) {
+        pthread_cond_wait(&scheduler->cond, &scheduler->mutex);
+    }
+    pthread_mutex_unlock(&scheduler->mutex);
+}
+
+int lsp_scheduler_cancel_request(LspScheduler* scheduler, const LspMessage* target) {
+    if (!scheduler || !target) return 0;
+
+    LspRequestJob* removed = NULL;
+    int found = 0;
+
+    pthread_mutex_lock(&scheduler->mutex);
+    LspRequestJob* prev = NULL;
+    for (LspRequestJob* job = scheduler->requests_head; job; prev = job, job = job->next) {
+        if (!lsp_message_same_id(job->msg, target)) continue;
+        if (prev) {
+            prev->next = job->next;
+        } else {
+            scheduler->requests_head = job->next;
+        }
+        if (scheduler->requests_tail == job) scheduler->requests_tail = prev;
+        job->next = NULL;
+        removed = job;
+        found = 1;
+        break;
+    }
+    if (!found) {
+        for (LspRequestJob* job = scheduler->running; job; job = job->next) {
+            if (lsp_message_same_id(job->msg, target)) {
+                job->cancelled = 1;
+                found = 1;
+                break;
+            }
+        }
+    }
+    if (removed) pthread_cond_broadcast(&scheduler->cond);
+    pthread_mutex_unlock(&scheduler->mutex);
+
+    if (removed) {
+        LSP_LOG_DEBUG("Request %s cancelled before dispatch", removed->msg->method);
+        lsp_server_send_response(scheduler->server, removed->msg, lsp_server_create_cancelled_error(removed->msg));
+        free_request_job(removed);
+    }
+
+    return found;
+}
+
+void lsp_scheduler_schedule_diagnostics(LspScheduler* scheduler, const char* uri, int version) {
+    if (!scheduler || !uri) return;
+
+    pthread_mutex_lock(&scheduler->mutex);
+    LspDiagnosticsJob* job = scheduler->diagnostics;
+    while (job && job->uri != uri) job = job->next;
+
+    if (!job) {
+        job = (LspDiagnosticsJob*)calloc(1, sizeof(LspDiagnosticsJob));
+        if (!job) {
+            pthread_mutex_unlock(&scheduler->mutex);
+            return;
+        }
+        job->uri = uri;
+        job->next = scheduler->diagnostics;
+        scheduler->diagnostics = job;
+    } else if (job->version != version) {
+        LSP_LOG_DEBUG("Superseding diagnostics for %s (version %d -> %d)", uri, job->version, version);
+    }
+
+    job->version = version;
+    deadline_after(&job->due, scheduler->debounce_ms);
+    pthread_cond_broadcast(&scheduler->cond);
+    pthread_mutex_unlock(&scheduler->mutex);
+}
+
+void lsp_scheduler_discard_diagnostics(LspScheduler* scheduler, const char* uri) {
+    if (!scheduler || !uri) return;
+
+    pthread_mutex_lock(&scheduler->mutex);
+    for (LspDiagnosticsJob** link = &scheduler->diagnostics; *link; link = &(*link)->next) {
+        LspDiagnosticsJob* job = *link;
+        if (job->uri == uri) {
+            *link = job->next;
+            free(job);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&scheduler->mutex);
+}
@@ -0,0 +1,23 @@
+#ifndef LSP_SCHEDULER_H
+#define LSP_SCHEDULER_H
+
+#include "protocol/json_rpc.h"
+
+#define LSP_SCHEDULER_WORKERS 2
+#define LSP_DIAGNOSTICS_DEBOUNCE_MS 200
+
+struct LspServer;
+
+typedef struct LspScheduler LspScheduler;
+
+LspScheduler* lsp_scheduler_create(struct LspServer* server, int worker_count, int debounce_ms);
+void lsp_scheduler_destroy(LspScheduler* scheduler);
+
+void lsp_scheduler_submit_request(LspScheduler* scheduler, LspMessage* msg);
+void lsp_scheduler_wait_requests(LspScheduler* scheduler);
+int lsp_scheduler_cancel_request(LspScheduler* scheduler, const LspMessage* target);
+
+void lsp_scheduler_schedule_diagnostics(LspScheduler* scheduler, const char* uri, int version);
+void lsp_scheduler_discard_diagnostics(LspScheduler* scheduler, const char* uri);
+
+#endif
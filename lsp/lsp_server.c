@@ -1,5 +1,10 @@
 #include "lsp_server.h"
 #include <ctype.h>
+#include "lsp_scheduler.h"
+#include "lsp_index.h"
+#include "lsp_log.h"
+#include "features/diagnostics.h"
+#include "features/semantic_tokens.h"
 
 static LspMethodRegistry* g_registry = NULL;
 
@@ -9,6 +14,7 @@ extern LspMessage* lsp_handle_exit(LspServer* server, const char* id, const char
 extern LspMessage* lsp_handle_text_document_did_open(LspServer* server, const char* id, const char* params);
 extern LspMessage* lsp_handle_text_document_did_change(LspServer* server, const char* id, const char* params);
 extern LspMessage* lsp_handle_text_document_did_close(LspServer* server, const char* id, const char* params);
+extern LspMessage* lsp_handle_text_document_did_save(LspServer* server, const char* id, const char* params);
 extern LspMessage* lsp_handle_text_document_completion(LspServer* server, const char* id, const char* params);
 extern LspMessage* lsp_handle_text_document_hover(LspServer* server, const char* id, const char* params);
 extern LspMessage* lsp_handle_text_document_definition(LspServer* server, const char* id, const char* params);
@@ -17,6 +23,10 @@ extern LspMessage* lsp_handle_text_document_signature_help(LspServer* server, co
 extern LspMessage* lsp_handle_text_document_formatting(LspServer* server, const char* id, const char* params);
 extern LspMessage* lsp_handle_text_document_range_formatting(LspServer* server, const char* id, const char* params);
 extern LspMessage* lsp_handle_text_document_on_type_formatting(LspServer* server, const char* id, const char* params);
+extern LspMessage* lsp_handle_text_document_semantic_tokens_full(LspServer* server, const char* id, const char* params);
+extern LspMessage* lsp_handle_text_document_semantic_tokens_delta(LspServer* server, const char* id, const char* params);
+extern LspMessage* lsp_handle_workspace_symbol(LspServer* server, const char* id, const char* params);
+extern LspMessage* lsp_handle_workspace_did_change_watched_files(LspServer* server, const char* id, const char* params);
 
 static void lsp_register_default_handlers(void) {
     if (g_registry) return;
@@ -27,6 +37,7 @@ static void lsp_register_default_handlers(void) {
     lsp_method_registry_register(g_registry, "textDocument/didOpen", lsp_handle_text_document_did_open);
     lsp_method_registry_register(g_registry, "textDocument/didChange", lsp_handle_text_document_did_change);
     lsp_method_registry_register(g_registry, "textDocument/didClose", lsp_handle_text_document_did_close);
+    lsp_method_registry_register(g_registry, "textDocument/didSave", lsp_handle_text_document_did_save);
     lsp_method_registry_register(g_registry, "textDocument/completion", lsp_handle_text_document_completion);
     lsp_method_registry_register(g_registry, "textDocument/hover", lsp_handle_text_document_hover);
     lsp_method_registry_register(g_registry, "textDocument/definition", lsp_handle_text_document_definition);
@@ -35,6 +46,10 @@ static void lsp_register_default_handlers(void) {
     lsp_method_registry_register(g_registry, "textDocument/formatting", lsp_handle_text_document_formatting);
     lsp_method_registry_register(g_registry, "textDocument/rangeFormatting", lsp_handle_text_document_range_formatting);
     lsp_method_registry_register(g_registry, "textDocument/onTypeFormatting", lsp_handle_text_document_on_type_formatting);
+    lsp_method_registry_register(g_registry, "textDocument/semanticTokens/full", lsp_handle_text_document_semantic_tokens_full);
+    lsp_method_registry_register(g_registry, "textDocument/semanticTokens/full/delta", lsp_handle_text_document_semantic_tokens_delta);
+    lsp_method_registry_register(g_registry, "workspace/symbol", lsp_handle_workspace_symbol);
+    lsp_method_registry_register(g_registry, "workspace/didChangeWatchedFiles", lsp_handle_workspace_did_change_watched_files);
 }
 
 LspServer* lsp_server_create(void) {
@@ -51,6 +66,10 @@ LspServer* lsp_server_create(void) {
     server->output = stdout;
     server->running = 0;
     server->exit_code = 0;
+    server->scheduler = NULL;
+    pthread_mutex_init(&server->lock, NULL);
+    pthread_mutex_init(&server->output_lock, NULL);
+    lsp_buffer_init(&server->output_buffer);
     
     server->capabilities_text_document_sync = LSP_TEXT_DOCUMENT_SYNC_INCREMENTAL;
     server->capabilities_completion_provider = 1;
@@ -63,10 +82,14 @@ LspServer* lsp_server_create(void) {
 
 void lsp_server_destroy(LspServer* server) {
     if (!server) return;
+    lsp_index_destroy(server->index);
     free(server->name);
     free(server->version);
     free(server->root_uri);
     lsp_document_store_destroy(server->documents);
+    pthread_mutex_destroy(&server->lock);
+    pthread_mutex_destroy(&server->output_lock);
+    lsp_buffer_free(&server->output_buffer);
     free(server);
 }
 
@@ -77,6 +100,7 @@ int lsp_server_initialize(LspServer* server, const char* root_uri, int process_i
     server->root_uri = root_uri ? strdup(root_uri) : NULL;
     server->process_id = process_id;
     server->state = LSP_SERVER_STATE_INITIALIZING;
+    server->index = lsp_index_create(server->root_uri, &server->lock);
     
     return 0;
 }
@@ -99,34 +123,201 @@ void lsp_server_set_io(LspServer* server, FILE* input, FILE* output) {
     server->output = output ? output : stdout;
 }
 
+typedef struct LspInboxItem {
+    LspMessage* msg;
+    struct LspInboxItem* next;
+} LspInboxItem;
+
+typedef struct {
+    LspServer* server;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    LspInboxItem* head;
+    LspInboxItem* tail;
+    int closed;
+} LspInbox;
+
+static int is_method(const LspMessage* msg, const char* method) {
+    return msg->method && strcmp(msg->method, method) == 0;
+}
+
+static int cancel_queued_request(LspInbox* inbox, const LspMessage* target) {
+    LspInboxItem* removed = NULL;
+    
+    pthread_mutex_lock(&inbox->mutex);
+    LspInboxItem* prev = NULL;
+    for (LspInboxItem* item = inbox->head; item; prev = item, item = item->next) {
+        if (!lsp_message_is_request(item->msg) || !lsp_message_same_id(item->msg, target)) continue;
+        if (prev) {
+            prev->next = item->next;
+        } else {
+            inbox->head = item->next;
+        }
+        if (inbox->tail == item) inbox->tail = prev;
+        removed = item;
+        break;
+    }
+    pthread_mutex_unlock(&inbox->mutex);
+    
+    if (!removed) return 0;
+    
+    lsp_server_send_response(inbox->server, removed->msg, lsp_server_create_cancelled_error(removed->msg));
+    lsp_message_destroy(removed->msg);
+    free(removed);
+    return 1;
+}
+
+static void handle_cancel_request(LspInbox* inbox, const LspMessage* msg) {
+    LspMessage* target = lsp_message_deserialize(msg->params);
+    if (!target) return;
+    
+    if (!cancel_queued_request(inbox, target) &&
+        !lsp_scheduler_cancel_request(inbox->server->scheduler, target)) {
+        LSP_LOG_DEBUG("$/cancelRequest for a request that already completed");
+    }
+    
+    lsp_message_destroy(target);
+}
+
+static void* reader_main(void* arg) {
+    LspInbox* inbox = (LspInbox*)arg;
+    LspServer* server = inbox->server;
+    
+    LspJsonDocument scratch;
+    lsp_json_document_init(&scratch);
+    
+    for (;;) {
+        size_t length = 0;
+        char* content = lsp_read_message_body(server->input, &length);
+        if (!content) break;
+        
+        LspMessage* msg = lsp_message_parse(content, length, &scratch);
+        if (!msg) {
+            LSP_LOG_WARN("Dropping malformed message (%zu bytes)", length);
+            continue;
+        }
+        
+        if (is_method(msg, "$/cancelRequest")) {
+            handle_cancel_request(inbox, msg);
+            lsp_message_destroy(msg);
+            continue;
+        }
+        
+        LspInboxItem* item = (LspInboxItem*)calloc(1, sizeof(LspInboxItem));
+        if (!item) {
+            lsp_message_destroy(msg);
+            continue;
+        }
+        item->msg = msg;
+        int is_exit = is_method(msg, "exit");
+        
+        pthread_mutex_lock(&inbox->mutex);
+        if (inbox->tail) {
+            inbox->tail->next = item;
+        } else {
+            inbox->head = item;
+        }
+        inbox->tail = item;
+        pthread_cond_signal(&inbox->cond);
+        pthread_mutex_unlock(&inbox->mutex);
+        
+        if (is_exit) break;
+    }
+    
+    lsp_json_document_free(&scratch);
+    
+    pthread_mutex_lock(&inbox->mutex);
+    inbox->closed = 1;
+    pthread_cond_signal(&inbox->cond);
+    pthread_mutex_unlock(&inbox->mutex);
+    
+    return NULL;
+}
+
+static LspMessage* inbox_pop(LspInbox* inbox) {
+    pthread_mutex_lock(&inbox->mutex);
+    while (!inbox->head && !inbox->closed) {
+        pthread_cond_wait(&inbox->cond, &inbox->mutex);
+    }
+    
+    LspMessage* msg = NULL;
+    LspInboxItem* item = inbox->head;
+    if (item) {
+        inbox->head = item->next;
+        if (!inbox->head) inbox->tail = NULL;
+        msg = item->msg;
+        free(item);
+    }
+    pthread_mutex_unlock(&inbox->mutex);
+    
+    return msg;
+}
+
+static int runs_on_dispatcher(const LspMessage* msg) {
+    return !lsp_message_is_request(msg) || is_method(msg, "initialize") || is_method(msg, "shutdown");
+}
+
 int lsp_server_run(LspServer* server) {
     if (!server) return -1;
     server->running = 1;
     
+    LspInbox inbox;
+    memset(&inbox, 0, sizeof(inbox));
+    inbox.server = server;
+    pthread_mutex_init(&inbox.mutex, NULL);
+    pthread_cond_init(&inbox.cond, NULL);
+    
+    server->scheduler = lsp_scheduler_create(server, LSP_SCHEDULER_WORKERS, LSP_DIAGNOSTICS_DEBOUNCE_MS);
+    if (!server->scheduler) {
+        LSP_LOG_WARN("Failed to start worker pool, requests will run on the dispatcher");
+    }
+    
+    pthread_t reader;
+    if (pthread_create(&reader, NULL, reader_main, &inbox) != 0) {
+        LSP_LOG_FATAL("Failed to start reader thread");
+        lsp_scheduler_destroy(server->scheduler);
+        server->scheduler = NULL;
+        pthread_cond_destroy(&inbox.cond);
+        pthread_mutex_destroy(&inbox.mutex);
+        server->running = 0;
+        return -1;
+    }
+    
     while (server->running) {
-        char* content = lsp_read_message(server->input);
-        if (!content) {
+        LspMessage* msg = inbox_pop(&inbox);
+        if (!msg) {
             server->running = 0;
             break;
         }
         
-        LspMessage* msg = lsp_message_deserialize(content);
-        free(content);
+        if (server->scheduler && !runs_on_dispatcher(msg)) {
+            lsp_scheduler_submit_request(server->scheduler, msg);
+            continue;
+        }
         
-        if (!msg) continue;
+        lsp_scheduler_wait_requests(server->scheduler);
         
+        pthread_mutex_lock(&server->lock);
         LspMessage* response = lsp_server_handle_message(server, msg);
-        lsp_message_destroy(msg);
+        pthread_mutex_unlock(&server->lock);
         
-        if (response) {
-            char* response_str = lsp_message_serialize(response);
-            lsp_message_destroy(response);
-            if (response_str) {
-                lsp_write_message(server->output, response_str);
-                free(response_str);
-            }
-        }
+        lsp_server_send_response(server, msg, response);
+        lsp_message_destroy(msg);
+    }
+    
+    pthread_join(reader, NULL);
+    
+    lsp_scheduler_destroy(server->scheduler);
+    server->scheduler = NULL;
+    
+    while (inbox.head) {
+        LspInboxItem* item = inbox.head;
+        inbox.head = item->next;
+        lsp_message_destroy(item->msg);
+        free(item);
     }
+    pthread_cond_destroy(&inbox.cond);
+    pthread_mutex_destroy(&inbox.mutex);
     
     return server->exit_code;
 }
@@ -163,6 +354,37 @@ LspMessage* lsp_server_handle_message(LspServer* server, const LspMessage* msg)
     return NULL;
 }
 
+static void write_message(LspServer* server, const LspMessage* msg) {
+    pthread_mutex_lock(&server->output_lock);
+    lsp_buffer_reset(&server->output_buffer);
+    if (lsp_message_serialize_to(msg, &server->output_buffer) == 0) {
+        lsp_write_buffer(server->output, &server->output_buffer);
+    } else {
+        LSP_LOG_ERROR("Failed to serialize outgoing message");
+    }
+    pthread_mutex_unlock(&server->output_lock);
+}
+
+LspMessage* lsp_server_create_cancelled_error(const LspMessage* request) {
+    if (!request) return NULL;
+    if (request->id_is_number) {
+        return lsp_message_create_error_num(request->id_number, LSP_REQUEST_CANCELLED, "Request cancelled");
+    }
+    return lsp_message_create_error(request->id, LSP_REQUEST_CANCELLED, "Request cancelled");
+}
+
+void lsp_server_send_response(LspServer* server, const LspMessage* request, LspMessage* response) {
+    if (!server || !response) return;
+    
+    if (request && request->id_is_number && !response->id && !response->id_is_number) {
+        response->id_is_number = 1;
+        response->id_number = request->id_number;
+    }
+    
+    write_message(server, response);
+    lsp_message_destroy(response);
+}
+
 LspMethodRegistry* lsp_method_registry_create(void) {
     LspMethodRegistry* registry = (LspMethodRegistry*)calloc(1, sizeof(LspMethodRegistry));
     if (!registry) return NULL;
@@ -219,7 +441,7 @@ char* lsp_server_get_capabilities_json(LspServer* server) {
     offset += snprintf(buffer + offset, sizeof(buffer) - offset, "{");
     
     offset += snprintf(buffer + offset, sizeof(buffer) - offset,
-        "\"textDocumentSync\":{\"openClose\":true,\"change\":%d,\"willSave\":false,\"willSaveWaitUntil\":false}",
+        "\"textDocumentSync\":{\"openClose\":true,\"change\":%d,\"willSave\":false,\"willSaveWaitUntil\":false,\"save\":{\"includeText\":false}}",
         server->capabilities_text_document_sync);
     
     if (server->capabilities_completion_provider) {
@@ -245,6 +467,11 @@ char* lsp_server_get_capabilities_json(LspServer* server) {
     offset += snprintf(buffer + offset, sizeof(buffer) - offset,
         ",\"documentSymbolProvider\":true");
     
+    if (server->index) {
+        offset += snprintf(buffer + offset, sizeof(buffer) - offset,
+            ",\"workspaceSymbolProvider\":true");
+    }
+    
     offset += snprintf(buffer + offset, sizeof(buffer) - offset,
         ",\"signatureHelpProvider\":{\"triggerCharacters\":[\"(\",\",\"]}");
     
@@ -257,6 +484,10 @@ char* lsp_server_get_capabilities_json(LspServer* server) {
     offset += snprintf(buffer + offset, sizeof(buffer) - offset,
         ",\"documentOnTypeFormattingProvider\":{\"firstTriggerCharacter\":\";\",\"moreTriggerCharacter\":[\"}\"]}");
     
+    offset += snprintf(buffer + offset, sizeof(buffer) - offset,
+        ",\"semanticTokensProvider\":{\"legend\":{\"tokenTypes\":%s,\"tokenModifiers\":%s},\"range\":false,\"full\":{\"delta\":true}}",
+        LSP_SEMANTIC_TOKEN_TYPES, LSP_SEMANTIC_TOKEN_MODIFIERS);
+    
     offset += snprintf(buffer + offset, sizeof(buffer) - offset, "}");
     
     return strdup(buffer);
@@ -268,13 +499,8 @@ void lsp_send_notification(LspServer* server, const char* method, const char* pa
     LspMessage* msg = lsp_message_create_notification(method, params);
     if (!msg) return;
     
-    char* content = lsp_message_serialize(msg);
+    write_message(server, msg);
     lsp_message_destroy(msg);
-    
-    if (content) {
-        lsp_write_message(server->output, content);
-        free(content);
-    }
 }
 
 void lsp_publish_diagnostics(LspServer* server, const char* uri, const LspDiagnosticList* diagnostics) {
@@ -290,3 +516,23 @@ void lsp_publish_diagnostics(LspServer* server, const char* uri, const LspDiagno
     
     lsp_send_notification(server, "textDocument/publishDiagnostics", params);
 }
+
+void lsp_server_schedule_diagnostics(LspServer* server, const char* uri) {
+    if (!server || !uri) return;
+    
+    if (server->scheduler) {
+        int version = lsp_document_store_get_version(server->documents, uri);
+        lsp_scheduler_schedule_diagnostics(server->scheduler, lsp_document_store_intern(server->documents, uri), version);
+        return;
+    }
+    
+    const LspDiagnosticList* diagnostics = lsp_analyze_document(lsp_document_store_get(server->documents, uri));
+    if (diagnostics) {
+        lsp_publish_diagnostics(server, uri, diagnostics);
+    }
+}
+
+void lsp_server_discard_diagnostics(LspServer* server, const char* uri) {
+    if (!server || !uri || !server->scheduler) return;
+    lsp_scheduler_discard_diagnostics(server->scheduler, lsp_document_store_intern(server->documents, uri));
+}
@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include "protocol/json_rpc.h"
 #include "protocol/lsp_messages.h"
 #include "lsp_document.h"
@@ -15,7 +16,7 @@ typedef enum {
     LSP_SERVER_STATE_SHUTDOWN
 } LspServerState;
 
-typedef struct {
+typedef struct LspServer {
     char* name;
     char* version;
     char* root_uri;
@@ -35,6 +36,12 @@ typedef struct {
     FILE* output;
     int running;
     int exit_code;
+    
+    struct LspScheduler* scheduler;
+    struct LspIndex* index;
+    pthread_mutex_t lock;
+    pthread_mutex_t output_lock;
+    LspBuffer output_buffer;
 } LspServer;
 
 typedef LspMessage* (*LspMethodHandler)(LspServer* server, const char* id, const char* params);
@@ -62,6 +69,11 @@ int lsp_server_run(LspServer* server);
 void lsp_server_stop(LspServer* server);
 
 LspMessage* lsp_server_handle_message(LspServer* server, const LspMessage* msg);
+void lsp_server_send_response(LspServer* server, const LspMessage* request, LspMessage* response);
+LspMessage* lsp_server_create_cancelled_error(const LspMessage* request);
+
+void lsp_server_schedule_diagnostics(LspServer* server, const char* uri);
+void lsp_server_discard_diagnostics(LspServer* server, const char* uri);
 
 LspMethodRegistry* lsp_method_registry_create(void);
 void lsp_method_registry_destroy(LspMethodRegistry* registry);
@@ -0,0 +1,411 @@
+#include "lsp_text_buffer.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    TEXT_CHUNK_ORIGINAL = 0,
+    TEXT_CHUNK_ADDED = 1
+};
+
+typedef struct {
+    char* data;
+    int length;
+    int capacity;
+    int* line_feeds;
+    int line_feed_count;
+    int line_feed_capacity;
+} TextChunk;
+
+typedef struct TextPiece {
+    int chunk;
+    int start;
+    int length;
+    int line_feeds;
+    unsigned int priority;
+    int total_length;
+    int total_line_feeds;
+    struct TextPiece* left;
+    struct TextPiece* right;
+} TextPiece;
+
+struct LspTextBuffer {
+    TextChunk chunks[2];
+    TextPiece* root;
+    unsigned int seed;
+};
+
+static int chunk_append(TextChunk* chunk, const char* text, int length) {
+    if (chunk->length + length + 1 > chunk->capacity) {
+        int capacity = chunk->capacity ? chunk->capacity : 256;
+        while (chunk->length + length + 1 > capacity) capacity *= 2;
+        char* data = (char*)realloc(chunk->data, capacity);
+        if (!data) return -1;
+        chunk->data = data;
+        chunk->capacity = capacity;
+    }
+
+    for (int i = 0; i < length; i++) {
+        if (text[i] != '\n') continue;
+        if (chunk->line_feed_count >= chunk->line_feed_capacity) {
+            int capacity = chunk->line_feed_capacity ? chunk->line_feed_capacity * 2 : 64;
+            int* line_feeds = (int*)realloc(chunk->line_feeds, capacity * sizeof(int));
+            if (!line_feeds) return -1;
+            chunk->line_feeds = line_feeds;
+            chunk->line_feed_capacity = capacity;
+        }
+        chunk->line_feeds[chunk->line_feed_count++] = chunk->length + i;
+    }
+
+    memcpy(chunk->data + chunk->length, text, length);
+    chunk->length += length;
+    chunk->data[chunk->length] = '\0';
+    return 0;
+}
+
+static int chunk_lower_bound(const TextChunk* chunk, int position) {
+    int low = 0;
+    int high = chunk->line_feed_count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (chunk->line_feeds[mid] < position) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static int chunk_count_line_feeds(const TextChunk* chunk, int start, int length) {
+    return chunk_lower_bound(chunk, start + length) - chunk_lower_bound(chunk, start);
+}
+
+static unsigned int next_priority(LspTextBuffer* buffer) {
+    buffer->seed ^= buffer->seed << 13;
+    buffer->seed ^= buffer->seed >> 17;
+    buffer->seed ^= buffer->seed << 5;
+    return buffer->seed;
+}
+
+static void piece_update(TextPiece* piece) {
+    piece->total_length = piece->length;
+    piece->total_line_feeds = piece->line_feeds;
+    if (piece->left) {
+        piece->total_length += piece->left->total_length;
+        piece->total_line_feeds += piece->left->total_line_feeds;
+    }
+    if (piece->right) {
+        piece->total_length += piece->right->total_length;
+        piece->total_line_feeds += piece->right->total_line_feeds;
+    }
+}
+
+static TextPiece* piece_create(LspTextBuffer* buffer, int chunk, int start, int length) {
+    TextPiece* piece = (TextPiece*)calloc(1, sizeof(TextPiece));
+    if (!piece) return NULL;
+    piece->chunk = chunk;
+    piece->start = start;
+    piece->length = length;
+    piece->line_feeds = chunk_count_line_feeds(&buffer->chunks[chunk], start, length);
+    piece->priority = next_priority(buffer);
+    piece_update(piece);
+    return piece;
+}
+
+static void piece_destroy(TextPiece* piece) {
+    if (!piece) return;
+    piece_destroy(piece->left);
+    piece_destroy(piece->right);
+    free(piece);
+}
+
+static int total_length(const TextPiece* piece) {
+    return piece ? piece->total_length : 0;
+}
+
+static int total_line_feeds(const TextPiece* piece) {
+    return piece ? piece->total_line_feeds : 0;
+}
+
+static TextPiece* piece_merge(TextPiece* left, TextPiece* right) {
+    if (!left) return right;
+    if (!right) return left;
+
+    if (left->priority >= right->priority) {
+        left->right = piece_merge(left->right, right);
+        piece_update(left);
+        return left;
+    }
+    right->left = piece_merge(left, right->left);
+    piece_update(right);
+    return right;
+}
+
+static int piece_split(LspTextBuffer* buffer, TextPiece* piece, int offset, TextPiece** left, TextPiece** right) {
+    if (!piece) {
+        *left = NULL;
+        *right = NULL;
+        return 0;
+    }
+
+    int left_length = total_length(piece->left);
+    if (offset <= left_length) {
+        TextPiece* inner_right = NULL;
+        if (piece_split(buffer, piece->left, offset, left, &inner_right) != 0) return -1;
+        piece->left = inner_right;
+        piece_update(piece);
+        *right = piece;
+        return 0;
+    }
+
+    if (offset >= left_length + piece->length) {
+        TextPiece* inner_left = NULL;
+        if (piece_split(buffer, piece->right, offset - left_length - piece->length, &inner_left, right) != 0) {
+            return -1;
+        }
+        piece->right = inner_left;
+        piece_update(piece);
+        *left = piece;
+        return 0;
+    }
+
+    int cut = offset - left_length;
+    TextPiece* tail = piece_create(buffer, piece->chunk, piece->start + cut, piece->length - cut);
+    if (!tail) return -1;
+
+    TextPiece* rest = piece->right;
+    piece->right = NULL;
+    piece->length = cut;
+    piece->line_feeds -= tail->line_feeds;
+    piece_update(piece);
+
+    *left = piece;
+    *right = piece_merge(tail, rest);
+    return 0;
+}
+
+static int extend_last_piece(TextPiece* piece, int chunk, int start, int length, int line_feeds) {
+    if (!piece) return 0;
+
+    int extended = piece->right
+        ? extend_last_piece(piece->right, chunk, start, length, line_feeds)
+        : (piece->chunk == chunk && piece->start + piece->length == start);
+    if (!extended) return 0;
+
+    if (!piece->right) {
+        piece->length += length;
+        piece->line_feeds += line_feeds;
+    }
+    piece_update(piece);
+    return 1;
+}
+
+LspTextBuffer* lsp_text_buffer_create(const char* text) {
+    LspTextBuffer* buffer = (LspTextBuffer*)calloc(1, sizeof(LspTextBuffer));
+    if (!buffer) return NULL;
+    buffer->seed = 2463534242u;
+
+    int length = text ? (int)strlen(text) : 0;
+    if (chunk_append(&buffer->chunks[TEXT_CHUNK_ORIGINAL], text ? text : "", length) != 0) {
+        lsp_text_buffer_destroy(buffer);
+        return NULL;
+    }
+
+    if (length > 0) {
+        buffer->root = piece_create(buffer, TEXT_CHUNK_ORIGINAL, 0, length);
+        if (!buffer->root) {
+            lsp_text_buffer_destroy(buffer);
+            return NULL;
+        }
+    }
+    return buffer;
+}
+
+void lsp_text_buffer_destroy(LspTextBuffer* buffer) {
+    if (!buffer) return;
+    piece_destroy(buffer->root);
+    for (int i = 0; i < 2; i++) {
+        free(buffer->chunks[i].data);
+        free(buffer->chunks[i].line_feeds);
+    }
+    free(buffer);
+}
+
+int lsp_text_buffer_replace(LspTextBuffer* buffer, int start, int end, const char* text) {
+    if (!buffer) return -1;
+
+    int length = total_length(buffer->root);
+    if (start < 0) start = 0;
+    if (start > length) start = length;
+    if (end < start) end = start;
+    if (end > length) end = length;
+
+    TextPiece* before = NULL;
+    TextPiece* rest = NULL;
+    TextPiece* removed = NULL;
+    TextPiece* after = NULL;
+    if (piece_split(buffer, buffer->root, start, &before, &rest) != 0) return -1;
+    if (piece_split(buffer, rest, end - start, &removed, &after) != 0) {
+        buffer->root = piece_merge(before, rest);
+        return -1;
+    }
+
+    int text_length = text ? (int)strlen(text) : 0;
+    if (text_length > 0) {
+        TextChunk* added = &buffer->chunks[TEXT_CHUNK_ADDED];
+        int added_start = added->length;
+        int added_line_feeds = added->line_feed_count;
+        if (chunk_append(added, text, text_length) != 0) {
+            buffer->root = piece_merge(before, piece_merge(removed, after));
+            return -1;
+        }
+        added_line_feeds = added->line_feed_count - added_line_feeds;
+
+        if (!extend_last_piece(before, TEXT_CHUNK_ADDED, added_start, text_length, added_line_feeds)) {
+            TextPiece* piece = piece_create(buffer, TEXT_CHUNK_ADDED, added_start, text_length);
+            if (!piece) {
+                buffer->root = piece_merge(before, piece_merge(removed, after));
+                return -1;
+            }
+            before = piece_merge(before, piece);
+        }
+    }
+
+    piece_destroy(removed);
+    buffer->root = piece_merge(before, after);
+    return 0;
+}
+
+int lsp_text_buffer_length(const LspTextBuffer* buffer) {
+    return buffer ? total_length(buffer->root) : 0;
+}
+
+int lsp_text_buffer_line_count(const LspTextBuffer* buffer) {
+    return buffer ? total_line_feeds(buffer->root) + 1 : 0;
+}
+
+static int line_feeds_before(const LspTextBuffer* buffer, int offset) {
+    const TextPiece* piece = buffer->root;
+    int line_feeds = 0;
+
+    while (piece) {
+        int left_length = total_length(piece->left);
+        if (offset <= left_length) {
+            piece = piece->left;
+            continue;
+        }
+
+        line_feeds += total_line_feeds(piece->left);
+        offset -= left_length;
+        if (offset <= piece->length) {
+            return line_feeds + chunk_count_line_feeds(&buffer->chunks[piece->chunk], piece->start, offset);
+        }
+
+        line_feeds += piece->line_feeds;
+        offset -= piece->length;
+        piece = piece->right;
+    }
+    return line_feeds;
+}
+
+static int line_feed_offset(const LspTextBuffer* buffer, int index) {
+    const TextPiece* piece = buffer->root;
+    int base = 0;
+
+    while (piece) {
+        int left_line_feeds = total_line_feeds(piece->left);
+        if (index < left_line_feeds) {
+            piece = piece->left;
+            continue;
+        }
+
+        index -= left_line_feeds;
+        base += total_length(piece->left);
+        if (index < piece->line_feeds) {
+            const TextChunk* chunk = &buffer->chunks[piece->chunk];
+            int position = chunk->line_feeds[chunk_lower_bound(chunk, piece->start) + index];
+            return base + position - piece->start;
+        }
+
+        index -= piece->line_feeds;
+        base += piece->length;
+        piece = piece->right;
+    }
+    return base;
+}
+
+void lsp_text_buffer_get_line_col(const LspTextBuffer* buffer, int offset, int* line, int* col) {
+    if (!buffer || !line || !col) return;
+
+    int length = total_length(buffer->root);
+    if (offset < 0) offset = 0;
+    if (offset > length) offset = length;
+
+    *line = line_feeds_before(buffer, offset);
+    *col = *line > 0 ? offset - line_feed_offset(buffer, *line - 1) - 1 : offset;
+}
+
+int lsp_text_buffer_offset_from_line_col(const LspTextBuffer* buffer, int line, int col) {
+    if (!buffer) return 0;
+
+    int length = total_length(buffer->root);
+    int line_count = total_line_feeds(buffer->root);
+    if (line < 0 || line > line_count) return length;
+
+    int line_start = line > 0 ? line_feed_offset(buffer, line - 1) + 1 : 0;
+    int line_end = line < line_count ? line_feed_offset(buffer, line) : length;
+    if (col < 0 || col > line_end - line_start) return line_end;
+    return line_start + col;
+}
+
+static char* copy_pieces(const LspTextBuffer* buffer, const TextPiece* piece, char* out) {
+    if (!piece) return out;
+    out = copy_pieces(buffer, piece->left, out);
+    memcpy(out, buffer->chunks[piece->chunk].data + piece->start, piece->length);
+    out += piece->length;
+    return copy_pieces(buffer, piece->right, out);
+}
+
+char* lsp_text_buffer_to_string(const LspTextBuffer* buffer) {
+    if (!buffer) return NULL;
+
+    char* text = (char*)malloc(total_length(buffer->root) + 1);
+    if (!text) return NULL;
+
+    char* end = copy_pieces(buffer, buffer->root, text);
+    *end = '\0';
+    return text;
+}
+
+static char* copy_range(const LspTextBuffer* buffer, const TextPiece* piece, int base, int start, int end, char* out) {
+    if (!piece || start >= base + piece->total_length || end <= base) return out;
+
+    int left_length = total_length(piece->left);
+    out = copy_range(buffer, piece->left, base, start, end, out);
+
+    int piece_start = base + left_length;
+    int from = start > piece_start ? start : piece_start;
+    int to = end < piece_start + piece->length ? end : piece_start + piece->length;
+    if (from < to) {
+        memcpy(out, buffer->chunks[piece->chunk].data + piece->start + (from - piece_start), to - from);
+        out += to - from;
+    }
+
+    return copy_range(buffer, piece->right, piece_start + piece->length, start, end, out);
+}
+
+char* lsp_text_buffer_substring(const LspTextBuffer* buffer, int start, int end) {
+    if (!buffer) return NULL;
+
+    int length = total_length(buffer->root);
+    if (start < 0) start = 0;
+    if (end > length) end = length;
+    if (end < start) end = start;
+
+    char* text = (char*)malloc(end - start + 1);
+    if (!text) return NULL;
+
+    char* out = copy_range(buffer, buffer->root, 0, start, end, text);
+    *out = '\0';
+    return text;
+}
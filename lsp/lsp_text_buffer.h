@@ -0,0 +1,20 @@
+#ifndef LSP_TEXT_BUFFER_H
+#define LSP_TEXT_BUFFER_H
+
+typedef struct LspTextBuffer LspTextBuffer;
+
+LspTextBuffer* lsp_text_buffer_create(const char* text);
+void lsp_text_buffer_destroy(LspTextBuffer* buffer);
+
+int lsp_text_buffer_replace(LspTextBuffer* buffer, int start, int end, const char* text);
+
+int lsp_text_buffer_length(const LspTextBuffer* buffer);
+int lsp_text_buffer_line_count(const LspTextBuffer* buffer);
+
+void lsp_text_buffer_get_line_col(const LspTextBuffer* buffer, int offset, int* line, int* col);
+int lsp_text_buffer_offset_from_line_col(const LspTextBuffer* buffer, int line, int col);
+
+char* lsp_text_buffer_to_string(const LspTextBuffer* buffer);
+char* lsp_text_buffer_substring(const LspTextBuffer* buffer, int start, int end);
+
+#endif
@@ -0,0 +1,453 @@
+#include "json_reader.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    LspJsonDocument* doc;
+    const char* text;
+    size_t length;
+    size_t pos;
+    int error;
+} JsonParser;
+
+static void skip_whitespace(JsonParser* p) {
+    while (p->pos < p->length) {
+        char c = p->text[p->pos];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+        p->pos++;
+    }
+}
+
+static int add_node(JsonParser* p, LspJsonType type, size_t start) {
+    LspJsonDocument* doc = p->doc;
+    if (doc->count >= doc->capacity) {
+        int capacity = doc->capacity ? doc->capacity * 2 : 64;
+        LspJsonNode* nodes = (LspJsonNode*)realloc(doc->nodes, capacity * sizeof(LspJsonNode));
+        if (!nodes) {
+            p->error = 1;
+            return -1;
+        }
+        doc->nodes = nodes;
+        doc->capacity = capacity;
+    }
+
+    int index = doc->count++;
+    LspJsonNode* node = &doc->nodes[index];
+    node->type = type;
+    node->start = (int)start;
+    node->end = (int)start;
+    node->child = -1;
+    node->next = -1;
+    node->count = 0;
+    node->escaped = 0;
+    return index;
+}
+
+static int is_hex(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static int scan_string(JsonParser* p, int* escaped) {
+    p->pos++;
+    while (p->pos < p->length) {
+        char c = p->text[p->pos];
+        if (c == '"') {
+            p->pos++;
+            return 1;
+        }
+        if (c == '\\') {
+            *escaped = 1;
+            if (p->pos + 1 >= p->length) break;
+            char e = p->text[p->pos + 1];
+            if (e == 'u') {
+                if (p->pos + 5 >= p->length) break;
+                for (int i = 2; i < 6; i++) {
+                    if (!is_hex(p->text[p->pos + i])) return 0;
+                }
+                p->pos += 6;
+                continue;
+            }
+            if (e == '\0' || !strchr("\"\\/bfnrt", e)) return 0;
+            p->pos += 2;
+            continue;
+        }
+        p->pos++;
+    }
+    return 0;
+}
+
+static int scan_number(JsonParser* p) {
+    size_t start = p->pos;
+    if (p->pos < p->length && p->text[p->pos] == '-') p->pos++;
+    size_t digits = p->pos;
+    while (p->pos < p->length && p->text[p->pos] >= '0' && p->text[p->pos] <= '9') p->pos++;
+    if (p->pos == digits) return 0;
+    if (p->pos < p->length && p->text[p->pos] == '.') {
+        p->pos++;
+        digits = p->pos;
+        while (p->pos < p->length && p->text[p->pos] >= '0' && p->text[p->pos] <= '9') p->pos++;
+        if (p->pos == digits) return 0;
+    }
+    if (p->pos < p->length && (p->text[p->pos] == 'e' || p->text[p->pos] == 'E')) {
+        p->pos++;
+        if (p->pos < p->length && (p->text[p->pos] == '+' || p->text[p->pos] == '-')) p->pos++;
+        digits = p->pos;
+        while (p->pos < p->length && p->text[p->pos] >= '0' && p->text[p->pos] <= '9') p->pos++;
+        if (p->pos == digits) return 0;
+    }
+    return p->pos > start;
+}
+
+static int scan_literal(JsonParser* p, const char* literal) {
+    size_t len = strlen(literal);
+    if (p->length - p->pos < len || memcmp(p->text + p->pos, literal, len) != 0) return 0;
+    p->pos += len;
+    return 1;
+}
+
+static int parse_value(JsonParser* p, int depth, int materialize);
+
+static int parse_container(JsonParser* p, int node, int depth, int materialize, int is_object) {
+    char close = is_object ? '}' : ']';
+    int children = materialize && depth + 1 < p->doc->max_depth;
+    int last = -1;
+    int count = 0;
+
+    p->pos++;
+    skip_whitespace(p);
+    if (p->pos < p->length && p->text[p->pos] == close) {
+        p->pos++;
+        return 0;
+    }
+
+    for (;;) {
+        if (is_object) {
+            skip_whitespace(p);
+            if (p->pos >= p->length || p->text[p->pos] != '"') return -1;
+            int key = parse_value(p, depth + 1, children);
+            if (p->error) return -1;
+            if (children) {
+                if (last >= 0) {
+                    p->doc->nodes[last].next = key;
+                } else {
+                    p->doc->nodes[node].child = key;
+                }
+                last = key;
+            }
+            skip_whitespace(p);
+            if (p->pos >= p->length || p->text[p->pos] != ':') return -1;
+            p->pos++;
+        }
+
+        skip_whitespace(p);
+        int value = parse_value(p, depth + 1, children);
+        if (p->error) return -1;
+        if (children) {
+            if (last >= 0) {
+                p->doc->nodes[last].next = value;
+            } else {
+                p->doc->nodes[node].child = value;
+            }
+            last = value;
+        }
+        count++;
+
+        skip_whitespace(p);
+        if (p->pos >= p->length) return -1;
+        char c = p->text[p->pos++];
+        if (c == close) break;
+        if (c != ',') return -1;
+    }
+
+    return count;
+}
+
+static int parse_value(JsonParser* p, int depth, int materialize) {
+    if (depth >= LSP_JSON_MAX_DEPTH) {
+        p->error = 1;
+        return -1;
+    }
+
+    skip_whitespace(p);
+    if (p->pos >= p->length) {
+        p->error = 1;
+        return -1;
+    }
+
+    size_t start = p->pos;
+    char c = p->text[p->pos];
+    LspJsonType type;
+    int escaped = 0;
+    int ok = 1;
+
+    switch (c) {
+        case '{':
+        case '[': {
+            type = c == '{' ? LSP_JSON_OBJECT : LSP_JSON_ARRAY;
+            int node = materialize ? add_node(p, type, start) : -1;
+            if (p->error) return -1;
+            int count = parse_container(p, node, depth, materialize, c == '{');
+            if (count < 0) {
+                p->error = 1;
+                return -1;
+            }
+            if (node >= 0) {
+                p->doc->nodes[node].end = (int)p->pos;
+                p->doc->nodes[node].count = count;
+            }
+            return node;
+        }
+        case '"':
+            type = LSP_JSON_STRING;
+            ok = scan_string(p, &escaped);
+            break;
+        case 't':
+            type = LSP_JSON_TRUE;
+            ok = scan_literal(p, "true");
+            break;
+        case 'f':
+            type = LSP_JSON_FALSE;
+            ok = scan_literal(p, "false");
+            break;
+        case 'n':
+            type = LSP_JSON_NULL;
+            ok = scan_literal(p, "null");
+            break;
+        default:
+            type = LSP_JSON_NUMBER;
+            ok = scan_number(p);
+            break;
+    }
+
+    if (!ok) {
+        p->error = 1;
+        return -1;
+    }
+    if (!materialize) return -1;
+
+    int node = add_node(p, type, start);
+    if (node < 0) return -1;
+    p->doc->nodes[node].end = (int)p->pos;
+    p->doc->nodes[node].escaped = escaped;
+    return node;
+}
+
+void lsp_json_document_init(LspJsonDocument* doc) {
+    if (!doc) return;
+    memset(doc, 0, sizeof(LspJsonDocument));
+}
+
+void lsp_json_document_free(LspJsonDocument* doc) {
+    if (!doc) return;
+    free(doc->nodes);
+    memset(doc, 0, sizeof(LspJsonDocument));
+}
+
+int lsp_json_parse(LspJsonDocument* doc, const char* text, size_t length, int max_depth) {
+    if (!doc || !text || length > 0x7fffffff) return -1;
+
+    doc->text = text;
+    doc->length = length;
+    doc->count = 0;
+    doc->max_depth = max_depth > 0 ? max_depth : LSP_JSON_MAX_DEPTH;
+
+    JsonParser parser;
+    parser.doc = doc;
+    parser.text = text;
+    parser.length = length;
+    parser.pos = 0;
+    parser.error = 0;
+
+    int root = parse_value(&parser, 0, 1);
+    if (!parser.error) {
+        skip_whitespace(&parser);
+        if (parser.pos != length) parser.error = 1;
+    }
+    if (parser.error || root != 0) {
+        doc->count = 0;
+        return -1;
+    }
+    return 0;
+}
+
+static const LspJsonNode* get_node(const LspJsonDocument* doc, int node) {
+    if (!doc || node < 0 || node >= doc->count) return NULL;
+    return &doc->nodes[node];
+}
+
+int lsp_json_first_child(const LspJsonDocument* doc, int node) {
+    const LspJsonNode* n = get_node(doc, node);
+    return n ? n->child : -1;
+}
+
+int lsp_json_next(const LspJsonDocument* doc, int node) {
+    const LspJsonNode* n = get_node(doc, node);
+    return n ? n->next : -1;
+}
+
+LspJsonType lsp_json_type(const LspJsonDocument* doc, int node) {
+    const LspJsonNode* n = get_node(doc, node);
+    return n ? n->type : LSP_JSON_NULL;
+}
+
+int lsp_json_count(const LspJsonDocument* doc, int node) {
+    const LspJsonNode* n = get_node(doc, node);
+    return n ? n->count : 0;
+}
+
+int lsp_json_key_equals(const LspJsonDocument* doc, int node, const char* key) {
+    const LspJsonNode* n = get_node(doc, node);
+    if (!n || !key || n->type != LSP_JSON_STRING) return 0;
+
+    if (!n->escaped) {
+        size_t len = (size_t)(n->end - n->start - 2);
+        return strlen(key) == len && memcmp(doc->text + n->start + 1, key, len) == 0;
+    }
+
+    char* value = lsp_json_string_dup(doc, node);
+    int equal = value && strcmp(value, key) == 0;
+    free(value);
+    return equal;
+}
+
+int lsp_json_member(const LspJsonDocument* doc, int object, const char* key) {
+    const LspJsonNode* n = get_node(doc, object);
+    if (!n || n->type != LSP_JSON_OBJECT) return -1;
+
+    for (int k = n->child; k >= 0; ) {
+        int value = doc->nodes[k].next;
+        if (lsp_json_key_equals(doc, k, key)) return value;
+        if (value < 0) break;
+        k = doc->nodes[value].next;
+    }
+    return -1;
+}
+
+int lsp_json_path(const LspJsonDocument* doc, int node, const char* path) {
+    if (!path) return -1;
+
+    while (node >= 0 && *path) {
+        const char* dot = strchr(path, '.');
+        size_t len = dot ? (size_t)(dot - path) : strlen(path);
+        char key[64];
+        if (len >= sizeof(key)) return -1;
+        memcpy(key, path, len);
+        key[len] = '\0';
+
+        node = lsp_json_member(doc, node, key);
+        path += len;
+        if (*path == '.') path++;
+    }
+    return node;
+}
+
+int lsp_json_int(const LspJsonDocument* doc, int node, int default_val) {
+    const LspJsonNode* n = get_node(doc, node);
+    if (!n || n->type != LSP_JSON_NUMBER) return default_val;
+
+    const char* p = doc->text + n->start;
+    const char* end = doc->text + n->end;
+    int negative = 0;
+    if (p < end && *p == '-') {
+        negative = 1;
+        p++;
+    }
+
+    long long value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (value < 0x7fffffff) value = value * 10 + (*p - '0');
+        p++;
+    }
+    if (value > 0x7fffffff) value = 0x7fffffff;
+    return (int)(negative ? -value : value);
+}
+
+static unsigned int read_hex4(const char* p) {
+    unsigned int code = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        code <<= 4;
+        if (c >= '0' && c <= '9') code |= (unsigned int)(c - '0');
+        else if (c >= 'a' && c <= 'f') code |= (unsigned int)(c - 'a' + 10);
+        else code |= (unsigned int)(c - 'A' + 10);
+    }
+    return code;
+}
+
+static size_t encode_utf8(unsigned int code, char* out) {
+    if (code < 0x80) {
+        out[0] = (char)code;
+        return 1;
+    }
+    if (code < 0x800) {
+        out[0] = (char)(0xC0 | (code >> 6));
+        out[1] = (char)(0x80 | (code & 0x3F));
+        return 2;
+    }
+    if (code < 0x10000) {
+        out[0] = (char)(0xE0 | (code >> 12));
+        out[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (code & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (code >> 18));
+    out[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (code & 0x3F));
+    return 4;
+}
+
+char* lsp_json_string_dup(const LspJsonDocument* doc, int node) {
+    const LspJsonNode* n = get_node(doc, node);
+    if (!n || n->type != LSP_JSON_STRING) return NULL;
+
+    const char* src = doc->text + n->start + 1;
+    size_t len = (size_t)(n->end - n->start - 2);
+    char* result = (char*)malloc(len + 1);
+    if (!result) return NULL;
+
+    if (!n->escaped) {
+        memcpy(result, src, len);
+        result[len] = '\0';
+        return result;
+    }
+
+    size_t j = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (src[i] != '\\') {
+            result[j++] = src[i];
+            continue;
+        }
+        char e = src[++i];
+        switch (e) {
+            case 'b': result[j++] = '\b'; break;
+            case 'f': result[j++] = '\f'; break;
+            case 'n': result[j++] = '\n'; break;
+            case 'r': result[j++] = '\r'; break;
+            case 't': result[j++] = '\t'; break;
+            case 'u': {
+                unsigned int code = read_hex4(src + i + 1);
+                i += 4;
+                if (code >= 0xD800 && code < 0xDC00 && i + 6 < len && src[i + 1] == '\\' && src[i + 2] == 'u') {
+                    unsigned int low = read_hex4(src + i + 3);
+                    if (low >= 0xDC00 && low < 0xE000) {
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                }
+                j += encode_utf8(code, result + j);
+                break;
+            }
+            default: result[j++] = e; break;
+        }
+    }
+    result[j] = '\0';
+    return result;
+}
+
+const char* lsp_json_raw(const LspJsonDocument* doc, int node, size_t* length) {
+    const LspJsonNode* n = get_node(doc, node);
+    if (!n) return NULL;
+    if (length) *length = (size_t)(n->end - n->start);
+    return doc->text + n->start;
+}
@@ -0,0 +1,54 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <stddef.h>
+
+#define LSP_JSON_MAX_DEPTH 128
+
+typedef enum {
+    LSP_JSON_NULL,
+    LSP_JSON_FALSE,
+    LSP_JSON_TRUE,
+    LSP_JSON_NUMBER,
+    LSP_JSON_STRING,
+    LSP_JSON_ARRAY,
+    LSP_JSON_OBJECT
+} LspJsonType;
+
+typedef struct {
+    LspJsonType type;
+    int start;
+    int end;
+    int child;
+    int next;
+    int count;
+    int escaped;
+} LspJsonNode;
+
+typedef struct {
+    const char* text;
+    size_t length;
+    LspJsonNode* nodes;
+    int count;
+    int capacity;
+    int max_depth;
+} LspJsonDocument;
+
+void lsp_json_document_init(LspJsonDocument* doc);
+void lsp_json_document_free(LspJsonDocument* doc);
+
+int lsp_json_parse(LspJsonDocument* doc, const char* text, size_t length, int max_depth);
+
+int lsp_json_first_child(const LspJsonDocument* doc, int node);
+int lsp_json_next(const LspJsonDocument* doc, int node);
+int lsp_json_member(const LspJsonDocument* doc, int object, const char* key);
+int lsp_json_path(const LspJsonDocument* doc, int node, const char* path);
+
+LspJsonType lsp_json_type(const LspJsonDocument* doc, int node);
+int lsp_json_count(const LspJsonDocument* doc, int node);
+int lsp_json_int(const LspJsonDocument* doc, int node, int default_val);
+int lsp_json_key_equals(const LspJsonDocument* doc, int node, const char* key);
+char* lsp_json_string_dup(const LspJsonDocument* doc, int node);
+const char* lsp_json_raw(const LspJsonDocument* doc, int node, size_t* length);
+
+#endif
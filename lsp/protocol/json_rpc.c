@@ -13,6 +13,7 @@ LspMessage* lsp_message_create(void) {
     msg->result = NULL;
     msg->error = NULL;
     msg->error_code = 0;
+    msg->body = NULL;
     return msg;
 }
 
@@ -21,9 +22,13 @@ void lsp_message_destroy(LspMessage* msg) {
     free(msg->jsonrpc);
     free(msg->method);
     free(msg->id);
-    free(msg->params);
-    free(msg->result);
-    free(msg->error);
+    if (msg->body) {
+        free(msg->body);
+    } else {
+        free(msg->params);
+        free(msg->result);
+        free(msg->error);
+    }
     free(msg);
 }
 
@@ -115,171 +120,201 @@ LspMessage* lsp_message_create_notification(const char* method, const char* para
     return msg;
 }
 
-char* lsp_message_serialize(const LspMessage* msg) {
-    if (!msg) return NULL;
-    
-    size_t buffer_size = 8192;
-    char* buffer = (char*)malloc(buffer_size);
-    if (!buffer) return NULL;
+void lsp_buffer_init(LspBuffer* buffer) {
+    if (!buffer) return;
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+void lsp_buffer_free(LspBuffer* buffer) {
+    if (!buffer) return;
+    free(buffer->data);
+    lsp_buffer_init(buffer);
+}
+
+void lsp_buffer_reset(LspBuffer* buffer) {
+    if (!buffer) return;
+    buffer->length = 0;
+    if (buffer->data) buffer->data[0] = '\0';
+}
+
+static int buffer_reserve(LspBuffer* buffer, size_t extra) {
+    if (buffer->length + extra + 1 <= buffer->capacity) return 0;
     
-    int offset = 0;
-    offset += snprintf(buffer + offset, buffer_size - offset, "{\"jsonrpc\":\"%s\"", msg->jsonrpc ? msg->jsonrpc : JSON_RPC_VERSION);
+    size_t capacity = buffer->capacity ? buffer->capacity : 1024;
+    while (buffer->length + extra + 1 > capacity) capacity *= 2;
     
-    if (msg->id || msg->id_is_number) {
-        if (msg->id_is_number) {
-            offset += snprintf(buffer + offset, buffer_size - offset, ",\"id\":%d", msg->id_number);
-        } else {
-            offset += snprintf(buffer + offset, buffer_size - offset, ",\"id\":\"%s\"", msg->id);
+    char* data = (char*)realloc(buffer->data, capacity);
+    if (!data) return -1;
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return 0;
+}
+
+int lsp_buffer_append(LspBuffer* buffer, const char* text, size_t length) {
+    if (!buffer || !text) return -1;
+    if (buffer_reserve(buffer, length) != 0) return -1;
+    memcpy(buffer->data + buffer->length, text, length);
+    buffer->length += length;
+    buffer->data[buffer->length] = '\0';
+    return 0;
+}
+
+int lsp_buffer_append_str(LspBuffer* buffer, const char* text) {
+    return text ? lsp_buffer_append(buffer, text, strlen(text)) : -1;
+}
+
+int lsp_buffer_append_int(LspBuffer* buffer, int value) {
+    char digits[16];
+    int len = snprintf(digits, sizeof(digits), "%d", value);
+    return lsp_buffer_append(buffer, digits, (size_t)len);
+}
+
+int lsp_buffer_append_json_string(LspBuffer* buffer, const char* text) {
+    if (!buffer || !text) return -1;
+    
+    if (lsp_buffer_append(buffer, "\"", 1) != 0) return -1;
+    
+    const char* run = text;
+    for (const char* p = text; *p; p++) {
+        unsigned char c = (unsigned char)*p;
+        char escape[8];
+        size_t escape_len = 2;
+        escape[0] = '\\';
+        switch (c) {
+            case '"': escape[1] = '"'; break;
+            case '\\': escape[1] = '\\'; break;
+            case '\b': escape[1] = 'b'; break;
+            case '\f': escape[1] = 'f'; break;
+            case '\n': escape[1] = 'n'; break;
+            case '\r': escape[1] = 'r'; break;
+            case '\t': escape[1] = 't'; break;
+            default:
+                if (c >= 0x20) continue;
+                snprintf(escape, sizeof(escape), "\\u%04x", c);
+                escape_len = 6;
+                break;
         }
+        if (lsp_buffer_append(buffer, run, (size_t)(p - run)) != 0) return -1;
+        if (lsp_buffer_append(buffer, escape, escape_len) != 0) return -1;
+        run = p + 1;
+    }
+    
+    if (lsp_buffer_append_str(buffer, run) != 0) return -1;
+    return lsp_buffer_append(buffer, "\"", 1);
+}
+
+int lsp_message_serialize_to(const LspMessage* msg, LspBuffer* buffer) {
+    if (!msg || !buffer) return -1;
+    
+    int rc = lsp_buffer_append_str(buffer, "{\"jsonrpc\":");
+    rc |= lsp_buffer_append_json_string(buffer, msg->jsonrpc ? msg->jsonrpc : JSON_RPC_VERSION);
+    
+    if (msg->id_is_number) {
+        rc |= lsp_buffer_append_str(buffer, ",\"id\":");
+        rc |= lsp_buffer_append_int(buffer, msg->id_number);
+    } else if (msg->id) {
+        rc |= lsp_buffer_append_str(buffer, ",\"id\":");
+        rc |= lsp_buffer_append_json_string(buffer, msg->id);
     }
     
     if (msg->method) {
-        offset += snprintf(buffer + offset, buffer_size - offset, ",\"method\":\"%s\"", msg->method);
+        rc |= lsp_buffer_append_str(buffer, ",\"method\":");
+        rc |= lsp_buffer_append_json_string(buffer, msg->method);
     }
     
     if (msg->params) {
-        offset += snprintf(buffer + offset, buffer_size - offset, ",\"params\":%s", msg->params);
+        rc |= lsp_buffer_append_str(buffer, ",\"params\":");
+        rc |= lsp_buffer_append_str(buffer, msg->params);
     }
     
     if (msg->result) {
-        offset += snprintf(buffer + offset, buffer_size - offset, ",\"result\":%s", msg->result);
+        rc |= lsp_buffer_append_str(buffer, ",\"result\":");
+        rc |= lsp_buffer_append_str(buffer, msg->result);
     }
     
     if (msg->error) {
-        offset += snprintf(buffer + offset, buffer_size - offset, ",\"error\":%s", msg->error);
+        rc |= lsp_buffer_append_str(buffer, ",\"error\":");
+        rc |= lsp_buffer_append_str(buffer, msg->error);
     }
     
-    offset += snprintf(buffer + offset, buffer_size - offset, "}");
-    
-    return buffer;
+    rc |= lsp_buffer_append(buffer, "}", 1);
+    return rc ? -1 : 0;
 }
 
-static char* extract_json_string(const char* json, const char* key, int* end_pos);
-
-static int extract_id(const char* json, LspMessage* msg) {
-    const char* key = "\"id\"";
-    const char* pos = strstr(json, key);
-    if (!pos) return 0;
-    
-    pos += strlen(key);
-    while (*pos && isspace((unsigned char)*pos)) pos++;
-    if (*pos != ':') return 0;
-    pos++;
-    while (*pos && isspace((unsigned char)*pos)) pos++;
+char* lsp_message_serialize(const LspMessage* msg) {
+    if (!msg) return NULL;
     
-    if (*pos == '"') {
-        pos++;
-        const char* end = pos;
-        while (*end && (*end != '"' || *(end-1) == '\\')) end++;
-        size_t len = end - pos;
-        msg->id = (char*)malloc(len + 1);
-        if (msg->id) {
-            strncpy(msg->id, pos, len);
-            msg->id[len] = '\0';
-        }
-        msg->id_is_number = 0;
-        return 1;
-    } else if (isdigit((unsigned char)*pos) || *pos == '-') {
-        msg->id_number = atoi(pos);
-        msg->id_is_number = 1;
-        return 1;
+    LspBuffer buffer;
+    lsp_buffer_init(&buffer);
+    if (lsp_message_serialize_to(msg, &buffer) != 0) {
+        lsp_buffer_free(&buffer);
+        return NULL;
     }
-    return 0;
+    return buffer.data;
 }
 
-static char* extract_json_string(const char* json, const char* key, int* end_pos) {
-    char pattern[256];
-    snprintf(pattern, sizeof(pattern), "\"%s\"", key);
-    const char* pos = strstr(json, pattern);
-    if (!pos) return NULL;
+static char* borrow_value(const LspJsonDocument* doc, int node, char* body) {
+    size_t length = 0;
+    const char* raw = lsp_json_raw(doc, node, &length);
+    if (!raw) return NULL;
+    
+    char* value = body + (raw - doc->text);
+    value[length] = '\0';
+    return value;
+}
+
+LspMessage* lsp_message_parse(char* body, size_t length, LspJsonDocument* scratch) {
+    if (!body) return NULL;
+    
+    LspJsonDocument local;
+    LspJsonDocument* doc = scratch;
+    if (!doc) {
+        lsp_json_document_init(&local);
+        doc = &local;
+    }
     
-    pos += strlen(pattern);
-    while (*pos && isspace((unsigned char)*pos)) pos++;
-    if (*pos != ':') return NULL;
-    pos++;
-    while (*pos && isspace((unsigned char)*pos)) pos++;
-    
-    if (*pos == '"') {
-        pos++;
-        const char* end = pos;
-        while (*end && (*end != '"' || *(end-1) == '\\')) end++;
-        size_t len = end - pos;
-        char* result = (char*)malloc(len + 1);
-        if (result) {
-            strncpy(result, pos, len);
-            result[len] = '\0';
-            if (end_pos) *end_pos = (int)(end - json);
-        }
-        return result;
-    } else if (*pos == '{') {
-        int brace_count = 1;
-        const char* end = pos + 1;
-        while (*end && brace_count > 0) {
-            if (*end == '{') brace_count++;
-            else if (*end == '}') brace_count--;
-            end++;
-        }
-        size_t len = end - pos;
-        char* result = (char*)malloc(len + 1);
-        if (result) {
-            strncpy(result, pos, len);
-            result[len] = '\0';
-            if (end_pos) *end_pos = (int)(end - json);
-        }
-        return result;
-    } else if (*pos == '[') {
-        int bracket_count = 1;
-        const char* end = pos + 1;
-        while (*end && bracket_count > 0) {
-            if (*end == '[') bracket_count++;
-            else if (*end == ']') bracket_count--;
-            end++;
-        }
-        size_t len = end - pos;
-        char* result = (char*)malloc(len + 1);
-        if (result) {
-            strncpy(result, pos, len);
-            result[len] = '\0';
-            if (end_pos) *end_pos = (int)(end - json);
+    LspMessage* msg = NULL;
+    if (lsp_json_parse(doc, body, length, 3) == 0 && lsp_json_type(doc, 0) == LSP_JSON_OBJECT) {
+        msg = lsp_message_create();
+    }
+    
+    if (msg) {
+        msg->jsonrpc = lsp_json_string_dup(doc, lsp_json_member(doc, 0, "jsonrpc"));
+        msg->method = lsp_json_string_dup(doc, lsp_json_member(doc, 0, "method"));
+        
+        int id = lsp_json_member(doc, 0, "id");
+        if (lsp_json_type(doc, id) == LSP_JSON_NUMBER) {
+            msg->id_is_number = 1;
+            msg->id_number = lsp_json_int(doc, id, 0);
+        } else {
+            msg->id = lsp_json_string_dup(doc, id);
         }
-        return result;
+        
+        int error = lsp_json_member(doc, 0, "error");
+        msg->error_code = lsp_json_int(doc, lsp_json_member(doc, error, "code"), 0);
+        
+        int params = lsp_json_member(doc, 0, "params");
+        int result = lsp_json_member(doc, 0, "result");
+        msg->body = body;
+        msg->params = params >= 0 ? borrow_value(doc, params, body) : NULL;
+        msg->result = result >= 0 ? borrow_value(doc, result, body) : NULL;
+        msg->error = error >= 0 ? borrow_value(doc, error, body) : NULL;
     } else {
-        const char* end = pos;
-        while (*end && (*end != ',' && *end != '}' && !isspace((unsigned char)*end))) end++;
-        size_t len = end - pos;
-        char* result = (char*)malloc(len + 1);
-        if (result) {
-            strncpy(result, pos, len);
-            result[len] = '\0';
-            if (end_pos) *end_pos = (int)(end - json);
-        }
-        return result;
+        free(body);
     }
+    
+    if (doc == &local) lsp_json_document_free(&local);
+    return msg;
 }
 
 LspMessage* lsp_message_deserialize(const char* json) {
     if (!json) return NULL;
     
-    LspMessage* msg = lsp_message_create();
-    if (!msg) return NULL;
-    
-    msg->jsonrpc = extract_json_string(json, "jsonrpc", NULL);
-    extract_id(json, msg);
-    msg->method = extract_json_string(json, "method", NULL);
-    msg->params = extract_json_string(json, "params", NULL);
-    msg->result = extract_json_string(json, "result", NULL);
-    
-    char* error_obj = extract_json_string(json, "error", NULL);
-    if (error_obj) {
-        msg->error = error_obj;
-        char* code_str = extract_json_string(error_obj, "code", NULL);
-        if (code_str) {
-            msg->error_code = atoi(code_str);
-            free(code_str);
-        }
-    }
-    
-    return msg;
+    char* body = strdup(json);
+    if (!body) return NULL;
+    return lsp_message_parse(body, strlen(body), NULL);
 }
 
 int lsp_message_is_request(const LspMessage* msg) {
@@ -294,6 +329,12 @@ int lsp_message_is_notification(const LspMessage* msg) {
     return msg && !msg->id && !msg->id_is_number && msg->method;
 }
 
+int lsp_message_same_id(const LspMessage* a, const LspMessage* b) {
+    if (!a || !b || a->id_is_number != b->id_is_number) return 0;
+    if (a->id_is_number) return a->id_number == b->id_number;
+    return a->id && b->id && strcmp(a->id, b->id) == 0;
+}
+
 int lsp_message_is_batch(const char* json) {
     if (!json) return 0;
     while (*json && isspace((unsigned char)*json)) json++;
@@ -435,36 +476,51 @@ int lsp_write_message(FILE* out, const char* content) {
     size_t len = strlen(content);
     fprintf(out, "Content-Length: %zu\r\n", len);
     fprintf(out, "\r\n");
-    fprintf(out, "%s", content);
+    fwrite(content, 1, len, out);
     fflush(out);
     return 0;
 }
 
-char* lsp_read_message(FILE* in) {
+int lsp_write_buffer(FILE* out, const LspBuffer* buffer) {
+    if (!out || !buffer || !buffer->data) return -1;
+    
+    fprintf(out, "Content-Length: %zu\r\n\r\n", buffer->length);
+    if (fwrite(buffer->data, 1, buffer->length, out) != buffer->length) return -1;
+    fflush(out);
+    return 0;
+}
+
+static int header_matches(const char* line, const char* name) {
+    while (*name) {
+        if (tolower((unsigned char)*line) != tolower((unsigned char)*name)) return 0;
+        line++;
+        name++;
+    }
+    return *line == ':';
+}
+
+char* lsp_read_message_body(FILE* in, size_t* length) {
     if (!in) return NULL;
     
-    char header[4096];
-    size_t header_len = 0;
-    int in_header = 1;
-    int c;
+    char line[1024];
+    size_t content_len = 0;
+    int have_length = 0;
     
-    while (in_header && header_len < sizeof(header) - 1) {
-        c = fgetc(in);
-        if (c == EOF) return NULL;
-        header[header_len++] = (char)c;
-        header[header_len] = '\0';
-        
-        if (header_len >= 4 && strcmp(header + header_len - 4, "\r\n\r\n") == 0) {
-            in_header = 0;
+    for (;;) {
+        if (!fgets(line, sizeof(line), in)) return NULL;
+        if (strcmp(line, "\r\n") == 0 || strcmp(line, "\n") == 0) {
+            if (have_length) break;
+            continue;
+        }
+        if (header_matches(line, "Content-Length")) {
+            char* end = NULL;
+            unsigned long value = strtoul(line + 15, &end, 10);
+            if (end == line + 15) return NULL;
+            content_len = (size_t)value;
+            have_length = 1;
         }
     }
     
-    char* len_str = lsp_read_header_content_length(header);
-    if (!len_str) return NULL;
-    
-    size_t content_len = atoi(len_str);
-    free(len_str);
-    
     if (content_len == 0 || content_len > 100 * 1024 * 1024) {
         return NULL;
     }
@@ -479,5 +535,10 @@ char* lsp_read_message(FILE* in) {
     }
     content[content_len] = '\0';
     
+    if (length) *length = content_len;
     return content;
 }
+
+char* lsp_read_message(FILE* in) {
+    return lsp_read_message_body(in, NULL);
+}
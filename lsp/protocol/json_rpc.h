@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "json_reader.h"
 
 #define JSON_RPC_VERSION "2.0"
 
@@ -16,7 +17,8 @@ typedef enum {
     LSP_SERVER_ERROR_START = -32099,
     LSP_SERVER_ERROR_END = -32000,
     LSP_SERVER_NOT_INITIALIZED = -32002,
-    LSP_UNKNOWN_ERROR_CODE = -32001
+    LSP_UNKNOWN_ERROR_CODE = -32001,
+    LSP_REQUEST_CANCELLED = -32800
 } LspErrorCode;
 
 typedef struct {
@@ -29,8 +31,15 @@ typedef struct {
     char* result;
     char* error;
     int error_code;
+    char* body;
 } LspMessage;
 
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} LspBuffer;
+
 typedef struct {
     char** items;
     int count;
@@ -49,21 +58,34 @@ LspMessage* lsp_message_create_error_num(int id, int code, const char* message);
 LspMessage* lsp_message_create_notification(const char* method, const char* params);
 
 char* lsp_message_serialize(const LspMessage* msg);
+int lsp_message_serialize_to(const LspMessage* msg, LspBuffer* buffer);
 LspMessage* lsp_message_deserialize(const char* json);
+LspMessage* lsp_message_parse(char* body, size_t length, LspJsonDocument* scratch);
 
 int lsp_message_is_request(const LspMessage* msg);
 int lsp_message_is_response(const LspMessage* msg);
 int lsp_message_is_notification(const LspMessage* msg);
+int lsp_message_same_id(const LspMessage* a, const LspMessage* b);
 int lsp_message_is_batch(const char* json);
 
 LspMessageBatch* lsp_message_batch_parse(const char* json);
 void lsp_message_batch_destroy(LspMessageBatch* batch);
 
+void lsp_buffer_init(LspBuffer* buffer);
+void lsp_buffer_free(LspBuffer* buffer);
+void lsp_buffer_reset(LspBuffer* buffer);
+int lsp_buffer_append(LspBuffer* buffer, const char* text, size_t length);
+int lsp_buffer_append_str(LspBuffer* buffer, const char* text);
+int lsp_buffer_append_int(LspBuffer* buffer, int value);
+int lsp_buffer_append_json_string(LspBuffer* buffer, const char* text);
+
 char* lsp_json_escape(const char* str);
 char* lsp_json_unescape(const char* str);
 
 char* lsp_read_header_content_length(const char* header);
 int lsp_write_message(FILE* out, const char* content);
+int lsp_write_buffer(FILE* out, const LspBuffer* buffer);
 char* lsp_read_message(FILE* in);
+char* lsp_read_message_body(FILE* in, size_t* length);
 
 #endif